@@ -119,6 +119,14 @@ MultiCommands::~MultiCommands()
            [] (Command *pcmd) {delete pcmd;});
 }
 
+size_t MultiCommands::GetMemorySize() const
+{
+  size_t size = sizeof(*this) + m_vRCs.size() * sizeof(int);
+  for (const Command *pcmd : m_vpcmds)
+    size += pcmd->GetMemorySize();
+  return size;
+}
+
 Command *MultiCommands::FindCommand(const std::type_info &ti)
 {
   // Initial implementation - search for first command of a specific class
@@ -189,6 +197,25 @@ void MultiCommands::Add(Command *pcmd)
   m_vpcmds.push_back(pcmd);
 }
 
+int MultiCommands::AddAndExecute(Command *pcmd)
+{
+  ASSERT(pcmd != nullptr);
+  if (pcmd->IsEntryChangeType() &&
+      std::none_of(m_vpcmds.begin(), m_vpcmds.end(),
+                   [] (Command *pc) {return pc != nullptr && pc->IsEntryChangeType();})) {
+    // As in Execute, save the DB information before the first command
+    // that could change an entry
+    SaveDBInformation();
+  }
+
+  Add(pcmd);
+  const int rc = pcmd->Execute();
+  if (pcmd->WasDBChanged())
+    m_CommandDBChange = CommandDBChange::MULTICOMMAND;
+  m_vRCs.push_back(rc);
+  return rc;
+}
+
 void MultiCommands::Insert(Command *pcmd, size_t ioffset)
 {
   // VERY INEFFICIENT - use sparingly to insert commands into the
@@ -636,6 +663,14 @@ DeleteEntryCommand::~DeleteEntryCommand()
 {
 }
 
+size_t DeleteEntryCommand::GetMemorySize() const
+{
+  size_t size = sizeof(*this) + m_ci.GetSize() + m_att.GetSize();
+  for (const auto &dependent : m_vdependents)
+    size += dependent.GetSize();
+  return size;
+}
+
 int DeleteEntryCommand::Execute()
 {
   // Get out quick if R-O
@@ -795,11 +830,11 @@ void DeleteAttachmentCommand::Undo()
 EditEntryCommand::EditEntryCommand(CommandInterface *pcomInt,
                                    const CItemData &old_ci,
                                    const CItemData &new_ci)
-  : Command(pcomInt), m_old_ci(old_ci), m_new_ci(new_ci)
+  : Command(pcomInt), m_uuid(old_ci.GetUUID()), m_delta(old_ci, new_ci)
 {
   // We're only supposed to operate on entries
   // with same uuids, and possibly different fields
-  ASSERT(m_old_ci.GetUUID() == m_new_ci.GetUUID());
+  ASSERT(old_ci.GetUUID() == new_ci.GetUUID());
 
   m_CommandChangeType = DB;
 }
@@ -808,24 +843,44 @@ EditEntryCommand::~EditEntryCommand()
 {
 }
 
+void EditEntryCommand::Replace(const bool bRedo)
+{
+  // The entry in the core is the one before the edit on execute or redo,
+  // and the one after it on undo
+  ItemListIter pos = m_pcomInt->Find(m_uuid);
+  ASSERT(pos != m_pcomInt->GetEntryEndIter());
+  if (pos == m_pcomInt->GetEntryEndIter())
+    return;
+
+  const CItemData old_ci(pos->second);
+  CItemData new_ci(old_ci);
+  if (bRedo)
+    m_delta.Apply(new_ci);
+  else
+    m_delta.Revert(new_ci);
+
+  m_pcomInt->DoReplaceEntry(old_ci, new_ci);
+
+  if (bRedo) {
+    m_pcomInt->AddChangedNodes(old_ci.GetGroup());
+    m_pcomInt->AddChangedNodes(new_ci.GetGroup());
+  }
+
+  if (m_bNotifyGUI) {
+    // If the entry's group has changed, refresh the entire tree, otherwise, just the entry
+    // in the tree and list views
+    UpdateGUICommand::GUI_Action gac = (old_ci.GetGroup() != new_ci.GetGroup()) ?
+      UpdateGUICommand::GUI_REFRESH_TREE : UpdateGUICommand::GUI_REFRESH_ENTRY;
+    m_pcomInt->NotifyGUINeedsUpdating(gac, m_uuid);
+  }
+}
+
 int EditEntryCommand::Execute()
 {
   if (!m_pcomInt->IsReadOnly()) {
     SaveDBInformation();
 
-    m_pcomInt->DoReplaceEntry(m_old_ci, m_new_ci);
-
-    m_pcomInt->AddChangedNodes(m_old_ci.GetGroup());
-    m_pcomInt->AddChangedNodes(m_new_ci.GetGroup());
-
-    if (m_bNotifyGUI) {
-      const CUUID entry_uuid = m_old_ci.GetUUID();
-      // If the entry's group has changed, refresh the entire tree, otherwise, just the entry
-      // in the tree and list views
-      UpdateGUICommand::GUI_Action gac = (m_old_ci.GetGroup() != m_new_ci.GetGroup()) ?
-        UpdateGUICommand::GUI_REFRESH_TREE : UpdateGUICommand::GUI_REFRESH_ENTRY;
-      m_pcomInt->NotifyGUINeedsUpdating(gac, entry_uuid);
-    }
+    Replace(true);
 
     m_CommandDBChange = DB;
   }
@@ -835,16 +890,7 @@ int EditEntryCommand::Execute()
 void EditEntryCommand::Undo()
 {
   if (!m_pcomInt->IsReadOnly() && m_CommandDBChange == DB) {
-    m_pcomInt->DoReplaceEntry(m_new_ci, m_old_ci);
-
-    if (m_bNotifyGUI) {
-      const CUUID entry_uuid = m_old_ci.GetUUID();
-      // If the entry's group has changed, refresh the entire tree, otherwise, just the entry
-      // in the tree and list views
-      UpdateGUICommand::GUI_Action gac = (m_old_ci.GetGroup() != m_new_ci.GetGroup()) ?
-                UpdateGUICommand::GUI_REFRESH_TREE : UpdateGUICommand::GUI_REFRESH_ENTRY;
-      m_pcomInt->NotifyGUINeedsUpdating(gac, entry_uuid);
-    }
+    Replace(false);
 
     RestoreDBInformation();
   }
@@ -899,19 +945,25 @@ UpdateEntryCommand::UpdateEntryCommand(CommandInterface *pcomInt,
 {
   m_CommandChangeType = DB;
 
+  m_old_ci.KeepFields({CItemData::UUID, ftype});
   m_new_ci.SetFieldValue(ftype, value);
 }
 
-void UpdateEntryCommand::Doit(const CUUID &entry_uuid,
-                              CItemData::FieldType ftype,
-                              const StringX &value,
+void UpdateEntryCommand::Doit(const StringX &value,
                               CItemData::EntryStatus es,
                               UpdateGUICommand::ExecuteFn efn)
 {
+  const CUUID &entry_uuid = m_old_ci.GetUUID();
   ItemListIter pos = m_pcomInt->Find(entry_uuid);
   if (pos != m_pcomInt->GetEntryEndIter()) {
-    if (ftype != CItemData::PASSWORD)
-      pos->second.SetFieldValue(ftype, value);
+    if (m_ftype == CItemData::POLICYNAME) {
+      const StringX sxOldPolicyName = pos->second.GetPolicyName();
+      pos->second.SetFieldValue(m_ftype, value);
+      // Only normal entries are in the policy index
+      m_pcomInt->UpdatePolicyEntry(entry_uuid, sxOldPolicyName,
+                                   pos->second.IsNormal() ? pos->second.GetPolicyName() : StringX());
+    } else if (m_ftype != CItemData::PASSWORD)
+      pos->second.SetFieldValue(m_ftype, value);
     else {
       time_t tttoldXtime;
       if (efn == UpdateGUICommand::WN_EXECUTE_REDO) {
@@ -926,8 +978,8 @@ void UpdateEntryCommand::Doit(const CUUID &entry_uuid,
         pos->second.SetPWHistory(m_old_ci.GetPWHistory());
       }
     }
-    if (ftype == CItemData::PASSWORD ||
-        ftype == CItemData::XTIME)
+    if (m_ftype == CItemData::PASSWORD ||
+        m_ftype == CItemData::XTIME)
       m_pcomInt->UpdateExpiryEntry(pos->second);
 
     pos->second.SetStatus(es);
@@ -940,8 +992,8 @@ int UpdateEntryCommand::Execute()
   if (!m_pcomInt->IsReadOnly()) {
     SaveDBInformation();
 
-    Doit(m_old_ci.GetUUID(), m_ftype, m_new_ci.GetFieldValue(m_ftype),
-         CItemData::ES_MODIFIED, UpdateGUICommand::WN_EXECUTE_REDO);
+    Doit(m_new_ci.GetFieldValue(m_ftype), CItemData::ES_MODIFIED,
+         UpdateGUICommand::WN_EXECUTE_REDO);
 
     if (m_bNotifyGUI)
       m_pcomInt->NotifyGUINeedsUpdating(UpdateGUICommand::GUI_REFRESH_ENTRYFIELD,
@@ -959,8 +1011,8 @@ int UpdateEntryCommand::Execute()
 void UpdateEntryCommand::Undo()
 {
   if (!m_pcomInt->IsReadOnly() && m_CommandDBChange == DB) {
-    Doit(m_old_ci.GetUUID(), m_ftype, m_old_ci.GetFieldValue(m_ftype),
-         m_old_ci.GetStatus(), UpdateGUICommand::WN_UNDO);
+    Doit(m_old_ci.GetFieldValue(m_ftype), m_old_ci.GetStatus(),
+         UpdateGUICommand::WN_UNDO);
 
     if (m_bNotifyGUI)
       m_pcomInt->NotifyGUINeedsUpdating(UpdateGUICommand::GUI_REFRESH_ENTRYFIELD,
@@ -983,6 +1035,8 @@ UpdatePasswordCommand::UpdatePasswordCommand(CommandInterface *pcomInt,
 {
   m_CommandChangeType = DB;
 
+  m_old_ci.KeepFields({CItemData::UUID, CItemData::ALIASUUID, CItemData::SHORTCUTUUID,
+                       CItemData::PASSWORD, CItemData::PWHIST, CItemData::XTIME});
   m_new_ci.SetPassword(sxNewPassword);
 }
 
@@ -48,6 +48,10 @@ public:
   virtual int Redo() {return Execute();} // common case
   virtual void Undo() = 0;
 
+  // Rough estimate of the memory held for undo and redo, which PWScore
+  // keeps within the MaxUndoMemory preference
+  virtual size_t GetMemorySize() const {return sizeof(*this);}
+
   void SetNoGUINotify() {m_bNotifyGUI = false;}
   bool GetGUINotify() const {return m_bNotifyGUI;}
 
@@ -238,6 +242,8 @@ public:
   ~AddEntryCommand();
   int Execute();
   void Undo();
+  size_t GetMemorySize() const override
+  { return sizeof(*this) + m_ci.GetSize() + m_att.GetSize(); }
 
   friend class DeleteEntryCommand; // allow access to c'tor
 
@@ -260,6 +266,7 @@ public:
   ~DeleteEntryCommand();
   int Execute();
   void Undo();
+  size_t GetMemorySize() const override;
 
   friend class AddEntryCommand; // allow access to c'tor
 
@@ -284,11 +291,16 @@ public:
   int Execute();
   void Undo();
 
+  size_t GetMemorySize() const override
+  { return sizeof(*this) + m_delta.GetSize(); }
+
 private:
   EditEntryCommand(CommandInterface *pcomInt, const CItemData &old_ci,
                    const CItemData &new_ci);
-  CItemData m_old_ci;
-  CItemData m_new_ci;
+  void Replace(const bool bRedo);
+
+  const pws_os::CUUID m_uuid;
+  const CItemDataDelta m_delta; // rather than both versions of the entry
 };
 
 class DeleteAttachmentCommand : public Command
@@ -301,6 +313,8 @@ public:
   ~DeleteAttachmentCommand();
   int Execute();
   void Undo();
+  size_t GetMemorySize() const override
+  { return sizeof(*this) + m_ci.GetSize() + m_att.GetSize(); }
 
 private:
   DeleteAttachmentCommand& operator=(const DeleteEntryCommand&) = delete; // Do not implement
@@ -320,6 +334,8 @@ public:
   ~EditAttachmentCommand();
   int Execute();
   void Undo();
+  size_t GetMemorySize() const override
+  { return sizeof(*this) + m_old_att.GetSize() + m_new_att.GetSize(); }
 
 private:
   EditAttachmentCommand(CommandInterface *pcomInt, const CItemAtt &old_att,
@@ -338,17 +354,20 @@ public:
   { return new UpdateEntryCommand(pcomInt, ci, ftype, value); }
   int Execute();
   void Undo();
+  size_t GetMemorySize() const override
+  { return sizeof(*this) + m_old_ci.GetSize() + m_new_ci.GetSize(); }
 
 private:
   UpdateEntryCommand(CommandInterface *pcomInt, const CItemData &ci,
                      const CItemData::FieldType ftype,
                      const StringX &value);
-  void Doit(const pws_os::CUUID &entry_uuid,
-            CItemData::FieldType ftype,
-            const StringX &value,
+  void Doit(const StringX &value,
             CItemData::EntryStatus es,
             UpdateGUICommand::ExecuteFn efn);
 
+  // Just the field, before and after, encrypted as in the entry. A new
+  // password also changes the history and expiry time, whose old values
+  // are added to m_old_ci when it's set.
   CItemData m_old_ci;
   CItemData m_new_ci;
   const CItemData::FieldType m_ftype;
@@ -363,11 +382,13 @@ public:
   { return new UpdatePasswordCommand(pcomInt, ci, sxNewPassword); }
   int Execute();
   void Undo();
+  size_t GetMemorySize() const override
+  { return sizeof(*this) + m_old_ci.GetSize() + m_new_ci.GetSize(); }
 
 private:
   UpdatePasswordCommand(CommandInterface *pcomInt,
                         const CItemData &ci, const StringX &sxNewPassword);
-  const CItemData m_old_ci; // for uuid, password, password history, XTime, entry status
+  CItemData m_old_ci; // for uuid, password, password history, XTime, entry status
   CItemData m_new_ci; // for new password
 };
 
@@ -552,8 +573,12 @@ public:
   ~MultiCommands();
   int Execute();
   void Undo();
+  size_t GetMemorySize() const override;
 
   void Add(Command *pcmd);
+  // Adds a command to an already executed MultiCommands and executes it,
+  // for PWScore::Transaction
+  int AddAndExecute(Command *pcmd);
   void Insert(Command *pcmd, size_t ioffset = 0); // VERY INEFFICIENT - use sparingly
   bool GetRC(Command *pcmd, int &rc);
   bool GetRC(const size_t ncmd, int &rc);
@@ -701,6 +726,9 @@ public:
   
   int Execute() override;
   void Undo() override;
+
+  const StringX& GetOldName() const { return m_OldName; }
+  const StringX& GetNewName() const { return m_NewName; }
 };
 
 #endif /*  __COMMAND_H */
@@ -96,6 +96,11 @@ class CommandInterface {
                                  const StringX &value) = 0;
   virtual void RemoveExpiryEntry(const CItemData &ci) = 0;
 
+  // An entry's password policy name has changed in place
+  virtual void UpdatePolicyEntry(const pws_os::CUUID &uuid,
+                                 const StringX &sxOldPolicyName,
+                                 const StringX &sxNewPolicyName) = 0;
+
   virtual const PSWDPolicyMap &GetPasswordPolicies() = 0;
   virtual bool SetPasswordPolicies(const PSWDPolicyMap &MapPSWDPLC) = 0;
   virtual bool AddPolicy(const StringX &sxPolicyName, const PWPolicy &st_pp,
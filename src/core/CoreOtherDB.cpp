@@ -65,7 +65,7 @@ void PWScore::Compare(PWScore *pothercore,
                       const int &subgroup_object, const int &subgroup_function,
                       CompareData &list_OnlyInCurrent, CompareData &list_OnlyInComp,
                       CompareData &list_Conflicts, CompareData &list_Identical,
-                      bool *pbCancel)
+                      bool *pbCancel, const bool bWithGTU)
 {
   /*
   Purpose:
@@ -90,6 +90,11 @@ void PWScore::Compare(PWScore *pothercore,
       if not found
         save & increment numOnlyInComp
     }
+
+    If bWithGTU is false, the results only hold the uuids and differences,
+    and the caller looks up the group, title and user when it needs them.
+    This saves three string copies per entry, which adds up when most of a
+    large database ends up in list_Identical.
   */
 
   CItemData::FieldBits bsConflicts(0);
@@ -111,19 +116,25 @@ void PWScore::Compare(PWScore *pothercore,
     if (!subgroup_bset ||
         currentItem.Matches(std::wstring(subgroup_name), subgroup_object,
                             subgroup_function)) {
-      st_data.group = currentItem.GetGroup();
-      st_data.title = currentItem.GetTitle();
-      st_data.user = currentItem.GetUser();
+      const StringX group = currentItem.GetGroup();
+      const StringX title = currentItem.GetTitle();
+      const StringX user = currentItem.GetUser();
+      if (bWithGTU) {
+        st_data.group = group;
+        st_data.title = title;
+        st_data.user = user;
+      }
 
-      StringX sx_original;
-      Format(sx_original, PWScore::GROUPTITLEUSERINCHEVRONS,
-                st_data.group.c_str(), st_data.title.c_str(), st_data.user.c_str());
+      if (!m_Observers.empty()) {
+        StringX sx_original;
+        Format(sx_original, PWScore::GROUPTITLEUSERINCHEVRONS,
+                  group.c_str(), title.c_str(), user.c_str());
 
-      // Update the Wizard page
-      UpdateWizard(sx_original.c_str());
+        // Update the Wizard page
+        UpdateWizard(sx_original.c_str());
+      }
 
-      ItemListIter foundPos = pothercore->Find(st_data.group,
-                                               st_data.title, st_data.user);
+      ItemListIter foundPos = pothercore->Find(group, title, user);
       if (foundPos != pothercore->GetEntryEndIter()) {
         // found a match, see if all other fields also match
         // Difference flags:
@@ -345,24 +356,30 @@ void PWScore::Compare(PWScore *pothercore,
     }
 
     st_data.Empty();
-    CItemData compItem = pothercore->GetEntry(compPos);
+    const CItemData &compItem = pothercore->GetEntry(compPos);
 
     if (!subgroup_bset ||
         compItem.Matches(std::wstring(subgroup_name), subgroup_object,
                          subgroup_function)) {
-      st_data.group = compItem.GetGroup();
-      st_data.title = compItem.GetTitle();
-      st_data.user = compItem.GetUser();
+      const StringX group = compItem.GetGroup();
+      const StringX title = compItem.GetTitle();
+      const StringX user = compItem.GetUser();
+      if (bWithGTU) {
+        st_data.group = group;
+        st_data.title = title;
+        st_data.user = user;
+      }
 
-      StringX sx_compare;
-      Format(sx_compare, PWScore::GROUPTITLEUSERINCHEVRONS,
-                st_data.group.c_str(), st_data.title.c_str(), st_data.user.c_str());
+      if (!m_Observers.empty()) {
+        StringX sx_compare;
+        Format(sx_compare, PWScore::GROUPTITLEUSERINCHEVRONS,
+                  group.c_str(), title.c_str(), user.c_str());
 
-      // Update the Wizard page
-      UpdateWizard(sx_compare.c_str());
+        // Update the Wizard page
+        UpdateWizard(sx_compare.c_str());
+      }
 
-      if (Find(st_data.group, st_data.title, st_data.user) ==
-          GetEntryEndIter()) {
+      if (Find(group, title, user) == GetEntryEndIter()) {
         // Didn't find any match...
         numOnlyInComp++;
         st_data.uuid0 = CUUID::NullUUID();
@@ -1050,16 +1067,72 @@ void PWScore::Synchronize(PWScore *pothercore,
                           const stringT &subgroup_name,
                           const int &subgroup_object, const int &subgroup_function,
                           int &numUpdated, CReport *pRpt, bool *pbCancel)
+{
+  std::vector<StringX> vs_updated;
+  numUpdated = 0;
+
+  MultiCommands *pmulticmds = PrepareSynchronize(pothercore, bsFields, subgroup_bset,
+                                                 subgroup_name, subgroup_object,
+                                                 subgroup_function, vs_updated, pbCancel);
+  if (pmulticmds == nullptr)
+    return;
+
+  numUpdated = static_cast<int>(vs_updated.size());
+
+  stringT str_results;
+  if (numUpdated > 0 && pRpt != nullptr) {
+    stringT str_singular_plural_type, str_singular_plural_verb;
+    LoadAString(str_singular_plural_type, numUpdated == 1 ? IDSC_ENTRY : IDSC_ENTRIES);
+    LoadAString(str_singular_plural_verb, numUpdated == 1 ? IDSC_WAS : IDSC_WERE);
+    Format(str_results, IDSC_SYNCHUPDATED, str_singular_plural_type.c_str(),
+                    str_singular_plural_verb.c_str());
+    pRpt->WriteLine(str_results.c_str());
+    for (size_t i = 0; i < vs_updated.size(); i++) {
+      Format(str_results, L"\t%ls", vs_updated[i].c_str());
+      pRpt->WriteLine(str_results.c_str());
+    }
+  }
+
+  // Stop updating the GUI whilst Synchronise is in progress
+  SuspendOnDBNotification();
+  Execute(pmulticmds);
+  // Resume updating the GUI after Synchronise has completed
+  ResumeOnDBNotification();
+
+  // See if user has cancelled too late - reset flag so incorrect information not given to user
+  if (pbCancel != nullptr && *pbCancel) {
+    *pbCancel = false;
+    return;
+  }
+
+  // tell the user we're done & provide short Synchronize report
+  if (pRpt != nullptr) {
+    stringT str_entries;
+    LoadAString(str_entries, numUpdated == 1 ? IDSC_ENTRY : IDSC_ENTRIES);
+    Format(str_results, IDSC_SYNCHCOMPLETED, numUpdated, str_entries.c_str());
+    pRpt->WriteLine(str_results.c_str());
+  }
+}
+
+MultiCommands *PWScore::PrepareSynchronize(const PWScore *pothercore,
+                                           const CItemData::FieldBits &bsFields, const bool &subgroup_bset,
+                                           const stringT &subgroup_name,
+                                           const int &subgroup_object, const int &subgroup_function,
+                                           std::vector<StringX> &vs_updated, bool *pbCancel,
+                                           const SyncProgressFn &progress)
 {
   /*
   Purpose:
-    Synchronize entries from otherCore to m_core
+    Build the commands that synchronize entries from otherCore to m_core
 
   Algorithm:
     Foreach entry in otherCore
       Find in m_core
         if find a match
           update requested fields
+
+  Nothing here notifies the GUI: the entry edits are marked not to, and
+  the GUI is updated once around the whole set when it's executed.
   */
 
   CItemData::FieldBits bsSyncFields(bsFields);
@@ -1074,11 +1147,7 @@ void PWScore::Synchronize(PWScore *pothercore,
     bsSyncFields.reset(ftInappropriateSyncFields[i]);
   }
 
-  std::vector<StringX> vs_updated;
-  numUpdated = 0;
-
-  // Stop updating the GUI whilst Synchronise is in progress
-  SuspendOnDBNotification();
+  vs_updated.clear();
 
   MultiCommands *pmulticmds = MultiCommands::Create(this);
   Command *pcmd1 = UpdateGUICommand::Create(this, UpdateGUICommand::WN_UNDO,
@@ -1090,17 +1159,22 @@ void PWScore::Synchronize(PWScore *pothercore,
   std::vector<StringX> vs_PoliciesAdded;
   const StringX sxSync_DateTime = PWSUtil::GetTimeStamp(true).c_str();
 
+  const size_t numOther = pothercore->GetNumEntries();
+  size_t numDone = 0;
+
   ItemListConstIter otherPos;
   for (otherPos = pothercore->GetEntryIter();
        otherPos != pothercore->GetEntryEndIter();
-       otherPos++) {
+       otherPos++, numDone++) {
     // See if user has cancelled
-    if (pbCancel != nullptr && *pbCancel) {
+    if ((pbCancel != nullptr && *pbCancel) ||
+        (progress && (numDone % PROGRESS_INTERVAL) == 0 &&
+         !progress(SyncProgress{SyncProgress::MATCHING, numDone, numOther}))) {
       delete pmulticmds;
-      return;
+      return nullptr;
     }
 
-    CItemData otherItem = pothercore->GetEntry(otherPos);
+    const CItemData &otherItem = pothercore->GetEntry(otherPos);
     CItemData::EntryType et = otherItem.GetEntryType();
 
     // Do not process Aliases and Shortcuts
@@ -1115,15 +1189,11 @@ void PWScore::Synchronize(PWScore *pothercore,
     const StringX sx_otherTitle = otherItem.GetTitle();
     const StringX sx_otherUser = otherItem.GetUser();
 
-    StringX sx_mergedentry;
-    Format(sx_mergedentry, PWScore::GROUPTITLEUSERINCHEVRONS,
-                sx_otherGroup.c_str(), sx_otherTitle.c_str(), sx_otherUser.c_str());
-
     ItemListConstIter foundPos = Find(sx_otherGroup, sx_otherTitle, sx_otherUser);
 
     if (foundPos != GetEntryEndIter()) {
       // found a match
-      CItemData curItem = GetEntry(foundPos);
+      const CItemData &curItem = GetEntry(foundPos);
 
       // Don't update if entry is protected
       if (curItem.IsProtected())
@@ -1174,56 +1244,25 @@ void PWScore::Synchronize(PWScore *pothercore,
       vs_updated.push_back(sx_updated);
 
       Command *pcmd = EditEntryCommand::Create(this, curItem, updItem);
+      pcmd->SetNoGUINotify();
       pmulticmds->Add(pcmd);
 
-      // Update the Wizard page
-      UpdateWizard(sx_updated.c_str());
-
-      numUpdated++;
+      // Update the Wizard page, for callers that don't follow the progress
+      if (!progress)
+        UpdateWizard(sx_updated.c_str());
     }  // Found match via [g:t:u]
   } // iteration over other core's entries
 
-  stringT str_results;
-  if (numUpdated > 0 && pRpt != nullptr) {
-    std::sort(vs_updated.begin(), vs_updated.end(), MergeSyncGTUCompare);
-    stringT str_singular_plural_type, str_singular_plural_verb;
-    LoadAString(str_singular_plural_type, numUpdated == 1 ? IDSC_ENTRY : IDSC_ENTRIES);
-    LoadAString(str_singular_plural_verb, numUpdated == 1 ? IDSC_WAS : IDSC_WERE);
-    Format(str_results, IDSC_SYNCHUPDATED, str_singular_plural_type.c_str(),
-                    str_singular_plural_verb.c_str());
-    pRpt->WriteLine(str_results.c_str());
-    for (size_t i = 0; i < vs_updated.size(); i++) {
-      Format(str_results, L"\t%ls", vs_updated[i].c_str());
-      pRpt->WriteLine(str_results.c_str());
-    }
-  }
-
-  // See if user has cancelled
-  if (pbCancel != nullptr && *pbCancel) {
+  if (progress && !progress(SyncProgress{SyncProgress::REPORTING, 0, vs_updated.size()})) {
     delete pmulticmds;
-    ResumeOnDBNotification();
-    return;
+    return nullptr;
   }
+  std::sort(vs_updated.begin(), vs_updated.end(), MergeSyncGTUCompare);
 
   Command *pcmd2 = UpdateGUICommand::Create(this, UpdateGUICommand::WN_REDO,
                                             UpdateGUICommand::GUI_REDO_MERGESYNC);
   pmulticmds->Add(pcmd2);
-  Execute(pmulticmds);
-
-  // Resume updating the GUI after Synchronise has completed
-  ResumeOnDBNotification();
-
-  // See if user has cancelled too late - reset flag so incorrect information not given to user
-  if (pbCancel != nullptr && *pbCancel) {
-    *pbCancel = false;
-    return;
-  }
-
-  // tell the user we're done & provide short Synchronize report
-  stringT str_entries;
-  LoadAString(str_entries, numUpdated == 1 ? IDSC_ENTRY : IDSC_ENTRIES);
-  Format(str_results, IDSC_SYNCHCOMPLETED, numUpdated, str_entries.c_str());
-  pRpt->WriteLine(str_results.c_str());
+  return pmulticmds;
 }
 
 Command *PWScore::ProcessPolicyName(const PWScore *pothercore, CItemData &updtEntry,
@@ -12,9 +12,6 @@
 #include "ItemData.h"
 #include "os/funcwrap.h"
 
-#include <functional>
-#include <algorithm>
-
 using namespace std;
 
 ExpPWEntry::ExpPWEntry(const CItemData &ci)
@@ -34,7 +31,7 @@ ExpPWEntry::ExpPWEntry(const CItemData &ci)
   expirytttXTime = tttXTime;
 }
 
-void ExpiredList::Add(const CItemData &ci)
+void ExpiryIndex::Add(const CItemData &ci)
 {
   // Not valid for aliases or shortcuts!
   if (ci.IsDependent())
@@ -44,21 +41,36 @@ void ExpiredList::Add(const CItemData &ci)
   // that doesn't have an expiration date - check!
   time_t tttXTime;
   ci.GetXTime(tttXTime);
-  if (tttXTime != time_t(0))
-    push_back(ExpPWEntry(ci));
+  if (tttXTime == time_t(0))
+    return;
+
+  const ExpPWEntry ee(ci);
+  Remove(ee.uuid); // at most one index entry per uuid
+  m_byUUID[ee.uuid] = m_byTime.insert(std::make_pair(ee.expirytttXTime, ee.uuid));
 }
 
-void ExpiredList::Remove(const CItemData &ci)
+void ExpiryIndex::Update(const pws_os::CUUID &uuid, time_t expirytttXTime)
 {
-  ExpiredList::iterator iter = std::find_if(begin(), end(),[ci](pws_os::CUUID v){return v == ci.GetUUID();});
-  if (iter != end())
-    erase(iter);
+  auto iter = m_byUUID.find(uuid);
+  if (iter == m_byUUID.end())
+    return;
+
+  m_byTime.erase(iter->second);
+  iter->second = m_byTime.insert(std::make_pair(expirytttXTime, uuid));
 }
 
-ExpiredList ExpiredList::GetExpired(const int &idays)
+void ExpiryIndex::Remove(const pws_os::CUUID &uuid)
+{
+  auto iter = m_byUUID.find(uuid);
+  if (iter != m_byUUID.end()) {
+    m_byTime.erase(iter->second);
+    m_byUUID.erase(iter);
+  }
+}
+
+ExpiredList ExpiryIndex::GetExpired(const int &idays) const
 {
   ExpiredList retval;
-  ExpiredList::iterator iter;
   struct tm st;
 
   time_t now, exptime=time_t(-1);
@@ -75,10 +87,19 @@ ExpiredList ExpiredList::GetExpired(const int &idays)
   if (exptime == time_t(-1))
     exptime = now;
 
-  for (iter = begin(); iter != end(); iter++) {
-    if (iter->expirytttXTime < exptime) {
-      retval.push_back(*iter);
-    }
+  // Only the expiring entries are visited, earliest first
+  const auto last = m_byTime.lower_bound(exptime);
+  for (auto iter = m_byTime.begin(); iter != last; iter++) {
+    retval.push_back(ExpPWEntry(iter->second, iter->first));
   }
   return retval;
 }
+
+bool ExpiryIndex::GetNextExpiry(ExpPWEntry &ee) const
+{
+  if (m_byTime.empty())
+    return false;
+
+  ee = ExpPWEntry(m_byTime.begin()->second, m_byTime.begin()->first);
+  return true;
+}
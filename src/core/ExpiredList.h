@@ -15,10 +15,12 @@
 #include "../os/UUID.h"
 #include "ItemData.h"
 
+#include <map>
 #include <vector>
 
 struct ExpPWEntry {
   ExpPWEntry(const CItemData &ci);
+  ExpPWEntry(const pws_os::CUUID &u, time_t t) : uuid(u), expirytttXTime(t) {}
   ExpPWEntry(const ExpPWEntry &ee) : uuid(ee.uuid), expirytttXTime(ee.expirytttXTime) {}
   ExpPWEntry &operator=(const ExpPWEntry &that) {
     if (this != &that) {
@@ -33,13 +35,36 @@ struct ExpPWEntry {
   time_t expirytttXTime;
 };
 
+// A snapshot of expiring entries, ordered by expiry time
 class ExpiredList: public std::vector<ExpPWEntry>
 {
+};
+
+// All entries with an expiry date, indexed both by expiry time (for
+// range & "next expiry" queries) and by uuid (for update & removal),
+// so that none of the operations need to scan all the candidates.
+class ExpiryIndex
+{
 public:
   void Add(const CItemData &ci);
   void Update(const CItemData &ci) {Remove(ci); Add(ci);}
-  void Remove(const CItemData &ci);
-  ExpiredList GetExpired(const int &idays); // return a subset
+  void Update(const pws_os::CUUID &uuid, time_t expirytttXTime);
+  void Remove(const CItemData &ci) {Remove(ci.GetUUID());}
+  void Remove(const pws_os::CUUID &uuid);
+  void clear() {m_byTime.clear(); m_byUUID.clear();}
+
+  size_t size() const {return m_byUUID.size();}
+  bool empty() const {return m_byUUID.empty();}
+
+  // Entries expiring before now + idays
+  ExpiredList GetExpired(const int &idays) const;
+  // Earliest expiring entry, false if there are none
+  bool GetNextExpiry(ExpPWEntry &ee) const;
+
+private:
+  using TimeIndex = std::multimap<time_t, pws_os::CUUID>;
+  TimeIndex m_byTime;
+  std::map<pws_os::CUUID, TimeIndex::iterator> m_byUUID;
 };
 
 #endif /* __EXPIREDLIST_H */
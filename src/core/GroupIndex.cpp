@@ -0,0 +1,127 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// GroupIndex.cpp
+//-----------------------------------------------------------------------------
+
+#include "GroupIndex.h"
+
+using pws_os::CUUID;
+
+static const wchar_t GROUP_SEP = L'.';
+
+StringX GroupIndex::PopPathElement(StringX &path)
+{
+  StringX elem;
+  size_t dotPos = path.find(GROUP_SEP);
+  const size_t len = path.length();
+
+  if (dotPos == StringX::npos) {
+    elem = path;
+    path.clear();
+  } else {
+    while (dotPos < len && path[dotPos] == GROUP_SEP) // consecutive dots
+      dotPos++;
+    if (dotPos < len) {
+      elem = path.substr(0, dotPos - 1);
+      path = path.substr(dotPos);
+    } else { // trailing dots
+      elem = path;
+      path.clear();
+    }
+  }
+  return elem;
+}
+
+StringX GroupIndex::Group::GetPath() const
+{
+  if (parent == nullptr)
+    return StringX();
+  const StringX parentPath = parent->GetPath();
+  return parentPath.empty() ? name : parentPath + GROUP_SEP + name;
+}
+
+void GroupIndex::Clear()
+{
+  m_root.subgroups.clear();
+  m_root.entries.clear();
+  m_entries.clear();
+}
+
+GroupIndex::Group *GroupIndex::GetGroup(const StringX &group)
+{
+  Group *g = &m_root;
+  StringX path(group);
+  while (!path.empty()) {
+    const StringX elem = PopPathElement(path);
+    std::unique_ptr<Group> &sub = g->subgroups[elem];
+    if (!sub)
+      sub.reset(new Group(g, elem));
+    g = sub.get();
+  }
+  return g;
+}
+
+const GroupIndex::Group *GroupIndex::AddGroup(const StringX &group)
+{
+  return GetGroup(group);
+}
+
+const GroupIndex::Entry *GroupIndex::Add(const CUUID &uuid, const StringX &group)
+{
+  Remove(uuid);
+  Group *g = GetGroup(group);
+  g->entries.emplace_back(new Entry(g, uuid, g->entries.size()));
+  Entry *entry = g->entries.back().get();
+  m_entries[uuid] = entry;
+  return entry;
+}
+
+bool GroupIndex::Remove(const CUUID &uuid)
+{
+  auto iter = m_entries.find(uuid);
+  if (iter == m_entries.end())
+    return false;
+
+  // Move the last sibling into the entry's slot rather than shifting
+  // them all down, so removing many entries from one group stays linear
+  std::vector<std::unique_ptr<Entry>> &siblings = iter->second->parent->entries;
+  const size_t pos = iter->second->pos;
+  m_entries.erase(iter);
+  if (pos != siblings.size() - 1) {
+    siblings[pos] = std::move(siblings.back());
+    siblings[pos]->pos = pos;
+  }
+  siblings.pop_back();
+  return true;
+}
+
+bool GroupIndex::RemoveGroup(const Group *group)
+{
+  if (group == nullptr || group->parent == nullptr ||
+      !group->entries.empty() || !group->subgroups.empty())
+    return false;
+  const StringX name(group->name); // erasing destroys group
+  return group->parent->subgroups.erase(name) == 1;
+}
+
+const GroupIndex::Entry *GroupIndex::Find(const CUUID &uuid) const
+{
+  auto iter = m_entries.find(uuid);
+  return iter != m_entries.end() ? iter->second : nullptr;
+}
+
+const GroupIndex::Group *GroupIndex::FindGroup(const StringX &group) const
+{
+  const Group *g = &m_root;
+  StringX path(group);
+  while (g != nullptr && !path.empty()) {
+    auto iter = g->subgroups.find(PopPathElement(path));
+    g = (iter != g->subgroups.end()) ? iter->second.get() : nullptr;
+  }
+  return g;
+}
@@ -0,0 +1,87 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// GroupIndex.h
+//-----------------------------------------------------------------------------
+
+#ifndef __GROUPINDEX_H
+#define __GROUPINDEX_H
+
+#include "StringX.h"
+#include "ItemData.h"
+#include "../os/UUID.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+// The group hierarchy of a set of entries: for each group, its subgroups
+// and the uuids of the entries directly in it. Only the entries' group
+// fields are read to build it, so views can create their nodes, and
+// decrypt display strings, on demand.
+//
+// Nodes have stable addresses for as long as they're in the index, so a
+// view can use them as item ids.
+class GroupIndex
+{
+public:
+  struct Group;
+
+  struct Node {
+    Node(Group *p, bool g) : parent(p), isGroup(g) {}
+    Group *parent; // nullptr for the root group
+    const bool isGroup;
+  };
+
+  struct Entry : Node {
+    Entry(Group *p, const pws_os::CUUID &u, size_t i)
+      : Node(p, false), uuid(u), pos(i) {}
+    const pws_os::CUUID uuid;
+    size_t pos; // index in parent->entries
+  };
+
+  struct Group : Node {
+    Group(Group *p, const StringX &n) : Node(p, true), name(n) {}
+    StringX GetPath() const;
+
+    const StringX name; // last element of path, empty for the root group
+    std::map<StringX, std::unique_ptr<Group>> subgroups;
+    std::vector<std::unique_ptr<Entry>> entries; // in no particular order
+  };
+
+  GroupIndex() : m_root(nullptr, StringX()) {}
+
+  void Clear();
+
+  // Adding an entry that's already there moves it to its (new) group
+  const Entry *Add(const CItemData &ci) {return Add(ci.GetUUID(), ci.GetGroup());}
+  const Entry *Add(const pws_os::CUUID &uuid, const StringX &group);
+  // Returns the group, creating it and any missing parents
+  const Group *AddGroup(const StringX &group);
+  // Removes the entry, but not the groups it was in
+  bool Remove(const pws_os::CUUID &uuid);
+  // Removes a group that has no entries or subgroups, other than the root
+  bool RemoveGroup(const Group *group);
+
+  const Group &GetRoot() const {return m_root;}
+  const Entry *Find(const pws_os::CUUID &uuid) const;
+  const Group *FindGroup(const StringX &group) const;
+  size_t GetNumEntries() const {return m_entries.size();}
+
+  // Chops the first element off a group path and returns it, i.e.,
+  // "a.b.c" returns "a" and leaves "b.c". Consecutive dots are part of
+  // the element before them: "a..b.c" returns "a." and leaves "b.c"
+  static StringX PopPathElement(StringX &path);
+
+private:
+  Group *GetGroup(const StringX &group);
+
+  Group m_root;
+  std::map<pws_os::CUUID, Entry *> m_entries;
+};
+
+#endif /* __GROUPINDEX_H */
@@ -0,0 +1,42 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// IdleTask.cpp
+//-----------------------------------------------------------------------------
+
+#include "IdleTask.h"
+#include "PWScore.h"
+
+#include <algorithm>
+
+EntryVisitTask::EntryVisitTask(const PWScore &core, const VisitFn &visit,
+                               size_t entriesPerStep, const DoneFn &done)
+  : m_core(core), m_visit(visit), m_done(done),
+    m_entriesPerStep(std::max(entriesPerStep, size_t(1))), m_next(0)
+{
+  m_uuids.reserve(core.GetNumEntries());
+  for (auto iter = core.GetEntryIter(); iter != core.GetEntryEndIter(); iter++)
+    m_uuids.push_back(iter->first);
+}
+
+bool EntryVisitTask::Step()
+{
+  const size_t end = std::min(m_next + m_entriesPerStep, m_uuids.size());
+  for (; m_next < end; m_next++) {
+    auto iter = m_core.Find(m_uuids[m_next]);
+    if (iter != m_core.GetEntryEndIter())
+      m_visit(iter->second);
+  }
+  if (m_next < m_uuids.size())
+    return true;
+  if (m_done) {
+    DoneFn done;
+    done.swap(m_done);
+    done();
+  }
+  return false;
+}
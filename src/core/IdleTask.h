@@ -0,0 +1,62 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// IdleTask.h
+//-----------------------------------------------------------------------------
+
+#ifndef __IDLETASK_H
+#define __IDLETASK_H
+
+#include "ItemData.h"
+#include "../os/UUID.h"
+
+#include <functional>
+#include <vector>
+
+class PWScore;
+
+// Work that a UI can put off until it has nothing better to do. It's done
+// in small steps, so that no step holds up the UI for long, and can be
+// abandoned between any two of them.
+class IdleTask
+{
+public:
+  virtual ~IdleTask() {}
+
+  // Does the next bit of the work. Returns false when there's none left.
+  virtual bool Step() = 0;
+};
+
+// Calls a function for each entry in a core, a few entries per step, and
+// then, if given, the done function. The entries are the ones there when
+// the task was created, less any deleted since, so the core may be changed
+// between steps.
+class EntryVisitTask : public IdleTask
+{
+public:
+  typedef std::function<void(const CItemData &)> VisitFn;
+  typedef std::function<void()> DoneFn;
+
+  EntryVisitTask(const PWScore &core, const VisitFn &visit,
+                 size_t entriesPerStep = DEFAULT_ENTRIES_PER_STEP,
+                 const DoneFn &done = nullptr);
+
+  bool Step() override;
+  size_t GetRemaining() const {return m_uuids.size() - m_next;}
+
+  static const size_t DEFAULT_ENTRIES_PER_STEP = 100;
+
+private:
+  const PWScore &m_core;
+  const VisitFn m_visit;
+  DoneFn m_done; // reset once called
+  const size_t m_entriesPerStep;
+  std::vector<pws_os::CUUID> m_uuids;
+  size_t m_next;
+};
+
+#endif /* __IDLETASK_H */
@@ -16,6 +16,7 @@
 #include "Util.h"
 #include "os/env.h"
 
+#include <algorithm>
 #include <vector>
 
 CItem::CItem()
@@ -109,6 +110,75 @@ bool CItem::operator==(const CItem &that) const
   return true;
 }
 
+void CItem::KeepFields(const std::vector<int> &fts)
+{
+  for (auto fiter = m_fields.begin(); fiter != m_fields.end();) {
+    if (std::find(fts.begin(), fts.end(), fiter->first) == fts.end())
+      fiter = m_fields.erase(fiter);
+    else
+      ++fiter;
+  }
+  m_URFL.clear();
+}
+
+bool CItem::IsSameField(int ft, const CItem &that) const
+{
+  const FieldConstIter ithis = m_fields.find(ft);
+  const FieldConstIter ithat = that.m_fields.find(ft);
+  if (ithis == m_fields.end() || ithat == that.m_fields.end())
+    return ithis == m_fields.end() && ithat == that.m_fields.end();
+
+  // Fields of copies of an item share their data, see CItemField
+  if (HasSameKey(that) && ithis->second.IsSameData(ithat->second))
+    return true;
+  return CompareFields(ithis->second, that, ithat->second);
+}
+
+bool CItem::HasSameKey(const CItem &that) const
+{
+  return memcmp(m_key, that.m_key, sizeof(m_key)) == 0;
+}
+
+CItemField CItem::ReEncrypt(const CItem &src, const CItemField &field) const
+{
+  if (HasSameKey(src) || field.IsEmpty())
+    return field;
+
+  std::vector<unsigned char> v;
+  src.GetField(field, v);
+  CItemField retval(field.GetType());
+  retval.Set(v.data(), v.size(), MakeBlowFish());
+  trashMemory(v.data(), v.size());
+  return retval;
+}
+
+void CItem::CopyField(int ft, const CItem &src)
+{
+  const FieldConstIter fiter = src.m_fields.find(ft);
+  if (fiter == src.m_fields.end())
+    m_fields.erase(ft);
+  else
+    m_fields[ft] = ReEncrypt(src, fiter->second);
+}
+
+bool CItem::IsSameUnknownFields(const CItem &that) const
+{
+  if (m_URFL.size() != that.m_URFL.size())
+    return false;
+  for (size_t i = 0; i < m_URFL.size(); i++) {
+    if (!CompareFields(m_URFL[i], that, that.m_URFL[i]))
+      return false;
+  }
+  return true;
+}
+
+void CItem::CopyUnknownFields(const CItem &src)
+{
+  m_URFL.clear();
+  for (const auto &field : src.m_URFL)
+    m_URFL.push_back(ReEncrypt(src, field));
+}
+
 size_t CItem::GetSize() const
 {
   size_t length(0);
@@ -123,6 +193,23 @@ size_t CItem::GetSize() const
   return length;
 }
 
+size_t CItem::GetPlainTextSizeBound() const
+{
+  // Each field is written as a type byte, a 32-bit length and its value,
+  // which is never longer than what's stored, except for times, which may
+  // be stored in 32 bits but are written as a time_t. The END field closes.
+  const size_t header = 1 + sizeof(uint32);
+  size_t length(header);
+
+  for (FieldConstIter fiter = m_fields.begin(); fiter != m_fields.end(); fiter++)
+    length += header + std::max(fiter->second.GetLength(), sizeof(time_t));
+
+  for (auto ufiter = m_URFL.begin(); ufiter != m_URFL.end(); ufiter++)
+    length += header + ufiter->GetLength();
+
+  return length;
+}
+
 BlowFish *CItem::MakeBlowFish() const
 {
   // Creating a BlowFish object's relatively expensive, so we use
@@ -314,6 +401,13 @@ StringX CItem::GetField(const CItemField &field) const
   return retval;
 }
 
+CItemField CItem::EncryptField(const StringX &value) const
+{
+  CItemField field;
+  field.Set(value, MakeBlowFish());
+  return field;
+}
+
 void CItem::GetTime(int whichtime, time_t &t) const
 {
   ASSERT(IsTimeField(whichtime));
@@ -169,6 +169,8 @@ public:
   CItem& operator=(const CItem& second);
   virtual void Clear();
   void ClearField(int ft) {m_fields.erase(ft);}
+  // Removes all fields but those of the given types, and the unknown ones
+  void KeepFields(const std::vector<int> &fts);
 
   void CopyTime(int ft, const CItem & src)
   {
@@ -182,6 +184,9 @@ public:
 
   size_t GetSize() const;
   void GetSize(size_t &isize) const {isize = GetSize();}
+  // Upper bound of a SerializePlainText of this item, so that the output
+  // can be allocated once
+  size_t GetPlainTextSizeBound() const;
     
   void push_length(std::vector<char> &v, uint32 s) const;
   template< typename T> void push(std::vector<char> &v, char type, T value) const
@@ -226,12 +231,23 @@ protected:
   uint8_t GetFieldAsByte(const int ft, uint8_t default_value = 0) const;
   StringX GetField(int ft) const;
   StringX GetField(const CItemField &field) const;
+  // A field of value encrypted with this item's key, for keeping values
+  // derived from the fields as protected as the fields themselves
+  CItemField EncryptField(const StringX &value) const;
 
   void SetTime(int whichtime, time_t t);
   void GetTime(int whichtime, time_t &t) const;
 
   bool IsFieldSet(int ft) const {return m_fields.find(ft) != m_fields.end();}
 
+  // For comparing and copying single fields between items, such as two
+  // versions of an entry, whose fields may be encrypted with different keys.
+  // CopyField removes the field if src doesn't have it.
+  bool IsSameField(int ft, const CItem &that) const;
+  void CopyField(int ft, const CItem &src);
+  bool IsSameUnknownFields(const CItem &that) const;
+  void CopyUnknownFields(const CItem &src);
+
   void GetUnknownField(unsigned char &type, size_t &length,
                        unsigned char * &pdata, const CItemField &item) const;
   bool IsItemDataField(unsigned char type) const
@@ -243,6 +259,9 @@ private:
   // Helper function for operator==
   bool CompareFields(const CItemField &fthis,
                      const CItem &that, const CItemField &fthat) const;
+  bool HasSameKey(const CItem &that) const;
+  // Copy of field encrypted with this item's key
+  CItemField ReEncrypt(const CItem &src, const CItemField &field) const;
 
   // Create local Encryption/Decryption object
   BlowFish *MakeBlowFish() const;
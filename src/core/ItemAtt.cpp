@@ -625,6 +625,7 @@ void CItemAtt::SerializePlainText(vector<char> &v)  const
   time_t t = 0;
     
   v.clear();
+  v.reserve(GetPlainTextSizeBound());
   
   // write mandatory field ATTUUID
   v.push_back(ATTUUID);
@@ -69,7 +69,8 @@ CItemData::CItemData()
 }
 
 CItemData::CItemData(const CItemData &that) :
-  CItem(that), m_entrytype(that.m_entrytype), m_entrystatus(that.m_entrystatus)
+  CItem(that), m_entrytype(that.m_entrytype), m_entrystatus(that.m_entrystatus),
+  m_pPWHistCache(that.m_pPWHistCache), m_pCustomFieldsCache(that.m_pCustomFieldsCache)
 {
 }
 
@@ -83,6 +84,9 @@ CItemData& CItemData::operator=(const CItemData &that)
     CItem::operator=(that);
     m_entrytype = that.m_entrytype;
     m_entrystatus = that.m_entrystatus;
+    // Copies share the key and the field data, so the caches are valid
+    m_pPWHistCache = that.m_pPWHistCache;
+    m_pCustomFieldsCache = that.m_pCustomFieldsCache;
   }
   return *this;
 }
@@ -92,6 +96,8 @@ void CItemData::Clear()
   CItem::Clear();
   m_entrytype = ET_NORMAL;
   m_entrystatus = ES_CLEAN;
+  m_pPWHistCache.reset();
+  m_pCustomFieldsCache.reset();
 }
 
 bool CItemData::operator==(const CItemData &that) const
@@ -570,10 +576,10 @@ StringX CItemData::GetFieldValue(FieldType ft) const
   }
 }
 
-StringX CItemData::GetEffectiveFieldValue(FieldType ft, const CItemData *pbci) const
+const CItemData *CItemData::GetEffectiveItem(FieldType ft, const CItemData *pbci) const
 {
   if (IsNormal() || IsBase())
-    return GetField(ft);
+    return this;
 
   // Here if we're a dependent;
   ASSERT(IsDependent());
@@ -599,22 +605,28 @@ StringX CItemData::GetEffectiveFieldValue(FieldType ft, const CItemData *pbci) c
     // TOTP parameters, and passkey parameters) are taken from base entry.
     // Everything else is from the actual entry.
     if (std::find(base_fields.begin(), base_fields.end(), ft) != base_fields.end())
-      return pbci->GetField(ft);
+      return pbci;
     else
-      return GetField(ft);
+      return this;
   } else if (IsShortcut()) {
     // For a shortcut everything is taken from its base entry,
     // except the group, title and user.
     if (ft == GROUP || ft == TITLE || ft == USER)
-      return GetField(ft);
+      return this;
     else
-      return pbci->GetField(ft);
+      return pbci;
   } else {
     ASSERT(0);
-    return _T("");
+    return nullptr;
   }
 }
 
+StringX CItemData::GetEffectiveFieldValue(FieldType ft, const CItemData *pbci) const
+{
+  const CItemData *pci = GetEffectiveItem(ft, pbci);
+  return pci == nullptr ? _T("") : pci->GetField(ft);
+}
+
 static void CleanNotes(StringX &s, TCHAR delimiter)
 {
   if (delimiter != 0) {
@@ -859,9 +871,66 @@ StringX CItemData::GetPreviousPassword() const
   return PWHistList::GetPreviousPassword(GetField(PWHIST));
 }
 
+PWHistList CItemData::GetPWHistoryList(PWSUtil::TMC time_format) const
+{
+  const auto fiter = m_fields.find(PWHIST);
+  if (fiter == m_fields.end())
+    return PWHistList();
+
+  std::shared_ptr<const PWHistCache> pcache = m_pPWHistCache;
+  if (!pcache || !pcache->field.IsSameData(fiter->second)) {
+    auto pnew = std::make_shared<PWHistCache>();
+    pnew->field = fiter->second;
+    pnew->time_format = time_format;
+    pnew->list = PWHistList(GetPWHistory(), time_format);
+    pnew->passwords.reserve(pnew->list.size());
+    for (auto &pwh_ent : pnew->list) {
+      pnew->passwords.push_back(EncryptField(pwh_ent.password));
+      pwh_ent.password.clear();
+    }
+    pcache = m_pPWHistCache = pnew;
+  } else if (pcache->time_format != time_format) {
+    // Only the change dates need redoing
+    auto pnew = std::make_shared<PWHistCache>(*pcache);
+    pnew->time_format = time_format;
+    pnew->list.setTimeFormat(time_format);
+    pcache = m_pPWHistCache = pnew;
+  }
+
+  PWHistList pwhistlist(pcache->list);
+  for (size_t i = 0; i < pwhistlist.size(); i++)
+    pwhistlist[i].password = GetField(pcache->passwords[i]);
+  return pwhistlist;
+}
+
 CustomFieldList CItemData::GetCustomFields() const
 {
-  return CustomFieldList(GetField(CUSTOMTEXT));
+  const auto fiter = m_fields.find(CUSTOMTEXT);
+  if (fiter == m_fields.end())
+    return CustomFieldList();
+
+  std::shared_ptr<const CustomFieldsCache> pcache = m_pCustomFieldsCache;
+  if (!pcache || !pcache->field.IsSameData(fiter->second)) {
+    auto pnew = std::make_shared<CustomFieldsCache>();
+    pnew->field = fiter->second;
+    pnew->list = CustomFieldList(GetField(fiter->second));
+    for (auto &field : pnew->list) {
+      const std::vector<CustomFieldProperty> props = field.GetProperties();
+      for (const auto &prop : props) {
+        pnew->values.push_back(EncryptField(prop.second));
+        field.SetProperty(prop.first, _T(""));
+      }
+    }
+    pcache = m_pCustomFieldsCache = pnew;
+  }
+
+  CustomFieldList fields(pcache->list);
+  auto value_iter = pcache->values.begin();
+  for (auto &field : fields) {
+    for (size_t i = 0; i < field.GetProperties().size(); i++)
+      field.SetProperty(field.GetProperties()[i].first, GetField(*value_iter++));
+  }
+  return fields;
 }
 
 static StringX EscapeCustomFieldsForTextExport(const StringX &s)
@@ -925,7 +994,7 @@ StringX CItemData::GetPlaintext(const TCHAR &separator,
   StringX history(_T(""));
   if (bsFields.test(CItemData::PWHIST)) {
     // History exported as "00000" if empty, to make parsing easier
-    PWHistList pwhistlist(GetPWHistory(), PWSUtil::TMC_EXPORT_IMPORT);
+    PWHistList pwhistlist(GetPWHistoryList(PWSUtil::TMC_EXPORT_IMPORT));
 
     //  Build export string
     history = pwhistlist.MakePWHistoryHeader();
@@ -1247,7 +1316,7 @@ string CItemData::GetXML(unsigned id, const FieldBits &bsExport,
   }
 
   if (bsExport.test(CItemData::PWHIST)) {
-    PWHistList pwhistlist(GetPWHistory(), PWSUtil::TMC_XML);
+    PWHistList pwhistlist(GetPWHistoryList(PWSUtil::TMC_XML));
     bool pwh_status = pwhistlist.isSaving();
     size_t pwh_max = pwhistlist.getMax();
 
@@ -1461,7 +1530,7 @@ void CItemData::UpdatePassword(const StringX& password)
 void CItemData::UpdatePasswordHistory()
 {
   const StringX pwh_str = GetPWHistory();
-  PWHistList pwhistlist(pwh_str, PWSUtil::TMC_EXPORT_IMPORT);
+  PWHistList pwhistlist(GetPWHistoryList(PWSUtil::TMC_EXPORT_IMPORT));
 
   if (pwh_str.empty()) {
     // If GetPWHistory() is empty, use preference values!
@@ -1986,7 +2055,7 @@ bool CItemData::ValidatePWHistory()
     return false;
   }
 
-  PWHistList pwhistlist(pwh, PWSUtil::TMC_EXPORT_IMPORT);
+  PWHistList pwhistlist(GetPWHistoryList(PWSUtil::TMC_EXPORT_IMPORT));
   if (pwhistlist.getErr() == 0)
     return true;
 
@@ -2480,6 +2549,7 @@ void CItemData::SerializePlainText(vector<char> &v,
   unsigned char uc = 0;
 
   v.clear();
+  v.reserve(GetPlainTextSizeBound(pcibase));
 
   // We can be either regular, alias or shortcut, use the right uuid.
   const FieldType uuidfts[] = {UUID, ALIASUUID, SHORTCUTUUID};
@@ -2614,6 +2684,67 @@ void CItemData::SerializePlainText(vector<char> &v,
   push_length(v, 0);
 }
 
+size_t CItemData::GetPlainTextSizeBound(const CItemData *pcibase) const
+{
+  size_t length = CItem::GetPlainTextSizeBound();
+
+  // An alias or shortcut's password is written as the [[g:t:u]] or [~g:t:u~]
+  // placeholder of its base
+  if (IsDependent() && pcibase != nullptr) {
+    const size_t header = 1 + sizeof(uint32);
+    length += header + 6;
+    const FieldType gtu[] = {GROUP, TITLE, USER};
+    for (auto ft : gtu) {
+      auto fiter = pcibase->m_fields.find(ft);
+      if (fiter != pcibase->m_fields.end())
+        length += fiter->second.GetLength();
+    }
+  }
+  return length;
+}
+
+CItemDataDelta::CItemDataDelta(const CItemData &before, const CItemData &after)
+  : m_bUnknownFields(false), m_before(before), m_after(after)
+{
+  std::vector<int> fts;
+  for (const auto &field : before.m_fields)
+    fts.push_back(field.first);
+  for (const auto &field : after.m_fields)
+    if (!before.IsFieldSet(field.first))
+      fts.push_back(field.first);
+
+  for (auto ft : fts)
+    if (!before.IsSameField(ft, after))
+      m_fts.push_back(ft);
+  m_bUnknownFields = !before.IsSameUnknownFields(after);
+
+  // Copies of an item share the data of their fields, so this
+  // only holds on to what changed
+  m_before.KeepFields(m_fts);
+  m_after.KeepFields(m_fts);
+  if (m_bUnknownFields) {
+    m_before.CopyUnknownFields(before);
+    m_after.CopyUnknownFields(after);
+  }
+}
+
+bool CItemDataDelta::IsEmpty() const
+{
+  return m_fts.empty() && !m_bUnknownFields &&
+    m_before.m_entrytype == m_after.m_entrytype &&
+    m_before.m_entrystatus == m_after.m_entrystatus;
+}
+
+void CItemDataDelta::Set(CItemData &item, const CItemData &values) const
+{
+  for (auto ft : m_fts)
+    item.CopyField(ft, values);
+  if (m_bUnknownFields)
+    item.CopyUnknownFields(values);
+  item.m_entrytype = values.m_entrytype;
+  item.m_entrystatus = values.m_entrystatus;
+}
+
   // Convenience: Get the name associated with FieldType
 stringT CItemData::FieldName(FieldType ft)
 {
@@ -20,12 +20,14 @@
 #include "StringX.h"
 #include "TotpCore.h"
 #include "CustomFields.h"
+#include "PWHistory.h"
 
 #include <time.h> // for time_t
 #include <bitset>
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
 
 //-----------------------------------------------------------------------------
 
@@ -172,6 +174,8 @@ public:
   StringX GetXTimeInt() const; // V30
   StringX GetPWHistory() const;  // V30
   StringX GetPreviousPassword() const;
+  // Parsed password history, as PWHistList(GetPWHistory(), time_format)
+  PWHistList GetPWHistoryList(PWSUtil::TMC time_format) const;
   CustomFieldList GetCustomFields() const;
   StringX GetCustomFieldsRaw() const {return GetField(CUSTOMTEXT);}
   void GetPWPolicy(PWPolicy &pwp) const;
@@ -195,6 +199,9 @@ public:
 
   // Following encapsulates difference between Alias and Shortcut w.r.t. field 'ownership':
   StringX GetEffectiveFieldValue(FieldType ft, const CItemData *pbci) const;
+  // The entry that ft is taken from: this one or, for some fields of a
+  // dependent, its base pbci
+  const CItemData *GetEffectiveItem(FieldType ft, const CItemData *pbci) const;
 
   // GetPlaintext returns all fields separated by separator, if delimiter is != 0, then
   // it's used for multi-line notes and to replace '.' within the Title field.
@@ -335,6 +342,8 @@ public:
 
   void SerializePlainText(std::vector<char> &v,
                           const CItemData *pcibase = nullptr) const;
+  // Upper bound of what SerializePlainText writes for the same arguments
+  size_t GetPlainTextSizeBound(const CItemData *pcibase = nullptr) const;
   bool DeSerializePlainText(const std::vector<char> &v);
 
   EntryType GetEntryType() const {return m_entrytype;}
@@ -418,6 +427,8 @@ public:
   void ClearPasskey();
 
 private:
+  friend class CItemDataDelta;
+
   EntryType m_entrytype;
   EntryStatus m_entrystatus;
 
@@ -441,6 +452,51 @@ private:
 
   int WriteUnknowns(PWSfile *out) const;
   size_t WriteIfSet(FieldType ft, PWSfile *out, bool isUTF8) const;
+
+  // The password history and custom fields as last parsed, so that they're
+  // not parsed again on every access. Each keeps a copy of the field it was
+  // parsed from, which shares the field's data until the field is set
+  // again, as a version stamp. The passwords and the custom field properties
+  // are kept encrypted with this item's key, as the fields are.
+  struct PWHistCache {
+    CItemField field;
+    PWSUtil::TMC time_format; // of the change dates in list
+    PWHistList list;          // without the passwords
+    std::vector<CItemField> passwords;
+  };
+  struct CustomFieldsCache {
+    CItemField field;
+    CustomFieldList list;           // without the property values
+    std::vector<CItemField> values; // of all the properties, in order
+  };
+  mutable std::shared_ptr<const PWHistCache> m_pPWHistCache;
+  mutable std::shared_ptr<const CustomFieldsCache> m_pCustomFieldsCache;
+};
+
+/*
+ * What an edit changed in an entry: the values before and after of only
+ * the fields that differ, as well as the entry type and status.
+ * This is what an EditEntryCommand keeps for undo and redo, rather than
+ * two copies of the whole entry.
+ */
+class CItemDataDelta
+{
+public:
+  CItemDataDelta(const CItemData &before, const CItemData &after);
+
+  // before -> after, and back
+  void Apply(CItemData &item) const {Set(item, m_after);}
+  void Revert(CItemData &item) const {Set(item, m_before);}
+
+  bool IsEmpty() const;
+  size_t GetSize() const {return m_before.GetSize() + m_after.GetSize();}
+
+private:
+  void Set(CItemData &item, const CItemData &values) const;
+
+  std::vector<int> m_fts; // types of the fields that differ
+  bool m_bUnknownFields;  // as do the unknown fields
+  CItemData m_before, m_after; // holding only those
 };
 
 inline bool CItemData::IsTextField(unsigned char t)
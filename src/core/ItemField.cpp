@@ -21,40 +21,10 @@ size_t CItemField::GetBlockSize(size_t size) const
   return  ((size / 8) + ((size % 8 != 0) ? 1 : 0)) * 8;
 }
 
-CItemField::CItemField(const CItemField &that)
-  : m_Type(that.m_Type), m_Length(that.m_Length)
-{
-  if (m_Length > 0) {
-    size_t bs = GetBlockSize(m_Length);
-    m_Data = new unsigned char[bs];
-    memcpy(m_Data, that.m_Data, bs);
-  } else {
-    m_Data = nullptr;
-  }
-}
-
-CItemField &CItemField::operator=(const CItemField &that)
-{
-  if (this != &that) {
-    m_Type = that.m_Type;
-    m_Length = that.m_Length;
-    delete[] m_Data;
-    if (m_Length > 0) {
-      size_t bs = GetBlockSize(m_Length);
-      m_Data = new unsigned char[bs];
-      memcpy(m_Data, that.m_Data, bs);
-    } else {
-      m_Data = nullptr;
-    }
-  }
-  return *this;
-}
-
 void CItemField::Empty()
 {
   if (m_Data != nullptr) {
-    delete[] m_Data;
-    m_Data = nullptr;
+    m_Data.reset();
     m_Length = 0;
   }
 }
@@ -67,16 +37,12 @@ void CItemField::Set(const unsigned char* value, size_t length,
   m_Length = length;
   BlockLength = GetBlockSize(m_Length);
 
-  delete[] m_Data;
+  // Never write into the old data, copies of this field may share it
+  m_Data.reset();
 
-  if (m_Length == 0) {
-    m_Data = nullptr;
-  } else {
-    m_Data = new unsigned char[BlockLength];
-    if (m_Data == nullptr) { // out of memory - try to fail gracefully
-      m_Length = 0; // at least keep structure consistent
-      return;
-    }
+  if (m_Length != 0) {
+    auto *data = new unsigned char[BlockLength];
+    m_Data.reset(data);
 
     auto *tempmem = new unsigned char[BlockLength];
     // invariant: BlockLength >= plainlength
@@ -87,7 +53,7 @@ void CItemField::Set(const unsigned char* value, size_t length,
 
     //Do the actual encryption
     for (size_t x = 0; x < BlockLength; x += 8)
-      bf->Encrypt(tempmem + x, m_Data + x);
+      bf->Encrypt(tempmem + x, data + x);
 
     trashMemory(tempmem, BlockLength);
     delete[] tempmem;
@@ -124,7 +90,7 @@ void CItemField::Get(unsigned char *value, size_t &length, const Fish *bf) const
 
     size_t x;
     for (x = 0; x < BlockLength; x += 8)
-      bf->Decrypt(m_Data + x, value + x);
+      bf->Decrypt(m_Data.get() + x, value + x);
 
     for (x = m_Length; x < BlockLength; x++)
       value[x] = 0;
@@ -149,7 +115,7 @@ void CItemField::Get(StringX &value, const Fish *bf) const
 
     // decrypt block by block
     for (x = 0; x < BlockLength; x += 8)
-      bf->Decrypt(m_Data + x, tempmem + x);
+      bf->Decrypt(m_Data.get() + x, tempmem + x);
 
     // copy to value TCHAR by TCHAR
     for (x = 0; x < m_Length/sizeof(TCHAR); x++)
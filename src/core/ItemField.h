@@ -13,6 +13,8 @@
 
 #include "StringX.h"
 
+#include <memory>
+
 //-----------------------------------------------------------------------------
 
 /*
@@ -26,12 +28,15 @@ class Fish;
 class CItemField
 {
 public:
-  explicit CItemField(unsigned char type = 0xff): m_Type(type), m_Length(0), m_Data(nullptr)
+  explicit CItemField(unsigned char type = 0xff): m_Type(type), m_Length(0)
   {}
-  CItemField(const CItemField &that); // copy ctor
-  ~CItemField() {if (m_Length > 0) delete[] m_Data;}
+  // Copies share the encrypted data, which is never changed in place
+  // but replaced by Set(), so that e.g. keeping a copy of an attachment
+  // for undo doesn't duplicate its content
+  CItemField(const CItemField &that) = default;
+  ~CItemField() = default;
 
-  CItemField &operator=(const CItemField &that);
+  CItemField &operator=(const CItemField &that) = default;
 
   void Set(const StringX &value, const Fish *bf, unsigned char type = 0xff);
   void Set(const unsigned char* value, size_t length, const Fish *bf, unsigned char type = 0xff);
@@ -42,6 +47,9 @@ public:
   size_t GetLength() const {return m_Length;}
   size_t GetSize() const {return GetBlockSize(m_Length);}
   bool IsEmpty() const {return m_Length == 0;}
+  // True if that is a copy of this field, see copy c'tor
+  bool IsSameData(const CItemField &that) const
+  {return m_Length == that.m_Length && m_Data == that.m_Data;}
   void Empty();
 
 private:
@@ -50,7 +58,7 @@ private:
 
   unsigned char m_Type; // almost const
   size_t m_Length;
-  unsigned char *m_Data;
+  std::shared_ptr<unsigned char[]> m_Data;
 };
 
 #endif /* __ITEMFIELD_H */
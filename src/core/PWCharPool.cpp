@@ -19,6 +19,7 @@
 #include "os/pws_tchar.h"
 
 #include <cmath>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -63,35 +64,99 @@ const size_t CPasswordCharPool::easyvision_hexdigit_len = LENGTH(easyvision_hexd
 // See the values of "charT sym" in the static const structure "leets" below
 const charT CPasswordCharPool::pronounceable_symbol_chars[] = _T("@&(#!|$+");
 
-namespace
-{
-
-class UrbgAdapter {
+/*
+ * RandSource hands out random numbers from a buffer that's filled
+ * in one go from a PWSrand instance, rather than calling into PWSrand
+ * for every number. It's also a UniformRandomBitGenerator, for use
+ * with std::shuffle.
+ */
+class CPasswordCharPool::RandSource {
 public:
-    UrbgAdapter(PWSrand* ri) : ri_{ ri }
-    { }
+  explicit RandSource(PWSrand *ri) : ri_{ ri }, pos_{ BUFLEN }
+  { }
+  ~RandSource() { trashMemory(buf_, sizeof(buf_)); }
 
-    typedef unsigned int result_type;
+  typedef unsigned int result_type;
 
-    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
-    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+  static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
 
-    result_type operator()() const {
-        return ri_->RandUInt();
+  result_type operator()() { return RandUInt(); }
+
+  unsigned int RandUInt() {
+    if (pos_ == BUFLEN) {
+      ri_->GetRandomData(buf_, sizeof(buf_));
+      pos_ = 0;
     }
+    return buf_[pos_++];
+  }
+
+  // Same rejection sampling as PWSrand::RangeRand()
+  unsigned int RangeRand(size_t len) {
+    if (len != 0) {
+      unsigned int r;
+      const size_t ceil = max() - (max() % len) - 1;
+      while ((r = RandUInt()) > ceil)
+        ;
+      return static_cast<unsigned int>(r % len);
+    } else
+      return 0;
+  }
+
 private:
-    PWSrand* const ri_;
+  enum { BUFLEN = 64 };
+  PWSrand *const ri_;
+  unsigned int buf_[BUFLEN];
+  unsigned int pos_;
+
+  RandSource(const RandSource &) = delete;
+  RandSource &operator=(const RandSource &) = delete;
 };
 
+namespace
+{
+/*
+ * Cumulative trigram frequencies, computed once from trigram.h, so that
+ * MakePronounceable() can pick each character with a binary search
+ * instead of re-summing the frequency tables.
+ */
+struct TrigramTables {
+  enum { N = 26 };
+  long start[N * N * N]; // running sum over all trigrams
+  long next[N][N][N];    // running sum over the third char, per digraph
+
+  TrigramTables() {
+    long sum = 0;
+    for (int c1 = 0; c1 < N; c1++)
+      for (int c2 = 0; c2 < N; c2++) {
+        long dsum = 0;
+        for (int c3 = 0; c3 < N; c3++) {
+          sum += tris[c1][c2][c3];
+          dsum += tris[c1][c2][c3];
+          start[(c1 * N + c2) * N + c3] = sum;
+          next[c1][c2][c3] = dsum;
+        }
+      }
+    ASSERT(sum == sigma);
+  }
+};
+
+const TrigramTables &GetTrigramTables()
+{
+  static const TrigramTables tables;
+  return tables;
+}
 }
 
 //-----------------------------------------------------------------------------
-CPasswordCharPool::typeFreq_s::typeFreq_s(const CPasswordCharPool *parent, CharType ct, uint nc)
+CPasswordCharPool::typeFreq_s::typeFreq_s(const CPasswordCharPool *parent, CharType ct, uint nc,
+                                          RandSource &rs)
   : numchars(nc)
 {
-  vchars.resize(parent->m_pwlen);
+  // No more than numchars will ever be taken
+  vchars.resize(std::min(nc, parent->m_pwlen));
   std::generate(vchars.begin(), vchars.end(),
-                [parent, ct] () {return parent->GetRandomChar(ct);});
+                [parent, ct, &rs] () {return parent->GetRandomChar(ct, rs);});
 }
 
 //-----------------------------------------------------------------------------
@@ -173,6 +238,8 @@ CPasswordCharPool::CPasswordCharPool(const PWPolicy &policy)
   for (int i = 0; i < NUMTYPES; i++) {
     m_x[i+1] = m_x[i] + m_lengths[i];
     m_sumlengths += m_lengths[i];
+    if (m_lengths[i] > 0)
+      m_allchars.append(m_char_arrays[i], m_lengths[i]);
   }
   ASSERT(m_sumlengths > 0);
 }
@@ -236,14 +303,31 @@ charT CPasswordCharPool::GetRandomChar(CPasswordCharPool::CharType t, unsigned i
   return retval;
 }
 
-charT CPasswordCharPool::GetRandomChar(CPasswordCharPool::CharType t) const
+charT CPasswordCharPool::GetRandomChar(CPasswordCharPool::CharType t, RandSource &rs) const
 {
-  PWSrand *ri = PWSrand::GetInstance();
-  uint r = ri->RangeRand(m_lengths[t]);
+  uint r = rs.RangeRand(m_lengths[t]);
   return GetRandomChar(t, r);
 }
 
 StringX CPasswordCharPool::MakePassword() const
+{
+  RandSource rs(PWSrand::GetInstance());
+  return MakePassword(rs);
+}
+
+std::vector<StringX> CPasswordCharPool::MakePasswords(size_t n) const
+{
+  // One RandSource for the whole batch, fed by this thread's own
+  // generator so that parallel callers don't contend
+  RandSource rs(PWSrand::GetThreadInstance());
+  std::vector<StringX> retval;
+  retval.reserve(n);
+  for (size_t i = 0; i < n; i++)
+    retval.push_back(MakePassword(rs));
+  return retval;
+}
+
+StringX CPasswordCharPool::MakePassword(RandSource &rs) const
 {
   // We don't care if the policy is inconsistent e.g.
   // number of lower case chars > 1 + make pronounceable
@@ -258,23 +342,23 @@ StringX CPasswordCharPool::MakePassword() const
 
   // pronounceable and hex passwords are handled separately:
   if (m_pronounceable)
-    return MakePronounceable();
+    return MakePronounceable(rs);
   if (m_usehexdigits)
-    return MakeHex();
+    return MakeHex(rs);
 
   vector<typeFreq_s> typeFreqs;
 
   if (m_uselowercase)
-    typeFreqs.push_back(typeFreq_s(this, LOWERCASE, m_numlowercase));
+    typeFreqs.push_back(typeFreq_s(this, LOWERCASE, m_numlowercase, rs));
 
   if (m_useuppercase)
-    typeFreqs.push_back(typeFreq_s(this, UPPERCASE, m_numuppercase));
+    typeFreqs.push_back(typeFreq_s(this, UPPERCASE, m_numuppercase, rs));
 
   if (m_usedigits)
-    typeFreqs.push_back(typeFreq_s(this, DIGIT, m_numdigits));
+    typeFreqs.push_back(typeFreq_s(this, DIGIT, m_numdigits, rs));
 
   if (m_usesymbols)
-    typeFreqs.push_back(typeFreq_s(this, SYMBOL, m_numsymbols));
+    typeFreqs.push_back(typeFreq_s(this, SYMBOL, m_numsymbols, rs));
 
   // Sort requested char type in decreasing order
   // of requested (at least) frequency:
@@ -298,29 +382,20 @@ StringX CPasswordCharPool::MakePassword() const
       }
     }
 
-  if (retval.size() < m_pwlen) {
-      StringX cat;
-
-      // Now fill in the rest
-      for (int i = 0; i < NUMTYPES; i++)
-          if (m_lengths[i] > 0)
-              cat += m_char_arrays[i];
-
-      if (!cat.empty()) {
-          while(retval.size() < m_pwlen) {
-              const uint r = PWSrand::GetInstance()->RangeRand(cat.size());
-              ASSERT(r < cat.size());
+  // Now fill in the rest
+  if (!m_allchars.empty()) {
+    while (retval.size() < m_pwlen) {
+      const uint r = rs.RangeRand(m_allchars.size());
+      ASSERT(r < m_allchars.size());
 
-              retval.push_back(cat[r]);
-          }
-      }
+      retval.push_back(m_allchars[r]);
+    }
   }
 
  do_shuffle:
   // If 'at least' values were non-zero, we have some unwanted order,
   // so we mix things up a bit:
-  UrbgAdapter g{ PWSrand::GetInstance() };
-  std::shuffle(retval.begin(), retval.end(), g);
+  std::shuffle(retval.begin(), retval.end(), rs);
 
   ASSERT(retval.length() == size_t(m_pwlen));
   return retval;
@@ -366,8 +441,9 @@ private:
   int m_i;
 };
 
+template<class RNG>
 static void leet_replace(stringT &password, unsigned int i,
-                         bool usedigits, bool usesymbols)
+                         bool usedigits, bool usesymbols, RNG &rng)
 {
   ASSERT(i < password.size());
   ASSERT(usedigits || usesymbols);
@@ -376,25 +452,26 @@ static void leet_replace(stringT &password, unsigned int i,
   charT symsub = usesymbols ? leets[password[i] - charT('a')].sym : 0;
 
   // if both substitutions possible, select one randomly
-  if (digsub != 0 && symsub != 0 && PWSrand::GetInstance()->RandUInt() % 2)
+  if (digsub != 0 && symsub != 0 && rng() % 2)
     digsub = 0;
   password[i] = (digsub != 0) ? digsub : symsub;
   ASSERT(password[i] != 0);
 }
 
-StringX CPasswordCharPool::MakePronounceable() const
+StringX CPasswordCharPool::MakePronounceable(RandSource &rs) const
 {
   /**
    * Following based on gpw.C from
    * http://www.multicians.org/thvv/tvvtools.html
    * Thanks to Tom Van Vleck, Morrie Gasser, and Dan Edwards.
+   * The frequency sums are precomputed (see TrigramTables), so each
+   * character is chosen with a binary search.
    */
-  charT c1, c2, c3;  /* array indices */
+  const TrigramTables &tt = GetTrigramTables();
+  const int N = TrigramTables::N;
   long sumfreq;      /* total frequencies[c1][c2][*] */
-  long ranno;        /* random number in [0,sumfreq] */
-  long sum;          /* running total of frequencies */
+  long ranno;        /* random number in [0,sumfreq) */
   uint nchar;        /* number of chars in password so far */
-  PWSrand *pwsrnd = PWSrand::GetInstance();
   stringT password(m_pwlen, 0);
 
   /* Pick a random starting point. */
@@ -403,47 +480,30 @@ StringX CPasswordCharPool::MakePronounceable() const
      for the general population.  For example, this code happily
      generates "mmitify" even though no word in my dictionary
      begins with mmi. So what.) */
-  sumfreq = sigma;  // sigma calculated by loadtris
-  ranno = static_cast<long>(pwsrnd->RangeRand(static_cast<size_t>(sumfreq + 1))); // Weight by sum of frequencies
-  sum = 0;
-  for (c1 = 0; c1 < 26; c1++) {
-    for (c2 = 0; c2 < 26; c2++) {
-      for (c3 = 0; c3 < 26; c3++) {
-        sum += tris[int(c1)][int(c2)][int(c3)];
-        if (sum > ranno) { // Pick first value
-          password[0] = charT('a') + c1;
-          password[1] = charT('a') + c2;
-          password[2] = charT('a') + c3;
-          c1 = c2 = c3 = 26; // Break all loops.
-        } // if sum
-      } // for c3
-    } // for c2
-  } // for c1
+  sumfreq = tt.start[N * N * N - 1];
+  ranno = static_cast<long>(rs.RangeRand(static_cast<size_t>(sumfreq))); // Weight by sum of frequencies
+  const long *pstart = std::upper_bound(tt.start, tt.start + N * N * N, ranno);
+  const int first = static_cast<int>(pstart - tt.start);
+  password[0] = charT('a') + first / (N * N);
+  if (m_pwlen > 1)
+    password[1] = charT('a') + (first / N) % N;
+  if (m_pwlen > 2)
+    password[2] = charT('a') + first % N;
 
   /* Do a random walk. */
   nchar = 3;  // We have three chars so far.
   while (nchar < m_pwlen) {
-    c1 = password[nchar-2] - charT('a'); // Take the last 2 chars
-    c2 = password[nchar-1] - charT('a'); // .. and find the next one.
-    sumfreq = 0;
-    for (c3 = 0; c3 < 26; c3++)
-      sumfreq += tris[int(c1)][int(c2)][int(c3)];
-    /* Note that sum < duos[c1][c2] because
-       duos counts all digraphs, not just those
-       in a trigraph. We want sum. */
+    const int c1 = password[nchar-2] - charT('a'); // Take the last 2 chars
+    const int c2 = password[nchar-1] - charT('a'); // .. and find the next one.
+    const long *cum = tt.next[c1][c2];
+    sumfreq = cum[N - 1];
     if (sumfreq == 0) { // If there is no possible extension..
+      password.resize(nchar);
       break;  // Break while nchar loop & print what we have.
     }
     /* Choose a continuation. */
-    ranno = static_cast<long>(pwsrnd->RangeRand(static_cast<size_t>(sumfreq + 1))); // Weight by sum of frequencies
-    sum = 0;
-    for (c3 = 0; c3 < 26; c3++) {
-      sum += tris[int(c1)][int(c2)][int(c3)];
-      if (sum > ranno) {
-        password[nchar++] = charT('a') + c3;
-        c3 = 26;  // Break the for c3 loop.
-      }
-    } // for c3
+    ranno = static_cast<long>(rs.RangeRand(static_cast<size_t>(sumfreq))); // Weight by sum of frequencies
+    password[nchar++] = charT('a') + static_cast<int>(std::upper_bound(cum, cum + N, ranno) - cum);
   } // while nchar
   /*
    * password now has an all-lowercase pronounceable password
@@ -460,38 +520,37 @@ StringX CPasswordCharPool::MakePronounceable() const
     for_each(password.begin(), password.end(), fill_sc);
     if (!sc.empty()) {
       // choose how many to replace (not too many, but at least one)
-      unsigned int rn = pwsrnd->RangeRand(sc.size() - 1)/2 + 1;
+      unsigned int rn = rs.RangeRand(sc.size() - 1)/2 + 1;
       // replace some of them
-      UrbgAdapter g{ pwsrnd };
-      std::shuffle(sc.begin(), sc.end(), g);
+      std::shuffle(sc.begin(), sc.end(), rs);
 
       for (unsigned int i = 0; i < rn; i++)
-        leet_replace(password, sc[i], m_usedigits, m_usesymbols);
+        leet_replace(password, sc[i], m_usedigits, m_usesymbols, rs);
     }
   }
   // case
-  uint i;
   if (m_uselowercase && !m_useuppercase)
     ; // nothing to do here
   else if (!m_uselowercase && m_useuppercase)
-    for (i = 0; i < m_pwlen; i++) {
-      if (_istalpha(password[i]))
-        password[i] = static_cast<charT>(_totupper(password[i]));
+    for (auto &c : password) {
+      if (_istalpha(c))
+        c = static_cast<charT>(_totupper(c));
     }
   else if (m_uselowercase && m_useuppercase) // mixed case
-    for (i = 0; i < m_pwlen; i++) {
-      if (_istalpha(password[i]) && pwsrnd->RandUInt() % 2)
-        password[i] = static_cast<charT>(_totupper(password[i]));
+    for (auto &c : password) {
+      if (_istalpha(c) && rs.RandUInt() % 2)
+        c = static_cast<charT>(_totupper(c));
     }
 
   return password.c_str();
 }
 
-StringX CPasswordCharPool::MakeHex() const
+StringX CPasswordCharPool::MakeHex(RandSource &rs) const
 {
-  StringX password = _T("");
+  StringX password;
+  password.reserve(m_pwlen);
   for (uint i = 0; i < m_pwlen; i++) {
-      unsigned int rand = PWSrand::GetInstance()->RangeRand(m_sumlengths);
+      unsigned int rand = rs.RangeRand(m_sumlengths);
       charT ch = GetRandomChar(HEXDIGIT, rand);
       password += ch;
   }
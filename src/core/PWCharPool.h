@@ -16,6 +16,7 @@
 #include "PWPolicy.h"
 
 #include <algorithm>
+#include <vector>
 
 /*
  * This class is used to create a random password based on the policy
@@ -28,6 +29,11 @@
  * CPasswordCharPool pwgen(policy);
  * StringX pwd = pwgen.MakePassword();
  *
+ * When many passwords are needed for the same policy, MakePasswords(n)
+ * reuses the pool and draws its randomness in large blocks from the
+ * calling thread's generator, which is much cheaper than n calls to
+ * MakePassword().
+ *
  * CheckMasterPassword() is used to verify the strength of existing passwords,
  * i.e., the password used to protect the database.
  */
@@ -37,6 +43,7 @@ class CPasswordCharPool
 public:
   CPasswordCharPool(const PWPolicy &policy);
   StringX MakePassword() const;
+  std::vector<StringX> MakePasswords(size_t n) const;
 
   ~CPasswordCharPool();
 
@@ -50,12 +57,15 @@ public:
 private:
   enum CharType {LOWERCASE = 0, UPPERCASE = 1,
                  DIGIT = 2, SYMBOL = 3, HEXDIGIT = 4, NUMTYPES = 5};
+  class RandSource; // buffered random numbers, see PWCharPool.cpp
+
   // select a chartype with weighted probability
   CharType GetRandomCharType(unsigned int rand) const;
   charT GetRandomChar(CharType t, unsigned int rand) const;
-  charT GetRandomChar(CharType t) const;
-  StringX MakePronounceable() const;
-  StringX MakeHex() const;
+  charT GetRandomChar(CharType t, RandSource &rs) const;
+  StringX MakePassword(RandSource &rs) const;
+  StringX MakePronounceable(RandSource &rs) const;
+  StringX MakeHex(RandSource &rs) const;
 
   // here are all the character types, in both full and "easyvision" versions
   static const charT std_lowercase_chars[];
@@ -89,6 +99,7 @@ private:
   const charT *m_char_arrays[NUMTYPES];
 
   size_t m_sumlengths; // sum of all selected chartypes
+  StringX m_allchars; // concatenation of all selected chartypes
 
   // Following state vars set by ctor, used by MakePassword()
   const uint m_pwlen;
@@ -109,7 +120,8 @@ private:
   struct typeFreq_s {
     uint numchars;
     StringX vchars;
-    typeFreq_s(const CPasswordCharPool *parent, CharType ct, uint nc);
+    typeFreq_s(const CPasswordCharPool *parent, CharType ct, uint nc,
+               RandSource &rs);
   };
 
   CPasswordCharPool &operator=(const CPasswordCharPool &) = delete;
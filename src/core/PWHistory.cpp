@@ -124,12 +124,7 @@ PWHistList::PWHistList(const StringX &pwh_str, PWSUtil::TMC time_format)
       break;
 
     pwh_ent.changetttdate = static_cast<time_t>(t);
-    pwh_ent.changedate =
-      PWSUtil::ConvertToDateTimeString(static_cast<time_t>(t), time_format);
-    if (pwh_ent.changedate.empty()) {
-      //                       1234567890123456789
-      pwh_ent.changedate = _T("1970-01-01 00:00:00");
-    }
+    pwh_ent.changedate = FormatChangeDate(pwh_ent.changetttdate, time_format);
 
     iStringXStream ispwlen(StringX(pwh_s, offset, 4)); // pw length 2 byte hex
     int ipwlen = 0;
@@ -155,6 +150,22 @@ PWHistList::PWHistList(const StringX &pwh_str, PWSUtil::TMC time_format)
   m_saveHistory = bStatus;
 }
 
+StringX PWHistList::FormatChangeDate(time_t t, PWSUtil::TMC time_format)
+{
+  StringX changedate = PWSUtil::ConvertToDateTimeString(t, time_format);
+  if (changedate.empty()) {
+    //               1234567890123456789
+    changedate = _T("1970-01-01 00:00:00");
+  }
+  return changedate;
+}
+
+void PWHistList::setTimeFormat(PWSUtil::TMC time_format)
+{
+  for (auto &pwh_ent : *this)
+    pwh_ent.changedate = FormatChangeDate(pwh_ent.changetttdate, time_format);
+}
+
 StringX PWHistList::GetPreviousPassword(const StringX &pwh_str)
 {
   if (pwh_str == _T("0") || pwh_str == _T("00000")) {
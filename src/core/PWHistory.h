@@ -96,6 +96,7 @@ private:
     size_t m_numErr;        // Number of ill-formed entries
 
     void sortList();
+    static StringX FormatChangeDate(time_t t, PWSUtil::TMC time_format);
 
 public:
     // Parse a password history string as defined
@@ -103,7 +104,7 @@ public:
     PWHistList(const StringX &pwh_str, PWSUtil::TMC time_format);
 
     PWHistList() : m_saveHistory(false), m_maxEntries(0), m_numErr(0) {};
-    PWHistList(PWHistList &) = default;
+    PWHistList(const PWHistList &) = default;
     ~PWHistList() = default;
 
     // Convert this object to a string in the canonical DB format
@@ -118,6 +119,9 @@ public:
 
     void addEntry(const PWHistEntry &pwh_ent) { push_back(pwh_ent); };
 
+    // Reformats the change dates, as if parsed with time_format
+    void setTimeFormat(PWSUtil::TMC time_format);
+
     static StringX GetPreviousPassword(const StringX &pwh_str);
     static StringX MakePWHistoryHeader(bool status, size_t pwh_max, size_t pwh_num = 0);
 
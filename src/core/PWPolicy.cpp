@@ -153,6 +153,16 @@ StringX PWPolicy::MakeRandomPassword() const
   return pwchars.MakePassword();
 }
 
+std::vector<StringX> PWPolicy::MakeRandomPasswords(size_t n) const
+{
+  PWPolicy pol(*this);
+  if (flags == 0)
+    pol = PWSprefs::GetInstance()->GetDefaultPolicy();
+
+  CPasswordCharPool pwchars(pol);
+  return pwchars.MakePasswords(n);
+}
+
 static stringT PolValueString(int flag, int count)
 {
   // helper function for Policy2Table
@@ -13,6 +13,10 @@
 
 #include <vector>
 #include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include "PWSAuxParse.h"
 #include "CustomFields.h"
@@ -46,6 +50,59 @@ static UINT ParseRunCommand(const StringX &sxInputString,
 static UINT ProcessIndex(const StringX &sxIndex, int &var_index,
                          StringX::size_type &st_column);
 
+namespace {
+// Autotype templates and run commands, parsed
+template<class T> class ParsedCache
+{
+public:
+  std::shared_ptr<const T> Get(const StringX &sx)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto iter = m_map.find(sx);
+    if (iter != m_map.end())
+      return iter->second;
+
+    // There are only ever a few, unless they're being edited
+    if (m_map.size() >= MAX_ENTRIES)
+      m_map.clear();
+    auto p = std::make_shared<const T>(sx);
+    m_map.emplace(sx, p);
+    return p;
+  }
+
+  void Clear()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_map.clear();
+  }
+
+private:
+  static const size_t MAX_ENTRIES = 64;
+  std::mutex m_mutex;
+  std::map<StringX, std::shared_ptr<const T>> m_map;
+};
+
+// A run command as parsed by ParseRunCommand, less the error message,
+// which is loaded when needed in the current language
+struct ParsedRunCommand {
+  explicit ParsedRunCommand(const StringX &sxRun_Command)
+    : bAutoType(false), st_column(0)
+  {
+    stringT serrmsg;
+    uierr = ParseRunCommand(sxRun_Command, v_rctokens, bAutoType, sxAutotype,
+                            serrmsg, st_column);
+  }
+
+  UINT uierr;
+  std::vector<st_RunCommandTokens> v_rctokens;
+  bool bAutoType;
+  StringX sxAutotype;
+  StringX::size_type st_column;
+};
+
+ParsedCache<ParsedRunCommand> runCommandCache;
+} // namespace
+
 static void ParseNotes(const StringX &sxNotes,
                        std::vector<StringX> &vsxnotes_lines)
 {
@@ -112,20 +169,23 @@ StringX PWSAuxParse::GetExpandedString(const StringX &sxRun_Command,
                                        StringX::size_type &st_column,
                                        bool &bURLSpecial)
 {
-  std::vector<st_RunCommandTokens> v_rctokens;
-  std::vector<st_RunCommandTokens>::iterator rc_iter;
   StringX sxretval(_T(""));
   stringT spath, sdrive, sdir, sfname, sextn;
   stringT sdbdir;
   bURLSpecial = false;
 
-  UINT uierr = ParseRunCommand(sxRun_Command, v_rctokens, 
-                               bAutoType, sxAutotype, 
-                               serrmsg, st_column);
+  const std::shared_ptr<const ParsedRunCommand> prc = runCommandCache.Get(sxRun_Command);
+  const UINT uierr = prc->uierr;
+  bAutoType = prc->bAutoType;
+  sxAutotype = prc->sxAutotype;
+  st_column = prc->st_column;
+  if (uierr != 0)
+    LoadAString(serrmsg, uierr);
+  else
+    serrmsg = _T("");
 
   // if called with nullptr ci, then we just parse to validate
   if (uierr > 0 || pci == nullptr) {
-    v_rctokens.clear();
     return sxretval;
   }
 
@@ -134,13 +194,16 @@ StringX PWSAuxParse::GetExpandedString(const StringX &sxRun_Command,
   pws_os::splitpath(spath, sdrive, sdir, sfname, sextn);
   sdbdir = pws_os::makepath(sdrive, sdir, _T(""), _T(""));
 
-  CItemData effci;
-  StringX sx_lastpswd, sx_totpauthcode;
-  GetEffectiveValues(pci, pbci, effci, sx_lastpswd, sx_totpauthcode);
-
-  for (rc_iter = v_rctokens.begin(); rc_iter < v_rctokens.end(); rc_iter++) {
-    st_RunCommandTokens &st_rctoken = *rc_iter;
+  // As GetEffectiveValues, but only for the fields that are used
+  if (pci->IsDependent()) {
+    ASSERT(pbci != nullptr);
+  }
+  const bool bNoValues = pci->IsDependent() && pbci == nullptr;
+  const auto fieldValue = [pci, pbci, bNoValues](CItemData::FieldType ft) {
+    return bNoValues ? StringX() : pci->GetEffectiveFieldValue(ft, pbci);
+  };
 
+  for (const st_RunCommandTokens &st_rctoken : prc->v_rctokens) {
     if (!st_rctoken.is_variable) {
       sxretval += st_rctoken.sxname.c_str();
       continue;
@@ -162,10 +225,10 @@ StringX PWSAuxParse::GetExpandedString(const StringX &sxRun_Command,
       sxretval += sextn.c_str();
     } else
     if (st_rctoken.sxname == _T("g") || st_rctoken.sxname == _T("group")) {
-      sxretval += effci.GetGroup();
+      sxretval += fieldValue(CItemData::GROUP);
     } else
     if (st_rctoken.sxname == _T("G") || st_rctoken.sxname == _T("GROUP")) {
-      StringX sxg = effci.GetGroup();
+      StringX sxg = fieldValue(CItemData::GROUP);
       StringX::size_type st_index;
       st_index = sxg.rfind(_T('.'));
       if (st_index != StringX::npos) {
@@ -174,22 +237,22 @@ StringX PWSAuxParse::GetExpandedString(const StringX &sxRun_Command,
       sxretval += sxg;
     } else
     if (st_rctoken.sxname == _T("t") || st_rctoken.sxname == _T("title")) {
-      sxretval += effci.GetTitle();
+      sxretval += fieldValue(CItemData::TITLE);
     } else
     if (st_rctoken.sxname == _T("u") || st_rctoken.sxname == _T("user")) {
-      sxretval += effci.GetUser();
+      sxretval += fieldValue(CItemData::USER);
     } else
     if (st_rctoken.sxname == _T("p") || st_rctoken.sxname == _T("password")) {
-      sxretval += effci.GetPassword();
+      sxretval += fieldValue(CItemData::PASSWORD);
     } else
       if (st_rctoken.sxname == _T("e") || st_rctoken.sxname == _T("email")) {
-      sxretval += effci.GetEmail();
+      sxretval += fieldValue(CItemData::EMAIL);
     } else
     if (st_rctoken.sxname == _T("a") || st_rctoken.sxname == _T("autotype")) {
       // Do nothing - autotype variable handled elsewhere
     } else
     if (st_rctoken.sxname == _T("url")) {
-      StringX sxurl = effci.GetURL();
+      StringX sxurl = fieldValue(CItemData::URL);
       if (sxurl.length() > 0) {
         // Remove 'Browse to' specifics
         StringX::size_type ipos;
@@ -221,10 +284,10 @@ StringX PWSAuxParse::GetExpandedString(const StringX &sxRun_Command,
     } else
     if (st_rctoken.sxname == _T("n") || st_rctoken.sxname == _T("notes")) {
       if (st_rctoken.index == 0) {
-        sxretval += effci.GetNotes();
+        sxretval += fieldValue(CItemData::NOTES);
       } else {
         std::vector<StringX> vsxnotes_lines;
-        ParseNotes(effci.GetNotes(), vsxnotes_lines);
+        ParseNotes(fieldValue(CItemData::NOTES), vsxnotes_lines);
         // If line there - use it; otherwise ignore it
         if (st_rctoken.index > 0 && st_rctoken.index <= static_cast<int>(vsxnotes_lines.size())) {
           sxretval += vsxnotes_lines[st_rctoken.index - 1];
@@ -246,7 +309,6 @@ StringX PWSAuxParse::GetExpandedString(const StringX &sxRun_Command,
         sxretval += _T(")");
     }
   }
-  v_rctokens.clear();
   return sxretval;
 }
 
@@ -333,9 +395,9 @@ static StringX duplicateCharInString(const StringX& input, TCHAR targetChar)
   return retval;
 };
 
-static bool ExpandCustomFieldValue(const StringX &sx_autotype, size_t &n,
-                                   const CustomFieldList *pcustomfields,
-                                   StringX &sxtmp)
+// \v{name}: returns false if not followed by a name in curly brackets
+static bool GetCustomFieldName(const StringX &sx_autotype, size_t &n,
+                               StringX &sxName)
 {
   if (n + 1 >= sx_autotype.length() || sx_autotype[n + 1] != TCHAR('{'))
     return false;
@@ -344,59 +406,19 @@ static bool ExpandCustomFieldValue(const StringX &sx_autotype, size_t &n,
   if (iEndBracket == StringX::npos)
     return false;
 
-  const StringX sxName = sx_autotype.substr(n + 2, iEndBracket - n - 2);
-  if (pcustomfields != nullptr) {
-    const auto it = std::find_if(pcustomfields->begin(), pcustomfields->end(),
-                                 [&sxName](const CustomField &cf) {
-                                   return cf.GetName() == sxName;
-                                 });
-    if (it != pcustomfields->end()) {
-      sxtmp += duplicateCharInString(it->GetValue(), L'\\');
-    }
-  }
+  sxName = sx_autotype.substr(n + 2, iEndBracket - n - 2);
   n = iEndBracket;
   return true;
 }
 
-StringX PWSAuxParse::GetAutoTypeString(const StringX &sx_in_autotype,
-                                       const StringX &sx_group,
-                                       const StringX &sx_title,
-                                       const StringX &sx_user,
-                                       const StringX &sx_pwd,
-                                       const StringX &sx_lastpwd,
-                                       const StringX &sx_notes,
-                                       const StringX &sx_url,
-                                       const StringX &sx_email,
-                                       const StringX& sx_totpauthcode,
-                                       const CustomFieldList *pcustomfields,
-                                       std::vector<size_t> &vactionverboffsets)
+// The notes as autotyped by \o, i.e., with "\r\n" as '\r' and "\t" as a
+// tab, and their lines
+static void ParseAutoTypeNotes(const StringX &sx_notes, StringX &sxNotes,
+                               std::vector<StringX> &vsxnotes_lines)
 {
-  StringX sxtmp(_T(""));
-  StringX sxNotes(sx_notes);
-  TCHAR curChar;
-  StringX sx_autotype(sx_in_autotype);
   StringX::size_type st_index;
-  std::vector<StringX> vsxnotes_lines;
-
-  vactionverboffsets.clear();
-
-  // If empty, try the database default
-  if (sx_autotype.empty()) {
-    sx_autotype = PWSprefs::GetInstance()->
-              GetPref(PWSprefs::DefaultAutotypeString);
-
-    // If still empty, take this default
-    if (sx_autotype.empty()) {
-      // checking for user and password for default settings
-      if (!sx_pwd.empty()){
-        if (!sx_user.empty())
-          sx_autotype = DEFAULT_AUTOTYPE;
-        else
-          sx_autotype = _T("\\p\\n");
-      }
-    }
-  }
 
+  sxNotes = sx_notes;
   // No recursive substitution (e.g. \p or \u), although '\t' will be replaced by a tab
   if (!sx_notes.empty()) {
     // Use \n and \r to tokenise this line
@@ -442,7 +464,115 @@ StringX PWSAuxParse::GetAutoTypeString(const StringX &sx_in_autotype,
       st_index += 1;
     }
   }
+}
 
+static StringX FindCustomFieldValue(const CustomFieldList *pcustomfields,
+                                   const StringX &sxName)
+{
+  if (pcustomfields != nullptr) {
+    const auto it = std::find_if(pcustomfields->begin(), pcustomfields->end(),
+                                 [&sxName](const CustomField &cf) {
+                                   return cf.GetName() == sxName;
+                                 });
+    if (it != pcustomfields->end())
+      return it->GetValue();
+  }
+  return StringX();
+}
+
+/*
+ * An autotype template compiled into a list of instructions: text, which
+ * is kept as it appears in the string returned by GetAutoTypeString,
+ * references to the fields whose values are to be typed, and the action
+ * verbs. Templates are compiled once and then cached, as the same few
+ * are used over and over again.
+ */
+class PWSAuxParse::AutoTypeTemplate
+{
+public:
+  enum OpCode {
+    OP_TEXT,        // text
+    OP_FIELD,       // the value of field
+    OP_NOTES,       // the notes or, if line != 0, one of their lines
+    OP_CUSTOMFIELD, // the value of the custom field named text
+    OP_ACTION       // verb, also as text
+  };
+
+  // Values of field other than CItemData::FieldType
+  enum {PREVIOUS_PASSWORD = -1, TOTP_AUTH_CODE = -2};
+
+  struct Op {
+    OpCode code;
+    StringX text;
+    int field;
+    size_t line;
+    TCHAR verb;
+    unsigned delay; // \d, \w, \W
+  };
+
+  explicit AutoTypeTemplate(const StringX &sx_autotype);
+
+  static std::shared_ptr<const AutoTypeTemplate> Get(const StringX &sx_autotype);
+  static void ClearCache();
+
+  std::vector<Op> m_ops;
+  bool m_bForceOldMethod; // \z
+
+private:
+  void AddText(const StringX &sx);
+  void AddOp(OpCode code, int field = 0, size_t line = 0, const StringX &text = StringX());
+  void AddAction(TCHAR verb, const StringX &sx, unsigned delay = 0);
+};
+
+namespace {
+ParsedCache<PWSAuxParse::AutoTypeTemplate> autoTypeCache;
+} // namespace
+
+std::shared_ptr<const PWSAuxParse::AutoTypeTemplate>
+PWSAuxParse::AutoTypeTemplate::Get(const StringX &sx_autotype)
+{
+  return autoTypeCache.Get(sx_autotype);
+}
+
+void PWSAuxParse::AutoTypeTemplate::ClearCache()
+{
+  autoTypeCache.Clear();
+}
+
+void PWSAuxParse::AutoTypeTemplate::AddText(const StringX &sx)
+{
+  if (m_ops.empty() || m_ops.back().code != OP_TEXT)
+    AddOp(OP_TEXT);
+  m_ops.back().text += sx;
+}
+
+void PWSAuxParse::AutoTypeTemplate::AddOp(OpCode code, int field, size_t line,
+                                          const StringX &text)
+{
+  Op op;
+  op.code = code;
+  op.text = text;
+  op.field = field;
+  op.line = line;
+  op.verb = 0;
+  op.delay = 0;
+  m_ops.push_back(op);
+}
+
+void PWSAuxParse::AutoTypeTemplate::AddAction(TCHAR verb, const StringX &sx,
+                                              unsigned delay)
+{
+  AddOp(OP_ACTION, 0, 0, sx);
+  m_ops.back().verb = verb;
+  m_ops.back().delay = delay;
+  if (verb == TCHAR('z'))
+    m_bForceOldMethod = true;
+}
+
+PWSAuxParse::AutoTypeTemplate::AutoTypeTemplate(const StringX &sx_autotype)
+  : m_bForceOldMethod(false)
+{
+  TCHAR curChar;
   const size_t N = sx_autotype.length();
   const StringX sxZeroes = _T("000");
   unsigned int gNumIts;
@@ -456,51 +586,46 @@ StringX PWSAuxParse::GetAutoTypeString(const StringX &sx_in_autotype,
 
       switch (curChar){
         case TCHAR('\\'):
-          sxtmp += TCHAR('\\');
+          AddText(_T("\\"));
           break;
         case TCHAR('n'):
         case TCHAR('r'):
-          sxtmp += TCHAR('\r');
+          AddText(_T("\r"));
           break;
         case TCHAR('t'):
-          sxtmp += TCHAR('\t');
+          AddText(_T("\t"));
           break;
         case TCHAR('s'):
-          sxtmp += TCHAR('\v');
+          AddText(_T("\v"));
           break;
         case TCHAR('g'):
-          sxtmp += duplicateCharInString(sx_group, L'\\');
+          AddOp(OP_FIELD, CItemData::GROUP);
           break;
         case TCHAR('i'):
-          sxtmp += duplicateCharInString(sx_title, L'\\');
+          AddOp(OP_FIELD, CItemData::TITLE);
           break;
         case TCHAR('u'):
-          sxtmp += duplicateCharInString(sx_user, L'\\');
+          AddOp(OP_FIELD, CItemData::USER);
           break;
         case TCHAR('p'):
-          sxtmp += duplicateCharInString(sx_pwd, L'\\');
+          AddOp(OP_FIELD, CItemData::PASSWORD);
           break;
         case TCHAR('q'):
-          sxtmp += duplicateCharInString(sx_lastpwd, L'\\');
+          AddOp(OP_FIELD, PREVIOUS_PASSWORD);
           break;
         case TCHAR('l'):
-          sxtmp += duplicateCharInString(sx_url, L'\\');
+          AddOp(OP_FIELD, CItemData::URL);
           break;
         case TCHAR('m'):
-          sxtmp += duplicateCharInString(sx_email, L'\\');
+          AddOp(OP_FIELD, CItemData::EMAIL);
           break;
         case TCHAR('2'):
-          sxtmp += duplicateCharInString(sx_totpauthcode, L'\\');
+          AddOp(OP_FIELD, TOTP_AUTH_CODE);
           break;
         case TCHAR('o'):
         {
-          StringX sxN;
-          bool bSendNotes(true);
-          if (n == (N - 1)) {
-            // This was the last character - send the lot!
-            sxN = sxNotes;
-          } else {
-            size_t line_number(0);
+          size_t line_number(0);
+          if (n != (N - 1)) {
             gNumIts = 0;
             for (n++; n < N && (gNumIts < 3); ++gNumIts, n++) {
               if (_istdigit(sx_autotype[n])) {
@@ -509,29 +634,11 @@ StringX PWSAuxParse::GetAutoTypeString(const StringX &sx_in_autotype,
               } else
                 break; // for loop
             }
-
-            if (line_number == 0) {
-              // Send the lot
-              sxN = sxNotes;
-            } else {
-              if (line_number <= vsxnotes_lines.size()) {
-                // Only copy if user has specified a valid Notes line number
-
-                sxN = vsxnotes_lines[line_number - 1];
-              } else {
-                bSendNotes = false;
-              }
-            }
             // Backup the extra character that delimited the \oNNN string
             n--;
           }
-
-          if (bSendNotes) {
-            // As per help '\n' & '\r\n' replaced by '\r'
-            Replace(sxN, StringX(_T("\r\n")), StringX(_T("\r")));
-            Replace(sxN, _T('\n'), _T('\r'));
-            sxtmp += sxN;
-          }
+          // line 0: this was the last character or no line was given - send the lot!
+          AddOp(OP_NOTES, CItemData::NOTES, line_number);
           break; // case 'o'
         }
 
@@ -544,60 +651,72 @@ StringX PWSAuxParse::GetAutoTypeString(const StringX &sx_in_autotype,
         case TCHAR('c'):  // select-all
         case TCHAR('j'):  // modifier emulation on
         case TCHAR('k'):  // modifier emulation off
-          vactionverboffsets.push_back(sxtmp.length());
-          sxtmp += _T("\\");
-          sxtmp += curChar;
+        {
+          StringX sxVerb(_T("\\"));
+          sxVerb += curChar;
+          AddAction(curChar, sxVerb);
           break; // case 'b' & 'z'
+        }
 
         case TCHAR('#'):  // Use older method but allow on/off
-          sxtmp += _T("\\");
-          sxtmp += curChar;
+          AddText(_T("\\#"));
           break; // case '#'
 
         case TCHAR('d'):  // Delay
         case TCHAR('w'):  // Wait milli-seconds
         case TCHAR('W'):  // Wait seconds
         {
-          // Need to ensure that the field length is 3, even if it wasn't
-          vactionverboffsets.push_back(sxtmp.length());
-          sxtmp += _T("\\");
-          sxtmp += curChar;
+          // Need to ensure that the field length is 3, even if it wasn't.
+          // The digits are part of the action, rather than text.
+          StringX sxVerb(_T("\\"));
+          sxVerb += curChar;
 
+          unsigned int delay = 0;
           gNumIts = 0;
           size_t i = n;
           for (i++; i < N && (gNumIts < 3); ++gNumIts, i++) {
             if (!_istdigit(sx_autotype[i]))
               break;
+            delay *= 10;
+            delay += (sx_autotype[i] - TCHAR('0'));
           }
           // Insert sufficient zeroes to ensure field is 3 characters long
-          sxtmp += sxZeroes.substr(0, 3 - gNumIts);
+          sxVerb += sxZeroes.substr(0, 3 - gNumIts);
+          sxVerb += sx_autotype.substr(n + 1, gNumIts);
+          n += gNumIts;
+          AddAction(curChar, sxVerb, delay);
           break; // case 'd', 'w' & 'W'
         }
 
         case TCHAR('{'):
         {
           // Special processing of particular commands - could be expanded later
-          sxtmp += _T("\\");
-          sxtmp += curChar;
+          StringX sxSpecial(_T("\\"));
+          sxSpecial += curChar;
           WORD wVK;
           bool bAlt, bCtrl, bShift;
           if (GetSpecialCommand(sx_autotype, n, wVK, bAlt, bCtrl, bShift)) {
-            if (bAlt) sxtmp += _T('!');
-            if (bCtrl) sxtmp += _T('^');
-            if (bShift) sxtmp += _T('+');
-            sxtmp += wVK;
+            if (bAlt) sxSpecial += _T('!');
+            if (bCtrl) sxSpecial += _T('^');
+            if (bShift) sxSpecial += _T('+');
+            sxSpecial += wVK;
           }
+          AddText(sxSpecial);
           break;
         }
 
         case TCHAR('e'): // escape
-          sxtmp += L'\x1B';
+          AddText(_T("\x1B"));
           break;        // Also copy explicit control characters to output string unchanged.
 
         case TCHAR('v'):
-          if (ExpandCustomFieldValue(sx_autotype, n, pcustomfields, sxtmp)) {
+        {
+          StringX sxName;
+          if (GetCustomFieldName(sx_autotype, n, sxName)) {
+            AddOp(OP_CUSTOMFIELD, CItemData::CUSTOMTEXT, 0, sxName);
             break;
           }
+        }
           // deliberate fall-through
           [[fallthrough]];
         case TCHAR('a'): // bell (can't hear it during testing!)
@@ -606,36 +725,104 @@ StringX PWSAuxParse::GetAutoTypeString(const StringX &sx_in_autotype,
         // and any others we have forgotten!
         // '\cC', '\uXXXX', '\OOO', '\<any other character not recognized above>'
         default:
-          sxtmp += L'\\';
-          sxtmp += curChar;
+        {
+          StringX sxOther(_T("\\"));
+          sxOther += curChar;
+          AddText(sxOther);
           break;
+        }
       }
     } else
-      sxtmp += curChar;
+      AddText(StringX(1, curChar));
   }
+}
 
-  vsxnotes_lines.clear();
-  return sxtmp;
+void PWSAuxParse::ClearAutoTypeCache()
+{
+  AutoTypeTemplate::ClearCache();
+  runCommandCache.Clear();
 }
 
-StringX PWSAuxParse::GetAutoTypeString(const CItemData &ci,
-                                       const PWScore &core,
-                                       std::vector<size_t> &vactionverboffsets)
+PWSAuxParse::AutoType::AutoType(const StringX &sx_autotype,
+                                const StringX &sx_group,
+                                const StringX &sx_title,
+                                const StringX &sx_user,
+                                const StringX &sx_pwd,
+                                const StringX &sx_lastpwd,
+                                const StringX &sx_notes,
+                                const StringX &sx_url,
+                                const StringX &sx_email,
+                                const StringX &sx_totpauthcode,
+                                const CustomFieldList *pcustomfields)
+{
+  Init(sx_autotype,
+       [&](int field) -> StringX {
+         switch (field) {
+           case CItemData::GROUP: return sx_group;
+           case CItemData::TITLE: return sx_title;
+           case CItemData::USER: return sx_user;
+           case CItemData::PASSWORD: return sx_pwd;
+           case AutoTypeTemplate::PREVIOUS_PASSWORD: return sx_lastpwd;
+           case CItemData::NOTES: return sx_notes;
+           case CItemData::URL: return sx_url;
+           case CItemData::EMAIL: return sx_email;
+           case AutoTypeTemplate::TOTP_AUTH_CODE: return sx_totpauthcode;
+           default: ASSERT(0); return StringX();
+         }
+       },
+       [pcustomfields](const StringX &sxName) {
+         return FindCustomFieldValue(pcustomfields, sxName);
+       });
+}
+
+PWSAuxParse::AutoType::AutoType(const CItemData &ci, const PWScore &core)
 {
   const CItemData *pbci(nullptr);
 
   if (ci.IsDependent()) {
     pbci = core.GetBaseEntry(&ci);
+    ASSERT(pbci != nullptr);
   }
+  // As GetEffectiveValues: nothing if a dependent's base is missing
+  const bool bNoValues = ci.IsDependent() && pbci == nullptr;
+
+  // Only the fields that the template refers to are fetched, from the
+  // entry or its base, rather than a copy of the lot
+  const auto fieldValue = [&ci, pbci, bNoValues](int field) -> StringX {
+    if (bNoValues)
+      return StringX();
+    switch (field) {
+      case AutoTypeTemplate::PREVIOUS_PASSWORD:
+      {
+        const CItemData *phci = ci.GetEffectiveItem(CItemData::PWHIST, pbci);
+        return phci != nullptr ? phci->GetPreviousPassword() : StringX();
+      }
+      case AutoTypeTemplate::TOTP_AUTH_CODE:
+        return ci.IsDependent() ? pbci->GetTotpAuthCode() : ci.GetTotpAuthCode();
+      default:
+        return ci.GetEffectiveFieldValue(static_cast<CItemData::FieldType>(field), pbci);
+    }
+  };
+
+  // The custom fields are only parsed if \v is used
+  const auto customFieldValue = [&ci, pbci, bNoValues](const StringX &sxName) -> StringX {
+    const CItemData *pcfci = bNoValues ? nullptr : ci.GetEffectiveItem(CItemData::CUSTOMTEXT, pbci);
+    if (pcfci == nullptr || !pcfci->IsCustomFieldsSet())
+      return StringX();
+    const CustomFieldList customFields = pcfci->GetCustomFields();
+    return FindCustomFieldValue(&customFields, sxName);
+  };
+
+  Init(fieldValue(CItemData::AUTOTYPE), fieldValue, customFieldValue);
+}
 
-  CItemData effci;
-  StringX sx_prevPassword, sx_totpAuthCode;
-
-  GetEffectiveValues(&ci, pbci, effci, sx_prevPassword, sx_totpAuthCode);
-
+void PWSAuxParse::AutoType::Init(const StringX &sx_in_autotype,
+                                 const std::function<StringX(int field)> &fieldValue,
+                                 const std::function<StringX(const StringX &name)> &customFieldValue)
+{
+  StringX sx_autotype(sx_in_autotype);
 
-  // If autotype string is empty, try the database default
-  StringX sx_autotype = effci.GetAutoType();
+  // If empty, try the database default
   if (sx_autotype.empty()) {
     sx_autotype = PWSprefs::GetInstance()->
               GetPref(PWSprefs::DefaultAutotypeString);
@@ -643,20 +830,327 @@ StringX PWSAuxParse::GetAutoTypeString(const CItemData &ci,
     // If still empty, take this default
     if (sx_autotype.empty()) {
       // checking for user and password for default settings
-      if (!effci.GetPassword().empty()){
-        if (!effci.GetUser().empty())
+      if (!fieldValue(CItemData::PASSWORD).empty()){
+        if (!fieldValue(CItemData::USER).empty())
           sx_autotype = DEFAULT_AUTOTYPE;
         else
           sx_autotype = _T("\\p\\n");
       }
     }
   }
-  const CustomFieldList customFields = effci.GetCustomFields();
-  return PWSAuxParse::GetAutoTypeString(sx_autotype, effci.GetGroup(),
-    effci.GetTitle(), effci.GetUser(), effci.GetPassword(), sx_prevPassword,
-    effci.GetNotes(), effci.GetURL(), effci.GetEmail(), sx_totpAuthCode,
-    &customFields,
-                                        vactionverboffsets);
+
+  m_ptemplate = AutoTypeTemplate::Get(sx_autotype);
+
+  const std::vector<AutoTypeTemplate::Op> &ops = m_ptemplate->m_ops;
+  m_vValues.resize(ops.size());
+
+  bool bNotesParsed(false);
+  StringX sxNotes;
+  std::vector<StringX> vsxnotes_lines;
+
+  for (size_t i = 0; i < ops.size(); i++) {
+    const AutoTypeTemplate::Op &op = ops[i];
+    switch (op.code) {
+      case AutoTypeTemplate::OP_FIELD:
+        m_vValues[i] = fieldValue(op.field);
+        break;
+      case AutoTypeTemplate::OP_CUSTOMFIELD:
+        m_vValues[i] = customFieldValue(op.text);
+        break;
+      case AutoTypeTemplate::OP_NOTES:
+      {
+        if (!bNotesParsed) {
+          ParseAutoTypeNotes(fieldValue(CItemData::NOTES), sxNotes, vsxnotes_lines);
+          bNotesParsed = true;
+        }
+        StringX sxN;
+        if (op.line == 0) {
+          // Send the lot
+          sxN = sxNotes;
+        } else if (op.line <= vsxnotes_lines.size()) {
+          // Only copy if user has specified a valid Notes line number
+          sxN = vsxnotes_lines[op.line - 1];
+        }
+        // As per help '\n' & '\r\n' replaced by '\r'
+        Replace(sxN, StringX(_T("\r\n")), StringX(_T("\r")));
+        Replace(sxN, _T('\n'), _T('\r'));
+        m_vValues[i] = sxN;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+bool PWSAuxParse::AutoType::IsEmpty() const
+{
+  const std::vector<AutoTypeTemplate::Op> &ops = m_ptemplate->m_ops;
+  for (size_t i = 0; i < ops.size(); i++) {
+    if (!ops[i].text.empty() && (ops[i].code == AutoTypeTemplate::OP_TEXT ||
+                                 ops[i].code == AutoTypeTemplate::OP_ACTION))
+      return false;
+    if (!m_vValues[i].empty())
+      return false;
+  }
+  return true;
+}
+
+bool PWSAuxParse::AutoType::ForcesOldMethod() const
+{
+  return m_ptemplate->m_bForceOldMethod;
+}
+
+StringX PWSAuxParse::AutoType::GetString(std::vector<size_t> &vactionverboffsets) const
+{
+  StringX sxtmp(_T(""));
+  vactionverboffsets.clear();
+
+  const std::vector<AutoTypeTemplate::Op> &ops = m_ptemplate->m_ops;
+  for (size_t i = 0; i < ops.size(); i++) {
+    switch (ops[i].code) {
+      case AutoTypeTemplate::OP_TEXT:
+        sxtmp += ops[i].text;
+        break;
+      case AutoTypeTemplate::OP_ACTION:
+        vactionverboffsets.push_back(sxtmp.length());
+        sxtmp += ops[i].text;
+        break;
+      case AutoTypeTemplate::OP_NOTES:
+        // No recursive substitution, the notes' '\' are kept as they are
+        sxtmp += m_vValues[i];
+        break;
+      default:
+        sxtmp += duplicateCharInString(m_vValues[i], L'\\');
+        break;
+    }
+  }
+  return sxtmp;
+}
+
+// Sends text as it would appear in GetAutoTypeString's string, processing
+// what SendAutoTypeString does outside of the action verbs
+static void SendAutoTypeText(PWSAuxParse::KeySender &ks, const StringX &sxautotype,
+                             const bool bForceOldMethod, bool &bForceOldMethod2)
+{
+  StringX sxtmp(_T(""));
+  wchar_t curChar;
+  const size_t N = sxautotype.length();
+
+  for (size_t n = 0; n < N; n++){
+    curChar = sxautotype[n];
+    if (curChar == _T('\\')) {
+      n++;
+      if (n < N)
+        curChar = sxautotype[n];
+
+      switch (curChar) {
+        case L'd':
+        case L'w':
+        case L'W':
+        case L'z':
+        case L'b':
+          // Not action verbs - treat as-is
+          sxtmp += L'\\';
+          sxtmp += curChar;
+          break;
+
+        case L'#':
+          // This toggles using the OldMethod as long as \z not specified ANYWHERE
+          // in the Autotype string
+          if (bForceOldMethod) {
+            // User has already used '\z' - ignore this \# - treat as-is
+            sxtmp += L'\\';
+            sxtmp += curChar;
+          } else {
+            // Send what we have
+            if (sxtmp.length() > 0) {
+              ks.SendString(sxtmp);
+              sxtmp.clear();
+            }
+            // Toggle
+            bForceOldMethod2 = !bForceOldMethod2;
+            ks.SetOldSendMethod(bForceOldMethod2);
+          }
+          break;
+
+        case L'{':
+        {
+          // Send what we have
+          if (!sxtmp.empty()) {
+            ks.SendString(sxtmp);
+            sxtmp.clear();
+          }
+
+          // Get this field
+          StringX sxSpecial = sxautotype.substr(n + 1);
+          StringX::size_type iEndBracket = sxSpecial.find(_T('}'));
+          if (iEndBracket == StringX::npos) { // malformed - no '}'
+            sxtmp += L'\\';
+            sxtmp += curChar;
+            break;
+          }
+          sxSpecial.erase(iEndBracket);
+          StringX::size_type iModifiersLength = sxSpecial.find_last_of(_T("!^+"));
+
+          bool bAlt(false), bCtrl(false), bShift(false);
+          if (iModifiersLength != StringX::npos) {
+            iModifiersLength++;
+            for (size_t i = 0; i < iModifiersLength; i++) {
+              if (sxSpecial[0] == _T('!')) {
+                bAlt = true;
+                sxSpecial.erase(0, 1);
+                continue;
+              }
+              if (sxSpecial[0] == _T('^')) {
+                bCtrl = true;
+                sxSpecial.erase(0, 1);
+                continue;
+              }
+              if (sxSpecial[0] == _T('+')) {
+                bShift = true;
+                sxSpecial.erase(0, 1);
+                continue;
+              }
+            }
+          } else { // no modifier
+            iModifiersLength = 0;
+          }
+
+          // Get Virtual Key code
+          WORD wVK = sxautotype[n + iModifiersLength + 1];
+          ks.SendVirtualKey(wVK, bAlt, bCtrl, bShift);
+
+          // Skip over modifiers, VK and closing bracket
+          n += iEndBracket + 1;
+          break;
+        }
+        default:
+          sxtmp += curChar;
+          break;
+      }
+    } else // curChar isn't backslash+special code
+      sxtmp += curChar;
+  }
+
+  if (!sxtmp.empty())
+    ks.SendString(sxtmp);
+}
+
+namespace {
+  class CKeySendSender : public PWSAuxParse::KeySender {
+  public:
+    explicit CKeySendSender(CKeySend &ks) : m_ks(ks) {}
+    void SendString(const StringX &data) override {m_ks.SendString(data);}
+    void SendVirtualKey(WORD wVK, bool bAlt, bool bCtrl, bool bShift) override
+    {m_ks.SendVirtualKey(wVK, bAlt, bCtrl, bShift);}
+    void SetAndDelay(unsigned d) override {m_ks.SetAndDelay(d);}
+    void SetOldSendMethod(bool bForceOldMethod) override
+    {m_ks.SetOldSendMethod(bForceOldMethod);}
+    void SelectAll() override {m_ks.SelectAll();}
+    void EmulateMods(bool emulate) override {m_ks.EmulateMods(emulate);}
+
+  private:
+    CKeySend &m_ks;
+  };
+}
+
+void PWSAuxParse::AutoType::Send(CKeySend &ks) const
+{
+  CKeySendSender sender(ks);
+  Send(sender);
+}
+
+void PWSAuxParse::AutoType::Send(KeySender &ks) const
+{
+  bool bForceOldMethod2(false);
+  const bool bForceOldMethod = ForcesOldMethod();
+
+  const std::vector<AutoTypeTemplate::Op> &ops = m_ptemplate->m_ops;
+  for (size_t i = 0; i < ops.size(); i++) {
+    const AutoTypeTemplate::Op &op = ops[i];
+    switch (op.code) {
+      case AutoTypeTemplate::OP_TEXT:
+        SendAutoTypeText(ks, op.text, bForceOldMethod, bForceOldMethod2);
+        break;
+      case AutoTypeTemplate::OP_NOTES:
+        SendAutoTypeText(ks, m_vValues[i], bForceOldMethod, bForceOldMethod2);
+        break;
+      case AutoTypeTemplate::OP_FIELD:
+      case AutoTypeTemplate::OP_CUSTOMFIELD:
+        // Typed as they are: no need to double their '\' as in GetString
+        if (!m_vValues[i].empty())
+          ks.SendString(m_vValues[i]);
+        break;
+      case AutoTypeTemplate::OP_ACTION:
+        switch (op.verb) {
+          case L'd':
+            /*
+             'd' means value is in milli-seconds, max value = 0.999s
+             and is the delay between sending each character
+
+             'w' means value is in milli-seconds, max value = 0.999s
+             'W' means value is in seconds, max value = 16m 39s
+             and is the wait time before sending the next character.
+             Use of this field does not change any current delay value.
+
+             User needs to understand that PasswordSafe will be unresponsive
+             for the whole of this wait period!
+            */
+            ks.SetAndDelay(op.delay);
+            break;
+          case L'w':
+            pws_os::sleep_ms(op.delay);
+            break;
+          case L'W':
+            pws_os::sleep_ms(op.delay * 1000);
+            break;
+          case L'b':
+            ks.SendString(_T("\b"));
+            break;
+          case L'c':
+            ks.SelectAll();
+            break;
+          case L'j':
+          case L'k':
+            ks.EmulateMods(op.verb == L'j');
+            break;
+          case L'z': // see ForcesOldMethod
+          default:
+            break;
+        }
+        break;
+      default:
+        ASSERT(0);
+        break;
+    }
+  }
+}
+
+StringX PWSAuxParse::GetAutoTypeString(const StringX &sx_in_autotype,
+                                       const StringX &sx_group,
+                                       const StringX &sx_title,
+                                       const StringX &sx_user,
+                                       const StringX &sx_pwd,
+                                       const StringX &sx_lastpwd,
+                                       const StringX &sx_notes,
+                                       const StringX &sx_url,
+                                       const StringX &sx_email,
+                                       const StringX& sx_totpauthcode,
+                                       const CustomFieldList *pcustomfields,
+                                       std::vector<size_t> &vactionverboffsets)
+{
+  const AutoType autotype(sx_in_autotype, sx_group, sx_title, sx_user, sx_pwd,
+                          sx_lastpwd, sx_notes, sx_url, sx_email, sx_totpauthcode,
+                          pcustomfields);
+  return autotype.GetString(vactionverboffsets);
+}
+
+StringX PWSAuxParse::GetAutoTypeString(const CItemData &ci,
+                                       const PWScore &core,
+                                       std::vector<size_t> &vactionverboffsets)
+{
+  return AutoType(ci, core).GetString(vactionverboffsets);
 }
 
 void PWSAuxParse::SendAutoTypeString(const StringX &sx_autotype,
@@ -15,11 +15,14 @@
 #define __PWSAUXPARSE_H
 
 #include "StringX.h"
+#include <functional>
+#include <memory>
 #include <vector>
 
 #define DEFAULT_AUTOTYPE _T("\\u\\t\\p\\n")
 
 class CItemData;
+class CKeySend;
 class CustomFieldList;
 class PWScore;
 
@@ -58,6 +61,54 @@ namespace PWSAuxParse {
   // as keystrokes:
   void SendAutoTypeString(const StringX &sx_autotype,
                           const std::vector<size_t> &vactionverboffsets);
+
+  class AutoTypeTemplate;
+
+  // What AutoType::Send types with: CKeySend's, as a test can fake them
+  class KeySender {
+  public:
+    virtual ~KeySender() {}
+    virtual void SendString(const StringX &data) = 0;
+    virtual void SendVirtualKey(WORD wVK, bool bAlt, bool bCtrl, bool bShift) = 0;
+    virtual void SetAndDelay(unsigned d) = 0;
+    virtual void SetOldSendMethod(bool bForceOldMethod) = 0;
+    virtual void SelectAll() = 0;
+    virtual void EmulateMods(bool emulate) = 0;
+  };
+
+  // An autotype string, ready to be sent. The template is compiled once
+  // and cached, and only the fields it refers to are fetched. Unlike
+  // GetAutoTypeString + SendAutoTypeString, field values are typed as they
+  // are, so there's no need to escape (and then unescape) their '\'.
+  class AutoType {
+  public:
+    AutoType(const CItemData &ci, const PWScore &core);
+    AutoType(const StringX &sxAutoCmd,
+             const StringX &sxgroup, const StringX &sxtitle,
+             const StringX &sxuser,
+             const StringX &sxpwd, const StringX &sxlastpwd,
+             const StringX &sxnotes, const StringX &sx_url,
+             const StringX &sx_email, const StringX &sx_totpauthcode,
+             const CustomFieldList *pcustomfields);
+
+    bool IsEmpty() const; // nothing to send
+    bool ForcesOldMethod() const; // \z
+    // As GetAutoTypeString
+    StringX GetString(std::vector<size_t> &vactionverboffsets) const;
+    void Send(CKeySend &ks) const;
+    void Send(KeySender &ks) const;
+
+  private:
+    void Init(const StringX &sx_autotype,
+              const std::function<StringX(int field)> &fieldValue,
+              const std::function<StringX(const StringX &name)> &customFieldValue);
+
+    std::shared_ptr<const AutoTypeTemplate> m_ptemplate;
+    std::vector<StringX> m_vValues; // per instruction, if a field
+  };
+
+  // Forgets the compiled autotype templates and parsed run commands
+  void ClearAutoTypeCache();
 }
 
 #endif /* __PWSAUXPARSE_H */
@@ -1397,7 +1397,7 @@ bool PWSFilterManager::PassesPWHFiltering(const CItemData *pci) const
   bool bValue(false);
   int iValue(0);
 
-  PWHistList pwhistlist(pci->GetPWHistory(), PWSUtil::TMC_EXPORT_IMPORT);
+  PWHistList pwhistlist(pci->GetPWHistoryList(PWSUtil::TMC_EXPORT_IMPORT));
 
   bPresent = pwhistlist.getMax() > 0 || !pwhistlist.empty();
 
@@ -10,9 +10,14 @@
 #include "Util.h"
 #include "StringXStream.h"
 
-using namespace std;
+#include <algorithm>
+#include <chrono>
+#include <cwchar>
+#include <functional>
+#include <iomanip>
+#include <thread>
 
-#define NUM_LOG_ENTRIES 256
+using namespace std;
 
 PWSLog *PWSLog::self = nullptr;
 
@@ -20,9 +25,6 @@ PWSLog *PWSLog::GetLog()
 {
   if (self == nullptr) {
     self = new PWSLog();
-    // The following sets the queue size once, avoiding
-    // memory management @ each call to Add(). (reference TBD)
-    self->m_log.resize(NUM_LOG_ENTRIES, _T(" "));
   }
   return self;
 }
@@ -33,38 +35,165 @@ void PWSLog::DeleteLog()
   self = nullptr;
 }
 
-void PWSLog::Add(const stringT &sLogRecord)
+PWSLog::Slot &PWSLog::Claim(const char *file, const char *function,
+                            const wchar_t *format, unsigned long long &seq)
+{
+  seq = m_next.fetch_add(1, memory_order_relaxed);
+  Slot &slot = m_slots[seq % NUM_LOG_ENTRIES];
+
+  // Mark the slot as being written before touching the event, so that a
+  // concurrent DumpLog skips it rather than reading a half-written one
+  slot.seq.store(0, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  Event &ev = slot.event;
+  ev.when = chrono::duration_cast<chrono::milliseconds>(
+              chrono::system_clock::now().time_since_epoch()).count();
+  ev.thread = static_cast<unsigned int>(hash<thread::id>()(this_thread::get_id()));
+  ev.file = file;
+  ev.function = function;
+  ev.format = format;
+  ev.nargs = 0;
+  ev.nchars = 0;
+  return slot;
+}
+
+void PWSLog::Publish(Slot &slot, unsigned long long seq)
+{
+  slot.seq.store(seq + 1, memory_order_release);
+}
+
+void PWSLog::Capture(Event &ev, const wchar_t *s)
+{
+  Event::Arg &arg = ev.args[ev.nargs++];
+  arg.type = Event::Arg::STRING;
+  arg.str.offset = ev.nchars;
+  arg.str.length = 0;
+  if (s == nullptr)
+    return;
+  const size_t room = MAX_ARG_CHARS - ev.nchars;
+  const size_t len = min(wcslen(s), room);
+  wmemcpy(ev.chars + ev.nchars, s, len);
+  arg.str.length = static_cast<unsigned short>(len);
+  ev.nchars = static_cast<unsigned short>(ev.nchars + len);
+}
+
+void PWSLog::Capture(Event &ev, const void *p)
+{
+  Event::Arg &arg = ev.args[ev.nargs++];
+  arg.type = Event::Arg::POINTER;
+  arg.p = p;
+}
+
+// Formats an event the way it would have been formatted when it was
+// logged: "timestamp thread file;\tfunction; <formatted arguments>"
+stringT PWSLog::Format(const Event &ev)
 {
-  static const stringT sb(_T(" "));
-  stringT sTimeStamp;
-  PWSUtil::GetTimeStamp(sTimeStamp);
+  const time_t secs = static_cast<time_t>(ev.when / 1000);
+  ostringstreamT os;
+  os << PWSUtil::ConvertToDateTimeString(secs, PWSUtil::TMC_EXPORT_IMPORT)
+     << TCHAR('.') << setw(3) << setfill(TCHAR('0')) << ev.when % 1000
+     << TCHAR(' ') << hex << setw(8) << ev.thread << dec << setfill(TCHAR(' '))
+     << TCHAR(' ')
+     << pws_os::Logit(PWS_LOGIT_HEADER, ev.file, ev.function);
+
+  // Each conversion in the format string consumes the next captured
+  // argument. Flags, width and precision are honoured; length modifiers
+  // are replaced by those matching the captured type.
+  unsigned iarg = 0;
+  for (const wchar_t *f = ev.format; *f != L'\0'; f++) {
+    if (*f != L'%') {
+      os << *f;
+      continue;
+    }
+    if (f[1] == L'%') {
+      os << L'%';
+      f++;
+      continue;
+    }
+
+    wstring spec(L"%");
+    const wchar_t *c = f + 1;
+    while (*c != L'\0' && wcschr(L"-+ #0123456789.", *c) != nullptr)
+      spec += *c++;
+    while (*c != L'\0' && wcschr(L"hlLjzt", *c) != nullptr)
+      c++;
+    if (*c == L'\0')
+      break;
+    const wchar_t conv = *c;
+    f = c;
+
+    if (iarg >= ev.nargs) {
+      os << L"(missing)";
+      continue;
+    }
+    const Event::Arg &arg = ev.args[iarg++];
+    if (arg.type == Event::Arg::STRING) {
+      os << wstring(ev.chars + arg.str.offset, arg.str.length);
+      continue;
+    }
 
-  // m_log preloaded, so pop_front is always valid (see GetLog).
-  m_log.pop_front();
-  m_log.push_back(sTimeStamp + sb + sLogRecord);
+    wchar_t buffer[64];
+    int n = -1;
+    const bool isIntConv = wcschr(L"diouxX", conv) != nullptr;
+    switch (arg.type) {
+      case Event::Arg::SIGNED:
+        spec += L"ll";
+        spec += isIntConv ? conv : L'd';
+        n = swprintf(buffer, NumberOf(buffer), spec.c_str(), arg.i);
+        break;
+      case Event::Arg::UNSIGNED:
+        spec += L"ll";
+        spec += isIntConv ? conv : L'u';
+        n = swprintf(buffer, NumberOf(buffer), spec.c_str(), arg.u);
+        break;
+      case Event::Arg::POINTER:
+        spec += L'p';
+        n = swprintf(buffer, NumberOf(buffer), spec.c_str(), arg.p);
+        break;
+      case Event::Arg::STRING:
+        break;
+    }
+    if (n >= 0)
+      os << buffer;
+  }
+
+  return os.str();
 }
 
 stringT PWSLog::DumpLog() const
 {
   const TCHAR *sHeader = _T("US04 ");
   ostringstreamT stLog;
+  vector<stringT> records;
+
+  // Newest first. A slot that's being (re)written while we look at it,
+  // i.e., whose sequence number isn't the expected one before and after
+  // copying it, is skipped.
+  const unsigned long long end = m_next.load(memory_order_acquire);
+  const unsigned long long begin = end > NUM_LOG_ENTRIES ? end - NUM_LOG_ENTRIES : 0;
+  for (unsigned long long seq = end; seq-- > begin; ) {
+    const Slot &slot = m_slots[seq % NUM_LOG_ENTRIES];
+    if (slot.seq.load(memory_order_acquire) != seq + 1)
+      continue;
+    const Event ev = slot.event;
+    atomic_thread_fence(memory_order_acquire);
+    if (slot.seq.load(memory_order_relaxed) != seq + 1)
+      continue;
+    records.push_back(Format(ev));
+  }
 
   // Start with header for Userstream
   stLog << sHeader;
 
   // Then total number of records
-  stLog << m_log.size() << _T(" ");
-
-  deque<stringT>::const_reverse_iterator criter;
-  deque<stringT>::const_reverse_iterator crend = m_log.rend();
+  stLog << records.size() << _T(" ");
 
   // Now add records - last first
-  for (criter = m_log.rbegin(); criter != crend; criter++) {
-    if (criter->length() > 1) {
-      // First add record length, then record
-      stLog << criter->length() << _T(" ");
-      stLog << criter->c_str() << _T(" ");
-    }
+  for (const auto &record : records) {
+    // First add record length, then record
+    stLog << record.length() << _T(" ");
+    stLog << record.c_str() << _T(" ");
   }
 
   return stLog.str();
@@ -9,39 +9,151 @@
 #ifndef _PWSLOG_H
 #define _PWSLOG_H
 
+/**
+ * PWSLog keeps the last NUM_LOG_ENTRIES log events in a fixed ring buffer,
+ * to be dumped (e.g., into a crash minidump) if something goes wrong.
+ *
+ * Adding an event just records where it came from, when, on which thread,
+ * and a copy of its arguments - no formatting, no allocation, no locks.
+ * Events are only turned into text by DumpLog().
+ *
+ * Log points above PWS_LOG_LEVEL compile to nothing. Build with
+ * -DPWS_LOG_LEVEL=PWS_LOG_LEVEL_ERROR to drop the function-entry traces,
+ * or PWS_LOG_LEVEL_OFF to drop logging altogether.
+ */
+
 #include "../os/typedefs.h"
 #include "../os/logit.h"
 
-#include <cassert>
-#include <deque>
+#include <atomic>
+#include <type_traits>
+
+#define PWS_LOG_LEVEL_OFF   0
+#define PWS_LOG_LEVEL_ERROR 1
+#define PWS_LOG_LEVEL_TRACE 2
 
-#define PWS_LOGIT_CONCAT(str) PWS_LOGIT_HEADER L ## str
+#ifndef PWS_LOG_LEVEL
+#define PWS_LOG_LEVEL PWS_LOG_LEVEL_TRACE
+#endif
+
+#define PWS_LOG_EVENT0(str) PWSLog::GetLog()->Add(__FILE__, __FUNCTION__, L ## str)
+#define PWS_LOG_EVENT(format_str, ...) PWSLog::GetLog()->Add(__FILE__, __FUNCTION__, \
+                                                             L ## format_str, __VA_ARGS__)
 
 // Now the actual logging macros
-#define PWS_LOGIT PWSLog::GetLog()->Add(pws_os::Logit(PWS_LOGIT_HEADER, __FILE__, __FUNCTION__))
-#define PWS_LOGIT_ARGS0(str) PWSLog::GetLog()->Add(pws_os::Logit(PWS_LOGIT_CONCAT(str), \
-                                                   __FILE__, __FUNCTION__))
-#define PWS_LOGIT_ARGS(format_str, ...) PWSLog::GetLog()->Add(pws_os::Logit(PWS_LOGIT_CONCAT(format_str), \
-                                                              __FILE__, __FUNCTION__, __VA_ARGS__))
+#if PWS_LOG_LEVEL >= PWS_LOG_LEVEL_TRACE
+#define PWS_LOGIT PWS_LOG_EVENT0("")
+#define PWS_LOGIT_ARGS0(str) PWS_LOG_EVENT0(str)
+#define PWS_LOGIT_ARGS(format_str, ...) PWS_LOG_EVENT(format_str, __VA_ARGS__)
+#else
+#define PWS_LOGIT do {} while (0)
+#define PWS_LOGIT_ARGS0(str) do {} while (0)
+#define PWS_LOGIT_ARGS(format_str, ...) do {} while (0)
+#endif
 
+#if PWS_LOG_LEVEL >= PWS_LOG_LEVEL_ERROR
+#define PWS_LOGERR_ARGS0(str) PWS_LOG_EVENT0(str)
+#define PWS_LOGERR_ARGS(format_str, ...) PWS_LOG_EVENT(format_str, __VA_ARGS__)
+#else
+#define PWS_LOGERR_ARGS0(str) do {} while (0)
+#define PWS_LOGERR_ARGS(format_str, ...) do {} while (0)
+#endif
 
 class PWSLog
 {
 public:
+  enum {NUM_LOG_ENTRIES = 256, MAX_ARGS = 4, MAX_ARG_CHARS = 64};
+
+  // One log point hit. file, function and format are string literals,
+  // so together they identify the log point. String arguments are
+  // copied (and truncated to fit) into chars.
+  struct Event {
+    struct Arg {
+      enum Type : unsigned char {SIGNED, UNSIGNED, POINTER, STRING} type;
+      union {
+        long long i;
+        unsigned long long u;
+        const void *p;
+        struct { unsigned short offset, length; } str;
+      };
+    };
+
+    long long when; // ms since the epoch
+    unsigned int thread;
+    const char *file;
+    const char *function;
+    const wchar_t *format;
+    unsigned char nargs;
+    unsigned short nchars;
+    Arg args[MAX_ARGS];
+    wchar_t chars[MAX_ARG_CHARS];
+  };
+
   virtual ~PWSLog() {}
 
   static PWSLog *GetLog(); // singleton
-  static void SetInstance(PWSLog *custom) { assert(self == nullptr); self = custom; }
   static void DeleteLog();
-  
-  virtual void Add(const stringT &sLogRecord);
+
+  template <typename... Args>
+  void Add(const char *file, const char *function, const wchar_t *format,
+           const Args &... args);
   stringT DumpLog() const;
 
 protected:
-  PWSLog() {}
+  PWSLog() : m_next(0) {}
+
 private:
+  struct Slot {
+    // 0 while empty or being written, else 1 + sequence number of event
+    std::atomic<unsigned long long> seq{0};
+    Event event;
+  };
+
+  // Claim() returns the slot for the next event, marked as being written,
+  // with the fixed fields filled in. Publish() makes it visible to DumpLog
+  Slot &Claim(const char *file, const char *function, const wchar_t *format,
+              unsigned long long &seq);
+  static void Publish(Slot &slot, unsigned long long seq);
+
+  static void Capture(Event &ev, const wchar_t *s);
+  static void Capture(Event &ev, const void *p);
+  template <typename T>
+  static typename std::enable_if<std::is_integral<T>::value ||
+                                 std::is_enum<T>::value>::type
+  Capture(Event &ev, T v);
+
+  static stringT Format(const Event &ev);
+
   static PWSLog *self;
-  std::deque<stringT> m_log;
+  std::atomic<unsigned long long> m_next;
+  Slot m_slots[NUM_LOG_ENTRIES];
 };
 
+template <typename... Args>
+void PWSLog::Add(const char *file, const char *function, const wchar_t *format,
+                 const Args &... args)
+{
+  static_assert(sizeof...(Args) <= MAX_ARGS, "Too many arguments for PWSLog event");
+  unsigned long long seq;
+  Slot &slot = Claim(file, function, format, seq);
+  const int dummy[] = {0, (Capture(slot.event, args), 0)...};
+  (void)dummy;
+  Publish(slot, seq);
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value ||
+                        std::is_enum<T>::value>::type
+PWSLog::Capture(Event &ev, T v)
+{
+  Event::Arg &arg = ev.args[ev.nargs++];
+  if (std::is_signed<T>::value) {
+    arg.type = Event::Arg::SIGNED;
+    arg.i = static_cast<long long>(v);
+  } else {
+    arg.type = Event::Arg::UNSIGNED;
+    arg.u = static_cast<unsigned long long>(v);
+  }
+}
+
 #endif /* _PWSLOG_H */
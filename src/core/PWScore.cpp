@@ -13,6 +13,7 @@
 #include "crypto/TwoFish.h"
 #include "PWSprefs.h"
 #include "PWHistory.h"
+#include "PWSAuxParse.h"
 #include "PWSLog.h"
 #include "PWSrand.h"
 #include "Util.h"
@@ -95,8 +96,6 @@ PWScore::PWScore() :
                      m_currfile(_T("")),
                      m_passkey(nullptr), m_passkey_len(0),
                      m_hashIters(MIN_HASH_ITERATIONS),
-                     m_lockFileHandle(INVALID_HANDLE_VALUE),
-                     m_lockFileHandle2(INVALID_HANDLE_VALUE),
                      m_ReadFileVersion(PWSfile::UNKNOWN_VERSION),
                      m_bIsReadOnly(false),
                      m_bNotifyDB(false),
@@ -116,6 +115,8 @@ PWScore::PWScore() :
   }
   m_undo_iter = m_redo_iter = m_vpcommands.end();
   m_undo_DBState_iter = m_redo_DBState_iter = m_vDBState.end();
+  m_UndoMemorySize = 0;
+  m_pTransaction = nullptr;
 }
 
 PWScore::~PWScore()
@@ -225,7 +226,7 @@ void PWScore::DoAddEntry(const CItemData &item, const CItemAtt *att)
     IncrementNumRecordsWithUnknownFields();
 
   if (item.IsNormal() && item.IsPolicyNameSet()) {
-    IncrementPasswordPolicy(item.GetPolicyName());
+    AddPolicyEntry(item.GetUUID(), item.GetPolicyName());
   }
 
   if (att != nullptr && att->HasContent()) {
@@ -351,7 +352,7 @@ void PWScore::DoDeleteEntry(const CItemData &item)
       DecrementNumRecordsWithUnknownFields();
 
     if (item.IsNormal() && item.IsPolicyNameSet()) {
-      DecrementPasswordPolicy(item.GetPolicyName());
+      RemovePolicyEntry(item.GetUUID(), item.GetPolicyName());
     }
 
     if (item.HasAttRef()) {
@@ -386,11 +387,11 @@ void PWScore::DoReplaceEntry(const CItemData &old_ci, const CItemData &new_ci)
   }
 
   if (old_ci.IsNormal() && old_ci.IsPolicyNameSet()) {
-    DecrementPasswordPolicy(old_ci.GetPolicyName());
+    RemovePolicyEntry(old_ci.GetUUID(), old_ci.GetPolicyName());
   }
 
   if (new_ci.IsNormal() && new_ci.IsPolicyNameSet()) {
-    IncrementPasswordPolicy(new_ci.GetPolicyName());
+    AddPolicyEntry(new_ci.GetUUID(), new_ci.GetPolicyName());
   }
 
   int ioldKBShortcut, inewKBShortcut;
@@ -461,11 +462,15 @@ void PWScore::ClearDBData()
   // Clear out policies
   m_MapPSWDPLC.clear();
   m_InitialMapPSWDPLC.clear();
+  m_PolicyEntries.clear();
 
   // Clear out Empty Groups
   m_vEmptyGroups.clear();
   m_InitialEmptyGroups.clear();
 
+  // Autotype templates and run commands may hold this database's data
+  PWSAuxParse::ClearAutoTypeCache();
+
   // Reset DB pre-command state to clean
   m_DBCurrentState = CLEAN;
 
@@ -858,6 +863,7 @@ void PWScore::ClearCommands()
     m_vpcommands.pop_back();
   }
   m_undo_iter = m_redo_iter = m_vpcommands.end();
+  m_UndoMemorySize = 0;
 
   // Clear DB states
   m_vDBState.clear();
@@ -894,6 +900,8 @@ int PWScore::Execute(Command *pcmd)
       IT IS THE RESPONSIBILTY OF THE UI TO ENSURE THAT A SINGLE USER ACTION GENERATES
       ONLY ONE CALL THIS ROUTINE. OTHERWISE MULTIPLE SAVES AND, POTENTIALLY, INTERMEDIATE
       BACKUPS MAY BE GENERATED.
+      An action made of several commands can run them through a Transaction
+      instead, and while one is open, calls to this routine join it.
 
     2. ALL COMMANDS UPDATE THE DATABASE (except UpdateGUICommand, which is
       always used in combination with a command that does) AND SO WILL GENERATE
@@ -901,6 +909,25 @@ int PWScore::Execute(Command *pcmd)
       the save immediate preference is set.
    */
 
+  if (m_pTransaction != nullptr)
+    return m_pTransaction->Execute(pcmd);
+
+  // Execute it
+  int rc = pcmd->Execute();
+
+  AddToUndoHistory(pcmd);
+
+  // If user has set Save Immediately, then Execute() changes the DB and it should be
+  // saved (with or without an intermediate backup)
+  NotifyDBModified();
+
+  // Then tell the UI update the GUI
+  NotifyGUINeedsUpdating(UpdateGUICommand::GUI_UPDATE_STATUSBAR, CUUID::NullUUID());
+  return rc;
+}
+
+void PWScore::AddToUndoHistory(Command *pcmd)
+{
    // If we have undone some previous commands, then this new command must
    // go on the end of the currently executed commands in the 
    // command chain and so we must delete any old commands
@@ -909,6 +936,7 @@ int PWScore::Execute(Command *pcmd)
     std::vector<Command *>::iterator cmd_Iter;
 
     for (cmd_Iter = m_redo_iter; cmd_Iter != m_vpcommands.end(); cmd_Iter++) {
+      m_UndoMemorySize -= std::min(m_UndoMemorySize, (*cmd_Iter)->GetMemorySize());
       delete (*cmd_Iter);
     }
 
@@ -921,12 +949,6 @@ int PWScore::Execute(Command *pcmd)
   // Put this command on the end of the command chain
   m_vpcommands.push_back(pcmd);
 
-  // And reset iterator to the end for undo/redo
-  m_undo_iter = m_redo_iter = m_vpcommands.end();
-
-  // Execute it
-  int rc = pcmd->Execute();
-
   // Save current before & after DB states
   // Note: commands should always change something but check
   DBStates cmdDBStates;
@@ -937,25 +959,52 @@ int PWScore::Execute(Command *pcmd)
   // Set current state
   m_DBCurrentState = cmdDBStates.after;
 
-  // And reset iterator to the end for undo/redo
+  // And reset iterators to the end for undo/redo
+  m_undo_iter = m_redo_iter = m_vpcommands.end();
   m_undo_DBState_iter = m_redo_DBState_iter = m_vDBState.end();
 
   // Set undo iterator to this one
   m_undo_iter--;
   m_undo_DBState_iter--;
 
-  // If user has set Save Immediately, then Execute() changes the DB and it should be
-  // saved (with or without an intermediate backup)
-  NotifyDBModified();
+  m_UndoMemorySize += pcmd->GetMemorySize();
+  LimitUndoHistory();
+}
 
-  // Then tell the UI update the GUI
-  NotifyGUINeedsUpdating(UpdateGUICommand::GUI_UPDATE_STATUSBAR, CUUID::NullUUID());
-  return rc;
+void PWScore::LimitUndoHistory()
+{
+  // Only called by AddToUndoHistory, i.e., with nothing to redo. The command just
+  // executed is always kept, however big.
+  ASSERT(m_redo_iter == m_vpcommands.end());
+  const PWSprefs *prefs = PWSprefs::GetInstance();
+  const size_t maxSteps = prefs->GetPref(PWSprefs::MaxUndoSteps);
+  const size_t maxMemory = size_t(prefs->GetPref(PWSprefs::MaxUndoMemory)) * 1024 * 1024;
+
+  size_t nevicted = 0;
+  while (nevicted + 1 < m_vpcommands.size() &&
+         ((maxSteps != 0 && m_vpcommands.size() - nevicted > maxSteps) ||
+          (maxMemory != 0 && m_UndoMemorySize > maxMemory))) {
+    Command *pcmd = m_vpcommands[nevicted++];
+    m_UndoMemorySize -= std::min(m_UndoMemorySize, pcmd->GetMemorySize());
+    delete pcmd;
+  }
+
+  if (nevicted == 0)
+    return;
+
+  m_vpcommands.erase(m_vpcommands.begin(), m_vpcommands.begin() + nevicted);
+  m_vDBState.erase(m_vDBState.begin(), m_vDBState.begin() + nevicted);
+
+  m_undo_iter = m_redo_iter = m_vpcommands.end();
+  m_undo_DBState_iter = m_redo_DBState_iter = m_vDBState.end();
+  m_undo_iter--;
+  m_undo_DBState_iter--;
 }
 
 void PWScore::Undo()
 {
   // Undo last executed command
+  ASSERT(m_pTransaction == nullptr);
   ASSERT(m_undo_iter != m_vpcommands.end());
 
   // Reset next command to redo (i.e., the one we just about to undo)
@@ -988,6 +1037,7 @@ void PWScore::Undo()
 void PWScore::Redo()
 {
   // Redo last undone command
+  ASSERT(m_pTransaction == nullptr);
   ASSERT(m_redo_iter != m_vpcommands.end());
 
   // Reset next command to undo (i.e. the one we just about to redo)
@@ -1028,12 +1078,93 @@ Command * PWScore::GetUndoCommand()
 
 bool PWScore::AnyToUndo() const
 {
-  return (m_undo_iter != m_vpcommands.end());
+  return (m_pTransaction == nullptr && m_undo_iter != m_vpcommands.end());
 }
 
 bool PWScore::AnyToRedo() const
 {
-  return (m_redo_iter != m_vpcommands.end());
+  return (m_pTransaction == nullptr && m_redo_iter != m_vpcommands.end());
+}
+
+PWScore::Transaction::Transaction(PWScore &core)
+  : m_core(core), m_pmulticmds(MultiCommands::Create(&core))
+{
+  ASSERT(m_core.m_pTransaction == nullptr);
+  m_core.m_pTransaction = this;
+}
+
+PWScore::Transaction::~Transaction()
+{
+  if (IsOpen())
+    Rollback();
+}
+
+int PWScore::Transaction::Execute(Command *pcmd)
+{
+  ASSERT(IsOpen());
+  return m_pmulticmds->AddAndExecute(pcmd);
+}
+
+void PWScore::Transaction::Commit()
+{
+  ASSERT(IsOpen());
+  m_core.m_pTransaction = nullptr;
+
+  if (m_pmulticmds->IsEmpty()) {
+    delete m_pmulticmds;
+    m_pmulticmds = nullptr;
+    return;
+  }
+
+  m_core.AddToUndoHistory(m_pmulticmds);
+  m_pmulticmds = nullptr;
+
+  m_core.NotifyDBModified();
+
+  // Coalesce the updates: the refreshes only depend on the final state of
+  // what they refresh, so only the last of identical ones is kept, whereas
+  // additions and deletions are all sent, in order.
+  std::vector<GUIUpdate> vUpdates;
+  vUpdates.swap(m_core.m_vGUIUpdates);
+  vUpdates.emplace_back(UpdateGUICommand::GUI_UPDATE_STATUSBAR, CUUID::NullUUID(),
+                        CItemData::START);
+
+  std::vector<GUIUpdate> vBatch;
+  vBatch.reserve(vUpdates.size());
+  for (auto iter = vUpdates.begin(); iter != vUpdates.end(); iter++) {
+    switch (iter->ga) {
+      case UpdateGUICommand::GUI_ADD_ENTRY:
+      case UpdateGUICommand::GUI_DELETE_ENTRY:
+      case UpdateGUICommand::GUI_REDO_IMPORT:
+      case UpdateGUICommand::GUI_UNDO_IMPORT:
+      case UpdateGUICommand::GUI_REDO_MERGESYNC:
+      case UpdateGUICommand::GUI_UNDO_MERGESYNC:
+        vBatch.push_back(*iter);
+        break;
+      default:
+        if (std::find(iter + 1, vUpdates.end(), *iter) == vUpdates.end())
+          vBatch.push_back(*iter);
+        break;
+    }
+  }
+
+  for (auto &observer : m_core.m_Observers) {
+    observer->UpdateGUIBatch(vBatch);
+  }
+}
+
+void PWScore::Transaction::Rollback()
+{
+  ASSERT(IsOpen());
+  // Still open while undoing, so that the commands' GUI updates are held
+  // back with the others and then dropped: the observers never saw any
+  // of the changes.
+  m_pmulticmds->Undo();
+  delete m_pmulticmds;
+  m_pmulticmds = nullptr;
+
+  m_core.m_pTransaction = nullptr;
+  m_core.m_vGUIUpdates.clear();
 }
 
 int PWScore::CheckPasskey(const StringX &filename, const StringX &passkey)
@@ -1120,7 +1251,8 @@ static void ProcessPasswordPolicy(CItemData &ci_temp, PWScore &core)
   }
 
   if (ci_temp.IsPolicyNameSet()) {
-    if (!core.IncrementPasswordPolicy(ci_temp.GetPolicyName())) {
+    PWPolicy st_pp;
+    if (!core.GetPolicyFromName(ci_temp.GetPolicyName(), st_pp)) {
       // Map name not present in database - clear it!
       ci_temp.ClearField(CItemData::POLICYNAME);
     }
@@ -1152,11 +1284,10 @@ void PWScore::ProcessReadEntry(CItemData &ci_temp,
   } // non-zero shortcut
 
   // Possibly expired?
-  time_t tttXTime;
-  ci_temp.GetXTime(tttXTime);
-  if (tttXTime != time_t(0)) {
-    m_ExpireCandidates.push_back(ExpPWEntry(ci_temp));
-  }
+  m_ExpireCandidates.Add(ci_temp);
+
+  if (ci_temp.IsNormal() && ci_temp.IsPolicyNameSet())
+    AddPolicyEntry(ci_temp.GetUUID(), ci_temp.GetPolicyName());
 
   // Finally, add it to the list!
   m_pwlist.insert(std::make_pair(ci_temp.GetUUID(), ci_temp));
@@ -1205,7 +1336,7 @@ static void ReportReadErrors(CReport *pRpt,
 
 int PWScore::ReadFile(const StringX &a_filename, const StringX &a_passkey,
                       const bool bValidate, const size_t iMAXCHARS,
-                      CReport *pRpt)
+                      CReport *pRpt, const ReadProgressFn &progress)
 {
   PWS_LOGIT_ARGS("bValidate=%ls; iMAXCHARS=%d; pRpt=%p",
                  bValidate ? L"true" : L"false", iMAXCHARS,
@@ -1311,7 +1442,18 @@ int PWScore::ReadFile(const StringX &a_filename, const StringX &a_passkey,
     pRpt->StartReport(IDSC_RPTVALIDATE, m_currfile.c_str());
   }
 
+  size_t numRead = 0;
+
   do {
+    if (progress && (numRead++ % PROGRESS_INTERVAL) == 0 &&
+        !progress(ulong64(in->GetOffset()), in->GetFileLength())) {
+      in->Close();
+      delete in;
+      ClearDBData();
+      if (pRpt != nullptr)
+        pRpt->EndReport();
+      return USER_CANCEL;
+    }
     ci_temp.Clear(); // Rather than creating a new one each time.
     status = in->ReadRecord(ci_temp);
     switch (status) {
@@ -1891,6 +2033,76 @@ bool PWScore::GetPolicyFromName(const StringX &sxPolicyName, PWPolicy &st_pp) co
   }
 }
 
+int PWScore::RotatePasswords(const UUIDVector &entries, const StringX &sxPolicyName,
+                             size_t &numRotated)
+{
+  numRotated = 0;
+
+  if (m_bIsReadOnly)
+    return FAILURE;
+
+  StringX sxDefPolicyStr;
+  LoadAString(sxDefPolicyStr, IDSC_DEFAULT_POLICY);
+
+  PWPolicy named_pwp;
+  if (!sxPolicyName.empty() && !GetPolicyFromName(sxPolicyName, named_pwp))
+    return FAILURE;
+
+  // Bucket the entries by the policy their new password is made with, so that
+  // each distinct policy's passwords are generated in a single batch.
+  // Typically there's just one or a handful of distinct policies.
+  std::vector<std::pair<PWPolicy, std::vector<CItemData *>>> buckets;
+  std::set<pws_os::CUUID> seen;
+
+  for (const auto &uuid : entries) {
+    ItemListIter iter = m_pwlist.find(uuid);
+    if (iter == m_pwlist.end() || iter->second.IsDependent() ||
+        !seen.insert(uuid).second)
+      continue;
+
+    CItemData &ci = iter->second;
+    PWPolicy pwp;
+    if (!sxPolicyName.empty()) {
+      pwp = named_pwp;
+    } else if (ci.IsPolicyNameSet() && GetPolicyFromName(ci.GetPolicyName(), pwp)) {
+      // pwp set from entry's named policy
+    } else if (ci.IsPasswordPolicySet()) {
+      ci.GetPWPolicy(pwp);
+    } else {
+      GetPolicyFromName(sxDefPolicyStr, pwp);
+    }
+
+    auto bucket = std::find_if(buckets.begin(), buckets.end(),
+                               [&pwp](const std::pair<PWPolicy, std::vector<CItemData *>> &b)
+                               {return b.first == pwp;});
+    if (bucket == buckets.end()) {
+      buckets.emplace_back(pwp, std::vector<CItemData *>());
+      bucket = buckets.end() - 1;
+    }
+    bucket->second.push_back(&ci);
+  }
+
+  if (buckets.empty())
+    return SUCCESS;
+
+  // Individual commands don't notify the GUI - a single tree refresh is done
+  // once all the passwords have been changed (MultiCommands::Undo does the same)
+  MultiCommands *pmulticmds = MultiCommands::Create(this);
+  for (auto &bucket : buckets) {
+    std::vector<StringX> passwords = bucket.first.MakeRandomPasswords(bucket.second.size());
+    for (size_t i = 0; i < passwords.size(); i++) {
+      Command *pcmd = UpdatePasswordCommand::Create(this, *bucket.second[i], passwords[i]);
+      pcmd->SetNoGUINotify();
+      pmulticmds->Add(pcmd);
+    }
+    numRotated += passwords.size();
+  }
+  pmulticmds->Add(UpdateGUICommand::Create(this, UpdateGUICommand::WN_EXECUTE_REDO,
+                                           UpdateGUICommand::GUI_REFRESH_TREE));
+
+  return Execute(pmulticmds);
+}
+
 class PolicyNameMatch
 {
 public:
@@ -1941,36 +2153,18 @@ void PWScore::MakePolicyUnique(std::map<StringX, StringX> &mapRenamedPolicies,
   return;
 }
 
-// functor object type for for_each:
-// Updates vector with entries using named password policy
-struct AddEntry {
-  AddEntry(const AddEntry&) = default;
-  AddEntry(const StringX sxPolicyName, std::vector<st_GroupTitleUser> &ventries)
-    : m_sxPolicyName(sxPolicyName), m_pventries(&ventries) {}
-
-  void operator()(std::pair<CUUID const, CItemData> &p)
-  {
-    if (p.second.GetPolicyName() == m_sxPolicyName) {
-      st_GroupTitleUser st;
-      st.group = p.second.GetGroup();
-      st.title = p.second.GetTitle();
-      st.user = p.second.GetUser();
-      m_pventries->push_back(st);
-      return;
-    }
-  }
-
-private:
-  AddEntry& operator=(const AddEntry&) = delete; // Do not implement
-  StringX m_sxPolicyName;
-  std::vector<st_GroupTitleUser> *m_pventries;
-};
-
 bool PWScore::GetEntriesUsingNamedPasswordPolicy(const StringX sxPolicyName,
               std::vector<st_GroupTitleUser> &ventries)
 {
-  AddEntry add_entry(sxPolicyName, ventries);
-  std::for_each(m_pwlist.begin(), m_pwlist.end(), add_entry);
+  for (const CUUID &uuid : GetEntriesUsingPolicy(sxPolicyName)) {
+    ItemListConstIter citer = m_pwlist.find(uuid);
+    if (citer == m_pwlist.end()) {
+      ASSERT(0); // Index out of step with the entries
+      continue;
+    }
+    const CItemData &ci = citer->second;
+    ventries.push_back(st_GroupTitleUser(ci.GetGroup(), ci.GetTitle(), ci.GetUser()));
+  }
 
   // Sort them before displayed in the dialog later
   std::sort(ventries.begin(), ventries.end(), GTUCompareV1);
@@ -1978,6 +2172,78 @@ bool PWScore::GetEntriesUsingNamedPasswordPolicy(const StringX sxPolicyName,
   return !ventries.empty();
 }
 
+const UUIDSet &PWScore::GetEntriesUsingPolicy(const StringX &sxPolicyName) const
+{
+  static const UUIDSet empty;
+  const auto iter = m_PolicyEntries.find(sxPolicyName);
+  return iter != m_PolicyEntries.end() ? iter->second : empty;
+}
+
+Command *PWScore::ReassignPasswordPolicy(const StringX &sxOldPolicyName,
+                                         const StringX &sxNewPolicyName)
+{
+  const UUIDSet &entries = GetEntriesUsingPolicy(sxOldPolicyName);
+  if (entries.empty() || sxOldPolicyName == sxNewPolicyName)
+    return nullptr;
+
+  MultiCommands *pmulticmds = MultiCommands::Create(this);
+  for (const CUUID &uuid : entries) {
+    ItemListConstIter citer = m_pwlist.find(uuid);
+    if (citer == m_pwlist.end()) {
+      ASSERT(0); // Index out of step with the entries
+      continue;
+    }
+    pmulticmds->Add(UpdateEntryCommand::Create(this, citer->second,
+                                               CItemData::POLICYNAME, sxNewPolicyName));
+  }
+  if (pmulticmds->IsEmpty()) {
+    delete pmulticmds;
+    return nullptr;
+  }
+  return pmulticmds;
+}
+
+void PWScore::AddPolicyEntry(const CUUID &uuid, const StringX &sxPolicyName)
+{
+  if (!m_PolicyEntries[sxPolicyName].insert(uuid).second)
+    return;
+
+  auto iter = m_MapPSWDPLC.find(sxPolicyName);
+  if (iter != m_MapPSWDPLC.end())
+    iter->second.usecount++;
+}
+
+void PWScore::RemovePolicyEntry(const CUUID &uuid, const StringX &sxPolicyName)
+{
+  auto eiter = m_PolicyEntries.find(sxPolicyName);
+  if (eiter == m_PolicyEntries.end() || eiter->second.erase(uuid) == 0)
+    return;
+  if (eiter->second.empty())
+    m_PolicyEntries.erase(eiter);
+
+  auto iter = m_MapPSWDPLC.find(sxPolicyName);
+  if (iter != m_MapPSWDPLC.end() && iter->second.usecount > 0)
+    iter->second.usecount--;
+}
+
+void PWScore::UpdatePolicyEntry(const CUUID &uuid, const StringX &sxOldPolicyName,
+                                const StringX &sxNewPolicyName)
+{
+  if (!sxOldPolicyName.empty())
+    RemovePolicyEntry(uuid, sxOldPolicyName);
+  if (!sxNewPolicyName.empty())
+    AddPolicyEntry(uuid, sxNewPolicyName);
+}
+
+void PWScore::UpdatePolicyUseCounts()
+{
+  // Policies set as a whole (e.g., from the policies dialog) come with
+  // whatever usecount they had when copied
+  for (auto &policy : m_MapPSWDPLC) {
+    policy.second.usecount = GetEntriesUsingPolicy(policy.first).size();
+  }
+}
+
 void PWScore::ParseDependants()
 {
   UUIDVector Possible_Aliases, Possible_Shortcuts;
@@ -2089,19 +2355,21 @@ bool PWScore::InitialiseGTU(GTUSet &setGTU, const StringX &sxPolicyName)
   if (sxPolicyName.empty())
     return false;
 
-  // Populate the set of all group/title/user entries
+  // Populate the set of group/title/user of the entries using the policy
   GTUSetPair pr_gtu;
-  ItemListConstIter citer;
 
-  for (citer = m_pwlist.begin(); citer != m_pwlist.end(); citer++) {
+  for (const CUUID &uuid : GetEntriesUsingPolicy(sxPolicyName)) {
+    ItemListConstIter citer = m_pwlist.find(uuid);
+    if (citer == m_pwlist.end()) {
+      ASSERT(0); // Index out of step with the entries
+      continue;
+    }
     const CItemData &ci = citer->second;
-    if (ci.GetPolicyName() == sxPolicyName) {
-      pr_gtu = setGTU.insert(st_GroupTitleUser(ci.GetGroup(), ci.GetTitle(), ci.GetUser()));
-      if (!pr_gtu.second) {
-        // Could happen if merging or synching a bad database!
-        setGTU.clear();
-        return false;
-      }
+    pr_gtu = setGTU.insert(st_GroupTitleUser(ci.GetGroup(), ci.GetTitle(), ci.GetUser()));
+    if (!pr_gtu.second) {
+      // Could happen if merging or synching a bad database!
+      setGTU.clear();
+      return false;
     }
   }
   return true;
@@ -2407,6 +2675,8 @@ int PWScore::DoAddDependentEntries(UUIDVector &dependentlist, CReport *pRpt,
             // Invalid - delete!
             if (pmapDeletedItems != nullptr)
               pmapDeletedItems->insert(ItemList_Pair(*paiter, *pci_curitem));
+            if (iter->second.IsNormal() && iter->second.IsPolicyNameSet())
+              RemovePolicyEntry(iter->first, iter->second.GetPolicyName());
             m_pwlist.erase(iter);
             continue;
           }
@@ -2431,6 +2701,8 @@ int PWScore::DoAddDependentEntries(UUIDVector &dependentlist, CReport *pRpt,
             // Invalid - delete!
             if (pmapDeletedItems != nullptr)
               pmapDeletedItems->insert(ItemList_Pair(*paiter, *pci_curitem));
+            if (iter->second.IsNormal() && iter->second.IsPolicyNameSet())
+              RemovePolicyEntry(iter->first, iter->second.GetPolicyName());
             m_pwlist.erase(iter);
             continue;
           }
@@ -2540,6 +2812,9 @@ void PWScore::UndoAddDependentEntries(ItemList *pmapDeletedItems,
        add_iter != pmapDeletedItems->end();
        add_iter++) {
     m_pwlist[add_iter->first] = add_iter->second;
+    const CItemData &ci = add_iter->second;
+    if (ci.IsNormal() && ci.IsPolicyNameSet())
+      AddPolicyEntry(add_iter->first, ci.GetPolicyName());
   }
 
   for (restore_iter = pmapSaveTypePW->begin();
@@ -2551,9 +2826,18 @@ void PWScore::UndoAddDependentEntries(ItemList *pmapDeletedItems,
 
     CItemData *pci_changeditem = &iter->second;
     st_SaveTypePW *pst_typepw = &restore_iter->second;
+    const bool bWasNormal = pci_changeditem->IsNormal();
     pci_changeditem->SetEntryType(pst_typepw->et);
     if (!pst_typepw->sxpw.empty())
       pci_changeditem->SetPassword(pst_typepw->sxpw);
+
+    // Only normal entries are in the policy index
+    if (pci_changeditem->IsPolicyNameSet() && bWasNormal != pci_changeditem->IsNormal()) {
+      if (bWasNormal)
+        RemovePolicyEntry(iter->first, pci_changeditem->GetPolicyName());
+      else
+        AddPolicyEntry(iter->first, pci_changeditem->GetPolicyName());
+    }
   }
 }
 
@@ -2665,7 +2949,7 @@ void PWScore::NotifyDBModified()
   // This allows the core to provide feedback to the UI that the Database
   // has changed particularly to invalidate any current Find results and
   // to populate message during Vista and later shutdowns
-  if (m_bNotifyDB) {
+  if (m_bNotifyDB && m_pTransaction == nullptr) {
     for(auto& observer : m_Observers) {
       observer->DatabaseModified(HasDBChanged());
     }
@@ -2678,6 +2962,10 @@ void PWScore::NotifyGUINeedsUpdating(UpdateGUICommand::GUI_Action ga,
 {
   // This allows the core to provide feedback to the UI that the GUI needs
   // updating due to a field having its value changed
+  if (m_pTransaction != nullptr) {
+    m_vGUIUpdates.emplace_back(ga, entry_uuid, ft);
+    return;
+  }
   for(auto& observer : m_Observers) {
     observer->UpdateGUI(ga, entry_uuid, ft);
   }
@@ -2688,6 +2976,10 @@ void PWScore::NotifyGUINeedsUpdating(UpdateGUICommand::GUI_Action ga,
 {
   // This allows the core to provide feedback to the UI that the GUI needs
   // updating due to a field having its value changed
+  if (m_pTransaction != nullptr) {
+    m_vGUIUpdates.emplace_back(ga, vGroups);
+    return;
+  }
   for(auto& observer : m_Observers) {
     observer->UpdateGUI(ga, vGroups);
   }
@@ -2721,8 +3013,12 @@ void PWScore::UpdateWizard(const stringT &s)
 
 bool PWScore::LockFile(const stringT &filename, stringT &locker)
 {
-  return pws_os::LockFile(filename, locker,
-                          m_lockFileHandle);
+  ASSERT(m_lockFileHandles.find(filename) == m_lockFileHandles.end());
+  HANDLE lockFileHandle = INVALID_HANDLE_VALUE;
+  if (!pws_os::LockFile(filename, locker, lockFileHandle))
+    return false;
+  m_lockFileHandles[filename] = lockFileHandle;
+  return true;
 }
 
 bool PWScore::IsLockedFile(const stringT &filename) const
@@ -2732,7 +3028,13 @@ bool PWScore::IsLockedFile(const stringT &filename) const
 
 void PWScore::UnlockFile(const stringT &filename)
 {
-  return pws_os::UnlockFile(filename, m_lockFileHandle);
+  HANDLE lockFileHandle = INVALID_HANDLE_VALUE;
+  auto iter = m_lockFileHandles.find(filename);
+  if (iter != m_lockFileHandles.end()) {
+    lockFileHandle = iter->second;
+    m_lockFileHandles.erase(iter);
+  }
+  pws_os::UnlockFile(filename, lockFileHandle);
 }
 
 void PWScore::SafeUnlockCurFile()
@@ -2743,22 +3045,15 @@ void PWScore::SafeUnlockCurFile()
 
 void PWScore::SafeUnlockFile(const stringT &filename)
 {
-  // The only way we're the locker is if it's locked & we're !readonly
-  if (!filename.empty() && !IsReadOnly() && IsLockedFile(filename))
+  // The only way we're the locker is if we locked it, or if it's locked
+  // & we're !readonly
+  if (filename.empty())
+    return;
+  if (m_lockFileHandles.find(filename) != m_lockFileHandles.end() ||
+      (!IsReadOnly() && IsLockedFile(filename)))
     UnlockFile(filename);
 }
 
-bool PWScore::LockFile2(const stringT &filename, stringT &locker)
-{
-  return pws_os::LockFile(filename, locker,
-                          m_lockFileHandle2);
-}
-
-void PWScore::UnlockFile2(const stringT &filename)
-{
-  return pws_os::UnlockFile(filename, m_lockFileHandle2);
-}
-
 bool PWScore::IsNodeModified(StringX &path) const
 {
   if (!IsEmptyGroup(path)) {
@@ -3180,20 +3475,13 @@ int PWScore::SetHeaderItem(const StringX &sxNewValue, PWSfile::HeaderType ht)
 void PWScore::UpdateExpiryEntry(const CUUID &uuid, const CItemData::FieldType ft,
                                 const StringX &value)
 {
-  ExpiredList::iterator iter;
-
-  iter = std::find_if(m_ExpireCandidates.begin(), m_ExpireCandidates.end(),
-                      [uuid](pws_os::CUUID v){return v == uuid;});
-  if (iter == m_ExpireCandidates.end())
-    return;
-
   if (ft == CItemData::XTIME) {
     time_t t;
     if ((VerifyImportDateTimeString(value.c_str(), t) ||
          VerifyXMLDateTimeString(value.c_str(), t)    ||
          VerifyASCDateTimeString(value.c_str(), t))   &&
          (t != time_t(-1))) {  // checkerror despite all our verification!
-      iter->expirytttXTime = t;
+      m_ExpireCandidates.Update(uuid, t);
     } else {
       ASSERT(0);
     }
@@ -3223,15 +3511,15 @@ bool PWScore::ChangeMode(stringT &locker, int &iErrorCode)
       // OK - still exists but is R-O - can't change mode!
       // Need new return code but not this close to release - later
       iErrorCode = READ_FAIL;
-      PWS_LOGIT_ARGS0("Failed: READ_FAIL");
+      PWS_LOGERR_ARGS0("Failed: READ_FAIL");
       return false;
     }
 
     // OK, we have write access, let's lock it
-    bool brc = pws_os::LockFile(m_currfile.c_str(), locker, m_lockFileHandle);
+    bool brc = LockFile(m_currfile.c_str(), locker);
     if (!brc) {
       iErrorCode = CANT_GET_LOCK;
-      PWS_LOGIT_ARGS0("Failed: CANT_GET_LOCK");
+      PWS_LOGERR_ARGS0("Failed: CANT_GET_LOCK");
       return false;
     }
 
@@ -3249,13 +3537,13 @@ bool PWScore::ChangeMode(stringT &locker, int &iErrorCode)
       iErrorCode = newFileSig.GetErrorCode();
     }
     if (iErrorCode != 0) {
-      pws_os::UnlockFile(m_currfile.c_str(), m_lockFileHandle);
-      PWS_LOGIT_ARGS("Failed code: %d", iErrorCode);
+      UnlockFile(m_currfile.c_str());
+      PWS_LOGERR_ARGS("Failed code: %d", iErrorCode);
       return false;
     }
   } else { // In R/W mode - switch to R-O
     // Unlock file
-    pws_os::UnlockFile(m_currfile.c_str(), m_lockFileHandle);
+    UnlockFile(m_currfile.c_str());
   }
 
   // Swap Read/Write : Read/Only status
@@ -3289,6 +3577,7 @@ bool PWScore::SetPasswordPolicies(const PSWDPolicyMap &MapPSWDPLC)
     m_MapPSWDPLC = MapPSWDPLC;
     brc = true;
   }
+  UpdatePolicyUseCounts();
   return brc;
 }
 
@@ -3302,28 +3591,6 @@ bool PWScore::SetDBFilters(const PWSFilters &MapDBFilters)
   return brc;
 }
 
-bool PWScore::IncrementPasswordPolicy(const StringX &sxPolicyName)
-{
-  auto iter = m_MapPSWDPLC.find(sxPolicyName);
-  if (iter == m_MapPSWDPLC.end()) {
-    return false;
-  } else {
-    iter->second.usecount++;
-    return true;
-  }
-}
-
-bool PWScore::DecrementPasswordPolicy(const StringX &sxPolicyName)
-{
-  auto iter = m_MapPSWDPLC.find(sxPolicyName);
-  if (iter == m_MapPSWDPLC.end() || iter->second.usecount == 0) {
-    return false;
-  } else {
-    iter->second.usecount--;
-    return true;
-  }
-}
-
 bool PWScore::AddPolicy(const StringX &sxPolicyName, const PWPolicy &st_pp,
                         const bool bAllowReplace)
 {
@@ -3338,6 +3605,7 @@ bool PWScore::AddPolicy(const StringX &sxPolicyName, const PWPolicy &st_pp,
   }
   if (bDoIt) {
     m_MapPSWDPLC[sxPolicyName] = st_pp;
+    m_MapPSWDPLC[sxPolicyName].usecount = GetEntriesUsingPolicy(sxPolicyName).size();
   }
   return bDoIt;
 }
@@ -25,6 +25,8 @@
 
 #include "coredefs.h"
 
+#include <functional>
+
 // Parameter list for ParseAliasPassword
 struct BaseEntryParms {
   // All fields except "InputType" are 'output'.
@@ -149,6 +151,8 @@ public:
   static void SetAsker(Asker *pAsker) {m_pAsker = pAsker;}
   static bool IsAskerSet() {return m_pAsker != nullptr;}
   static bool IsReporterSet() {return m_pReporter != nullptr;}
+  static Asker *GetAsker() {return m_pAsker;}
+  static Reporter *GetReporter() {return m_pReporter;}
 
   // Get/Set File UUIDs
   void ClearFileUUID() { m_hdr.m_file_uuid = pws_os::CUUID::NullUUID(); }
@@ -176,12 +180,19 @@ public:
   StringX GetCurFile() const {return m_currfile;}
   void SetCurFile(const StringX &file) {m_currfile = file;}
 
+  // Called now and then while the records are read, with the number of
+  // bytes read so far and the file's size. Returning false cancels the
+  // read, which then returns USER_CANCEL with the database cleared.
+  // Called on whichever thread runs ReadFile.
+  typedef std::function<bool(ulong64 bytesRead, ulong64 fileLength)> ReadProgressFn;
+
   int ReadCurFile(const StringX &passkey, const bool bValidate = false,
-                  const size_t iMAXCHARS = 0, CReport *pRpt = nullptr)
-  {return ReadFile(m_currfile, passkey, bValidate, iMAXCHARS, pRpt);}
+                  const size_t iMAXCHARS = 0, CReport *pRpt = nullptr,
+                  const ReadProgressFn &progress = nullptr)
+  {return ReadFile(m_currfile, passkey, bValidate, iMAXCHARS, pRpt, progress);}
   int ReadFile(const StringX &filename, const StringX &passkey,
                const bool bValidate = false, const size_t iMAXCHARS = 0,
-               CReport *pRpt = nullptr);
+               CReport *pRpt = nullptr, const ReadProgressFn &progress = nullptr);
   PWSfile::VERSION GetReadFileVersion() const {return m_ReadFileVersion;}
   bool BackupCurFile(unsigned int maxNumIncBackups, int backupSuffix,
                      const stringT &userBackupPrefix,
@@ -223,7 +234,7 @@ public:
                const int &subgroup_object, const int &subgroup_function,
                CompareData &list_OnlyInCurrent, CompareData &list_OnlyInComp,
                CompareData &list_Conflicts, CompareData &list_Identical,
-               bool *pbCancel = nullptr);
+               bool *pbCancel = nullptr, const bool bWithGTU = true);
 
   stringT Merge(PWScore *pothercore,
                 const bool &subgroup_bset,
@@ -237,6 +248,29 @@ public:
                    const int &subgroup_object, const int &subgroup_function,
                    int &numUpdated, CReport *pRpt, bool *pbCancel = nullptr);
 
+  // Where a synchronize is: matching the other database's entries against
+  // ours, then sorting the names of the updated ones for the report.
+  struct SyncProgress {
+    enum Phase {MATCHING, REPORTING};
+    Phase phase;
+    size_t done, total;
+  };
+  // Returning false cancels the synchronize, as *pbCancel does.
+  // Called on whichever thread runs PrepareSynchronize.
+  typedef std::function<bool(const SyncProgress &progress)> SyncProgressFn;
+
+  // The part of Synchronize that doesn't change this core, so that it can
+  // run on a worker thread: returns the commands that make the whole
+  // change, with one GUI update around them, for the caller to Execute.
+  // vs_updated gets the sorted '«g» «t» «u»' of the entries to be updated.
+  // Returns nullptr if cancelled.
+  MultiCommands *PrepareSynchronize(const PWScore *pothercore,
+                                    const CItemData::FieldBits &bsFields, const bool &subgroup_bset,
+                                    const stringT &subgroup_name,
+                                    const int &subgroup_object, const int &subgroup_function,
+                                    std::vector<StringX> &vs_updated, bool *pbCancel = nullptr,
+                                    const SyncProgressFn &progress = nullptr);
+
   // helper function to Sync a single item, returns true if dstItem was updated.
   // Adds ProcessPolicyName command to multiCommand if a password policy was updated.
   bool SyncItem(const CItemData& srcItem, CItemData& dstItem,
@@ -302,12 +336,14 @@ public:
   void SafeUnlockCurFile(); // unlocks current file iff we locked it.
   void SafeUnlockFile(const stringT &filename);
 
-  // Following 3 routines only for SaveAs to use a temporary lock handle
-  // LockFile2, UnLockFile2 & MoveLock
-  bool LockFile2(const stringT &filename, stringT &locker);
-  void UnlockFile2(const stringT &filename);
-  void MoveLock()
-  {m_lockFileHandle = m_lockFileHandle2; m_lockFileHandle2 = INVALID_HANDLE_VALUE;}
+  // Following 3 routines only for SaveAs to lock the new file before
+  // unlocking the old one: LockFile2, UnLockFile2 & MoveLock.
+  // Each locked file has its own handle, so these are now the same as
+  // LockFile & UnlockFile, and there's no lock to move.
+  bool LockFile2(const stringT &filename, stringT &locker)
+  {return LockFile(filename, locker);}
+  void UnlockFile2(const stringT &filename) {UnlockFile(filename);}
+  void MoveLock() {}
 
   // Set application data
   void SetApplicationNameAndVersion(const stringT &appName, DWORD dwMajorMinor,
@@ -323,6 +359,17 @@ public:
   // Get all password policy names
   void GetPolicyNames(std::vector<stringT> &vNames) const;
   bool GetPolicyFromName(const StringX &sxPolicyName, PWPolicy &st_pp) const;
+
+  // Bulk password rotation: new passwords for all the given entries are
+  // generated in one batch and applied (with password history and PMTIME
+  // updates) as a single undoable command, i.e., one GUI refresh and at most
+  // one "Save Immediately" save.
+  // An empty sxPolicyName means each entry's own policy (named or specific),
+  // falling back to the default policy.
+  // Aliases, shortcuts and unknown UUIDs are skipped.
+  int RotatePasswords(const UUIDVector &entries, const StringX &sxPolicyName,
+                      size_t &numRotated);
+
   Command *ProcessPolicyName(const PWScore *pothercore, CItemData &updtEntry,
                              std::map<StringX, StringX> &mapRenamedPolicies,
                              std::vector<StringX> &vs_PoliciesAdded,
@@ -336,6 +383,13 @@ public:
 
   bool GetEntriesUsingNamedPasswordPolicy(const StringX sxPolicyName,
                                           std::vector<st_GroupTitleUser> &ventries);
+  // Entries whose password policy name is sxPolicyName
+  const UUIDSet &GetEntriesUsingPolicy(const StringX &sxPolicyName) const;
+  // Changes the policy name of all the entries using sxOldPolicyName to
+  // sxNewPolicyName (cleared if empty), e.g., when the policy is renamed or
+  // deleted. Returns nullptr if there are no such entries.
+  Command *ReassignPasswordPolicy(const StringX &sxOldPolicyName,
+                                  const StringX &sxNewPolicyName);
 
   // Populate setGTU & setUUID from m_pwlist. Returns false & empty set if
   // m_pwlist had one or more entries with same GTU/UUID respectively.
@@ -366,8 +420,35 @@ public:
  
   // Command functions
   int Execute(Command *pcmd);
+
+  // Groups the commands executed while it is open, through it or through
+  // Execute, into a single undo step. Observers are told once, on Commit,
+  // that the database was modified (i.e., at most one Save Immediately)
+  // and get the GUI updates of all the commands in one UpdateGUIBatch.
+  // Rollback undoes the commands, whose GUI updates are then never sent;
+  // a Transaction that goes out of scope uncommitted is rolled back.
+  // Only one can be open at a time, during which Undo and Redo are not
+  // available.
+  class Transaction
+  {
+  public:
+    explicit Transaction(PWScore &core);
+    ~Transaction();
+    int Execute(Command *pcmd);
+    void Commit();
+    void Rollback();
+    bool IsOpen() const {return m_pmulticmds != nullptr;}
+
+  private:
+    Transaction(const Transaction &) = delete;
+    Transaction &operator=(const Transaction &) = delete;
+
+    PWScore &m_core;
+    MultiCommands *m_pmulticmds;
+  };
   void Undo();
   void Redo();
+  bool InTransaction() const {return m_pTransaction != nullptr;}
   void ClearCommands();  // This should be private to prevent UI calling directly but called by coretest
   bool AnyToUndo() const;
   bool AnyToRedo() const;
@@ -469,17 +550,15 @@ public:
   void SetRUEList(const UUIDList &RUElist)
   {m_RUEList = RUElist;}
 
-  size_t GetExpirySize() {return m_ExpireCandidates.size();}
-  ExpiredList GetExpired(int idays) {return m_ExpireCandidates.GetExpired(idays);}
+  size_t GetExpirySize() const {return m_ExpireCandidates.size();}
+  ExpiredList GetExpired(int idays) const {return m_ExpireCandidates.GetExpired(idays);}
+  bool GetNextExpiry(ExpPWEntry &ee) const {return m_ExpireCandidates.GetNextExpiry(ee);}
 
   // Yubi support:
   const unsigned char *GetYubiSK() const;
   void SetYubiSK(const unsigned char *);
   
   // Password Policies
-  bool IncrementPasswordPolicy(const StringX &sxPolicyName);
-  bool DecrementPasswordPolicy(const StringX &sxPolicyName);
-
   const PSWDPolicyMap &GetPasswordPolicies()
   {return m_MapPSWDPLC;}
 
@@ -511,6 +590,9 @@ protected:
   bool Validate(const size_t iMAXCHARS, CReport *pRpt, st_ValidateResults &st_vr); // protected for unit testing
 
 private:
+  // Records between calls to a ReadProgressFn or SyncProgressFn: often
+  // enough for a smooth progress bar, seldom enough not to slow things down
+  static const size_t PROGRESS_INTERVAL = 64;
 
   // Database update routines
 
@@ -617,8 +699,9 @@ private:
   static unsigned char m_session_key[32];
   static bool m_session_initialized;
 
-  HANDLE m_lockFileHandle;
-  HANDLE m_lockFileHandle2;
+  // The files we've locked, with the handle to unlock each with. Another
+  // database is locked (e.g., File->Open) before the current one is unlocked.
+  std::map<stringT, HANDLE> m_lockFileHandles;
 
   stringT m_AppNameAndVersion;
   PWSfile::VERSION m_ReadFileVersion;
@@ -679,6 +762,18 @@ private:
   std::vector<Command *> m_vpcommands;
   std::vector<Command *>::iterator m_undo_iter;
   std::vector<Command *>::iterator m_redo_iter;
+  size_t m_UndoMemorySize; // sum of their GetMemorySize()
+
+  // Drops the oldest commands beyond the MaxUndoSteps and MaxUndoMemory
+  // preferences
+  void LimitUndoHistory();
+
+  // Puts an executed command on the end of the command chain
+  void AddToUndoHistory(Command *pcmd);
+
+  // The open Transaction, if any, and the GUI updates it holds back
+  Transaction *m_pTransaction;
+  std::vector<GUIUpdate> m_vGUIUpdates;
   
   // DB clean/dirty states - before and after command execution.
   enum DBState { CLEAN, DIRTY };
@@ -697,7 +792,7 @@ private:
   PWSFileSig *m_pFileSig;
 
   // Entries with an expiry date
-  ExpiredList m_ExpireCandidates;
+  ExpiryIndex m_ExpireCandidates;
   void AddExpiryEntry(const CItemData &ci)
   {m_ExpireCandidates.Add(ci);}
   void UpdateExpiryEntry(const CItemData &ci)
@@ -707,6 +802,14 @@ private:
   void RemoveExpiryEntry(const CItemData &ci)
   {m_ExpireCandidates.Remove(ci);}
 
+  // Entries by password policy name, which also gives the policies' usecount
+  std::map<StringX, UUIDSet> m_PolicyEntries;
+  void AddPolicyEntry(const pws_os::CUUID &uuid, const StringX &sxPolicyName);
+  void RemovePolicyEntry(const pws_os::CUUID &uuid, const StringX &sxPolicyName);
+  void UpdatePolicyEntry(const pws_os::CUUID &uuid, const StringX &sxOldPolicyName,
+                         const StringX &sxNewPolicyName);
+  void UpdatePolicyUseCounts();
+
   stringT GetXMLPWPolicies(const OrderedItemList *pOIL = nullptr);
   PSWDPolicyMap m_MapPSWDPLC;
   PSWDPolicyMap m_InitialMapPSWDPLC;  // Needed for HavePasswordPolicyNamesChanged
@@ -128,6 +128,7 @@ public:
   {return m_nRecordsWithUnknownFields;}
 
   long GetOffset() const;
+  ulong64 GetFileLength() const {return m_fileLength;}
   
   // Following implemented in V3 and later
   virtual uint32 GetNHashIters() const {return 0;}
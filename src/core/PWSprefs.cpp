@@ -192,6 +192,8 @@ const PWSprefs::intPref PWSprefs::m_int_prefs[NumIntPrefs] = {
   {_T("DNDMaximumMemorySize"), 14000, ptApplication, -1, INT_MAX},   // application
   {_T("DisplayMode"), DisplayModeSystem, ptApplication,
                            minDisplayMode, maxDisplayMode},         // application
+  {_T("MaxUndoSteps"), 1000, ptApplication, 0, INT_MAX},            // application, 0 = unlimited
+  {_T("MaxUndoMemory"), 256, ptApplication, 0, INT_MAX},            // application, in MB, 0 = unlimited
 };
 
 const PWSprefs::stringPref PWSprefs::m_string_prefs[NumStringPrefs] = {
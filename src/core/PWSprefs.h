@@ -149,7 +149,7 @@ public:
     AutotypeSelectAllKeyCode, AutotypeSelectAllModMask, //X only
     TreeFontPtSz, PasswordFontPtSz, NotesFontPtSz, AddEditFontPtSz, VKFontPtSz,
     WindowTransparency, DefaultExpiryDays, DNDMaxMemSize,
-    DisplayMode,
+    DisplayMode, MaxUndoSteps, MaxUndoMemory,
     NumIntPrefs};
 
   enum StringPrefs {CurrentBackup, CurrentFile, LastView, DefaultUsername,
@@ -6,30 +6,62 @@
 * http://www.opensource.org/licenses/artistic-license-2.0.php
 */
 #include <limits>
+#include <algorithm>
 #include <cstring> // for std::memcpy
 #include "os/rand.h"
 
 #include "PwsPlatform.h"
 #include "PWSrand.h"
+#include "Util.h"
 
-PWSrand *PWSrand::self = nullptr;
+std::atomic<PWSrand *> PWSrand::self{nullptr};
+std::mutex PWSrand::s_instanceMutex;
+
+namespace {
+  // The shared instance serializes its callers, per-thread ones don't lock
+  std::unique_lock<std::mutex> LockIfShared(std::mutex &m, bool isThreadInstance)
+  {
+    return isThreadInstance ? std::unique_lock<std::mutex>() : std::unique_lock<std::mutex>(m);
+  }
+} // anonymous namespace
 
 PWSrand *PWSrand::GetInstance()
 {
-  if (self == nullptr) {
-    self = new PWSrand;
+  PWSrand *p = self.load(std::memory_order_acquire);
+  if (p == nullptr) {
+    std::lock_guard<std::mutex> guard(s_instanceMutex);
+    p = self.load(std::memory_order_relaxed);
+    if (p == nullptr) {
+      p = new PWSrand;
+      self.store(p, std::memory_order_release);
+    }
   }
-  return self;
+  return p;
 }
 
 void PWSrand::DeleteInstance()
 {
-  delete self;
-  self = nullptr;
+  std::lock_guard<std::mutex> guard(s_instanceMutex);
+  delete self.exchange(nullptr);
+}
+
+struct PWSrand::ThreadInstanceHolder
+{
+  PWSrand *instance = nullptr;
+  ~ThreadInstanceHolder() { delete instance; }
+};
+
+PWSrand *PWSrand::GetThreadInstance()
+{
+  thread_local ThreadInstanceHolder holder;
+  if (holder.instance == nullptr)
+    holder.instance = new PWSrand(GetInstance());
+  return holder.instance;
 }
 
 PWSrand::PWSrand()
-  : R{}, rgbRandomData{}, ibRandomData(SHA256::HASHLEN)
+  : m_IsThreadInstance(false), m_key{}, m_rndbuf{}, m_rndpos(RNDBUFLEN),
+    m_sinceReseed(0), m_reseedInterval(DEFAULT_RESEED_INTERVAL)
 {
   m_IsInternalPRNG = !pws_os::InitRandomDataFunction();
 
@@ -41,96 +73,144 @@ PWSrand::PWSrand()
   p = new unsigned char[slen];
   pws_os::GetRandomSeed(p, slen);
   s.Update(p, slen);
+  trashMemory(p, slen);
   delete[] p;
   s.Final(K);
+
+  ReseedUnlocked();
+}
+
+PWSrand::PWSrand(PWSrand *parent)
+  : m_IsThreadInstance(true), m_IsInternalPRNG(parent->m_IsInternalPRNG),
+    m_key{}, m_rndbuf{}, m_rndpos(RNDBUFLEN),
+    m_sinceReseed(0), m_reseedInterval(parent->GetReseedInterval())
+{
+  // GetRandomSeed() isn't reentrant, so we take our
+  // initial entropy from the parent instead
+  unsigned char seed[SHA256::HASHLEN];
+  parent->GetRandomData(seed, sizeof(seed));
+  SHA256 s;
+  s.Update(seed, sizeof(seed));
+  s.Final(K);
+  trashMemory(seed, sizeof(seed));
+
+  ReseedUnlocked();
 }
 
 PWSrand::~PWSrand()
 {
+  trashMemory(K, sizeof(K));
+  trashMemory(m_key, sizeof(m_key));
+  trashMemory(m_rndbuf, sizeof(m_rndbuf));
 }
 
 void PWSrand::AddEntropy(unsigned char *bytes, unsigned int numBytes)
 {
   ASSERT(bytes != nullptr);
+  auto lock = LockIfShared(m_mutex, m_IsThreadInstance);
 
   SHA256 s;
 
   s.Update(K, sizeof(K));
   s.Update(bytes, numBytes);
   s.Final(K);
+
+  ReseedUnlocked();
+}
+
+void PWSrand::Reseed()
+{
+  auto lock = LockIfShared(m_mutex, m_IsThreadInstance);
+  ReseedUnlocked();
 }
 
-void PWSrand::NextRandBlock()
+void PWSrand::SetReseedInterval(unsigned long nBytes)
 {
+  auto lock = LockIfShared(m_mutex, m_IsThreadInstance);
+  m_reseedInterval = nBytes;
+}
+
+void PWSrand::ReseedUnlocked()
+{
+  // New key = SHA256(K | current key | fresh randomness).
+  // If we have an external random source, we mix it in with our
+  // own state. This helps protect against poor or subverted
+  // external PRNGs. Otherwise, we'll rely on our lonesome.
   SHA256 s;
   s.Update(K, sizeof(K));
-  s.Final(R);
+  s.Update(m_key, sizeof(m_key));
 
-  constexpr int N = SHA256::HASHLEN / sizeof(uint32);
-
-  // Use temporary buffers to avoid alignment issues
-  uint32 Ktemp[N], Rtemp[N];
+  unsigned char fresh[ChaCha20::KEYLEN];
+  if (m_IsThreadInstance) {
+    GetInstance()->GetRandomData(fresh, sizeof(fresh));
+    s.Update(fresh, sizeof(fresh));
+  }
+  if (!m_IsInternalPRNG) {
+    bool status;
+    status = pws_os::GetRandomData(fresh, sizeof(fresh));
+    ASSERT(status);
+    if (status)
+      s.Update(fresh, sizeof(fresh));
+  }
+  trashMemory(fresh, sizeof(fresh));
+  s.Final(m_key);
 
+  // Step K forward, so that the next reseed differs
+  // even without new entropy
+  constexpr int N = SHA256::HASHLEN / sizeof(uint32);
+  uint32 Ktemp[N];
   std::memcpy(Ktemp, K, sizeof(Ktemp));
-  std::memcpy(Rtemp, R, sizeof(Rtemp));
-
   Ktemp[0]++;
-
-  for (int32 i = 0; i < N; i++)
-    Ktemp[i] += Rtemp[i];
-
   std::memcpy(K, Ktemp, sizeof(Ktemp));
+
+  // Discard anything generated with the previous key
+  trashMemory(m_rndbuf, sizeof(m_rndbuf));
+  m_rndpos = RNDBUFLEN;
+  m_sinceReseed = 0;
 }
 
-void PWSrand::GetRandomData( void * const buffer, unsigned long length )
+void PWSrand::Refill()
 {
-  if (!m_IsInternalPRNG) {
-    bool status;
-    status = pws_os::GetRandomData(buffer, length);
-    ASSERT(status);
-    UNREFERENCED_PARAMETER(status); // used only in assert
-  }
+  if (m_reseedInterval != 0 && m_sinceReseed >= m_reseedInterval)
+    ReseedUnlocked();
 
-  // If we have an external random source, we'll
-  // xor it in with ours. This helps protect against
-  // poor or subverted external PRNGs.
-  // Otherwise, we'll rely on our lonesome.
-
-  unsigned char *pb = static_cast<unsigned char *>(buffer);
-  while (length > SHA256::HASHLEN) {
-    NextRandBlock();
-    for (unsigned int j = 0; j < SHA256::HASHLEN; j++)
-      pb[j] = (m_IsInternalPRNG) ? R[j] : pb[j] ^ R[j];
-    length -= SHA256::HASHLEN;
-    pb += SHA256::HASHLEN;
-  }
+  static const unsigned char nonce[ChaCha20::NONCELEN] = {0};
+  ChaCha20 cc(m_key, nonce);
+  cc.Keystream(m_rndbuf, sizeof(m_rndbuf));
 
-  ASSERT(length <= SHA256::HASHLEN);
-  if (length > 0) {
-    unsigned long i = 0;
-    NextRandBlock();
-    while (i < length) {
-      pb[i] = (m_IsInternalPRNG) ? R[i] : pb[i] ^ R[i];
-      i++;
-    }
-  }
+  // Fast key erasure: the head of the buffer becomes the next key
+  std::memcpy(m_key, m_rndbuf, sizeof(m_key));
+  trashMemory(m_rndbuf, sizeof(m_key));
+  m_rndpos = sizeof(m_key);
 }
 
-// generate random numbers from a buffer filled in by GetRandomData()
-unsigned int PWSrand::RandUInt()
+void PWSrand::GetRandomData( void * const buffer, unsigned long length )
 {
-  // we don't want to keep filling the random buffer for each number we
-  // want, so fill the buffer with random data and use it up
+  auto lock = LockIfShared(m_mutex, m_IsThreadInstance);
+  GetRandomDataUnlocked(static_cast<unsigned char *>(buffer), length);
+}
 
-  if (ibRandomData > (SHA256::HASHLEN - sizeof(uint32))) {
-    // no data left, refill the buffer
-    GetRandomData(rgbRandomData, SHA256::HASHLEN);
-    ibRandomData = 0;
+void PWSrand::GetRandomDataUnlocked(unsigned char *pb, unsigned long length)
+{
+  m_sinceReseed += length;
+
+  while (length > 0) {
+    if (m_rndpos == RNDBUFLEN)
+      Refill();
+    unsigned long n = std::min(length, static_cast<unsigned long>(RNDBUFLEN - m_rndpos));
+    std::memcpy(pb, m_rndbuf + m_rndpos, n);
+    // Don't keep what we've handed out
+    std::memset(m_rndbuf + m_rndpos, 0, n);
+    m_rndpos += static_cast<unsigned int>(n);
+    pb += n;
+    length -= n;
   }
+}
 
+unsigned int PWSrand::RandUInt()
+{
   unsigned int u = 0;
-  std::memcpy(&u, rgbRandomData + ibRandomData, sizeof(uint32));
-  ibRandomData += sizeof(uint32);
+  GetRandomData(&u, sizeof(u));
   return u;
 }
 
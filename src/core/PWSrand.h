@@ -12,13 +12,25 @@
 #define __PWSRAND_H
 
 #include "crypto/sha256.h"
+#include "crypto/ChaCha20.h"
+
+#include <atomic>
+#include <mutex>
 
 class PWSrand
 {
 public:
+  // The process-wide generator. Its methods are serialized internally,
+  // so it may be shared, but worker threads doing anything in bulk
+  // should use GetThreadInstance() instead.
   static PWSrand *GetInstance();
   static void DeleteInstance();
 
+  // A generator private to the calling thread, created on first use and
+  // seeded from the process-wide one. It takes no locks, and is deleted
+  // when the thread exits.
+  static PWSrand *GetThreadInstance();
+
   void AddEntropy(unsigned char *bytes, unsigned int numBytes);
   //  fill this buffer with random data
   void GetRandomData( void * const buffer, unsigned long length );
@@ -27,17 +39,44 @@ public:
   //  generate a random integer in [0, len)
   unsigned int RangeRand(size_t len);
 
+  // Mix in fresh randomness now: from the OS for the process-wide
+  // generator, from the process-wide generator and the OS for a
+  // per-thread one. This also happens automatically every
+  // GetReseedInterval() bytes of output; 0 disables that.
+  void Reseed();
+  void SetReseedInterval(unsigned long nBytes);
+  unsigned long GetReseedInterval() const {return m_reseedInterval;}
+
 private:
   PWSrand(); // start with some minimal entropy
+  PWSrand(PWSrand *parent); // per-thread instance
   ~PWSrand();
 
-  void NextRandBlock();
-  static PWSrand *self;
-  bool m_IsInternalPRNG;
-  unsigned char K[SHA256::HASHLEN];
-  unsigned char R[SHA256::HASHLEN];
+  struct ThreadInstanceHolder;
 
-  char rgbRandomData[SHA256::HASHLEN];
-  unsigned int ibRandomData;
+  // Random data is served from a buffer of ChaCha20 keystream. Each refill
+  // replaces the ChaCha20 key with the first KEYLEN bytes of the new
+  // keystream ("fast key erasure"), so earlier output can't be recovered
+  // from the current state. The key is periodically re-derived from K and
+  // fresh randomness.
+  enum { RNDBUFLEN = 16 * ChaCha20::BLOCKSIZE,
+         DEFAULT_RESEED_INTERVAL = 1024 * 1024 }; // bytes of output
+
+  void ReseedUnlocked();
+  void Refill();
+  void GetRandomDataUnlocked(unsigned char *pb, unsigned long length);
+
+  static std::atomic<PWSrand *> self;
+  static std::mutex s_instanceMutex;
+
+  const bool m_IsThreadInstance;
+  bool m_IsInternalPRNG;
+  std::mutex m_mutex; // not used by per-thread instances
+  unsigned char K[SHA256::HASHLEN]; // entropy pool
+  unsigned char m_key[ChaCha20::KEYLEN];
+  unsigned char m_rndbuf[RNDBUFLEN];
+  unsigned int m_rndpos;
+  unsigned long m_sinceReseed;
+  unsigned long m_reseedInterval;
 };
 #endif /*  __PWSRAND_H */
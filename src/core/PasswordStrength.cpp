@@ -0,0 +1,535 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// PasswordStrength.cpp
+//-----------------------------------------------------------------------------
+
+#include "PasswordStrength.h"
+#include "Util.h"
+#include "trigram.h" // for the price of letters
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+const double PasswordStrength::MAX_STRENGTH = 100.0;
+
+namespace
+{
+// Passwords are looked at for patterns this much at a time, which keeps
+// the search for repeats cheap, and is far more than MAX_STRENGTH needs
+const size_t MAX_ANALYSED = 128;
+const size_t MIN_MATCH = 3;
+// Not even the most common password is the attacker's first guess
+const double MIN_MATCH_GUESSES = 10.0;
+const unsigned char NON_ASCII = 0;
+
+// Most common first, from the usual leaked password lists. Passwords that
+// are keyboard walks, sequences or repeats are found as such anyway.
+const char *const COMMON_PASSWORDS[] = {
+  "password", "iloveyou", "princess", "rockyou", "abc123", "nicole",
+  "daniel", "babygirl", "monkey", "lovely", "jessica", "michael",
+  "ashley", "qwerty", "iloveu", "michelle", "tigger", "sunshine",
+  "chocolate", "soccer", "anthony", "friends", "butterfly", "purple",
+  "angel", "jordan", "liverpool", "justin", "loveme", "football",
+  "secret", "andrea", "carlos", "jennifer", "joshua", "bubbles",
+  "superman", "hannah", "amanda", "loveyou", "pretty", "basketball",
+  "andrew", "angels", "tweety", "flower", "playboy", "hello",
+  "elizabeth", "hottie", "tinkerbell", "charlie", "samantha", "barbie",
+  "chelsea", "lovers", "teamo", "jasmine", "brandon", "shadow",
+  "melissa", "eminem", "matthew", "robert", "danielle", "forever",
+  "family", "jonathan", "computer", "whatever", "dragon", "vanessa",
+  "cookie", "naruto", "summer", "sweety", "spongebob", "joseph",
+  "junior", "softball", "taylor", "yellow", "daniela", "lauren",
+  "mickey", "princesa", "alexandra", "alexis", "jesus", "estrella",
+  "miguel", "william", "thomas", "beautiful", "mylove", "angela",
+  "poohbear", "patrick", "iloveme", "sakura", "adrian", "alexander",
+  "destiny", "christian", "sayang", "america", "dancer", "monica",
+  "richard", "diamond", "carolina", "steven", "rangers", "louise",
+  "orange", "shorty", "nathan", "snoopy", "gabriel", "hunter",
+  "cherry", "killer", "sandra", "alejandro", "buster", "george",
+  "brittany", "alejandra", "patricia", "rachel", "tequiero", "cheese",
+  "arsenal", "dolphin", "antonio", "heather", "david", "ginger",
+  "stephanie", "peanut", "blink182", "sweetie", "beauty", "victoria",
+  "honey", "fernando", "pokemon", "maggie", "corazon", "chicken",
+  "pepper", "cristina", "rainbow", "kisses", "manuel", "myspace",
+  "rebelde", "ricardo", "babygurl", "heaven", "baseball", "martin",
+  "greenday", "november", "alyssa", "madison", "mother", "batman",
+  "september", "december", "morgan", "mariposa", "maria", "gabriela",
+  "bailey", "jeremy", "pamela", "kimberly", "gemini", "shannon",
+  "pictures", "sophie", "jessie", "hellokitty", "claudia", "angelica",
+  "austin", "victor", "horses", "tiffany", "mariana", "eduardo",
+  "andres", "courtney", "booboo", "kissme", "harley", "ronaldo",
+  "precious", "october", "inuyasha", "peaches", "veronica", "chris",
+  "adriana", "cutie", "james", "banana", "prince", "friend", "crystal",
+  "celtic", "edward", "oliver", "diana", "samsung", "freedom",
+  "angelo", "kenneth", "master", "scooby", "carmen", "sebastian",
+  "rebecca", "jackie", "spiderman", "christopher", "garfield",
+  "miranda", "letmein", "welcome", "admin", "login", "trustno1",
+  "starwars", "access", "mustang", "passport", "solo", "internet",
+  "google", "apple", "love", "money", "god",
+  "pass", "test", "guest", "root", "user", "changeme", "default",
+  "winter", "spring", "autumn", "january", "february", "march", "april",
+  "june", "july", "august", "monday", "tuesday", "wednesday",
+  "thursday", "friday", "saturday", "sunday", "pwsafe", "passwordsafe",
+};
+
+// US keyboard, unshifted and shifted, row by row. Each row is offset by
+// about half a key from the one above it.
+const char *const KEY_ROWS[][2] = {
+  {"`1234567890-=", "~!@#$%^&*()_+"},
+  {"qwertyuiop[]\\", "QWERTYUIOP{}|"},
+  {"asdfghjkl;'", "ASDFGHJKL:\""},
+  {"zxcvbnm,./", "ZXCVBNM<>?"},
+};
+const double KEY_STARTING_POSITIONS = 94.0;
+const double KEY_AVERAGE_DEGREE = 4.6;
+
+struct KeyPos {
+  signed char row = -1, col = -1;
+  bool shifted = false;
+  bool IsValid() const {return row >= 0;}
+};
+
+inline bool IsLower(unsigned char c) {return c >= 'a' && c <= 'z';}
+inline bool IsUpper(unsigned char c) {return c >= 'A' && c <= 'Z';}
+inline bool IsLetter(unsigned char c) {return IsLower(c) || IsUpper(c);}
+inline bool IsDigit(unsigned char c) {return c >= '0' && c <= '9';}
+inline unsigned char ToLower(unsigned char c) {return IsUpper(c) ? c - 'A' + 'a' : c;}
+
+double Binomial(size_t n, size_t k)
+{
+  if (k > n)
+    return 0;
+  double r = 1;
+  for (size_t i = 1; i <= k; i++)
+    r = r * double(n - k + i) / double(i);
+  return r;
+}
+
+/*
+ * Everything the estimator looks up, built once
+ */
+struct Tables {
+  static const int N = 26;
+  static const int PRICE_UNIT = 32; // trigram prices are in 1/32 bits
+  struct Word {
+    const char *word;
+    size_t len;
+    unsigned rank;
+  };
+
+  unsigned char trigramPrice[N][N][N];
+  std::vector<Word> words; // sorted alphabetically
+  size_t maxWordLen;
+  KeyPos keys[128];
+  unsigned char unleet[128]; // letter a l33t character stands for, or 0
+  int currentYear;
+
+  Tables();
+  unsigned Rank(const unsigned char *s, size_t n) const; // 0 if not common
+};
+
+Tables::Tables() : maxWordLen(0)
+{
+  // Price of a letter given the two before it: -log2 of its frequency
+  // after them, smoothed, and never more than a random letter's
+  const double maxPrice = std::log2(double(N));
+  for (int c1 = 0; c1 < N; c1++)
+    for (int c2 = 0; c2 < N; c2++) {
+      long sum = 0;
+      for (int c3 = 0; c3 < N; c3++)
+        sum += tris[c1][c2][c3];
+      for (int c3 = 0; c3 < N; c3++) {
+        double price = maxPrice;
+        if (sum > 0) {
+          const double p = (tris[c1][c2][c3] + 0.5) / (sum + 0.5 * double(N));
+          price = std::min(-std::log2(p), maxPrice);
+        }
+        trigramPrice[c1][c2][c3] = static_cast<unsigned char>(std::lround(price * double(PRICE_UNIT)));
+      }
+    }
+
+  const size_t numWords = sizeof(COMMON_PASSWORDS) / sizeof(COMMON_PASSWORDS[0]);
+  words.reserve(numWords);
+  for (size_t i = 0; i < numWords; i++) {
+    const size_t len = std::strlen(COMMON_PASSWORDS[i]);
+    words.push_back(Word{COMMON_PASSWORDS[i], len, unsigned(i + 1)});
+    maxWordLen = std::max(maxWordLen, len);
+  }
+  auto wordLess = [](const Word &a, const Word &b) {
+    const int c = std::strcmp(a.word, b.word);
+    return c < 0 || (c == 0 && a.rank < b.rank);
+  };
+  std::sort(words.begin(), words.end(), wordLess);
+  // Keep the best rank of a word that's listed twice, just in case
+  words.erase(std::unique(words.begin(), words.end(),
+                          [](const Word &a, const Word &b) {
+                            return std::strcmp(a.word, b.word) == 0;
+                          }),
+              words.end());
+
+  for (signed char row = 0; row < 4; row++)
+    for (int shifted = 0; shifted < 2; shifted++) {
+      const char *keys_in_row = KEY_ROWS[row][shifted];
+      for (signed char col = 0; keys_in_row[col] != '\0'; col++) {
+        KeyPos &kp = keys[static_cast<unsigned char>(keys_in_row[col])];
+        kp.row = row;
+        kp.col = col;
+        kp.shifted = shifted != 0;
+      }
+    }
+
+  std::memset(unleet, 0, sizeof(unleet));
+  const char *const LEET[][2] = {
+    {"4@", "a"}, {"8", "b"}, {"(", "c"}, {"3", "e"}, {"6", "g"},
+    {"1!|", "i"}, {"0", "o"}, {"$5", "s"}, {"7+", "t"}, {"2", "z"},
+  };
+  for (const auto &l : LEET)
+    for (const char *p = l[0]; *p != '\0'; p++)
+      unleet[static_cast<unsigned char>(*p)] = static_cast<unsigned char>(l[1][0]);
+
+  // Close enough, and doesn't need the (non-reentrant) localtime()
+  currentYear = 1970 + int(std::time(nullptr) / 31556952L);
+}
+
+unsigned Tables::Rank(const unsigned char *s, size_t n) const
+{
+  auto iter = std::lower_bound(words.begin(), words.end(), n,
+                               [s](const Word &w, size_t len) {
+                                 const int c = std::memcmp(w.word, s, std::min(w.len, len));
+                                 return c < 0 || (c == 0 && w.len < len);
+                               });
+  if (iter != words.end() && iter->len == n && std::memcmp(iter->word, s, n) == 0)
+    return iter->rank;
+  return 0;
+}
+
+const Tables &GetTables()
+{
+  static const Tables tables;
+  return tables;
+}
+
+/*
+ * Finds the cheapest way to build (a part of) a password from patterns
+ * and single characters. Patterns are matched against the password in
+ * ASCII, with NON_ASCII for anything else, repeats against the original.
+ */
+class Estimator
+{
+public:
+  Estimator(const Tables &t, const unsigned char *s, const charT *orig)
+    : m_t(t), m_s(s), m_orig(orig) {}
+
+  double Bits(size_t b, size_t e) const;
+
+private:
+  struct Match {
+    size_t i, j; // [i, j)
+    double bits;
+  };
+  typedef std::vector<Match> Matches;
+
+  void AddMatch(Matches &matches, size_t i, size_t j, double guesses) const
+  {matches.push_back(Match{i, j, std::log2(std::max(guesses, MIN_MATCH_GUESSES))});}
+
+  double CharBits(size_t b, size_t i) const; // price of m_s[i] on its own
+  void DictionaryMatches(size_t b, size_t e, Matches &matches) const;
+  void SpatialMatches(size_t b, size_t e, Matches &matches) const;
+  void SequenceMatches(size_t b, size_t e, Matches &matches) const;
+  void RepeatMatches(size_t b, size_t e, Matches &matches) const;
+  void YearMatches(size_t b, size_t e, Matches &matches) const;
+
+  double UppercaseVariations(size_t i, size_t n) const;
+  bool Adjacent(unsigned char a, unsigned char b, int &direction) const;
+
+  const Tables &m_t;
+  const unsigned char *m_s;
+  const charT *m_orig;
+};
+
+double Estimator::CharBits(size_t b, size_t i) const
+{
+  static const double LETTER = std::log2(26.0), DIGIT = std::log2(10.0),
+    SYMBOL = std::log2(33.0), OTHER = std::log2(100.0);
+  const unsigned char c = m_s[i];
+  if (IsLetter(c)) {
+    double bits = LETTER;
+    if (i >= b + 2 && IsLetter(m_s[i - 1]) && IsLetter(m_s[i - 2]))
+      bits = double(m_t.trigramPrice[ToLower(m_s[i - 2]) - 'a']
+                                    [ToLower(m_s[i - 1]) - 'a']
+                                    [ToLower(c) - 'a']) / double(Tables::PRICE_UNIT);
+    return IsUpper(c) ? bits + 1 : bits;
+  }
+  if (IsDigit(c))
+    return DIGIT;
+  return c == NON_ASCII ? OTHER : SYMBOL;
+}
+
+double Estimator::Bits(size_t b, size_t e) const
+{
+  if (b >= e)
+    return 0;
+
+  Matches matches;
+  DictionaryMatches(b, e, matches);
+  SpatialMatches(b, e, matches);
+  SequenceMatches(b, e, matches);
+  RepeatMatches(b, e, matches);
+  YearMatches(b, e, matches);
+  std::sort(matches.begin(), matches.end(),
+            [](const Match &m1, const Match &m2) { return m1.j < m2.j; });
+
+  // best[k] is the price of the cheapest way to build m_s[b, b + k)
+  std::vector<double> best(e - b + 1);
+  auto m = matches.cbegin();
+  for (size_t k = 1; k <= e - b; k++) {
+    best[k] = best[k - 1] + CharBits(b, b + k - 1);
+    for (; m != matches.cend() && m->j == b + k; m++)
+      best[k] = std::min(best[k], best[m->i - b] + m->bits);
+  }
+  return best[e - b];
+}
+
+double Estimator::UppercaseVariations(size_t i, size_t n) const
+{
+  size_t upper = 0, lower = 0;
+  for (size_t k = i; k < i + n; k++) {
+    if (IsUpper(m_s[k])) upper++;
+    else if (IsLower(m_s[k])) lower++;
+  }
+  if (upper == 0)
+    return 1;
+  // All caps, or just the first or last letter, are what people do
+  if (lower == 0 || (upper == 1 && (IsUpper(m_s[i]) || IsUpper(m_s[i + n - 1]))))
+    return 2;
+  double variations = 0;
+  for (size_t k = 1; k <= std::min(upper, lower); k++)
+    variations += Binomial(upper + lower, k);
+  return variations;
+}
+
+void Estimator::DictionaryMatches(size_t b, size_t e, Matches &matches) const
+{
+  unsigned char word[64], reversed[64], unleeted[64];
+  const size_t maxLen = std::min(m_t.maxWordLen, sizeof(word));
+
+  for (size_t i = b; i < e; i++) {
+    size_t avail = 0; // up to the end or the first non-ASCII character
+    for (; avail < maxLen && i + avail < e && m_s[i + avail] != NON_ASCII; avail++)
+      word[avail] = ToLower(m_s[i + avail]);
+
+    for (size_t n = MIN_MATCH; n <= avail; n++) {
+      double guesses = 0;
+      if (unsigned rank = m_t.Rank(word, n))
+        guesses = rank;
+      std::reverse_copy(word, word + n, reversed);
+      if (unsigned rank = m_t.Rank(reversed, n))
+        if (guesses == 0 || 2.0 * rank < guesses)
+          guesses = 2.0 * rank;
+
+      size_t subs = 0, ones = 0;
+      for (size_t k = 0; k < n; k++) {
+        const unsigned char u = word[k] < 128 ? m_t.unleet[word[k]] : 0;
+        unleeted[k] = u != 0 ? u : word[k];
+        if (u != 0) subs++;
+        if (word[k] == '1') ones++;
+      }
+      if (subs > 0) {
+        unsigned rank = m_t.Rank(unleeted, n);
+        if (rank == 0 && ones > 0) { // '1' may be an 'l' as well as an 'i'
+          for (size_t k = 0; k < n; k++)
+            if (word[k] == '1') unleeted[k] = 'l';
+          rank = m_t.Rank(unleeted, n);
+        }
+        // Each substituted character may or may not have been substituted
+        if (rank != 0 && (guesses == 0 || rank * std::pow(2.0, double(subs)) < guesses))
+          guesses = rank * std::pow(2.0, double(subs));
+      }
+
+      if (guesses > 0)
+        AddMatch(matches, i, i + n, guesses * UppercaseVariations(i, n));
+    }
+  }
+  trashMemory(word, sizeof(word));
+  trashMemory(reversed, sizeof(reversed));
+  trashMemory(unleeted, sizeof(unleeted));
+}
+
+bool Estimator::Adjacent(unsigned char a, unsigned char b, int &direction) const
+{
+  if (a >= 128 || b >= 128)
+    return false;
+  const KeyPos &ka = m_t.keys[a], &kb = m_t.keys[b];
+  if (!ka.IsValid() || !kb.IsValid())
+    return false;
+  const int dr = kb.row - ka.row, dc = kb.col - ka.col;
+  // The rows are staggered, so a key touches two keys in each of the
+  // rows above and below it
+  const bool adjacent = (dr == 0 && (dc == 1 || dc == -1)) ||
+                        (dr == -1 && (dc == 0 || dc == 1)) ||
+                        (dr == 1 && (dc == 0 || dc == -1));
+  direction = (dr + 1) * 3 + (dc + 1);
+  return adjacent;
+}
+
+void Estimator::SpatialMatches(size_t b, size_t e, Matches &matches) const
+{
+  for (size_t i = b; i + MIN_MATCH <= e; i++) {
+    size_t j = i + 1, turns = 0, shifted = 0;
+    int direction, lastDirection = -1;
+    if (m_s[i] < 128 && m_t.keys[m_s[i]].shifted)
+      shifted++;
+    for (; j < e && Adjacent(m_s[j - 1], m_s[j], direction); j++) {
+      if (direction != lastDirection) {
+        turns++;
+        lastDirection = direction;
+      }
+      if (m_t.keys[m_s[j]].shifted)
+        shifted++;
+    }
+
+    const size_t len = j - i;
+    if (len < MIN_MATCH)
+      continue;
+    // Every possible walk of this length with as many turns
+    double guesses = 0;
+    for (size_t k = 2; k <= len; k++)
+      for (size_t t = 1; t <= std::min(turns, k - 1); t++)
+        guesses += Binomial(k - 1, t - 1) * KEY_STARTING_POSITIONS *
+                   std::pow(KEY_AVERAGE_DEGREE, double(t));
+    if (shifted > 0) {
+      const size_t unshifted = len - shifted;
+      if (unshifted == 0) {
+        guesses *= 2;
+      } else {
+        double variations = 0;
+        for (size_t k = 1; k <= std::min(shifted, unshifted); k++)
+          variations += Binomial(len, k);
+        guesses *= variations;
+      }
+    }
+    AddMatch(matches, i, j, guesses);
+  }
+}
+
+void Estimator::SequenceMatches(size_t b, size_t e, Matches &matches) const
+{
+  auto charClass = [](unsigned char c) {
+    return IsLower(c) ? 1 : IsUpper(c) ? 2 : IsDigit(c) ? 3 : 0;
+  };
+  for (size_t i = b; i + MIN_MATCH <= e; i++) {
+    const int cls = charClass(m_s[i]);
+    if (cls == 0 || charClass(m_s[i + 1]) != cls)
+      continue;
+    const int delta = int(m_s[i + 1]) - int(m_s[i]);
+    if (delta == 0 || delta > 5 || delta < -5)
+      continue;
+    size_t j = i + 2;
+    while (j < e && charClass(m_s[j]) == cls && int(m_s[j]) - int(m_s[j - 1]) == delta)
+      j++;
+    if (j - i < MIN_MATCH)
+      continue;
+
+    // Sequences starting at the obvious places are tried first
+    double base;
+    if (std::strchr("aAzZ019", m_s[i]) != nullptr)
+      base = 4;
+    else
+      base = cls == 3 ? 10 : 26;
+    AddMatch(matches, i, j, base * double(j - i) * (delta < 0 ? 2 : 1));
+  }
+}
+
+void Estimator::RepeatMatches(size_t b, size_t e, Matches &matches) const
+{
+  // The shortest repeated unit starting at each position. A repeat costs
+  // what its unit does, plus the number of times it's repeated.
+  for (size_t i = b; i + 2 <= e; i++) {
+    for (size_t unit = 1; i + 2 * unit <= e; unit++) {
+      if (!std::equal(m_orig + i, m_orig + i + unit, m_orig + i + unit))
+        continue;
+      size_t count = 2;
+      while (i + (count + 1) * unit <= e &&
+             std::equal(m_orig + i, m_orig + i + unit, m_orig + i + count * unit))
+        count++;
+      if (count * unit >= MIN_MATCH)
+        matches.push_back(Match{i, i + count * unit,
+                                Bits(i, i + unit) + std::log2(double(count))});
+      break;
+    }
+  }
+}
+
+void Estimator::YearMatches(size_t b, size_t e, Matches &matches) const
+{
+  const int MIN_YEAR_SPACE = 20;
+  for (size_t i = b; i + 4 <= e; i++) {
+    if (!IsDigit(m_s[i]) || !IsDigit(m_s[i + 1]) || !IsDigit(m_s[i + 2]) || !IsDigit(m_s[i + 3]))
+      continue;
+    const int year = (m_s[i] - '0') * 1000 + (m_s[i + 1] - '0') * 100 +
+                     (m_s[i + 2] - '0') * 10 + (m_s[i + 3] - '0');
+    if (year >= 1900 && year <= 2099)
+      AddMatch(matches, i, i + 4, std::max(std::abs(year - m_t.currentYear), MIN_YEAR_SPACE));
+  }
+}
+} // namespace
+
+void PasswordStrength::Preload()
+{
+  GetTables();
+}
+
+double PasswordStrength::Estimate(const StringX &password)
+{
+  const size_t length = password.length();
+  if (length == 0)
+    return 0.0;
+
+  std::vector<unsigned char> s(length);
+  for (size_t i = 0; i < length; i++) {
+    const charT c = password[i];
+    s[i] = (c > 0 && c < 128) ? static_cast<unsigned char>(c) : NON_ASCII;
+  }
+
+  const Estimator estimator(GetTables(), s.data(), password.c_str());
+  double bits = 0;
+  // A long password that's a short one over and over again is as weak as
+  // the short one, however often it's repeated
+  size_t period = 1;
+  if (length > MAX_ANALYSED) {
+    for (; period <= MAX_ANALYSED; period++) {
+      size_t i = period;
+      while (i < length && password[i] == password[i - period])
+        i++;
+      if (i == length)
+        break;
+    }
+  }
+  if (length > MAX_ANALYSED && period <= MAX_ANALYSED) {
+    bits = estimator.Bits(0, period) + std::log2(double(length) / double(period));
+  } else {
+    for (size_t b = 0; b < length && bits < MAX_STRENGTH; b += MAX_ANALYSED)
+      bits += estimator.Bits(b, std::min(b + MAX_ANALYSED, length));
+  }
+
+  trashMemory(s.data(), s.size());
+  return std::min(bits, MAX_STRENGTH);
+}
+
+void WeakPasswords::Update(const CItemData &ci)
+{
+  if (!ci.IsAlias() && !ci.IsShortcut() &&
+      PasswordStrength::Estimate(ci.GetPassword()) < m_minStrength)
+    m_weak.insert(ci.GetUUID());
+  else
+    m_weak.erase(ci.GetUUID());
+}
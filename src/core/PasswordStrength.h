@@ -0,0 +1,72 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// PasswordStrength.h
+//-----------------------------------------------------------------------------
+
+#ifndef __PASSWORDSTRENGTH_H
+#define __PASSWORDSTRENGTH_H
+
+#include "StringX.h"
+#include "ItemData.h"
+#include "../os/UUID.h"
+
+#include <set>
+
+/*
+ * Estimates how hard a password is to guess for an attacker who tries the
+ * usual patterns first, along the lines of zxcvbn: the password is split
+ * into the cheapest sequence of
+ *
+ *  - common passwords and words, also reversed, capitalized or in l33t,
+ *  - keyboard walks ("qwerty", "zxcvbn", "1qaz2wsx"),
+ *  - sequences ("abcd", "9753"),
+ *  - repeats ("aaaa", "abcabc"), priced by what is repeated,
+ *  - years ("1987"),
+ *
+ * and single characters, whose price depends on their class and, for
+ * letters, on how likely they are to follow the previous two in English
+ * (trigram.h), so that pronounceable passwords are weaker than random ones.
+ *
+ * The lookup tables are built once, on first use or by Preload(), after
+ * which Estimate() is thread-safe.
+ */
+class PasswordStrength
+{
+public:
+  // Strength in bits, capped at 100, i.e., on the same scale as
+  // CPasswordCharPool::CalculatePasswordStrength
+  static double Estimate(const StringX &password);
+
+  // Builds the lookup tables now, rather than on the first estimate
+  static void Preload();
+
+  static const double MAX_STRENGTH;
+};
+
+// The entries whose passwords are estimated to be weaker than minStrength.
+// Aliases and shortcuts are left out, since their password is their
+// base's. Fed an entry at a time, e.g., by an EntryVisitTask after a
+// database is read, and then whenever an entry changes.
+class WeakPasswords
+{
+public:
+  explicit WeakPasswords(double minStrength) : m_minStrength(minStrength) {}
+
+  void Update(const CItemData &ci);
+  void Remove(const pws_os::CUUID &uuid) {m_weak.erase(uuid);}
+  void Clear() {m_weak.clear();}
+
+  bool IsWeak(const pws_os::CUUID &uuid) const {return m_weak.find(uuid) != m_weak.end();}
+  size_t GetCount() const {return m_weak.size();}
+
+private:
+  const double m_minStrength;
+  std::set<pws_os::CUUID> m_weak;
+};
+
+#endif /* __PASSWORDSTRENGTH_H */
@@ -2,6 +2,8 @@
 #include "core.h"
 #include "PolicyManager.h"
 
+#include <algorithm>
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // class PolicyManager
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -86,6 +88,43 @@ PSWDPolicyMap PolicyManager::GetPolicies() const
   return m_Policies;
 }
 
+std::map<StringX, StringX> PolicyManager::GetRenamedPolicies() const
+{
+  std::map<StringX, StringX> renamed;
+  
+  for (const auto& command : m_UndoStack) {
+    
+    auto rename = dynamic_cast<const PolicyCommandRename*>(command.get());
+    
+    if (rename == nullptr) {
+      continue;
+    }
+    
+    // A policy may be renamed more than once
+    auto iter = std::find_if(renamed.begin(), renamed.end(),
+      [rename](const std::pair<const StringX, StringX>& names) { return names.second == rename->GetOldName(); }
+    );
+    
+    if (iter != renamed.end()) {
+      iter->second = rename->GetNewName();
+    }
+    else {
+      renamed[rename->GetOldName()] = rename->GetNewName();
+    }
+  }
+  
+  for (auto iter = renamed.begin(); iter != renamed.end();) {
+    if (iter->first == iter->second) {
+      iter = renamed.erase(iter);
+    }
+    else {
+      ++iter;
+    }
+  }
+  
+  return renamed;
+}
+
 PWPolicy PolicyManager::GetPolicy(const stringT& name) const
 {
   return (m_Policies.find(StringX(name.c_str())) == m_Policies.end()) ? GetDefaultPolicy() : m_Policies.at(StringX(name.c_str()));
@@ -53,6 +53,12 @@ public:
    */
   PSWDPolicyMap GetPolicies() const;
   
+  /**
+   * Provides the policies renamed so far, as original name to current name,
+   * e.g., to reassign the entries using them.
+   */
+  std::map<StringX, StringX> GetRenamedPolicies() const;
+  
   /**
    * Provides a policy with the given name from the internal collection of policies.
    * 
@@ -66,7 +66,7 @@ void FindMatches(const StringX& searchText, bool fCaseSensitive,
     }
 
     if (!found && bsFields.test(CItemData::PWHIST)) {
-      PWHistList pwhistlist(afn(itr).GetPWHistory(), PWSUtil::TMC_XML);
+      PWHistList pwhistlist(afn(itr).GetPWHistoryList(PWSUtil::TMC_XML));
       for (PWHistList::iterator iter = pwhistlist.begin(); iter != pwhistlist.end(); iter++) {
         PWHistEntry pwshe = *iter;
         found = fCaseSensitive ? pwshe.password.find(searchText) != StringX::npos : FindNoCase(searchText, pwshe.password );
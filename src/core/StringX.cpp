@@ -9,9 +9,13 @@
 #include <ctype.h>
 #include <string.h>
 #include <cstdarg>
+#include <cstdint>
+#include <mutex>
+#include <new>
 #include "StringX.h"
 #include "Util.h"
 #include "os/pws_str.h"
+#include "os/mem.h"
 
 #include "os/pws_tchar.h"
 
@@ -20,6 +24,116 @@
 #include "core_st.h"
 #endif
 
+// SecureAlloc storage
+//
+// Most StringX and VectorX buffers are small and short-lived (field
+// getters, lower-cased copies for searching, etc.). Rather than a
+// malloc/free round trip for each of them, blocks up to the largest size
+// class are carved out of slabs of locked pages and recycled via per-class
+// free lists. Each block is wiped once, when it's freed, so recycled
+// blocks never hold stale data. Slabs are kept for the life of the process.
+namespace {
+  const size_t SizeClasses[] = {32, 64, 128, 256, 512}; // bytes
+  const size_t NumSizeClasses = NumberOf(SizeClasses);
+  const size_t PageSize = 4096;
+  const size_t SlabSize = 4 * PageSize;
+
+  class SecurePool
+  {
+  public:
+    static SecurePool &Instance()
+    {
+      // Deliberately never destroyed: static StringX objects may be
+      // freed after this would have been
+      static SecurePool *pool = new SecurePool;
+      return *pool;
+    }
+
+    // Index of smallest class that fits nbytes, or -1 if too large
+    static int SizeClass(size_t nbytes)
+    {
+      for (size_t i = 0; i < NumSizeClasses; i++)
+        if (nbytes <= SizeClasses[i])
+          return static_cast<int>(i);
+      return -1;
+    }
+
+    void *Allocate(int sc)
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      if (m_free[sc] == nullptr && !AddSlab(sc))
+        return nullptr;
+      FreeBlock *block = m_free[sc];
+      m_free[sc] = block->next;
+      block->next = nullptr;
+      return block;
+    }
+
+    void Deallocate(void *p, int sc)
+    {
+      FreeBlock *block = static_cast<FreeBlock *>(p);
+      std::lock_guard<std::mutex> guard(m_mutex);
+      block->next = m_free[sc];
+      m_free[sc] = block;
+    }
+
+  private:
+    struct FreeBlock { FreeBlock *next; };
+
+    SecurePool() : m_free{} {}
+
+    bool AddSlab(int sc)
+    {
+      unsigned char *raw = static_cast<unsigned char *>(std::malloc(SlabSize + PageSize));
+      if (raw == nullptr)
+        return false;
+      m_slabs.push_back(raw);
+
+      // Page-align, so that locking the slab doesn't lock (or later
+      // get unlocked along with) anyone else's memory. Locking may fail
+      // if we're over the user's limit, in which case we still get the
+      // pooling, but not the swap protection, same as plain malloc.
+      unsigned char *slab = raw + (PageSize - reinterpret_cast<uintptr_t>(raw) % PageSize);
+      pws_os::mlock(slab, SlabSize);
+
+      const size_t size = SizeClasses[sc];
+      for (size_t offset = SlabSize; offset >= size; offset -= size) {
+        FreeBlock *block = reinterpret_cast<FreeBlock *>(slab + offset - size);
+        block->next = m_free[sc];
+        m_free[sc] = block;
+      }
+      return true;
+    }
+
+    std::mutex m_mutex;
+    FreeBlock *m_free[NumSizeClasses];
+    std::vector<unsigned char *> m_slabs;
+  };
+} // anonymous namespace
+
+void *S_Alloc::SecureAllocate(size_t nbytes)
+{
+  const int sc = SecurePool::SizeClass(nbytes);
+  void *p = (sc >= 0) ? SecurePool::Instance().Allocate(sc) : std::malloc(nbytes);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void S_Alloc::SecureDeallocate(void *p, size_t nbytes)
+{
+  if (p == nullptr)
+    return;
+
+  wipeMemory(p, nbytes);
+
+  const int sc = SecurePool::SizeClass(nbytes);
+  if (sc >= 0)
+    SecurePool::Instance().Deallocate(p, sc);
+  else
+    std::free(p);
+}
+
 // A few convenience functions for StringX & stringT
 
 template<class T> int CompareNoCase(const T &s1, const T &s2)
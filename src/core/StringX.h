@@ -36,6 +36,12 @@ extern void trashMemory(void *buffer, size_t length);
 
 namespace S_Alloc
 {
+  // Raw storage for SecureAlloc, implemented in StringX.cpp.
+  // Small blocks come from a pool of locked (non-swappable) pages and are
+  // reused; every block is scrubbed when it's freed.
+  void *SecureAllocate(size_t nbytes);
+  void SecureDeallocate(void *p, size_t nbytes);
+
   template <typename T>
     class SecureAlloc
     {
@@ -98,35 +104,19 @@ namespace S_Alloc
       // Allocate raw memory
       pointer allocate(size_type n, const_pointer hint = nullptr) {
         UNREFERENCED_PARAMETER(hint);
-        pointer p = static_cast<pointer>(std::malloc(n * sizeof(T)));
-        if (p == nullptr)
-          throw std::bad_alloc();
-        return p;
+        return static_cast<pointer>(SecureAllocate(n * sizeof(T)));
       }
 
-#ifdef _WIN32
-#pragma optimize("", off)
-#endif
-      // Free raw memory.
+      // Scrub and free raw memory.
       // Note that C++ standard defines this function as:
       //   deallocate(pointer p, size_type n).
       void deallocate(pointer p, size_type n) {
         // assert(p != nullptr);
         // The standard states that p must not be nullptr. However, some
         // STL implementations fail this requirement, so the check must
-        // be made here.
-        if (p == nullptr)
-          return;
-
-        if (n > 0) {
-          const size_type N = n * sizeof(T);
-          trashMemory(static_cast<void *>(p), N);
-        }
-        std::free(p);
+        // be made (in SecureDeallocate).
+        SecureDeallocate(static_cast<void *>(p), n * sizeof(T));
       }
-#ifdef _WIN32
-#pragma optimize("", on)
-#endif
 
     private:
       // No data
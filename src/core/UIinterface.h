@@ -12,6 +12,31 @@
 #include "ItemData.h"
 
 #include <algorithm>
+#include <vector>
+
+// A GUI update held back by an open PWScore::Transaction, to be delivered
+// with the others by Observer::UpdateGUIBatch when it is committed
+struct GUIUpdate
+{
+  GUIUpdate(UpdateGUICommand::GUI_Action ga_, const pws_os::CUUID &entry_uuid_,
+            CItemData::FieldType ft_)
+    : ga(ga_), entry_uuid(entry_uuid_), ft(ft_), bGroups(false) {}
+  GUIUpdate(UpdateGUICommand::GUI_Action ga_, const std::vector<StringX> &vGroups_)
+    : ga(ga_), entry_uuid(pws_os::CUUID::NullUUID()), ft(CItemData::START),
+      vGroups(vGroups_), bGroups(true) {}
+
+  bool operator==(const GUIUpdate &that) const
+  {
+    return ga == that.ga && entry_uuid == that.entry_uuid && ft == that.ft &&
+      vGroups == that.vGroups && bGroups == that.bGroups;
+  }
+
+  UpdateGUICommand::GUI_Action ga;
+  pws_os::CUUID entry_uuid;
+  CItemData::FieldType ft;
+  std::vector<StringX> vGroups;
+  bool bGroups; // which UpdateGUI this is for
+};
 
 /**
  * An abstract base class representing all of the UI functionality
@@ -45,6 +70,18 @@ public:
   virtual void UpdateGUI(UpdateGUICommand::GUI_Action /* ga */,
                          const std::vector<StringX> &/* vGroups */) {}
 
+  // UpdateGUIBatch: all the updates of a committed PWScore::Transaction,
+  // in order. By default, they're passed on one at a time.
+  virtual void UpdateGUIBatch(const std::vector<GUIUpdate> &updates)
+  {
+    for (const auto &update : updates) {
+      if (update.bGroups)
+        UpdateGUI(update.ga, update.vGroups);
+      else
+        UpdateGUI(update.ga, update.entry_uuid, update.ft);
+    }
+  }
+
   // GUIRefreshEntry: called when the entry's graphic representation
   // may have changed - GUI should update and invalidate its display.
   virtual void GUIRefreshEntry(const CItemData &/* ci */, bool /* bAllowFail */ = false) {}
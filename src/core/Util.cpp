@@ -37,6 +37,7 @@
 #include <iomanip>
 
 #include <cerrno>
+#include <cstring>
 
 using namespace std;
 
@@ -106,6 +107,20 @@ void trashMemory(LPTSTR buffer, size_t length)
   trashMemory(reinterpret_cast<unsigned char *>(buffer), length * sizeof(buffer[0]));
 }
 
+// Single pass scrub, for hot paths such as SecureAlloc::deallocate
+void wipeMemory(void *buffer, size_t length)
+{
+  if (buffer == nullptr || length == 0)
+    return;
+
+#if (defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 25))) || \
+    defined(__OpenBSD__) || defined(__FreeBSD__)
+  explicit_bzero(buffer, length);
+#else
+  secure_zero(buffer, length);
+#endif
+}
+
 /**
 Burn some stack memory
 @param len amount of stack to burn in bytes
@@ -43,6 +43,7 @@ class CUTF8Conv;
 
 extern void trashMemory(void *buffer, size_t length);
 extern void trashMemory(LPTSTR buffer, size_t length);
+extern void wipeMemory(void *buffer, size_t length);
 extern void burnStack(unsigned long len); // borrowed from libtomcrypt
 
 extern void ConvertPasskey(const StringX &text,
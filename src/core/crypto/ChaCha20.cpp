@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+ * All rights reserved. Use of the code is allowed under the
+ * Artistic License 2.0 terms, as specified in the LICENSE file
+ * distributed with this code, or available from
+ * http://www.opensource.org/licenses/artistic-license-2.0.php
+ */
+// ChaCha20.cpp
+// Straightforward portable implementation of the RFC 8439 block function.
+//-----------------------------------------------------------------------------
+#include "ChaCha20.h"
+#include "../Util.h"
+
+#include <algorithm>
+
+namespace {
+  inline uint32 rotl32(uint32 x, int n)
+  {
+    return (x << n) | (x >> (32 - n));
+  }
+
+  inline uint32 load32_le(const unsigned char *p)
+  {
+    return uint32(p[0]) | (uint32(p[1]) << 8) |
+      (uint32(p[2]) << 16) | (uint32(p[3]) << 24);
+  }
+
+  inline void store32_le(unsigned char *p, uint32 v)
+  {
+    p[0] = static_cast<unsigned char>(v);
+    p[1] = static_cast<unsigned char>(v >> 8);
+    p[2] = static_cast<unsigned char>(v >> 16);
+    p[3] = static_cast<unsigned char>(v >> 24);
+  }
+
+  inline void quarter_round(uint32 &a, uint32 &b, uint32 &c, uint32 &d)
+  {
+    a += b; d ^= a; d = rotl32(d, 16);
+    c += d; b ^= c; b = rotl32(b, 12);
+    a += b; d ^= a; d = rotl32(d, 8);
+    c += d; b ^= c; b = rotl32(b, 7);
+  }
+} // anonymous namespace
+
+ChaCha20::ChaCha20(const unsigned char key[KEYLEN],
+                   const unsigned char nonce[NONCELEN], uint32 counter)
+  : block{}, blockpos(BLOCKSIZE)
+{
+  // "expand 32-byte k"
+  state[0] = 0x61707865; state[1] = 0x3320646e;
+  state[2] = 0x79622d32; state[3] = 0x6b206574;
+  for (int i = 0; i < 8; i++)
+    state[4 + i] = load32_le(key + 4 * i);
+  state[12] = counter;
+  for (int i = 0; i < 3; i++)
+    state[13 + i] = load32_le(nonce + 4 * i);
+}
+
+ChaCha20::~ChaCha20()
+{
+  trashMemory(state, sizeof(state));
+  trashMemory(block, sizeof(block));
+}
+
+void ChaCha20::NextBlock()
+{
+  uint32 x[16];
+  std::copy(state, state + 16, x);
+
+  for (int i = 0; i < 10; i++) {
+    // column rounds
+    quarter_round(x[0], x[4], x[8],  x[12]);
+    quarter_round(x[1], x[5], x[9],  x[13]);
+    quarter_round(x[2], x[6], x[10], x[14]);
+    quarter_round(x[3], x[7], x[11], x[15]);
+    // diagonal rounds
+    quarter_round(x[0], x[5], x[10], x[15]);
+    quarter_round(x[1], x[6], x[11], x[12]);
+    quarter_round(x[2], x[7], x[8],  x[13]);
+    quarter_round(x[3], x[4], x[9],  x[14]);
+  }
+
+  for (int i = 0; i < 16; i++)
+    store32_le(block + 4 * i, x[i] + state[i]);
+
+  trashMemory(x, sizeof(x));
+  state[12]++; // block counter
+  blockpos = 0;
+}
+
+void ChaCha20::Keystream(unsigned char *out, size_t len)
+{
+  while (len > 0) {
+    if (blockpos == BLOCKSIZE)
+      NextBlock();
+    size_t n = std::min(len, size_t(BLOCKSIZE - blockpos));
+    std::copy(block + blockpos, block + blockpos + n, out);
+    blockpos += static_cast<unsigned int>(n);
+    out += n;
+    len -= n;
+  }
+}
+
+void ChaCha20::Process(const unsigned char *in, unsigned char *out, size_t len)
+{
+  while (len > 0) {
+    if (blockpos == BLOCKSIZE)
+      NextBlock();
+    size_t n = std::min(len, size_t(BLOCKSIZE - blockpos));
+    for (size_t i = 0; i < n; i++)
+      out[i] = in[i] ^ block[blockpos + i];
+    blockpos += static_cast<unsigned int>(n);
+    in += n;
+    out += n;
+    len -= n;
+  }
+}
@@ -0,0 +1,46 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// ChaCha20.h
+// ChaCha20 stream cipher (RFC 8439), used as the keystream generator
+// behind PWSrand.
+//-----------------------------------------------------------------------------
+#ifndef __CHACHA20_H
+#define __CHACHA20_H
+
+#include "../../os/typedefs.h"
+#include "../PwsPlatform.h"
+
+class ChaCha20
+{
+public:
+  static const unsigned int KEYLEN = 32;
+  static const unsigned int NONCELEN = 12;
+  static const unsigned int BLOCKSIZE = 64;
+
+  ChaCha20(const unsigned char key[KEYLEN], const unsigned char nonce[NONCELEN],
+           uint32 counter = 0);
+  ~ChaCha20();
+
+  // Write len bytes of raw keystream to out
+  void Keystream(unsigned char *out, size_t len);
+  // out = in XOR keystream; in and out may be the same buffer
+  void Process(const unsigned char *in, unsigned char *out, size_t len);
+
+private:
+  void NextBlock();
+
+  uint32 state[16];
+  unsigned char block[BLOCKSIZE];
+  unsigned int blockpos;
+};
+
+#endif /* __CHACHA20_H */
+//-----------------------------------------------------------------------------
+// Local variables:
+// mode: c++
+// End:
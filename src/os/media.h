@@ -15,7 +15,7 @@ namespace pws_os {
   /**
   * Windows: Get Media Type from OS using FindMimeFromData
   *
-  * Linux: Uses gio library? UNTESTED
+  * Linux: libmagic, with one handle loaded per process
   */
   stringT GetMediaType(const stringT &sfilename);
 };
@@ -111,8 +111,9 @@ bool CKeySend::IsEmulatingMods() const
   return m_impl->IsEmulatingMods();
 }
 
-void CKeySend::SendVirtualKey(WORD, bool, bool, bool)
+void CKeySend::SendVirtualKey(WORD wVK, bool bAlt, bool bCtrl, bool bShift)
 {
+  m_impl->SendVirtualKey(wVK, bAlt, bCtrl, bShift, m_delayMS);
 }
 
 void CKeySend::SetOldSendMethod(bool)
@@ -253,6 +253,7 @@ static stringT GetLockFileName(const stringT &filename)
  */
 void pws_os::TryUnlockFile(const stringT &filename, HANDLE &lockFileHandle)
 {
+  UNREFERENCED_PARAMETER(lockFileHandle);
   const stringT lockFilename = GetLockFileName(filename);
 
   size_t mbsSize = wcstombs(nullptr, lockFilename.c_str(), lockFilename.length()) + 1;
@@ -278,7 +279,9 @@ void pws_os::TryUnlockFile(const stringT &filename, HANDLE &lockFileHandle)
           (plkHost == pws_os::gethostname()) &&                             // at the same machine...
           (pws_os::processExists(plkPid) == ProcessCheckResult::NOT_FOUND)  // with a newly started application instance?
         ) {
-          UnlockFile(filename, lockFileHandle);
+          // Don't pass lockFileHandle - that's for the lock we're about to take
+          HANDLE staleHandle = INVALID_HANDLE_VALUE;
+          UnlockFile(filename, staleHandle);
           pws_os::Trace(
             L"Orphan .plk file (%ls) removed of user= %ls @ host= %ls and process= %d", 
             lockFilename.c_str(), plkUser.c_str(), plkHost.c_str(), plkPid
@@ -291,12 +294,163 @@ void pws_os::TryUnlockFile(const stringT &filename, HANDLE &lockFileHandle)
   }
 }
 
+// Appended to the locker data of a lock file held by an OFD lock (see
+// OFDLockFile), which is how we know such a file is stale once nobody holds
+// the lock. Anything reading the pid ignores what follows it.
+static const stringT OFD_LOCK_MARKER(_T(";ofd"));
+
+static stringT GetLockerString()
+{
+  const stringT user = pws_os::getusername();
+  const stringT host = pws_os::gethostname();
+  const stringT pid = pws_os::getprocessid();
+
+  return user + _T("@") + host + _T(":") + pid;
+}
+
+static void ReadLocker(const stringT &lock_filename, stringT &locker,
+                       bool *pbOFDLock = nullptr)
+{
+  if (pbOFDLock != nullptr)
+    *pbOFDLock = false;
+
+  // read locker data ("user@machine:nnnnnnnn") from file
+  StringXStream lockerStream;
+  if (PWSUtil::loadFile(lock_filename.c_str(), lockerStream)) {
+    locker = stringx2std(lockerStream.str());
+
+    const size_t markerPos = locker.length() >= OFD_LOCK_MARKER.length() ?
+      locker.length() - OFD_LOCK_MARKER.length() : stringT::npos;
+    if (markerPos != stringT::npos && locker.compare(markerPos, stringT::npos, OFD_LOCK_MARKER) == 0) {
+      locker.erase(markerPos);
+      if (pbOFDLock != nullptr)
+        *pbOFDLock = true;
+    }
+
+    if (!PWSUtil::HasValidLockerData(locker)) {
+      locker = _T("");
+      Format(locker, IDSC_INVALIDLOCKER, lock_filename.c_str());
+    }
+  }
+  else {
+    LoadAString(locker, IDSC_CANTREADLOCKER);
+  }
+}
+
+#ifdef F_OFD_SETLK
+/*
+ * Where supported, the lock is an open file description (OFD) lock on the
+ * .plk file, held via lockFileHandle for as long as the database is open.
+ * The kernel (or the NFS/SMB server) releases it when the process dies, so
+ * there are no stale locks to clean up, and the locker data written into the
+ * file is only there to tell others who has it.
+ * Unlike classic POSIX record locks, OFD locks aren't dropped when some other
+ * descriptor for the same file is closed by this process, e.g., when the
+ * locker data is read back, or the prefs/lock code re-opens it.
+ */
+enum class OFDLockResult { LOCKED, HELD_BY_OTHER, UNSUPPORTED };
+
+static OFDLockResult OFDLockFile(const char *lfn, const stringT &lock_filename,
+                                 stringT &locker, HANDLE &lockFileHandle)
+{
+  // Retry if we lose the race against an unlocker, see below
+  for (int attempt = 0; attempt < 3; attempt++) {
+    bool created = true;
+    int fd = open(lfn, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, (S_IREAD | S_IWRITE));
+    if (fd == -1 && errno == EEXIST) {
+      created = false;
+      fd = open(lfn, O_RDWR | O_CLOEXEC);
+    }
+    if (fd == -1)
+      return OFDLockResult::UNSUPPORTED; // let the O_EXCL code report why
+
+    struct flock fl = {};
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET; // l_start = l_len = 0: whole file
+    if (fcntl(fd, F_OFD_SETLK, &fl) == -1) {
+      const int err = errno;
+      close(fd);
+      if (err == EAGAIN || err == EACCES) {
+        ReadLocker(lock_filename, locker);
+        return OFDLockResult::HELD_BY_OTHER;
+      }
+      // e.g., EINVAL - filesystem or kernel doesn't support OFD locks
+      if (created)
+        unlink(lfn);
+      return OFDLockResult::UNSUPPORTED;
+    }
+
+    // The previous owner unlinks the file before closing its descriptor, so
+    // we may have locked a file that's no longer the lock file. Only a lock
+    // on the file that's still at lfn counts.
+    struct stat fst, pst;
+    if (fstat(fd, &fst) != 0 || stat(lfn, &pst) != 0 ||
+        fst.st_dev != pst.st_dev || fst.st_ino != pst.st_ino) {
+      close(fd);
+      continue;
+    }
+
+    if (!created) {
+      // An existing file that nobody holds an OFD lock on is either stale,
+      // or belongs to an older version that locks by file existence only.
+      // One we wrote with an OFD lock (it has the marker) is stale, whoever
+      // and wherever its locker was: e.g., left on a share by a crashed
+      // instance on another host. Otherwise, only take it over when it's
+      // provably ours and stale, same as TryUnlockFile does, and report the
+      // locker, so the user gets to decide (e.g., via "Remove Lock?").
+      stringT oldLocker, plkUser, plkHost;
+      int plkPid = -1;
+      bool bOFDLock = false;
+      ReadLocker(lock_filename, oldLocker, &bOFDLock);
+      if (!bOFDLock &&
+          (!PWSUtil::GetLockerData(oldLocker, plkUser, plkHost, plkPid) ||
+          plkUser != pws_os::getusername() ||
+          plkHost != pws_os::gethostname() ||
+          (plkPid != getpid() &&
+           pws_os::processExists(plkPid) != pws_os::ProcessCheckResult::NOT_FOUND))) {
+        close(fd);
+        locker = oldLocker;
+        return OFDLockResult::HELD_BY_OTHER;
+      }
+    }
+
+    const stringT lockStr = GetLockerString() + OFD_LOCK_MARKER;
+    const size_t len = lockStr.length() * sizeof(TCHAR);
+    if (ftruncate(fd, 0) != 0 ||
+        pwrite(fd, lockStr.c_str(), len, 0) != static_cast<ssize_t>(len)) {
+      close(fd);
+      unlink(lfn);
+      LoadAString(locker, IDSC_SYSTEMLOCKERROR);
+      return OFDLockResult::HELD_BY_OTHER;
+    }
+
+    lockFileHandle = fd;
+    return OFDLockResult::LOCKED;
+  }
+  return OFDLockResult::UNSUPPORTED;
+}
+#endif /* F_OFD_SETLK */
+
 bool pws_os::LockFile(const stringT &filename, stringT &locker,
                       HANDLE &lockFileHandle)
 {
-  UNREFERENCED_PARAMETER(lockFileHandle);
   const stringT lock_filename = GetLockFileName(filename);
 
+  size_t lfs = wcstombs(nullptr, lock_filename.c_str(), lock_filename.length()) + 1;
+  std::unique_ptr<char[]> lfn(new char[lfs]);
+  wcstombs(lfn.get(), lock_filename.c_str(), lfs);
+
+#ifdef F_OFD_SETLK
+  switch (OFDLockFile(lfn.get(), lock_filename, locker, lockFileHandle)) {
+    case OFDLockResult::LOCKED:
+      return true;
+    case OFDLockResult::HELD_BY_OTHER:
+      return false;
+    case OFDLockResult::UNSUPPORTED:
+      break; // fall back to locking by exclusive creation
+  }
+#endif
+
   // If there is a matching plk file to the database (filename) 
   // we will try to remove it if it meets the criteria for removal.
   if (pws_os::IsLockedFile(filename)) {
@@ -304,10 +458,7 @@ bool pws_os::LockFile(const stringT &filename, stringT &locker,
   }
   
   bool retval = false;
-  size_t lfs = wcstombs(nullptr, lock_filename.c_str(), lock_filename.length()) + 1;
-  char *lfn = new char[lfs];
-  wcstombs(lfn, lock_filename.c_str(), lfs);
-  int fh = open(lfn, (O_CREAT | O_EXCL | O_WRONLY),
+  int fh = open(lfn.get(), (O_CREAT | O_EXCL | O_WRONLY),
                  (S_IREAD | S_IWRITE));
 
   if (fh == -1) { // failed to open exclusively. Already locked, or ???
@@ -318,22 +469,8 @@ bool pws_os::LockFile(const stringT &filename, stringT &locker,
         LoadAString(locker, IDSC_NOLOCKACCESS);
       break;
     case EEXIST: // filename already exists
-      {
-        // read locker data ("user@machine:nnnnnnnn") from file
-        StringXStream lockerStream;
-        if (PWSUtil::loadFile(lock_filename.c_str(), lockerStream)) {
-          locker = stringx2std(lockerStream.str());
-
-          if (!PWSUtil::HasValidLockerData(locker)) {
-            locker = _T("");
-            Format(locker, IDSC_INVALIDLOCKER, lock_filename.c_str());
-          }
-        }
-        else {
-          LoadAString(locker, IDSC_CANTREADLOCKER);
-        }
-      } // EEXIST block
-        break;
+      ReadLocker(lock_filename, locker);
+      break;
     case EINVAL: // Invalid oflag or pmode argument
       LoadAString(locker, IDSC_INTERNALLOCKERROR);
       break;
@@ -350,11 +487,7 @@ bool pws_os::LockFile(const stringT &filename, stringT &locker,
     retval = false;
   } else { // valid filehandle, write our info
     ssize_t numWrit;
-    const stringT user = pws_os::getusername();
-    const stringT host = pws_os::gethostname();
-    const stringT pid = pws_os::getprocessid();
-
-    const stringT lockStr = user + _T("@") + host + _T(":") + pid;
+    const stringT lockStr = GetLockerString();
 
     numWrit = write(fh, lockStr.c_str(),
                     lockStr.length() * sizeof(TCHAR));
@@ -362,19 +495,24 @@ bool pws_os::LockFile(const stringT &filename, stringT &locker,
     close(fh);
     retval = (numWrit > 0);
   }
-  delete[] lfn;
   return retval;
 }
 
 void pws_os::UnlockFile(const stringT &filename, HANDLE &lockFileHandle)
 {
-  UNREFERENCED_PARAMETER(lockFileHandle);
   stringT lock_filename = GetLockFileName(filename);
   size_t lfs = wcstombs(nullptr, lock_filename.c_str(), lock_filename.length()) + 1;
   char *lfn = new char[lfs];
   wcstombs(lfn, lock_filename.c_str(), lfs);
   unlink(lfn);
   delete[] lfn;
+
+  // Closing the descriptor releases the OFD lock, if that's what we hold.
+  // Unlinking first means no-one can take the lock on the old file.
+  if (lockFileHandle != INVALID_HANDLE_VALUE) {
+    close(lockFileHandle);
+    lockFileHandle = INVALID_HANDLE_VALUE;
+  }
 }
 
 bool pws_os::IsLockedFile(const stringT &filename)
@@ -16,40 +16,75 @@
 
 #include <magic.h>
 
+#include <mutex>
+
 using namespace std;
 
-stringT pws_os::GetMediaType(const stringT &sfilename) {
-    /**
-     * Using libmagic instead of external 'file' command
-     */
+/*
+ * magic_load() parses the whole magic database, which costs far more than
+ * checking a file, so one handle is opened on first use and kept for the
+ * life of the process. libmagic handles aren't thread-safe, hence the mutex.
+ */
+namespace {
+  class MagicHandle {
+  public:
+    static MagicHandle &Instance() {
+      static MagicHandle instance;
+      return instance;
+    }
 
-    if (!pws_os::FileExists(sfilename))
+    std::mutex &Mutex() {return m_mutex;}
+
+    // Call with Mutex() held
+    stringT GetMediaType(const stringT &sfilename) {
+      if (m_cookie == nullptr || !pws_os::FileExists(sfilename))
         return _T("unknown");
 
-    const char *smimeType;
-    magic_t magic_cookie;
-    stringT wcmimeType;
+      const char *smimeType = magic_file(m_cookie, pws_os::tomb(sfilename).c_str());
+      if (smimeType == nullptr) {
+        pws_os::Trace(L"GetMediaType - libmagic error - %s", magic_error(m_cookie));
+        return _T("unknown");
+      }
+      // Copy now, since the result is only valid until the next libmagic call
+      return pws_os::towc(smimeType);
+    }
 
-    //MAGIC_MIME_TYPE -> return mime type of the file
-    magic_cookie = magic_open(MAGIC_MIME_TYPE);
+  private:
+    MagicHandle() {
+      //MAGIC_MIME_TYPE -> return mime type of the file
+      m_cookie = magic_open(MAGIC_MIME_TYPE);
 
-    if (magic_cookie == nullptr) {
+      if (m_cookie == nullptr) {
         pws_os::Trace(L"GetMediaType - Error during libmagic initialization");
-        return _T("unknown");
+        return;
+      }
+
+      //Load default magic db
+      if (magic_load(m_cookie, nullptr) != 0) {
+        pws_os::Trace(L"GetMediaType - Cannot load libmagic database - %s", magic_error(m_cookie));
+        magic_close(m_cookie);
+        m_cookie = nullptr;
+      }
     }
 
-    //Load default magic db
-    if (magic_load(magic_cookie, nullptr) != 0) {
-        pws_os::Trace(L"GetMediaType - Cannot load libmagic database - %s", magic_error(magic_cookie));
-        magic_close(magic_cookie);
-        return _T("unknown");
+    ~MagicHandle() {
+      if (m_cookie != nullptr)
+        magic_close(m_cookie);
     }
 
-    smimeType = magic_file(magic_cookie, pws_os::tomb(sfilename).c_str());
+    MagicHandle(const MagicHandle &) = delete;
+    MagicHandle &operator=(const MagicHandle &) = delete;
 
-    wcmimeType = pws_os::towc(smimeType);
-    //close at end since result is lost after that
-    magic_close(magic_cookie);
+    magic_t m_cookie = nullptr;
+    std::mutex m_mutex;
+  };
+}
 
-    return wcmimeType;
+stringT pws_os::GetMediaType(const stringT &sfilename) {
+    /**
+     * Using libmagic instead of external 'file' command
+     */
+    MagicHandle &magic = MagicHandle::Instance();
+    std::lock_guard<std::mutex> guard(magic.Mutex());
+    return magic.GetMediaType(sfilename);
 }
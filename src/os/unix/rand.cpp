@@ -15,19 +15,56 @@
 #include <cstring>
 #include <sys/time.h>
 
+#if defined(__linux__) || defined(__FreeBSD__)
+#include <sys/random.h>
+#include <cerrno>
+#define PWS_HAVE_GETRANDOM
+#endif
+
 using namespace std;
 
+#ifdef PWS_HAVE_GETRANDOM
+static bool getrandom_fill(void *p, unsigned long len)
+{
+  // getrandom(2) blocks only until the kernel's pool has been
+  // initialized, after which it never blocks. Requests may be
+  // satisfied partially or interrupted, hence the loop.
+  char *pc = static_cast<char *>(p);
+  while (len > 0) {
+    ssize_t n = getrandom(pc, len, 0);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    pc += n;
+    len -= static_cast<unsigned long>(n);
+  }
+  return true;
+}
+#endif
+
 bool pws_os::InitRandomDataFunction()
 {
-  // For starters, we won't rely on /dev/urandom, only on /dev/random for
+  // We use getrandom(2) where it's available, as it doesn't suffer from
+  // /dev/urandom's early-boot weakness, nor does it need a file descriptor.
+  // Otherwise, we won't rely on /dev/urandom, only on /dev/random for
   // the seed. Returning false indicates this decision.
-  // Perhaps we can check for a hardware rng in future versions, and change
-  // the returned value accordingly?
+#ifdef PWS_HAVE_GETRANDOM
+  char probe;
+  return getrandom_fill(&probe, sizeof(probe));
+#else
   return false;
+#endif
 }
 
 bool pws_os::GetRandomData(void *p, unsigned long len)
 {
+#ifdef PWS_HAVE_GETRANDOM
+  if (getrandom_fill(p, len))
+    return true;
+  // ENOSYS on ancient kernels - fall through to /dev/urandom
+#endif
   // Return data from /dev/urandom
   // Will not be used by PasswordSafe when InitRandomDataFunction()
   // returns false!
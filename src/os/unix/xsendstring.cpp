@@ -34,6 +34,7 @@
 #include <fstream>
 #include <sstream>
 #include <map>
+#include <chrono>
 
 #include <X11/Intrinsic.h> // in libxt-dev
 #include <X11/keysym.h>
@@ -92,14 +93,15 @@ public:
 
 enum class KeyEventType { PRESS, RELEASE };
 
-// A simple helper class
+// A simple helper class. The target window is filled in when the event
+// is sent (see SetFocusWindow), so that events can be built up front, and
+// cached, without a server round trip for each one
 class AutotypeEvent : public XKeyEvent {
 public:
   AutotypeEvent(Display *disp, KeyEventType ktype, int kcode, int kstate,
                 Time ktime = CurrentTime) {
     display = disp;
-    int revert_to;
-    XGetInputFocus(display, &window, &revert_to);
+    window = None;
     subwindow = None;
     x = y = x_root = y_root = 1;
     same_screen = True;
@@ -112,6 +114,19 @@ public:
   bool IsPressed() const { return type == KeyPress; }
 };
 
+// Returns the window that currently has input focus. Queried once per
+// string/select-all rather than once per key event
+static Window GetFocusWindow(Display *disp) {
+  Window focus = None;
+  int revert_to;
+  XGetInputFocus(disp, &focus, &revert_to);
+  return focus;
+}
+
+// With no inter-key delay configured, keystrokes are flushed to the X
+// server in bursts of this many characters rather than one at a time
+static const size_t AUTOTYPE_BURST_CHARS = 32;
+
 // helper method that throws if keysym is not mapped to any KeyCode
 KeyCode KeySymToKeyCode(Display *disp, KeySym sym);
 
@@ -445,19 +460,22 @@ class ModifierFactory {
   };
 
   ModifierCreator<XModPos> m_shift, m_ctrl;
-  ModifierCreator<KeySym> m_mode_switch, m_level3_shift;
+  ModifierCreator<KeySym> m_alt, m_mode_switch, m_level3_shift;
 
 public:
   explicit ModifierFactory(Display *disp)
       : m_display{ disp },
         m_shift{ disp, XModPos{ XModPos::MODMAP_INDEX_SHIFT } },
         m_ctrl{ disp, XModPos{ XModPos::MODMAP_INDEX_CONTROL } },
+        m_alt{ disp, XK_Alt_L },
         m_mode_switch{ disp, XK_Mode_switch },
         m_level3_shift{ disp, XK_ISO_Level3_Shift } {}
 
   std::vector<ModifierKey> GetModifiersForKeySym(KeyCode code, KeySym sym);
 
   ModifierKey Control() { return m_ctrl; }
+  ModifierKey Shift() { return m_shift; }
+  ModifierKey Alt() { return m_alt; }
 };
 
 std::vector<ModifierKey> ModifierFactory::GetModifiersForKeySym(KeyCode code,
@@ -613,6 +631,8 @@ struct wchar2xevent_map_ptr {
   using wchar2event_map =
       std::map<StringX::value_type, std::vector<AutotypeEvent> >;
   wchar2event_map m_map;
+  // the cached sequences depend on whether modifiers are emulated
+  bool m_emulateMods = true;
   wchar2event_map *operator->() { return &m_map; }
 };
 
@@ -652,6 +672,12 @@ void CKeySendImpl::DoSendString(const StringX &str, unsigned delayMS,
   typedef vector<AutotypeEvent> AutotypeEventVector;
   AutotypeEventVector keypresses;
 
+  wchar2xevent_map_ptr &charmap = *m_wcharmap;
+  if (charmap.m_emulateMods != emulateMods) {
+    charmap->clear();
+    charmap.m_emulateMods = emulateMods;
+  }
+
   for (const auto &chr : str) {
 
     // throw away 'vertical tab' chars which are only used on Windows to send a
@@ -660,9 +686,9 @@ void CKeySendImpl::DoSendString(const StringX &str, unsigned delayMS,
 
     using maptype = wchar2xevent_map_ptr::wchar2event_map;
 
-    wchar2xevent_map_ptr &charmap = *m_wcharmap;
+    // Each distinct char is mapped to its keycode & modifiers only once
     maptype::const_iterator itr = charmap->lower_bound(chr);
-    if (itr != charmap->end() && charmap->key_comp()(itr->first, chr)) {
+    if (itr != charmap->end() && !charmap->key_comp()(chr, itr->first)) {
       keypresses.insert(keypresses.end(), itr->second.begin(),
                         itr->second.end());
     } else {
@@ -683,20 +709,39 @@ void CKeySendImpl::DoSendString(const StringX &str, unsigned delayMS,
       charmap->insert(itr,
                       maptype::value_type{ chr, { keypresses.begin() + count,
                                                   keypresses.end() } });
-
-      // hack to know after which keys to sleep
-      keypresses.push_back(AutotypeEvent{ m_display, KeyEventType::PRESS, 0, 0 });
     }
+
+    // hack to know after which keys to sleep
+    keypresses.push_back(AutotypeEvent{ m_display, KeyEventType::PRESS, 0, 0 });
   }
 
+  // The queued events are sent in bursts: a burst of several chars when no
+  // delay is configured, else one char. After each burst we wait for the
+  // server to take the events (XSync) and sleep whatever remains of the
+  // delay, so the delay is the minimum time between chars rather than
+  // something added on top of the round trip.
+  using clock = std::chrono::steady_clock;
+  const Window focus = GetFocusWindow(m_display);
+  const size_t burst = delayMS == 0 ? AUTOTYPE_BURST_CHARS : 1;
+  size_t nchars = 0;
+  clock::time_point burstStart = clock::now();
+
   for (auto k : keypresses) {
     if (k.keycode) {
+      k.window = focus;
       m_method->GenerateKeyEvent(&k);
-    } else {
-      XFlush(m_display);
-      pws_os::sleep_ms(delayMS);
+    } else if (++nchars % burst == 0) {
+      XSync(m_display, False);
+      if (delayMS != 0) {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               clock::now() - burstStart).count();
+        if (elapsed < static_cast<long long>(delayMS))
+          pws_os::sleep_ms(delayMS - static_cast<unsigned>(elapsed));
+        burstStart = clock::now();
+      }
     }
   }
+  XFlush(m_display);
 }
 
 void CKeySendImpl::SendString(const StringX &str, unsigned delayMS) {
@@ -741,7 +786,9 @@ void CKeySendImpl::SelectAll(unsigned delayMS, int code /*= 0*/,
                          modkeys.cend(), m_display, code,
                          m_emulateModsSeparately);
 
+  const Window focus = GetFocusWindow(m_display);
   for (auto k : selectAllEvents) {
+    k.window = focus;
     m_method->GenerateKeyEvent(&k);
   }
   XFlush(m_display);
@@ -749,6 +796,31 @@ void CKeySendImpl::SelectAll(unsigned delayMS, int code /*= 0*/,
   pws_os::sleep_ms(delayMS);
 }
 
+void CKeySendImpl::SendVirtualKey(unsigned keysym, bool bAlt, bool bCtrl,
+                                  bool bShift, unsigned delayMS) {
+  std::vector<ModifierKey> modkeys;
+  if (bAlt)
+    modkeys.push_back( m_modFactory->Alt() );
+  if (bCtrl)
+    modkeys.push_back( m_modFactory->Control() );
+  if (bShift)
+    modkeys.push_back( m_modFactory->Shift() );
+
+  std::vector<AutotypeEvent> keyEvents;
+  SequenceAutotypeEvents(std::back_inserter(keyEvents), modkeys.cbegin(),
+                         modkeys.cend(), m_display,
+                         KeySymToKeyCode(m_display, keysym),
+                         m_emulateModsSeparately);
+
+  const Window focus = GetFocusWindow(m_display);
+  for (auto k : keyEvents) {
+    k.window = focus;
+    m_method->GenerateKeyEvent(&k);
+  }
+  XFlush(m_display);
+  pws_os::sleep_ms(delayMS);
+}
+
 CKeySendImpl::CKeySendImpl(pws_os::AutotypeMethod method)
     : m_display(XOpenDisplay(nullptr)) {
   if (m_display) {
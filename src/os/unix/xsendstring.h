@@ -68,6 +68,10 @@ class CKeySendImpl
     bool IsEmulatingMods() const { return m_emulateModsSeparately; }
     // If code == 0, autotypes Ctrl-A
     void SelectAll(unsigned delayMS, int code = 0, int mask = 0);
+    // Autotypes a KeySym, as returned by CKeySend::LookupVirtualKey,
+    // with the given modifiers held
+    void SendVirtualKey(unsigned keysym, bool bAlt, bool bCtrl, bool bShift,
+                        unsigned delayMS);
 };
 
 #endif
@@ -171,3 +171,32 @@ TEST_F(AliasShortcutTest, Shortcut)
               sc2.GetEffectiveFieldValue(ft, &base));
   }
 }
+
+TEST_F(AliasShortcutTest, ShortcutAutoType)
+{
+  CItemData sc;
+
+  sc.SetTitle(L"shortcut");
+  sc.SetUser(L"sc-user");
+  sc.SetGroup(L"sc-group");
+  sc.SetPassword(L"[Shortcut]");
+  sc.SetShortcut();
+  sc.CreateUUID(); // call after setting to shortcut!
+
+  base.SetAutoType(L"\\i:\\u:\\p:\\v{PIN}:\\o");
+  const pws_os::CUUID base_uuid = base.GetUUID();
+  MultiCommands *pmulticmds = MultiCommands::Create(&core);
+  pmulticmds->Add(AddEntryCommand::Create(&core, base));
+  pmulticmds->Add(AddEntryCommand::Create(&core, sc, base_uuid));
+  core.Execute(pmulticmds);
+
+  const CItemData sc2 = core.GetEntry(core.Find(sc.GetUUID()));
+
+  // Autotype string, password, custom fields and notes are from base
+  std::vector<size_t> vactionverboffsets;
+  const PWSAuxParse::AutoType autotype(sc2, core);
+  EXPECT_FALSE(autotype.IsEmpty());
+  EXPECT_EQ(L"shortcut:sc-user:base-password:base-pin:base-notes",
+            autotype.GetString(vactionverboffsets));
+  EXPECT_TRUE(vactionverboffsets.empty());
+}
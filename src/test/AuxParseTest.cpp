@@ -16,6 +16,7 @@
 #include "core/PWSAuxParse.h"
 #include "core/ItemData.h"
 #include "core/PWScore.h"
+#include "os/KeySend.h"
 #include "gtest/gtest.h"
 
 
@@ -155,3 +156,100 @@ TEST(AuxParseTest, testCustomFieldsEdgeCases)
 
   EXPECT_EQ(L" and/or \\v", expanded);
 }
+
+TEST(AuxParseTest, testAutoTypeActionVerbs)
+{
+  std::vector<size_t> vactionverboffsets;
+  WORD wVKEnter, wVKTab;
+  ASSERT_TRUE(CKeySend::LookupVirtualKey(L"ENTER", wVKEnter));
+  ASSERT_TRUE(CKeySend::LookupVirtualKey(L"TAB", wVKTab));
+  const PWSAuxParse::AutoType autotype(
+      L"\\u\\t\\p\\d5\\nA\\o2\\W\\q\\b",
+      L"", L"", L"jo\\e", L"pw", L"old", L"line1\r\nline2", L"", L"", L"",
+      nullptr);
+
+  // Field values have their '\' doubled, \d and \W are padded to 3 digits
+  EXPECT_EQ(L"jo\\\\e\tpw\\d005\rAline2\\W000old\\b",
+            autotype.GetString(vactionverboffsets));
+  const std::vector<size_t> expected = {8, 20, 28};
+  EXPECT_EQ(expected, vactionverboffsets);
+  EXPECT_FALSE(autotype.IsEmpty());
+  EXPECT_FALSE(autotype.ForcesOldMethod());
+
+  // As the string GetAutoTypeString returned before it used AutoType
+  const struct {
+    const wchar_t *autotype;
+    StringX expected;
+    std::vector<size_t> offsets;
+  } cases[] = {
+    {L"\\g\\i\\l\\m\\e\\2\\o",
+     L"grpttlurle@m\x1b" L"123456n1\rn2\rn3", {}},
+    {L"\\u\\#x\\{Enter}\\c\\j\\k\\z\\w10",
+     StringX(L"u\\#x\\{") + StringX(1, wVKEnter) + L"}\\c\\j\\k\\z\\w010",
+     {8, 10, 12, 14, 16}},
+    {L"\\u\\{^+Tab}\\r\\s\\x",
+     StringX(L"u\\{^+") + StringX(1, wVKTab) + L"}\r\v\\x", {}},
+  };
+  for (const auto &c : cases) {
+    const PWSAuxParse::AutoType at(c.autotype, L"grp", L"ttl", L"u", L"pw", L"old",
+                                   L"n1\r\nn2\r\nn3", L"url", L"e@m", L"123456",
+                                   nullptr);
+    EXPECT_EQ(c.expected, at.GetString(vactionverboffsets)) << c.autotype;
+    EXPECT_EQ(c.offsets, vactionverboffsets) << c.autotype;
+  }
+
+  const PWSAuxParse::AutoType oldMethod(L"\\z\\u", L"", L"", L"", L"", L"",
+                                        L"", L"", L"", L"", nullptr);
+  EXPECT_TRUE(oldMethod.ForcesOldMethod());
+
+  // Nothing to type
+  const PWSAuxParse::AutoType empty(L"\\u\\o3", L"", L"", L"", L"", L"",
+                                    L"one line", L"", L"", L"", nullptr);
+  EXPECT_TRUE(empty.IsEmpty());
+}
+
+// Records what AutoType::Send types, rather than typing it
+class RecordingKeySender : public PWSAuxParse::KeySender
+{
+public:
+  void SendString(const StringX &data) override
+  { calls.push_back(L"S:" + data); }
+  void SendVirtualKey(WORD wVK, bool bAlt, bool bCtrl, bool bShift) override
+  {
+    StringX sx(L"V:");
+    if (bAlt) sx += L'!';
+    if (bCtrl) sx += L'^';
+    if (bShift) sx += L'+';
+    calls.push_back(sx + StringX(1, wVK));
+  }
+  void SetAndDelay(unsigned d) override
+  { calls.push_back(L"D:" + StringX(std::to_wstring(d).c_str())); }
+  void SetOldSendMethod(bool bForceOldMethod) override
+  { calls.push_back(bForceOldMethod ? L"O:1" : L"O:0"); }
+  void SelectAll() override
+  { calls.push_back(L"A"); }
+  void EmulateMods(bool emulate) override
+  { calls.push_back(emulate ? L"M:1" : L"M:0"); }
+
+  std::vector<StringX> calls;
+};
+
+TEST(AuxParseTest, testAutoTypeSend)
+{
+  WORD wVKTab;
+  ASSERT_TRUE(CKeySend::LookupVirtualKey(L"TAB", wVKTab));
+
+  const PWSAuxParse::AutoType autotype(
+      L"\\u\\t\\p\\#x\\{^+Tab}\\d5\\c\\j\\k\\b\\o",
+      L"", L"", L"jo\\e", L"pw", L"", L"n1\r\nn2", L"", L"", L"",
+      nullptr);
+  RecordingKeySender ks;
+  autotype.Send(ks);
+
+  // Field values are typed as they are, '\' included
+  const std::vector<StringX> expected = {
+    L"S:jo\\e", L"S:\t", L"S:pw", L"O:1", L"S:x",
+    StringX(L"V:^+") + StringX(1, wVKTab),
+    L"D:5", L"A", L"M:1", L"M:0", L"S:\b", L"S:n1\rn2"};
+  EXPECT_EQ(expected, ks.calls);
+}
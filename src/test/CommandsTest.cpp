@@ -14,6 +14,7 @@
 #include "core/PWScore.h"
 #include "core/PWSfileV3.h"
 #include "core/PWHistory.h"
+#include "core/PWSprefs.h"
 #include "os/file.h"
 
 #include "gtest/gtest.h"
@@ -447,3 +448,328 @@ TEST_F(CommandsTest, UpdateEntry)
   // Get core to delete any existing commands
   core.ClearCommands();
 }
+
+TEST_F(CommandsTest, RotatePasswords)
+{
+  PWScore core;
+
+  const int32 i1day = 86400; // 24 * 60 * 60 seconds
+  const StringX sxOldPassword1(L"Squ1shyTomato");
+  const StringX sxOldPassword2(L"Wobbl1ngJelly");
+
+  CItemData it1, it2;
+  time_t t;
+  time(&t);
+  it1.CreateUUID();
+  it1.SetCTime(t);
+  it1.SetTitle(L"Rotor");
+  it1.SetPassword(sxOldPassword1);
+  it1.SetPWHistory(L"10300");  // On and save 3
+  it1.SetPMTime(t - i1day * 40);
+  it1.SetXTime(t - i1day * 2); // Say expired 2 days ago
+  it2.CreateUUID();
+  it2.SetCTime(t);
+  it2.SetTitle(L"Stator");
+  it2.SetPassword(sxOldPassword2);
+  it2.SetPWHistory(L"10300");
+
+  core.Execute(AddEntryCommand::Create(&core, it1));
+  core.Execute(AddEntryCommand::Create(&core, it2));
+  ASSERT_EQ(1U, core.GetExpired(0).size());
+
+  pws_os::CUUID unknown;
+  const UUIDVector uuids{it1.GetUUID(), it2.GetUUID(), unknown, it1.GetUUID()};
+  size_t numRotated = 42;
+
+  EXPECT_EQ(PWScore::FAILURE, core.RotatePasswords(uuids, L"NoSuchPolicy", numRotated));
+  EXPECT_EQ(0U, numRotated);
+
+  EXPECT_EQ(PWScore::SUCCESS, core.RotatePasswords(uuids, StringX(), numRotated));
+  EXPECT_EQ(2U, numRotated);
+
+  const CItemData &r1 = core.GetEntry(core.Find(it1.GetUUID()));
+  const CItemData &r2 = core.GetEntry(core.Find(it2.GetUUID()));
+  EXPECT_NE(sxOldPassword1, r1.GetPassword());
+  EXPECT_NE(sxOldPassword2, r2.GetPassword());
+  EXPECT_NE(r1.GetPassword(), r2.GetPassword());
+
+  {
+    PWHistList pwhl(r1.GetPWHistory(), PWSUtil::TMC_ASC_UNKNOWN);
+    ASSERT_EQ(1U, pwhl.size());
+    EXPECT_EQ(sxOldPassword1, pwhl[0].password);
+  }
+  time_t tPMtime;
+  r2.GetPMTime(tPMtime);
+  EXPECT_GE(tPMtime, t);
+
+  // One command for all the entries => a single Undo restores all of them
+  core.Undo();
+  EXPECT_EQ(sxOldPassword1, core.GetEntry(core.Find(it1.GetUUID())).GetPassword());
+  EXPECT_EQ(sxOldPassword2, core.GetEntry(core.Find(it2.GetUUID())).GetPassword());
+  EXPECT_TRUE(core.AnyToUndo()); // the AddEntryCommands
+
+  // Get core to delete any existing commands
+  core.ClearCommands();
+}
+
+TEST_F(CommandsTest, Synchronize)
+{
+  PWScore core, other;
+  CItemData ci, oi, protectedItem;
+  ci.CreateUUID();
+  ci.SetGroup(L"g");
+  ci.SetTitle(L"t");
+  ci.SetPassword(L"old");
+  oi = ci;
+  oi.CreateUUID();
+  oi.SetPassword(L"new");
+  protectedItem.CreateUUID();
+  protectedItem.SetTitle(L"p");
+  protectedItem.SetPassword(L"mine");
+  protectedItem.SetProtected(true);
+  CItemData otherProtected(protectedItem);
+  otherProtected.SetPassword(L"theirs");
+
+  core.Execute(AddEntryCommand::Create(&core, ci));
+  core.Execute(AddEntryCommand::Create(&core, protectedItem));
+  other.Execute(AddEntryCommand::Create(&other, oi));
+  other.Execute(AddEntryCommand::Create(&other, otherProtected));
+
+  CItemData::FieldBits bsFields;
+  bsFields.set(CItemData::PASSWORD);
+
+  // Cancelling leaves the core as it was
+  std::vector<StringX> vs_updated;
+  std::vector<PWScore::SyncProgress> progress;
+  MultiCommands *pmcmd = core.PrepareSynchronize(&other, bsFields, false, L"", 0, 0,
+                                                 vs_updated, nullptr,
+                                                 [&](const PWScore::SyncProgress &p) {
+                                                   progress.push_back(p);
+                                                   return false;
+                                                 });
+  EXPECT_EQ(nullptr, pmcmd);
+  ASSERT_EQ(1U, progress.size());
+  EXPECT_EQ(PWScore::SyncProgress::MATCHING, progress[0].phase);
+  EXPECT_EQ(0U, progress[0].done);
+  EXPECT_EQ(2U, progress[0].total);
+
+  // Preparing doesn't change the core either
+  progress.clear();
+  pmcmd = core.PrepareSynchronize(&other, bsFields, false, L"", 0, 0, vs_updated, nullptr,
+                                  [&](const PWScore::SyncProgress &p) {
+                                    progress.push_back(p);
+                                    return true;
+                                  });
+  ASSERT_NE(nullptr, pmcmd);
+  ASSERT_EQ(1U, vs_updated.size()); // not the protected entry
+  EXPECT_EQ(PWScore::SyncProgress::REPORTING, progress.back().phase);
+  EXPECT_EQ(L"old", core.GetEntry(core.Find(ci.GetUUID())).GetPassword());
+
+  core.Execute(pmcmd);
+  EXPECT_EQ(L"new", core.GetEntry(core.Find(ci.GetUUID())).GetPassword());
+  EXPECT_EQ(L"mine", core.GetEntry(core.Find(protectedItem.GetUUID())).GetPassword());
+
+  // One command for the whole synchronize
+  core.Undo();
+  EXPECT_EQ(L"old", core.GetEntry(core.Find(ci.GetUUID())).GetPassword());
+
+  int numUpdated = 0;
+  core.Synchronize(&other, bsFields, false, L"", 0, 0, numUpdated, nullptr);
+  EXPECT_EQ(1, numUpdated);
+  EXPECT_EQ(L"new", core.GetEntry(core.Find(ci.GetUUID())).GetPassword());
+
+  // Get core to delete any existing commands
+  core.ClearCommands();
+  other.ClearCommands();
+}
+
+TEST_F(CommandsTest, UndoHistoryLimit)
+{
+  PWScore core;
+  PWSprefs *prefs = PWSprefs::GetInstance();
+  const int maxSteps = prefs->GetPref(PWSprefs::MaxUndoSteps);
+  prefs->SetPref(PWSprefs::MaxUndoSteps, 3);
+
+  for (int i = 0; i < 5; i++) {
+    CItemData ci;
+    ci.CreateUUID();
+    ci.SetTitle(StringX(L"entry ") + StringX(std::to_wstring(i).c_str()));
+    ci.SetPassword(L"xyzzy");
+    core.Execute(AddEntryCommand::Create(&core, ci));
+  }
+  EXPECT_EQ(5U, core.GetNumEntries());
+
+  // Only the last 3 additions can be undone
+  int undone = 0;
+  while (core.AnyToUndo()) {
+    core.Undo();
+    undone++;
+  }
+  EXPECT_EQ(3, undone);
+  EXPECT_EQ(2U, core.GetNumEntries());
+
+  while (core.AnyToRedo())
+    core.Redo();
+  EXPECT_EQ(5U, core.GetNumEntries());
+
+  prefs->SetPref(PWSprefs::MaxUndoSteps, maxSteps);
+  // Get core to delete any existing commands
+  core.ClearCommands();
+}
+
+namespace {
+class CountingObserver : public Observer
+{
+public:
+  void DatabaseModified(bool) override {nModified++;}
+  void UpdateGUI(UpdateGUICommand::GUI_Action, const pws_os::CUUID &,
+                 CItemData::FieldType) override {nUpdates++;}
+  void UpdateGUIBatch(const std::vector<GUIUpdate> &updates) override
+  {nBatches++; batch = updates;}
+
+  int nModified = 0, nUpdates = 0, nBatches = 0;
+  std::vector<GUIUpdate> batch;
+};
+
+CItemData MakeEntry(const StringX &title)
+{
+  CItemData ci;
+  ci.CreateUUID();
+  ci.SetTitle(title);
+  ci.SetPassword(L"xyzzy");
+  return ci;
+}
+} // namespace
+
+TEST_F(CommandsTest, Transaction)
+{
+  PWScore core;
+  CountingObserver observer;
+  core.RegisterObserver(&observer);
+  core.ResumeOnDBNotification();
+
+  PWScore::Transaction transaction(core);
+  EXPECT_TRUE(core.InTransaction());
+  transaction.Execute(AddEntryCommand::Create(&core, MakeEntry(L"one")));
+  transaction.Execute(AddEntryCommand::Create(&core, MakeEntry(L"two")));
+  // Joins the open transaction
+  core.Execute(AddEntryCommand::Create(&core, MakeEntry(L"three")));
+  EXPECT_EQ(3U, core.GetNumEntries());
+  EXPECT_FALSE(core.AnyToUndo());
+  EXPECT_EQ(0, observer.nModified);
+  EXPECT_EQ(0, observer.nUpdates);
+
+  transaction.Commit();
+  EXPECT_FALSE(core.InTransaction());
+  EXPECT_EQ(1, observer.nModified);
+  EXPECT_EQ(0, observer.nUpdates);
+  EXPECT_EQ(1, observer.nBatches);
+  ASSERT_EQ(4U, observer.batch.size());
+  EXPECT_EQ(UpdateGUICommand::GUI_ADD_ENTRY, observer.batch[0].ga);
+  EXPECT_EQ(UpdateGUICommand::GUI_UPDATE_STATUSBAR, observer.batch[3].ga);
+
+  // One undo step for the lot
+  ASSERT_TRUE(core.AnyToUndo());
+  core.Undo();
+  EXPECT_EQ(0U, core.GetNumEntries());
+  EXPECT_FALSE(core.AnyToUndo());
+  core.Redo();
+  EXPECT_EQ(3U, core.GetNumEntries());
+
+  core.UnregisterObserver(&observer);
+  // Get core to delete any existing commands
+  core.ClearCommands();
+}
+
+TEST_F(CommandsTest, TransactionRollback)
+{
+  PWScore core;
+  CountingObserver observer;
+  core.RegisterObserver(&observer);
+  core.ResumeOnDBNotification();
+
+  {
+    PWScore::Transaction transaction(core);
+    transaction.Execute(AddEntryCommand::Create(&core, MakeEntry(L"one")));
+    transaction.Execute(AddEntryCommand::Create(&core, MakeEntry(L"two")));
+    EXPECT_EQ(2U, core.GetNumEntries());
+    // Not committed, so rolled back here
+  }
+  EXPECT_FALSE(core.InTransaction());
+  EXPECT_EQ(0U, core.GetNumEntries());
+  EXPECT_FALSE(core.AnyToUndo());
+  EXPECT_EQ(0, observer.nModified);
+  EXPECT_EQ(0, observer.nUpdates);
+  EXPECT_EQ(0, observer.nBatches);
+
+  core.UnregisterObserver(&observer);
+  // Get core to delete any existing commands
+  core.ClearCommands();
+}
+
+TEST_F(CommandsTest, PolicyEntries)
+{
+  PWScore core;
+  PWPolicy policy;
+  policy.flags = PWPolicy::UseLowercase;
+  policy.length = 12;
+  PSWDPolicyMap policies;
+  policies[L"P1"] = policy;
+  policies[L"P2"] = policy;
+  core.Execute(DBPolicyNamesCommand::Create(&core, policies, DBPolicyNamesCommand::NP_REPLACEALL));
+
+  CItemData one = MakeEntry(L"one"), two = MakeEntry(L"two");
+  one.SetPolicyName(L"P1");
+  two.SetPolicyName(L"P1");
+  core.Execute(AddEntryCommand::Create(&core, one));
+  core.Execute(AddEntryCommand::Create(&core, two));
+  core.Execute(AddEntryCommand::Create(&core, MakeEntry(L"three")));
+
+  // Only normal entries use a policy
+  CItemData base = MakeEntry(L"base"), alias = MakeEntry(L"alias");
+  alias.SetPolicyName(L"P1");
+  alias.SetAlias();
+  core.Execute(AddEntryCommand::Create(&core, base));
+  core.Execute(AddEntryCommand::Create(&core, alias, base.GetUUID()));
+
+  EXPECT_EQ(2U, core.GetEntriesUsingPolicy(L"P1").size());
+  EXPECT_EQ(2U, core.GetPasswordPolicies().at(L"P1").usecount);
+  GTUSet gtus;
+  EXPECT_TRUE(core.InitialiseGTU(gtus, L"P1"));
+  EXPECT_EQ(2U, gtus.size());
+
+  // Changing the field in place
+  core.Execute(UpdateEntryCommand::Create(&core, one, CItemData::POLICYNAME, L"P2"));
+  EXPECT_EQ(1U, core.GetPasswordPolicies().at(L"P1").usecount);
+  EXPECT_EQ(1U, core.GetPasswordPolicies().at(L"P2").usecount);
+
+  // Reassigning all of P2's entries, then deleting one
+  core.Execute(core.ReassignPasswordPolicy(L"P2", L"P1"));
+  EXPECT_EQ(2U, core.GetPasswordPolicies().at(L"P1").usecount);
+  EXPECT_EQ(0U, core.GetPasswordPolicies().at(L"P2").usecount);
+  EXPECT_EQ(nullptr, core.ReassignPasswordPolicy(L"P2", L"P1"));
+
+  core.Execute(DeleteEntryCommand::Create(&core, core.GetEntry(core.Find(two.GetUUID()))));
+  std::vector<st_GroupTitleUser> ventries;
+  EXPECT_TRUE(core.GetEntriesUsingNamedPasswordPolicy(L"P1", ventries));
+  ASSERT_EQ(1U, ventries.size());
+  EXPECT_EQ(L"one", ventries[0].title);
+
+  // Policies set as a whole get their usecount from the entries
+  policies = core.GetPasswordPolicies();
+  policies[L"P1"].usecount = 42;
+  policies[L"P3"] = policy;
+  core.Execute(DBPolicyNamesCommand::Create(&core, policies, DBPolicyNamesCommand::NP_REPLACEALL));
+  EXPECT_EQ(1U, core.GetPasswordPolicies().at(L"P1").usecount);
+
+  core.Undo();
+  EXPECT_EQ(1U, core.GetPasswordPolicies().at(L"P1").usecount);
+  core.Undo();
+  core.Undo();
+  core.Undo();
+  EXPECT_EQ(2U, core.GetPasswordPolicies().at(L"P1").usecount);
+  EXPECT_EQ(0U, core.GetPasswordPolicies().at(L"P2").usecount);
+  EXPECT_EQ(2U, core.GetEntriesUsingPolicy(L"P1").size());
+
+  core.ClearCommands();
+}
@@ -0,0 +1,111 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// ExpiredListTest.cpp: Unit test for the expiry index
+
+#ifdef WIN32
+#include "../ui/Windows/stdafx.h"
+#endif
+
+#include "core/ExpiredList.h"
+
+#include "gtest/gtest.h"
+
+// A fixture for factoring common code across tests
+class ExpiredListTest : public ::testing::Test
+{
+protected:
+  ExpiredListTest() {}
+  void SetUp() override;
+
+  static const time_t i1day = 86400; // 24 * 60 * 60 seconds
+  time_t now;
+  CItemData ci1, ci2, ci3, ci4;
+};
+
+void ExpiredListTest::SetUp()
+{
+  time(&now);
+  ci1.CreateUUID(); ci1.SetXTime(now - 10 * i1day); // expired
+  ci2.CreateUUID(); ci2.SetXTime(now + 3 * i1day);  // expires soon
+  ci3.CreateUUID(); ci3.SetXTime(now - 20 * i1day); // expired earlier
+  ci4.CreateUUID();                                 // no expiry date
+}
+
+TEST_F(ExpiredListTest, Empty)
+{
+  ExpiryIndex idx;
+  ExpPWEntry ee(ci1);
+
+  EXPECT_TRUE(idx.empty());
+  EXPECT_FALSE(idx.GetNextExpiry(ee));
+  EXPECT_TRUE(idx.GetExpired(100).empty());
+
+  idx.Add(ci4);
+  EXPECT_TRUE(idx.empty());
+}
+
+TEST_F(ExpiredListTest, Ordered)
+{
+  ExpiryIndex idx;
+  idx.Add(ci1);
+  idx.Add(ci2);
+  idx.Add(ci3);
+  idx.Add(ci4);
+  idx.Add(ci1); // no duplicates
+  EXPECT_EQ(3U, idx.size());
+
+  ExpiredList expired = idx.GetExpired(0);
+  ASSERT_EQ(2U, expired.size());
+  EXPECT_EQ(ci3.GetUUID(), expired[0].uuid);
+  EXPECT_EQ(ci1.GetUUID(), expired[1].uuid);
+
+  expired = idx.GetExpired(7);
+  ASSERT_EQ(3U, expired.size());
+  EXPECT_EQ(ci2.GetUUID(), expired[2].uuid);
+
+  ExpPWEntry ee(ci4);
+  ASSERT_TRUE(idx.GetNextExpiry(ee));
+  EXPECT_EQ(ci3.GetUUID(), ee.uuid);
+  EXPECT_EQ(now - 20 * i1day, ee.expirytttXTime);
+}
+
+TEST_F(ExpiredListTest, UpdateRemove)
+{
+  ExpiryIndex idx;
+  idx.Add(ci1);
+  idx.Add(ci2);
+  idx.Add(ci3);
+
+  // Move the earliest to the end
+  ci3.SetXTime(now + 30 * i1day);
+  idx.Update(ci3);
+  EXPECT_EQ(3U, idx.size());
+  ExpPWEntry ee(ci4);
+  ASSERT_TRUE(idx.GetNextExpiry(ee));
+  EXPECT_EQ(ci1.GetUUID(), ee.uuid);
+
+  idx.Update(ci2.GetUUID(), now - 30 * i1day);
+  ASSERT_TRUE(idx.GetNextExpiry(ee));
+  EXPECT_EQ(ci2.GetUUID(), ee.uuid);
+  EXPECT_EQ(2U, idx.GetExpired(0).size());
+
+  // Removing an entry's expiry date removes it from the index
+  ci2.SetXTime(time_t(0));
+  idx.Update(ci2);
+  EXPECT_EQ(2U, idx.size());
+
+  idx.Remove(ci1);
+  idx.Remove(ci1);
+  ASSERT_EQ(1U, idx.size());
+  EXPECT_TRUE(idx.GetExpired(0).empty());
+  ASSERT_TRUE(idx.GetNextExpiry(ee));
+  EXPECT_EQ(ci3.GetUUID(), ee.uuid);
+
+  idx.clear();
+  EXPECT_TRUE(idx.empty());
+}
@@ -280,6 +280,43 @@ TEST_F(FileV3Test, V4Extension)
   ASSERT_EQ(0, std::rename("V3test.psafe4", "V3test.psafe3"));
 }
 
+TEST_F(FileV3Test, ReadProgress)
+{
+  const int N = 200;
+  PWSfileV3 fw(fname.c_str(), PWSfile::Write, PWSfile::V30);
+  ASSERT_EQ(PWSfile::SUCCESS, fw.Open(passphrase));
+  for (int i = 0; i < N; i++) {
+    CItemData ci(smallItem);
+    ci.CreateUUID();
+    EXPECT_EQ(PWSfile::SUCCESS, fw.WriteRecord(ci));
+  }
+  ASSERT_EQ(PWSfile::SUCCESS, fw.Close());
+
+  PWScore core;
+  int nCalls = 0;
+  ulong64 lastRead = 0, length = 0;
+  auto progress = [&](ulong64 bytesRead, ulong64 fileLength) {
+    EXPECT_GE(bytesRead, lastRead);
+    EXPECT_LE(bytesRead, fileLength);
+    lastRead = bytesRead;
+    length = fileLength;
+    nCalls++;
+    return true;
+  };
+  EXPECT_EQ(PWSfile::SUCCESS, core.ReadFile(fname.c_str(), passphrase, false, 0, nullptr, progress));
+  EXPECT_EQ(size_t(N), core.GetNumEntries());
+  EXPECT_GT(nCalls, 1);
+  EXPECT_GT(lastRead, 0U);
+  EXPECT_GT(length, lastRead);
+
+  // Cancelling leaves nothing behind
+  nCalls = 0;
+  auto cancel = [&](ulong64, ulong64) { return ++nCalls < 2; };
+  EXPECT_EQ(PWScore::USER_CANCEL, core.ReadFile(fname.c_str(), passphrase, false, 0, nullptr, cancel));
+  EXPECT_EQ(2, nCalls);
+  EXPECT_EQ(0U, core.GetNumEntries());
+}
+
 TEST_F(FileV3Test, PasskeyTest)
 {
   CItemData ci;
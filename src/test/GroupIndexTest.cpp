@@ -0,0 +1,149 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// GroupIndexTest.cpp: Unit test for the group hierarchy index
+
+#ifdef WIN32
+#include "../ui/Windows/stdafx.h"
+#endif
+
+#include "core/GroupIndex.h"
+
+#include "gtest/gtest.h"
+
+// A fixture for factoring common code across tests
+class GroupIndexTest : public ::testing::Test
+{
+protected:
+  GroupIndexTest() {}
+  void SetUp() override;
+
+  CItemData ci1, ci2, ci3, ci4;
+};
+
+void GroupIndexTest::SetUp()
+{
+  ci1.CreateUUID(); ci1.SetGroup(L"a.b");
+  ci2.CreateUUID(); ci2.SetGroup(L"a");
+  ci3.CreateUUID(); ci3.SetGroup(L"a.b.c");
+  ci4.CreateUUID();                         // root
+}
+
+TEST_F(GroupIndexTest, PathElements)
+{
+  StringX path(L"a.b.c");
+  EXPECT_EQ(L"a", GroupIndex::PopPathElement(path));
+  EXPECT_EQ(L"b.c", path);
+
+  path = L"a..b.c";
+  EXPECT_EQ(L"a.", GroupIndex::PopPathElement(path));
+  EXPECT_EQ(L"b.c", path);
+
+  path = L"a..";
+  EXPECT_EQ(L"a..", GroupIndex::PopPathElement(path));
+  EXPECT_TRUE(path.empty());
+}
+
+TEST_F(GroupIndexTest, Hierarchy)
+{
+  GroupIndex idx;
+  EXPECT_EQ(0U, idx.GetNumEntries());
+  EXPECT_TRUE(idx.GetRoot().subgroups.empty());
+
+  idx.Add(ci1);
+  idx.Add(ci2);
+  idx.Add(ci3);
+  idx.Add(ci4);
+  idx.AddGroup(L"x.y");
+  EXPECT_EQ(4U, idx.GetNumEntries());
+
+  const GroupIndex::Group &root = idx.GetRoot();
+  ASSERT_EQ(2U, root.subgroups.size());
+  ASSERT_EQ(1U, root.entries.size());
+  EXPECT_EQ(ci4.GetUUID(), root.entries[0]->uuid);
+  EXPECT_EQ(&root, root.entries[0]->parent);
+
+  const GroupIndex::Group *b = idx.FindGroup(L"a.b");
+  ASSERT_NE(nullptr, b);
+  EXPECT_TRUE(b->isGroup);
+  EXPECT_EQ(L"b", b->name);
+  EXPECT_EQ(L"a.b", b->GetPath());
+  EXPECT_EQ(idx.FindGroup(L"a"), b->parent);
+  ASSERT_EQ(1U, b->entries.size());
+  ASSERT_EQ(1U, b->subgroups.size());
+
+  const GroupIndex::Entry *e3 = idx.Find(ci3.GetUUID());
+  ASSERT_NE(nullptr, e3);
+  EXPECT_FALSE(e3->isGroup);
+  EXPECT_EQ(L"a.b.c", e3->parent->GetPath());
+
+  const GroupIndex::Group *y = idx.FindGroup(L"x.y");
+  ASSERT_NE(nullptr, y);
+  EXPECT_TRUE(y->entries.empty());
+  EXPECT_EQ(nullptr, idx.FindGroup(L"a.z"));
+}
+
+TEST_F(GroupIndexTest, MoveRemove)
+{
+  GroupIndex idx;
+  idx.Add(ci1);
+  idx.Add(ci2);
+
+  // Re-adding moves the entry, leaving its old group in place
+  idx.Add(ci1.GetUUID(), L"d");
+  EXPECT_EQ(2U, idx.GetNumEntries());
+  EXPECT_EQ(L"d", idx.Find(ci1.GetUUID())->parent->GetPath());
+  const GroupIndex::Group *b = idx.FindGroup(L"a.b");
+  ASSERT_NE(nullptr, b);
+  EXPECT_TRUE(b->entries.empty());
+
+  EXPECT_TRUE(idx.Remove(ci2.GetUUID()));
+  EXPECT_FALSE(idx.Remove(ci2.GetUUID()));
+  EXPECT_EQ(nullptr, idx.Find(ci2.GetUUID()));
+  EXPECT_TRUE(idx.FindGroup(L"a")->entries.empty());
+  EXPECT_EQ(1U, idx.GetNumEntries());
+
+  // Only childless groups can go
+  EXPECT_FALSE(idx.RemoveGroup(&idx.GetRoot()));
+  EXPECT_FALSE(idx.RemoveGroup(idx.FindGroup(L"a")));
+  EXPECT_TRUE(idx.RemoveGroup(b));
+  EXPECT_EQ(nullptr, idx.FindGroup(L"a.b"));
+  EXPECT_TRUE(idx.RemoveGroup(idx.FindGroup(L"a")));
+  EXPECT_EQ(nullptr, idx.FindGroup(L"a"));
+  EXPECT_FALSE(idx.RemoveGroup(idx.FindGroup(L"d")));
+
+  idx.Clear();
+  EXPECT_EQ(0U, idx.GetNumEntries());
+  EXPECT_TRUE(idx.GetRoot().subgroups.empty());
+}
+
+TEST_F(GroupIndexTest, RemoveSiblings)
+{
+  GroupIndex idx;
+  std::vector<CItemData> items(5);
+  for (auto &ci : items) {
+    ci.CreateUUID();
+    idx.Add(ci.GetUUID(), L"g");
+  }
+  const GroupIndex::Group *g = idx.FindGroup(L"g");
+  ASSERT_NE(nullptr, g);
+
+  // Take out the first, a middle and the last one
+  EXPECT_TRUE(idx.Remove(items[0].GetUUID()));
+  EXPECT_TRUE(idx.Remove(items[2].GetUUID()));
+  EXPECT_TRUE(idx.Remove(items[4].GetUUID()));
+  ASSERT_EQ(2U, g->entries.size());
+  for (size_t i = 0; i < g->entries.size(); i++)
+    EXPECT_EQ(i, g->entries[i]->pos);
+  EXPECT_EQ(g, idx.Find(items[1].GetUUID())->parent);
+  EXPECT_EQ(g, idx.Find(items[3].GetUUID())->parent);
+
+  EXPECT_TRUE(idx.Remove(items[1].GetUUID()));
+  EXPECT_TRUE(idx.Remove(items[3].GetUUID()));
+  EXPECT_TRUE(g->entries.empty());
+  EXPECT_EQ(0U, idx.GetNumEntries());
+}
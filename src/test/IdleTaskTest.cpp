@@ -0,0 +1,117 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// IdleTaskTest.cpp: Unit test for the idle-time tasks
+
+#ifdef WIN32
+#include "../ui/Windows/stdafx.h"
+#endif
+
+#include "core/IdleTask.h"
+#include "core/PasswordStrength.h"
+#include "core/PWScore.h"
+
+#include "gtest/gtest.h"
+
+#include <set>
+
+// A fixture for factoring common code across tests
+class IdleTaskTest : public ::testing::Test
+{
+protected:
+  IdleTaskTest() {}
+  void SetUp() override;
+
+  static const int N = 25;
+  PWScore core;
+  CItemData items[N];
+};
+
+void IdleTaskTest::SetUp()
+{
+  for (auto &ci : items) {
+    ci.CreateUUID();
+    ci.SetTitle(L"title");
+    ci.SetPassword(L"password");
+    core.Execute(AddEntryCommand::Create(&core, ci));
+  }
+}
+
+TEST_F(IdleTaskTest, VisitsAll)
+{
+  std::set<pws_os::CUUID> visited;
+  EntryVisitTask task(core, [&](const CItemData &ci) { visited.insert(ci.GetUUID()); }, 10);
+
+  EXPECT_EQ(size_t(N), task.GetRemaining());
+  EXPECT_TRUE(task.Step());
+  EXPECT_EQ(10U, visited.size());
+  EXPECT_TRUE(task.Step());
+  EXPECT_FALSE(task.Step());
+  EXPECT_EQ(0U, task.GetRemaining());
+  EXPECT_EQ(size_t(N), visited.size());
+  EXPECT_FALSE(task.Step()); // nothing left, nothing done
+}
+
+TEST_F(IdleTaskTest, ChangesBetweenSteps)
+{
+  std::set<pws_os::CUUID> visited;
+  EntryVisitTask task(core, [&](const CItemData &ci) { visited.insert(ci.GetUUID()); }, 10);
+
+  EXPECT_TRUE(task.Step());
+  // Entries deleted after the task was created are skipped, added ones aren't visited
+  int nDeleted = 0;
+  for (const auto &ci : items) {
+    if (nDeleted < 5 && visited.find(ci.GetUUID()) == visited.end()) {
+      core.Execute(DeleteEntryCommand::Create(&core, ci));
+      nDeleted++;
+    }
+  }
+  CItemData added;
+  added.CreateUUID();
+  core.Execute(AddEntryCommand::Create(&core, added));
+
+  while (task.Step())
+    ;
+  EXPECT_EQ(size_t(N - nDeleted), visited.size());
+  EXPECT_TRUE(visited.find(added.GetUUID()) == visited.end());
+}
+
+TEST_F(IdleTaskTest, WeakPasswordsAudit)
+{
+  // As PasswordSafeFrame does after reading a database
+  WeakPasswords weak(33);
+  bool done = false;
+  EntryVisitTask task(core, [&](const CItemData &ci) { weak.Update(ci); }, 10,
+                      [&]() { done = true; });
+
+  EXPECT_TRUE(task.Step());
+  EXPECT_FALSE(done);
+  while (task.Step())
+    ;
+  EXPECT_TRUE(done);
+  EXPECT_EQ(size_t(N), weak.GetCount()); // they're all "password"
+  done = false;
+  EXPECT_FALSE(task.Step());
+  EXPECT_FALSE(done); // only called once
+
+  // Changes after the audit are applied an entry at a time
+  CItemData strong = items[0];
+  strong.SetPassword(L"Wq7#zR!u9@Lp2$Xe5%Ky8^Mv3&Nb6*Tj");
+  weak.Update(strong);
+  EXPECT_FALSE(weak.IsWeak(strong.GetUUID()));
+  EXPECT_TRUE(weak.IsWeak(items[1].GetUUID()));
+  weak.Remove(items[1].GetUUID());
+  EXPECT_EQ(size_t(N - 2), weak.GetCount());
+
+  // An alias's password is its base's
+  CItemData alias;
+  alias.CreateUUID();
+  alias.SetPassword(L"weak");
+  alias.SetAlias();
+  weak.Update(alias);
+  EXPECT_FALSE(weak.IsWeak(alias.GetUUID()));
+}
@@ -165,6 +165,29 @@ TEST_F(ItemDataTest, PlainTextSerialization)
   EXPECT_EQ(fullItem, di);
 }
 
+TEST_F(ItemDataTest, PlainTextSizeBound)
+{
+  std::vector<char> v;
+  emptyItem.SerializePlainText(v);
+  EXPECT_LE(v.size(), emptyItem.GetPlainTextSizeBound());
+
+  fullItem.SerializePlainText(v);
+  EXPECT_LE(v.size(), fullItem.GetPlainTextSizeBound());
+
+  // An alias is written with its base's group, title and user
+  CItemData base, alias;
+  base.CreateUUID();
+  base.SetGroup(L"A rather long group name.With a subgroup");
+  base.SetTitle(L"The base entry's title");
+  base.SetUser(L"somebody@example.com");
+  alias.CreateUUID();
+  alias.SetTitle(L"al");
+  alias.SetAlias();
+  alias.SetBaseUUID(base.GetUUID());
+  alias.SerializePlainText(v, &base);
+  EXPECT_LE(v.size(), alias.GetPlainTextSizeBound(&base));
+}
+
 TEST_F(ItemDataTest, PasswordHistory)
 {
   const StringX pw1(L"banana-0rchid");
@@ -489,3 +512,92 @@ TEST_F(ItemDataTest, UnknownFields)
   // how they're processed. Worth exposing an API
   // just for testing, TBD.
 }
+
+TEST_F(ItemDataTest, ItemDataDelta)
+{
+  CItemData before;
+  before.CreateUUID();
+  before.SetTitle(L"mountain goat");
+  before.SetPassword(L"quiet-harbour");
+  before.SetNotes(L"to be removed");
+
+  CItemData after(before);
+  after.SetTitle(L"mountain lion");
+  after.SetNotes(L"");
+  after.SetURL(L"https://example.org");
+  after.SetStatus(CItemData::ES_MODIFIED);
+
+  CItemDataDelta delta(before, after);
+  EXPECT_FALSE(delta.IsEmpty());
+
+  CItemData ci(before);
+  delta.Apply(ci);
+  EXPECT_EQ(after, ci);
+  EXPECT_EQ(L"mountain lion", ci.GetTitle());
+  EXPECT_TRUE(ci.GetNotes().empty());
+  EXPECT_EQ(L"quiet-harbour", ci.GetPassword());
+
+  delta.Revert(ci);
+  EXPECT_EQ(before, ci);
+  EXPECT_EQ(L"to be removed", ci.GetNotes());
+  EXPECT_TRUE(ci.GetURL().empty());
+
+  EXPECT_TRUE(CItemDataDelta(before, before).IsEmpty());
+}
+
+TEST_F(ItemDataTest, ParsedFieldsCache)
+{
+  PWSprefs *prefs = PWSprefs::GetInstance();
+  prefs->SetPref(PWSprefs::SavePasswordHistory, true);
+  prefs->SetPref(PWSprefs::NumPWHistoryDefault, 3);
+
+  CItemData di;
+  di.SetCTime();
+  di.SetPassword(L"banana-0rchid");
+  di.UpdatePassword(L"banana-1rchid");
+
+  const auto expect_same = [](const PWHistList &expected, const PWHistList &actual) {
+    EXPECT_EQ(expected.isSaving(), actual.isSaving());
+    EXPECT_EQ(expected.getMax(), actual.getMax());
+    EXPECT_EQ(expected.getErr(), actual.getErr());
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      EXPECT_EQ(expected[i].changetttdate, actual[i].changetttdate);
+      EXPECT_EQ(expected[i].changedate, actual[i].changedate);
+      EXPECT_EQ(expected[i].password, actual[i].password);
+    }
+  };
+
+  expect_same(PWHistList(di.GetPWHistory(), PWSUtil::TMC_XML),
+              di.GetPWHistoryList(PWSUtil::TMC_XML));
+  // Again from the cache, and in another format
+  expect_same(PWHistList(di.GetPWHistory(), PWSUtil::TMC_XML),
+              di.GetPWHistoryList(PWSUtil::TMC_XML));
+  expect_same(PWHistList(di.GetPWHistory(), PWSUtil::TMC_EXPORT_IMPORT),
+              di.GetPWHistoryList(PWSUtil::TMC_EXPORT_IMPORT));
+
+  // Setting the field invalidates the cache, also of a copy's
+  CItemData copy(di);
+  di.UpdatePassword(L"banana-2rchid");
+  EXPECT_EQ(2U, di.GetPWHistoryList(PWSUtil::TMC_XML).size());
+  EXPECT_EQ(1U, copy.GetPWHistoryList(PWSUtil::TMC_XML).size());
+  di.SetPWHistory(L"");
+  EXPECT_TRUE(di.GetPWHistoryList(PWSUtil::TMC_XML).empty());
+
+  CustomField cf;
+  cf.SetName(L"PIN");
+  cf.SetValue(L"1234");
+  cf.SetSensitive(true);
+  EXPECT_TRUE(di.AddCustomField(cf));
+  for (int i = 0; i < 2; i++) {
+    const CustomFieldList fields = di.GetCustomFields();
+    ASSERT_EQ(1U, fields.size());
+    EXPECT_EQ(L"PIN", fields[0].GetName());
+    EXPECT_EQ(L"1234", fields[0].GetValue());
+    EXPECT_TRUE(fields[0].IsSensitive());
+  }
+  EXPECT_TRUE(di.SetCustomFieldProperty(L"PIN", CustomField::PROP_VALUE, L"4321"));
+  EXPECT_EQ(L"4321", di.GetCustomFields()[0].GetValue());
+  EXPECT_TRUE(di.DeleteCustomField(L"PIN"));
+  EXPECT_TRUE(di.GetCustomFields().empty());
+}
@@ -0,0 +1,61 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// KeySendTest.cpp: Autotype throughput test
+//
+// Not part of coretest: this types into whatever window has input focus,
+// so it is built as keysendtest (configure with -DKEYSEND_TEST=ON) and
+// ctest runs it on a throwaway X server via xvfb-run.
+
+#include "os/KeySend.h"
+#include "core/PWSprefs.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+  void bench(const char *name, bool useXTEST, unsigned delayMS)
+  {
+    PWSprefs::GetInstance()->SetPref(PWSprefs::UseAltAutoType, useXTEST);
+
+    // Mix of plain, shifted and repeated chars, as in a typical password
+    StringX data;
+    for (int i = 0; i < 40; i++)
+      data += _T("aB3$xY7!kQ");
+
+    CKeySend ks(false, delayMS);
+    auto start = std::chrono::steady_clock::now();
+    ks.SendString(data);
+    std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << data.length() << " chars in " << secs.count()
+              << "s (" << data.length() / secs.count() << " chars/s)" << std::endl;
+  }
+}
+
+class KeySendTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    if (getenv("DISPLAY") == nullptr)
+      GTEST_SKIP() << "DISPLAY not set, run under xvfb-run";
+  }
+};
+
+TEST_F(KeySendTest, XTEST)
+{
+  bench("xtest, no delay", true, 0);
+  bench("xtest, 1ms delay", true, 1);
+}
+
+TEST_F(KeySendTest, SendKeys)
+{
+  bench("sendkeys, no delay", false, 0);
+}
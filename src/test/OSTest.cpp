@@ -9,8 +9,16 @@
 
 #include "os/media.h"
 #include "os/dir.h"
+#include "os/env.h"
+#include "os/file.h"
+#include "core/PWScore.h"
+#include "core/Util.h"
 #include "gtest/gtest.h"
 
+#ifndef WIN32
+#include <fcntl.h>
+#endif
+
 TEST(OSTest, testMedia)
 {
   EXPECT_EQ(_T("unknown"), pws_os::GetMediaType(_T("nosuchfile")));
@@ -44,4 +52,85 @@ TEST(OSTest, testPath)
 
   out_path = pws_os::makepath(in_drive, in_dir, in_file, in_ext);
   EXPECT_EQ(in_path, out_path);
-}
\ No newline at end of file
+}
+TEST(OSTest, testLockFile)
+{
+  const stringT fname(_T("LockTest.psafe3"));
+  const stringT plkname(_T("LockTest.plk"));
+  HANDLE h1 = INVALID_HANDLE_VALUE, h2 = INVALID_HANDLE_VALUE;
+  stringT locker;
+
+  ASSERT_TRUE(pws_os::LockFile(fname, locker, h1));
+  EXPECT_TRUE(pws_os::IsLockedFile(fname));
+
+  // A second lock on the same file fails, and tells us who has it
+  EXPECT_FALSE(pws_os::LockFile(fname, locker, h2));
+  EXPECT_EQ(0U, locker.find(pws_os::getusername() + _T("@")));
+
+  pws_os::UnlockFile(fname, h1);
+  EXPECT_EQ(INVALID_HANDLE_VALUE, h1);
+  EXPECT_FALSE(pws_os::IsLockedFile(fname));
+
+  EXPECT_TRUE(pws_os::LockFile(fname, locker, h2));
+  pws_os::UnlockFile(fname, h2);
+
+#if !defined(WIN32) && defined(F_OFD_SETLK)
+  // Lock files nobody holds a lock on, as left by a crashed instance
+  // or by an older version
+  auto writeStale = [&plkname](const stringT &data) {
+    FILE *f = pws_os::FOpen(plkname, _T("wb"));
+    ASSERT_NE(nullptr, f);
+    fwrite(data.c_str(), sizeof(TCHAR), data.length(), f);
+    fclose(f);
+  };
+
+  // Someone else's is reported, not taken over
+  const stringT other(_T("nobody@nowhere:99999999"));
+  writeStale(other);
+  EXPECT_FALSE(pws_os::LockFile(fname, locker, h1));
+  EXPECT_EQ(other, locker);
+  EXPECT_EQ(INVALID_HANDLE_VALUE, h1);
+  pws_os::UnlockFile(fname, h1); // "Remove Lock?"
+  EXPECT_FALSE(pws_os::FileExists(plkname));
+
+  // Ours, from a process that no longer exists, is
+  writeStale(pws_os::getusername() + _T("@") + pws_os::gethostname() + _T(":99999999"));
+  EXPECT_TRUE(pws_os::LockFile(fname, locker, h1));
+  EXPECT_NE(INVALID_HANDLE_VALUE, h1);
+
+  // The locker is reported without the OFD lock marker
+  EXPECT_FALSE(pws_os::LockFile(fname, locker, h2));
+  EXPECT_TRUE(PWSUtil::HasValidLockerData(locker));
+  EXPECT_EQ(stringT::npos, locker.find(_T(";")));
+  pws_os::UnlockFile(fname, h1);
+
+  // So is anyone's that was held by an OFD lock, e.g., a crashed
+  // instance on another host
+  writeStale(other + _T(";ofd"));
+  EXPECT_TRUE(pws_os::LockFile(fname, locker, h1));
+  EXPECT_NE(INVALID_HANDLE_VALUE, h1);
+  pws_os::UnlockFile(fname, h1);
+#endif
+  EXPECT_FALSE(pws_os::FileExists(plkname));
+}
+
+TEST(OSTest, testCoreLocksEachFile)
+{
+  // As when File->Open locks the new database before unlocking the old one
+  const stringT fname1(_T("LockTest1.psafe3")), fname2(_T("LockTest2.psafe3"));
+  PWScore core;
+  stringT locker;
+  ASSERT_TRUE(core.LockFile(fname1, locker));
+  ASSERT_TRUE(core.LockFile(fname2, locker));
+
+  core.SafeUnlockFile(fname1);
+  EXPECT_FALSE(pws_os::IsLockedFile(fname1));
+
+  // Still held
+  HANDLE h = INVALID_HANDLE_VALUE;
+  EXPECT_FALSE(pws_os::LockFile(fname2, locker, h));
+  EXPECT_EQ(INVALID_HANDLE_VALUE, h);
+
+  core.SafeUnlockFile(fname2);
+  EXPECT_FALSE(pws_os::IsLockedFile(fname2));
+}
@@ -0,0 +1,111 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// PWCharPoolTest.cpp: Unit test for password generation
+
+#ifdef WIN32
+#include "../ui/Windows/stdafx.h"
+#endif
+
+#include "core/PWCharPool.h"
+#include "core/PWPolicy.h"
+#include "os/pws_tchar.h"
+#include "gtest/gtest.h"
+
+#include <set>
+
+namespace {
+  PWPolicy MakePolicy(uint16 flags, int length)
+  {
+    PWPolicy pol;
+    pol.flags = flags;
+    pol.length = length;
+    return pol;
+  }
+
+  size_t CountIf(const StringX &s, int (*pred)(wint_t))
+  {
+    return std::count_if(s.begin(), s.end(),
+                         [pred](charT c) {return pred(c) != 0;});
+  }
+}
+
+TEST(PWCharPoolTest, MinimumCounts)
+{
+  PWPolicy pol = MakePolicy(PWPolicy::UseLowercase | PWPolicy::UseUppercase |
+                            PWPolicy::UseDigits | PWPolicy::UseSymbols, 12);
+  pol.lowerminlength = 2;
+  pol.upperminlength = 3;
+  pol.digitminlength = 4;
+  pol.symbolminlength = 1;
+  pol.symbols = _T("#!");
+
+  const auto pws = pol.MakeRandomPasswords(200);
+  ASSERT_EQ(pws.size(), 200u);
+  for (const auto &pw : pws) {
+    ASSERT_EQ(pw.length(), 12u);
+    EXPECT_GE(CountIf(pw, iswlower), 2u);
+    EXPECT_GE(CountIf(pw, iswupper), 3u);
+    EXPECT_GE(CountIf(pw, iswdigit), 4u);
+    EXPECT_GE(std::count_if(pw.begin(), pw.end(),
+                            [](charT c) {return c == _T('#') || c == _T('!');}), 1);
+    for (auto c : pw)
+      EXPECT_TRUE(iswalnum(c) || c == _T('#') || c == _T('!')) << int(c);
+  }
+  // Random passwords of this length shouldn't collide
+  EXPECT_EQ(std::set<StringX>(pws.begin(), pws.end()).size(), pws.size());
+
+  // Single-shot path obeys the same rules
+  const StringX pw = pol.MakeRandomPassword();
+  EXPECT_EQ(pw.length(), 12u);
+  EXPECT_GE(CountIf(pw, iswdigit), 4u);
+}
+
+TEST(PWCharPoolTest, Hex)
+{
+  const PWPolicy pol = MakePolicy(PWPolicy::UseHexDigits, 32);
+  for (const auto &pw : pol.MakeRandomPasswords(50)) {
+    ASSERT_EQ(pw.length(), 32u);
+    for (auto c : pw)
+      EXPECT_TRUE(iswdigit(c) || (c >= _T('a') && c <= _T('f'))) << int(c);
+  }
+}
+
+TEST(PWCharPoolTest, EasyVision)
+{
+  const PWPolicy pol = MakePolicy(PWPolicy::UseLowercase | PWPolicy::UseUppercase |
+                                  PWPolicy::UseDigits | PWPolicy::UseEasyVision, 40);
+  const StringX ambiguous = _T("lIO0125");
+  for (const auto &pw : pol.MakeRandomPasswords(50)) {
+    ASSERT_EQ(pw.length(), 40u);
+    EXPECT_EQ(pw.find_first_of(ambiguous), StringX::npos) << pw.c_str();
+  }
+}
+
+TEST(PWCharPoolTest, Pronounceable)
+{
+  PWPolicy pol = MakePolicy(PWPolicy::MakePronounceable | PWPolicy::UseLowercase, 10);
+  for (const auto &pw : pol.MakeRandomPasswords(100)) {
+    ASSERT_GE(pw.length(), 3u);
+    ASSERT_LE(pw.length(), 10u);
+    EXPECT_EQ(CountIf(pw, iswlower), pw.length()) << pw.c_str();
+  }
+
+  pol.flags = PWPolicy::MakePronounceable | PWPolicy::UseUppercase;
+  for (const auto &pw : pol.MakeRandomPasswords(100))
+    EXPECT_EQ(CountIf(pw, iswupper), pw.length()) << pw.c_str();
+
+  // With digits, at least one letter gets a 'leet' substitute
+  // whenever a candidate exists
+  pol.flags = PWPolicy::MakePronounceable | PWPolicy::UseLowercase | PWPolicy::UseDigits;
+  pol.length = 20;
+  size_t withDigits = 0;
+  for (const auto &pw : pol.MakeRandomPasswords(100))
+    if (CountIf(pw, iswdigit) > 0)
+      withDigits++;
+  EXPECT_GT(withDigits, 90u);
+}
@@ -0,0 +1,94 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// PWSLogTest.cpp: Unit test for the PWSLog ring buffer
+
+#ifdef WIN32
+#include "../ui/Windows/stdafx.h"
+#endif
+
+#include "core/PWSLog.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+  // Number of records claimed by the header of a DumpLog
+  size_t RecordCount(const stringT &dump)
+  {
+    std::wistringstream is(dump);
+    std::wstring header;
+    size_t count = 0;
+    is >> header >> count;
+    EXPECT_EQ(L"US04", header);
+    return count;
+  }
+}
+
+TEST(PWSLogTest, FormatOnDump)
+{
+  const std::wstring name(L"SomePref");
+  int *ptr = nullptr;
+  PWS_LOGIT;
+  PWS_LOGIT_ARGS("bUseCopy=%ls", L"true");
+  PWS_LOGIT_ARGS("Name: %ls; index=%d; flags=0x%04x; p=%p", name.c_str(), -3, 42u, ptr);
+  PWS_LOGERR_ARGS0("Failed: READ_FAIL");
+
+  const stringT dump = PWSLog::GetLog()->DumpLog();
+  EXPECT_NE(stringT::npos, dump.find(L"PWSLogTest.cpp;\t"));
+  EXPECT_NE(stringT::npos, dump.find(L"bUseCopy=true"));
+  EXPECT_NE(stringT::npos, dump.find(L"Name: SomePref; index=-3; flags=0x002a; p="));
+  // Newest first
+  EXPECT_LT(dump.find(L"Failed: READ_FAIL"), dump.find(L"bUseCopy=true"));
+}
+
+TEST(PWSLogTest, Wraparound)
+{
+  for (int i = 0; i < PWSLog::NUM_LOG_ENTRIES + 50; i++)
+    PWS_LOGIT_ARGS("event %d", i);
+
+  const stringT dump = PWSLog::GetLog()->DumpLog();
+  EXPECT_EQ(static_cast<size_t>(PWSLog::NUM_LOG_ENTRIES), RecordCount(dump));
+  EXPECT_NE(stringT::npos, dump.find(L"event 305 "));
+  EXPECT_NE(stringT::npos, dump.find(L"event 50 "));
+  EXPECT_EQ(stringT::npos, dump.find(L"event 49 "));
+}
+
+TEST(PWSLogTest, LongStringTruncated)
+{
+  const std::wstring s(1000, L'x');
+  PWS_LOGIT_ARGS("%ls|%ls", s.c_str(), L"gone");
+
+  const stringT dump = PWSLog::GetLog()->DumpLog();
+  const std::wstring expected = std::wstring(PWSLog::MAX_ARG_CHARS, L'x') + L"|";
+  const size_t pos = dump.find(expected);
+  ASSERT_NE(stringT::npos, pos);
+  EXPECT_NE(L'x', dump[pos - 1]);
+  EXPECT_NE(L"gone", dump.substr(pos + expected.length(), 4));
+}
+
+TEST(PWSLogTest, ConcurrentAdd)
+{
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++)
+    threads.emplace_back([t]() {
+      for (int i = 0; i < 5000; i++)
+        PWS_LOGIT_ARGS("thread %d event %d", t, i);
+    });
+  // Dump while others are writing: must not crash, and must only
+  // return whole records
+  for (int i = 0; i < 10; i++)
+    EXPECT_LE(RecordCount(PWSLog::GetLog()->DumpLog()),
+              static_cast<size_t>(PWSLog::NUM_LOG_ENTRIES));
+  for (auto &th : threads)
+    th.join();
+
+  EXPECT_EQ(static_cast<size_t>(PWSLog::NUM_LOG_ENTRIES),
+            RecordCount(PWSLog::GetLog()->DumpLog()));
+}
@@ -0,0 +1,47 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// PWSrandBench.cpp: Throughput benchmark for PWSrand
+//
+// Not part of coretest: configure with -DBUILD_BENCHMARKS=ON and run
+// pwsrandbench by hand.
+#ifdef WIN32
+#include "../ui/Windows/stdafx.h"
+#endif
+
+#include "core/PWSrand.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace {
+  void bench(const char *name, unsigned long reqsize, unsigned long total)
+  {
+    PWSrand *rnd = PWSrand::GetInstance();
+    std::vector<unsigned char> buf(reqsize);
+    const unsigned long n = total / reqsize;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < n; i++)
+      rnd->GetRandomData(buf.data(), reqsize);
+    std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << n << " x " << reqsize << " bytes in "
+              << secs.count() << "s ("
+              << (double(n) * reqsize / (1024 * 1024)) / secs.count() << " MiB/s)"
+              << std::endl;
+  }
+}
+
+int main()
+{
+  bench("bulk", 64 * 1024, 256 * 1024 * 1024);
+  // ItemField pads each field with < 16 bytes of random data
+  bench("tiny", 7, 64 * 1024 * 1024);
+
+  PWSrand::DeleteInstance();
+  return 0;
+}
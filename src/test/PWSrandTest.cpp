@@ -0,0 +1,109 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// PWSrandTest.cpp: Unit test for PWSrand
+#ifdef WIN32
+#include "../ui/Windows/stdafx.h"
+#endif
+
+#include "core/PWSrand.h"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+TEST(PWSrandTest, GetRandomData)
+{
+  PWSrand *rnd = PWSrand::GetInstance();
+  // Span several internal buffers, and make sure successive
+  // requests don't repeat
+  std::vector<unsigned char> a(5000), b(5000);
+  rnd->GetRandomData(a.data(), static_cast<unsigned long>(a.size()));
+  rnd->GetRandomData(b.data(), static_cast<unsigned long>(b.size()));
+  EXPECT_NE(a, b);
+
+  // Every byte value should show up in 10000 random bytes
+  std::vector<bool> seen(256);
+  for (auto c : a) seen[c] = true;
+  for (auto c : b) seen[c] = true;
+  for (int i = 0; i < 256; i++)
+    EXPECT_TRUE(seen[i]) << "byte value " << i;
+
+  // Tiny requests must not repeat either
+  unsigned char t1[3], t2[3];
+  rnd->GetRandomData(t1, sizeof(t1));
+  rnd->GetRandomData(t2, sizeof(t2));
+  rnd->GetRandomData(t2, 0); // no-op
+  EXPECT_NE(memcmp(t1, t2, sizeof(t1)), 0);
+}
+
+TEST(PWSrandTest, RangeRand)
+{
+  PWSrand *rnd = PWSrand::GetInstance();
+  std::vector<int> counts(10);
+  for (int i = 0; i < 10000; i++) {
+    unsigned int r = rnd->RangeRand(counts.size());
+    ASSERT_LT(r, counts.size());
+    counts[r]++;
+  }
+  for (auto c : counts)
+    EXPECT_GT(c, 800);
+  EXPECT_EQ(rnd->RangeRand(0), 0u);
+  EXPECT_EQ(rnd->RangeRand(1), 0u);
+}
+
+TEST(PWSrandTest, AddEntropy)
+{
+  PWSrand *rnd = PWSrand::GetInstance();
+  unsigned char a[32], b[32];
+  rnd->GetRandomData(a, sizeof(a));
+  unsigned char e[] = "some entropy";
+  rnd->AddEntropy(e, sizeof(e));
+  rnd->GetRandomData(b, sizeof(b));
+  EXPECT_NE(memcmp(a, b, sizeof(a)), 0);
+}
+
+TEST(PWSrandTest, ThreadInstance)
+{
+  PWSrand *mine = PWSrand::GetThreadInstance();
+  EXPECT_EQ(mine, PWSrand::GetThreadInstance());
+  EXPECT_NE(mine, PWSrand::GetInstance());
+
+  const int NTHREADS = 4;
+  std::vector<PWSrand *> instances(NTHREADS);
+  std::vector<std::vector<unsigned char>> data(NTHREADS);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < NTHREADS; i++) {
+    threads.emplace_back([i, &instances, &data]() {
+      PWSrand *rnd = PWSrand::GetThreadInstance();
+      instances[i] = rnd;
+      rnd->SetReseedInterval(4096); // force a few reseeds
+      data[i].resize(64 * 1024);
+      for (size_t off = 0; off < data[i].size(); off += 1024)
+        rnd->GetRandomData(data[i].data() + off, 1024);
+      // while others hammer the shared one
+      for (int j = 0; j < 1000; j++)
+        PWSrand::GetInstance()->RandUInt();
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  for (int i = 0; i < NTHREADS; i++) {
+    EXPECT_NE(instances[i], mine);
+    // (instance addresses may be reused once a thread has exited)
+    for (int j = i + 1; j < NTHREADS; j++)
+      EXPECT_NE(data[i], data[j]);
+  }
+
+  unsigned char a[32], b[32];
+  mine->GetRandomData(a, sizeof(a));
+  mine->Reseed();
+  mine->GetRandomData(b, sizeof(b));
+  EXPECT_NE(memcmp(a, b, sizeof(a)), 0);
+}
@@ -0,0 +1,66 @@
+/*
+* Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+* All rights reserved. Use of the code is allowed under the
+* Artistic License 2.0 terms, as specified in the LICENSE file
+* distributed with this code, or available from
+* http://www.opensource.org/licenses/artistic-license-2.0.php
+*/
+// PasswordStrengthTest.cpp: Unit test for the password strength estimator
+
+#ifdef WIN32
+#include "../ui/Windows/stdafx.h"
+#endif
+
+#include "core/PasswordStrength.h"
+#include "core/PWCharPool.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+  // Bounds of the "weak" and "medium" bands of the strength meters
+  const double WEAK = 33, MEDIUM = 66;
+
+  double Estimate(const wchar_t *pwd)
+  {
+    return PasswordStrength::Estimate(StringX(pwd));
+  }
+}
+
+TEST(PasswordStrengthTest, Bounds)
+{
+  EXPECT_EQ(0.0, Estimate(L""));
+  EXPECT_GT(Estimate(L"x"), 0.0);
+  EXPECT_EQ(PasswordStrength::MAX_STRENGTH, Estimate(L"Wq7#zR!u9@Lp2$Xe5%Ky8^Mv3&Nb6*Tj"));
+
+  // Lots of nothing is still nothing much
+  EXPECT_LT(Estimate(StringX(1000, L'a').c_str()), WEAK);
+}
+
+TEST(PasswordStrengthTest, Patterns)
+{
+  // Each of these is rated "strong" by CalculatePasswordStrength
+  const wchar_t *weak[] = {
+    L"password", L"Password1", L"p@ssw0rd", L"drowssap", // common, l33t, reversed
+    L"qwertyuiop", L"1qaz2wsx", L"zxcvbnm,./",           // keyboard walks
+    L"abcdefghijk", L"9876543210", L"acegikmoq",         // sequences
+    L"xkcdxkcdxkcd", L"zzzzzzzzzzzzzzzz",                // repeats
+    L"iloveyou1987", L"Sunshine2020!",                   // word + year
+  };
+  for (auto pwd : weak)
+    EXPECT_LT(Estimate(pwd), WEAK) << pwd;
+
+  EXPECT_GT(Estimate(L"k9#Vq2!xT7@mZ4&w"), MEDIUM);
+}
+
+TEST(PasswordStrengthTest, Ordering)
+{
+  // English-like text is easier to guess than random letters
+  EXPECT_LT(Estimate(L"thequickbrownfox"), Estimate(L"xqzjvkwpmbtfyhrg"));
+  // Capitalizing the first letter is worth less than a random capital
+  EXPECT_LT(Estimate(L"Monkey"), Estimate(L"monKey"));
+  EXPECT_LT(Estimate(L"monkey"), Estimate(L"Monkey"));
+  // Anything not ASCII is hard to guess
+  EXPECT_GT(Estimate(L"אבגדהו"), Estimate(L"abcxyz"));
+  // Longer is stronger
+  EXPECT_LT(Estimate(L"k9#Vq2"), Estimate(L"k9#Vq2!x"));
+}
@@ -11,7 +11,9 @@
 #include "../ui/Windows/stdafx.h"
 #endif
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 #include "core/StringX.h"
 #include "core/StringXStream.h"
@@ -179,6 +181,37 @@ TEST(StringXTest, testAssign)
   EXPECT_TRUE(s1 == s2);
 }
 
+TEST(StringXTest, testSecureAlloc)
+{
+  S_Alloc::SecureAlloc<wchar_t> alloc;
+
+  // Small blocks are recycled, and wiped before they're handed out again
+  wchar_t *p = alloc.allocate(20);
+  std::fill(p, p + 20, L'x');
+  alloc.deallocate(p, 20);
+  wchar_t *q = alloc.allocate(20);
+  EXPECT_EQ(p, q);
+  EXPECT_TRUE(std::all_of(q, q + 20, [](wchar_t c) { return c == 0; }));
+  alloc.deallocate(q, 20);
+
+  // Blocks of different size classes don't overlap
+  std::vector<std::pair<wchar_t *, size_t>> blocks;
+  for (size_t n = 1; n < 200; n += 7) {
+    wchar_t *b = alloc.allocate(n);
+    std::fill(b, b + n, wchar_t(n));
+    blocks.push_back({b, n});
+  }
+  for (const auto &b : blocks) {
+    EXPECT_TRUE(std::all_of(b.first, b.first + b.second,
+                            [&b](wchar_t c) { return c == wchar_t(b.second); }));
+    alloc.deallocate(b.first, b.second);
+  }
+
+  // Large strings bypass the pool
+  StringX big(10000, L'z'), copy(big);
+  EXPECT_EQ(big, copy);
+}
+
 
 TEST(TrimLeft, SpaceOnLeft) {
   wstring s{L" abc"};
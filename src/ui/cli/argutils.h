@@ -37,7 +37,7 @@ struct UserArgs {
   StringX safe;
   StringX passphrase[2];
   enum OpType {Unset, Import, Export, CreateNew, Search, Add,
-               Diff, Sync, Merge, Help} Operation{Unset};
+               Diff, Sync, Merge, Generate, RotateExpired, Help} Operation{Unset};
   enum {Print, Delete, Update, ClearFields, ChangePassword, GenerateTotpCode} SearchAction{Print};
   enum {Unknown, XML, Text} Format{Unknown};
 
@@ -62,6 +62,9 @@ struct UserArgs {
   DiffFmt dfmt{DiffFmt::Unified};
   unsigned int colwidth{60}; // for side-by-side diff
 
+  // used by generate, rotate-expired & newpass
+  std::wstring policyName;
+
   // used by add & update
   using FieldValue = std::tuple<CItemData::FieldType, StringX>;
   using FieldUpdates = std::vector< FieldValue >;
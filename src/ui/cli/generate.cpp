@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+ * All rights reserved. Use of the code is allowed under the
+ * Artistic License 2.0 terms, as specified in the LICENSE file
+ * distributed with this code, or available from
+ * http://www.opensource.org/licenses/artistic-license-2.0.php
+ */
+
+#include "stdafx.h"
+#include "./generate.h"
+#include "./argutils.h"
+#include "./safeutils.h"
+#include "./strutils.h"
+
+#include "core/PWScore.h"
+#include "core/PWPolicy.h"
+#include "core/Util.h"
+
+#include <iostream>
+#include <cwctype>
+
+using namespace std;
+
+int GeneratePasswords(PWScore &core, const UserArgs &ua)
+{
+  size_t count = 0;
+  if (!ua.opArg.empty() && iswdigit(ua.opArg[0])) try {
+    size_t pos = 0;
+    const unsigned long n = stoul(ua.opArg, &pos);
+    if (pos == ua.opArg.length())
+      count = n;
+  } catch (const std::exception &) {
+    // count remains 0, reported below
+  }
+  if (count == 0) {
+    wcerr << L"Invalid number of passwords to generate: " << ua.opArg << endl;
+    return PWScore::FAILURE;
+  }
+
+  PWPolicy pwp;
+  if (ua.policyName.empty()) {
+    if (InitPWPolicy(pwp, core) != PWScore::SUCCESS) {
+      wcerr << L"Error initializing default password policy" << endl;
+      return PWScore::FAILURE;
+    }
+  } else if (!core.GetPolicyFromName(std2stringx(ua.policyName), pwp)) {
+    wcerr << L"No such password policy: " << ua.policyName << endl;
+    return PWScore::FAILURE;
+  }
+
+  // Generate in batches, to bound memory when asked for millions
+  const size_t BATCH = 4096;
+  while (count > 0) {
+    const size_t n = min(count, BATCH);
+    for (const auto &pw : pwp.MakeRandomPasswords(n))
+      wcout << pw << L'\n';
+    count -= n;
+  }
+  wcout.flush();
+  return PWScore::SUCCESS;
+}
+
+int RotateExpiredPasswords(PWScore &core, const UserArgs &ua)
+{
+  int idays = 0;
+  if (!ua.opArg.empty()) {
+    if (!iswdigit(ua.opArg[0])) {
+      wcerr << L"Invalid number of days: " << ua.opArg << endl;
+      return PWScore::FAILURE;
+    }
+    idays = stoi(ua.opArg);
+  }
+
+  PWPolicy pwp;
+  if (!ua.policyName.empty() && !core.GetPolicyFromName(std2stringx(ua.policyName), pwp)) {
+    wcerr << L"No such password policy: " << ua.policyName << endl;
+    return PWScore::FAILURE;
+  }
+
+  UUIDVector uuids;
+  for (const auto &ee : core.GetExpired(idays)) {
+    auto iter = core.Find(ee.uuid);
+    if (iter == core.GetEntryEndIter())
+      continue;
+    const CItemData &ci = iter->second;
+    wcout << st_GroupTitleUser{ci.GetGroup(), ci.GetTitle(), ci.GetUser()} << L" ["
+          << PWSUtil::ConvertToDateTimeString(ee.expirytttXTime, PWSUtil::TMC_EXPORT_IMPORT)
+          << L"]" << endl;
+    uuids.push_back(ee.uuid);
+  }
+
+  if (uuids.empty()) {
+    wcout << L"No expired passwords" << endl;
+    return PWScore::SUCCESS;
+  }
+
+  if (!ua.confirmed) {
+    wchar_t choice{};
+    wcout << L"Change " << uuids.size() << L" password(s) [y/n]? ";
+    wcin >> choice;
+    if (choice != L'y' && choice != L'Y')
+      return PWScore::SUCCESS;
+  }
+
+  size_t numRotated = 0;
+  const int status = core.RotatePasswords(uuids, std2stringx(ua.policyName), numRotated);
+  if (status == PWScore::SUCCESS)
+    wcout << numRotated << L" password(s) changed" << endl;
+  return status;
+}
+
+int SaveAfterRotate(PWScore &core, const UserArgs &ua)
+{
+  if (!ua.dry_run && core.HasDBChanged())
+    return core.WriteCurFile();
+
+  return PWScore::SUCCESS;
+}
@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+ * All rights reserved. Use of the code is allowed under the
+ * Artistic License 2.0 terms, as specified in the LICENSE file
+ * distributed with this code, or available from
+ * http://www.opensource.org/licenses/artistic-license-2.0.php
+ */
+
+#pragma once
+
+struct UserArgs;
+class PWScore;
+
+// Writes --generate=N passwords per --policy (or the default policy)
+// to stdout, one per line
+int GeneratePasswords(PWScore &core, const UserArgs &ua);
+
+// Changes the passwords of all entries that have expired, or will expire
+// within --rotate-expired=days, per --policy (or each entry's own policy)
+int RotateExpiredPasswords(PWScore &core, const UserArgs &ua);
+int SaveAfterRotate(PWScore &core, const UserArgs &ua);
@@ -31,6 +31,7 @@
 #include "./diff.h"
 #include "./safeutils.h"
 #include "./impexp.h"
+#include "./generate.h"
 #include "./cli-version.h"
 
 #include "core/PWScore.h"
@@ -92,6 +93,8 @@ const map<UserArgs::OpType, pws_op> pws_ops = {
   { UserArgs::Diff,       {OpenCore,        Diff,       null_op}},
   { UserArgs::Sync,       {OpenCore,        Sync,       SaveCore}},
   { UserArgs::Merge,      {OpenCore,        Merge,      SaveCore}},
+  { UserArgs::Generate,   {OpenCore,        GeneratePasswords, null_op}},
+  { UserArgs::RotateExpired, {OpenCore,     RotateExpiredPasswords, SaveAfterRotate}},
 };
 
 static wstring usage_string = LR"usagestring(
@@ -105,7 +108,8 @@ Usage: %PROGNAME% safe --imp[=file] --text|--xml
 
        %PROGNAME% safe --search=<text> [--ignore-case]
                       [--subset=<Field><OP><string>[/iI] [--fields=f1,f2,..]
-                      [--delete | --update=Field1=Value1,Field2=Value2,.. | --print[=field1,field2...] ] [--yes]
+                      [--delete | --update=Field1=Value1,Field2=Value2,.. | --print[=field1,field2...] |
+                       --newpass [--policy=<policy-name>] ] [--yes]
                       [--generate-totp]
 
        %PROGNAME% safe --diff=<other-safe> [ --subset=<Field><OP><Value>[/iI] ]
@@ -116,6 +120,10 @@ Usage: %PROGNAME% safe --imp[=file] --text|--xml
 
        %PROGNAME% safe --merge=<other-safe> [ --subset=<Field><OP><Value>[/iI] ] [--yes]
 
+       %PROGNAME% safe --generate=N [--policy=<policy-name>]
+
+       %PROGNAME% safe --rotate-expired[=days] [--policy=<policy-name>] [--yes]
+
                         where OP is one of ==, !==, ^= !^=, $=, !$=, ~=, !~=
                          = => exactly similar
                          ^ => begins with
@@ -203,6 +211,32 @@ static std::wstring help_delete_string = LR"helpstring(
           This deletes the found entry without asking for confirmation.
 )helpstring";
 
+static std::wstring help_generate_string = LR"helpstring(
+ Example: Generating passwords
+
+            %PROGNAME% pwsafe.psafe3 --generate=1000 --policy="Web sites"
+
+          This writes 1000 passwords made according to the named password policy "Web sites"
+          of database pwsafe.psafe3 to standard output, one per line. Without --policy, the
+          default password policy is used.
+)helpstring";
+
+static std::wstring help_rotate_string = LR"helpstring(
+ Example: Changing the passwords of expired entries
+
+            %PROGNAME% pwsafe.psafe3 --rotate-expired=7 --policy="Web sites"
+
+          This lists the entries of database pwsafe.psafe3 whose passwords have expired or
+          will expire within the next 7 days and, after confirmation, replaces all of them with
+          passwords made according to the password policy "Web sites". Without --policy, each
+          entry's own password policy (or the default policy) is used. The old passwords are kept
+          in the entries' password history.
+
+            %PROGNAME% pwsafe.psafe3 --search="Bank" --newpass --policy="Banking"
+
+          Similarly, this changes the passwords of the matching entries after confirmation.
+)helpstring";
+
 static std::wstring help_synchronize_string = LR"helpstring(
  Example: Synchronizing databases
 
@@ -217,6 +251,8 @@ const map<wstring, wstring> pws_help_examples = {
   { L"update",      help_update_string      },
   { L"search",      help_search_string      },
   { L"delete",      help_delete_string      },
+  { L"generate",    help_generate_string    },
+  { L"rotate",      help_rotate_string      },
   { L"sync",        help_synchronize_string },
   { L"synchronize", help_synchronize_string },
 };
@@ -325,7 +361,7 @@ bool parseArgs(int argc, char *argv[], UserArgs &ua)
   }
 
   try {
-    static const char* short_options = "i::e::txcs:b:f:oa:u:p::rl:vyd:gjknz:m:w:P:Q:GVh::";
+    static const char* short_options = "i::e::txcs:b:f:oa:u:p::rl:vyd:gjknz:m:w:P:Q:GR:L:E::Vh::";
     static constexpr struct option long_options[] = {
       // name,          has_arg,            flag,    val
       {"import",        optional_argument,  nullptr, 'i'},
@@ -355,6 +391,9 @@ bool parseArgs(int argc, char *argv[], UserArgs &ua)
       {"passphrase",    required_argument,  nullptr, 'P'},
       {"passphrase2",   required_argument,  nullptr, 'Q'},
       {"generate-totp", no_argument,        nullptr, 'G'},
+      {"generate",      required_argument,  nullptr, 'R'},
+      {"policy",        required_argument,  nullptr, 'L'},
+      {"rotate-expired", optional_argument, nullptr, 'E'},
       {"verbose",       no_argument,        nullptr, 'V'},
       {"help",          optional_argument,  nullptr, 'h'},
       {nullptr,         0,                  nullptr,  0 }
@@ -505,6 +544,20 @@ bool parseArgs(int argc, char *argv[], UserArgs &ua)
         ua.SearchAction = UserArgs::GenerateTotpCode;
         break;
 
+      case 'R':
+        assert(optarg);
+        ua.SetMainOp(UserArgs::Generate, optarg);
+        break;
+
+      case 'L':
+        assert(optarg);
+        ua.policyName = Utf82wstring(optarg);
+        break;
+
+      case 'E':
+        ua.SetMainOp(UserArgs::RotateExpired, optarg);
+        break;
+
       case 'V':
         ua.verbosity_level++;
         break;
@@ -584,6 +637,7 @@ int main(int argc, char *argv[])
 
   if (itr != pws_ops.end()) {
     const bool openReadOnly = ua.Operation == UserArgs::Export || ua.Operation == UserArgs::Diff ||
+                              ua.Operation == UserArgs::Generate ||
                               (ua.Operation == UserArgs::Search && (ua.SearchAction == UserArgs::Print || ua.SearchAction == UserArgs::GenerateTotpCode));
     PWScore core;
     try {
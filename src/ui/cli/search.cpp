@@ -232,8 +232,8 @@ int SearchInternal(PWScore &core, const UserArgs &ua, wostream &os)
     }
 
     case UserArgs::ChangePassword:
-      return DoSearch<UserArgs::ChangePassword>(core, ua, [&core](const ItemPtrVec &matches) {
-        return ChangePasswordOfSearchResults(matches, core);
+      return DoSearch<UserArgs::ChangePassword>(core, ua, [&core, &ua](const ItemPtrVec &matches) {
+        return ChangePasswordOfSearchResults(matches, core, ua.policyName);
       });
 
     case UserArgs::GenerateTotpCode:
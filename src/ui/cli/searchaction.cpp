@@ -99,49 +99,19 @@ int ClearFieldsOfSearchResults(const ItemPtrVec &items, PWScore &core,
   return PWScore::SUCCESS;
 }
 
-int ChangePasswordOfSearchResults(const ItemPtrVec &items, PWScore &core)
+int ChangePasswordOfSearchResults(const ItemPtrVec &items, PWScore &core,
+                                  const std::wstring &policyName)
 {
-  // Helper class to (1) find the correct policy for an entry and (2) to
-  // initialize the default policy only once & only if required
-  class PWPolicyForEntry
-  {
-    PWScore *core;
-    std::unique_ptr<PWPolicy> defpwp;
-
-  public:
-    PWPolicyForEntry(PWScore *c): core{c} {}
-    PWPolicy Get(const CItemData *entry)
-    {
-      PWPolicy pwp;
-      if ( entry->IsPolicyNameSet() ) {
-        if ( core->GetPolicyFromName( entry->GetPolicyName(), pwp ) )
-          return pwp;
-      }
-
-      if ( entry->IsPasswordPolicySet() ) {
-        entry->GetPWPolicy(pwp);
-        return pwp;
-      }
-
-      if ( !defpwp ) {
-        defpwp.reset( new PWPolicy );
-        auto initfn = [this]() {
-          if ( InitPWPolicy(*defpwp, *core) != PWScore::SUCCESS )
-              throw std::logic_error("Could not initialize default password policy");
-        };
-        initfn();
-      };
-
-      return *defpwp;
-    }
-  };
-
-  PWPolicyForEntry pol(&core);
-  for( auto p: items ) {
-    auto it = core.Find(p->GetUUID());
-    it->second.SetPassword( pol.Get(p).MakeRandomPassword() );
-  }
-  return PWScore::SUCCESS;
+  UUIDVector uuids;
+  uuids.reserve(items.size());
+  for( auto p: items )
+    uuids.push_back(p->GetUUID());
+
+  size_t numRotated = 0;
+  int status = core.RotatePasswords(uuids, std2stringx(policyName), numRotated);
+  if ( status != PWScore::SUCCESS && !policyName.empty() )
+    wcerr << L"Could not change passwords using policy: " << policyName << endl;
+  return status;
 }
 
 int GenerateTotpCodeForSearchResults(const ItemPtrVec& items, PWScore&, std::wostream& os, int verbosity_level) 
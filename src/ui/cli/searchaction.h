@@ -22,7 +22,7 @@ int PrintSearchResults(const ItemPtrVec &items, PWScore &core, const CItemData::
 int DeleteSearchResults(const ItemPtrVec &items, PWScore &core);
 int UpdateSearchResults(const ItemPtrVec &items, PWScore &core, const FieldUpdates &updates);
 int ClearFieldsOfSearchResults(const ItemPtrVec &items, PWScore &core, const CItemData::FieldBits &ftp);
-int ChangePasswordOfSearchResults(const ItemPtrVec &items, PWScore &core);
+int ChangePasswordOfSearchResults(const ItemPtrVec &items, PWScore &core, const std::wstring &policyName);
 int GenerateTotpCodeForSearchResults(const ItemPtrVec& items, PWScore& core, std::wostream& os, int verbosity_level);
 
 template <int action>
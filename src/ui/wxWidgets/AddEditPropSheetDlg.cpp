@@ -2340,9 +2340,7 @@ void AddEditPropSheetDlg::UpdatePasswordConfirmationAsterisk(bool show)
 
 void AddEditPropSheetDlg::UpdatePasswordStrengthMeter()
 {
-  const auto password = tostringx(m_BasicPasswordTextCtrl->GetValue());
-  auto strength = CPasswordCharPool::CalculatePasswordStrength(password);
-  m_BasicStrengthMeter->SetStrength(strength);
+  m_BasicStrengthMeter->SetPassword(tostringx(m_BasicPasswordTextCtrl->GetValue()));
 }
 
 void AddEditPropSheetDlg::ShowAlias()
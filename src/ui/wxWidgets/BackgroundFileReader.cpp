@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+ * All rights reserved. Use of the code is allowed under the
+ * Artistic License 2.0 terms, as specified in the LICENSE file
+ * distributed with this code, or available from
+ * http://www.opensource.org/licenses/artistic-license-2.0.php
+ */
+
+/** \file BackgroundFileReader.cpp
+*
+*/
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include <wx/wxprec.h>
+
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+#include <wx/progdlg.h>
+#include <wx/stopwatch.h>
+
+#include "BackgroundFileReader.h"
+#include "wxUtilities.h"
+
+#include "core/Proxy.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifdef __WXMSW__
+#include <wx/msw/msvcrt.h>
+#endif
+
+namespace {
+const int PROGRESS_RANGE = 1000;
+const long SHOW_DELAY_MS = 500; // small databases open before a dialog would be noticed
+const unsigned long POLL_INTERVAL_MS = 50;
+
+// Runs calls from the reading thread on the main thread, which is where
+// the wx Asker and Reporter have to show their message boxes
+class Marshaller
+{
+public:
+  // Reading thread: blocks until the main thread has run fn
+  bool Call(const std::function<bool()> &fn)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_pending = &fn;
+    m_cv.wait(lock, [this] { return m_pending == nullptr; });
+    return m_result;
+  }
+
+  // Main thread: runs the pending call, if any
+  void Service()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_pending == nullptr)
+      return;
+    const std::function<bool()> *fn = m_pending;
+    lock.unlock();
+    const bool result = (*fn)();
+    lock.lock();
+    m_result = result;
+    m_pending = nullptr;
+    m_cv.notify_one();
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  const std::function<bool()> *m_pending = nullptr;
+  bool m_result = false;
+};
+
+class MarshalledAsker : public Asker
+{
+public:
+  MarshalledAsker(Marshaller &m, Asker *asker) : m_marshaller(m), m_asker(asker) {}
+  bool operator()(const stringT &question) override
+  {return m_marshaller.Call([&] { return (*m_asker)(question); });}
+  bool operator()(const stringT &title, const stringT &question) override
+  {return m_marshaller.Call([&] { return (*m_asker)(title, question); });}
+
+private:
+  Marshaller &m_marshaller;
+  Asker *m_asker;
+};
+
+class MarshalledReporter : public Reporter
+{
+public:
+  MarshalledReporter(Marshaller &m, Reporter *reporter) : m_marshaller(m), m_reporter(reporter) {}
+  void operator()(const stringT &message) override
+  {m_marshaller.Call([&] { (*m_reporter)(message); return true; });}
+  void operator()(const stringT &title, const stringT &message) override
+  {m_marshaller.Call([&] { (*m_reporter)(title, message); return true; });}
+
+private:
+  Marshaller &m_marshaller;
+  Reporter *m_reporter;
+};
+} // namespace
+
+int BackgroundFileReader::Read(const StringX &filename, const StringX &passkey,
+                               const bool bValidate, const size_t iMAXCHARS)
+{
+  Marshaller marshaller;
+  Asker *asker = PWScore::GetAsker();
+  Reporter *reporter = PWScore::GetReporter();
+  MarshalledAsker marshalledAsker(marshaller, asker);
+  MarshalledReporter marshalledReporter(marshaller, reporter);
+  if (asker != nullptr)
+    PWScore::SetAsker(&marshalledAsker);
+  if (reporter != nullptr)
+    PWScore::SetReporter(&marshalledReporter);
+
+  std::atomic<ulong64> bytesRead(0), fileLength(0);
+  std::atomic<bool> cancelled(false), finished(false);
+  int status = PWScore::FAILURE;
+
+  std::thread reader([&] {
+    status = m_core.ReadFile(filename, passkey, bValidate, iMAXCHARS, nullptr,
+                             [&](ulong64 done, ulong64 total) {
+                               bytesRead = done;
+                               fileLength = total;
+                               return !cancelled;
+                             });
+    finished = true;
+  });
+
+  // Cancel only takes effect once the records are being read, i.e., after
+  // the key has been derived from the passkey, which can't be interrupted.
+  wxStopWatch sw;
+  std::unique_ptr<wxProgressDialog> progress;
+  while (!finished) {
+    marshaller.Service();
+    if (!progress && sw.Time() > SHOW_DELAY_MS) {
+      progress.reset(new wxProgressDialog(_("Opening database"),
+                                          towxstring(filename), PROGRESS_RANGE, m_parent,
+                                          wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME));
+    }
+    if (progress) {
+      const ulong64 total = fileLength;
+      // Stay short of the maximum, which would end the dialog's modality
+      const int value = total == 0 ? 0 :
+        std::min(int(bytesRead * PROGRESS_RANGE / total), PROGRESS_RANGE - 1);
+      if (!progress->Update(value))
+        cancelled = true;
+    }
+    wxMilliSleep(POLL_INTERVAL_MS);
+  }
+  reader.join();
+
+  PWScore::SetAsker(asker);
+  PWScore::SetReporter(reporter);
+  return status;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+ * All rights reserved. Use of the code is allowed under the
+ * Artistic License 2.0 terms, as specified in the LICENSE file
+ * distributed with this code, or available from
+ * http://www.opensource.org/licenses/artistic-license-2.0.php
+ */
+
+/** \file BackgroundFileReader.h
+*
+* Reads a database on a worker thread, so that the UI stays responsive
+* while a large file is decrypted. A progress dialog with a Cancel button
+* is shown if the read takes more than a moment; the calling thread waits
+* for the read to finish or be cancelled, so the views are only populated
+* once the core holds the whole database.
+*
+* TimedTaskChain runs its tasks on the main thread, one timer tick at a
+* time, which can't help with a single long call like PWScore::ReadFile.
+*/
+
+#ifndef _BACKGROUNDFILEREADER_H_
+#define _BACKGROUNDFILEREADER_H_
+
+#include "core/PWScore.h"
+#include "core/StringX.h"
+
+class wxWindow;
+
+class BackgroundFileReader
+{
+public:
+  BackgroundFileReader(wxWindow *parent, PWScore &core) : m_parent(parent), m_core(core) {}
+
+  // Same arguments and return values as PWScore::ReadFile, plus USER_CANCEL
+  // if the user cancelled the read. Must be called on the main thread.
+  int Read(const StringX &filename, const StringX &passkey,
+           const bool bValidate = false, const size_t iMAXCHARS = 0);
+  int ReadCurFile(const StringX &passkey)
+  {return Read(m_core.GetCurFile(), passkey);}
+
+private:
+  wxWindow *m_parent;
+  PWScore &m_core;
+};
+
+#endif // _BACKGROUNDFILEREADER_H_
@@ -359,7 +359,9 @@ void CompareDlg::DoCompare(wxCommandEvent& WXUNUSED(evt))
                          m_current->data,
                          m_comparison->data,
                          m_conflicts->data,
-                         m_identical->data);
+                         m_identical->data,
+                         nullptr,
+                         false); // the grids look up group/title/user for the rows on screen
 
   struct {
     ComparisonData* cd;
@@ -573,25 +575,8 @@ void CompareDlg::DoEditInCurrentDB(ContextMenuData menuContext) {
   const pws_os::CUUID& uuid = table[menuContext.selectedRows[0]].uuid0;
   
   if (ViewEditEntry(m_currentCore, uuid, m_currentCore->IsReadOnly())) {
-    int idx = menuContext.selectedRows[0];
-    if (menuContext.cdata == m_conflicts)
-      idx = idx/2;
-    auto itr = m_currentCore->Find(uuid);
-    if (itr != m_currentCore->GetEntryEndIter()) {
-      const CItemData& item = itr->second;
-      //we update these in the grid directly from st_CompareData, so keep track
-      if (item.IsGroupSet())
-        menuContext.cdata->data[idx].group = item.GetGroup();
-      else
-        menuContext.cdata->data[idx].group.clear();
-      if (item.IsTitleSet())
-        menuContext.cdata->data[idx].title = item.GetTitle();
-      else
-        menuContext.cdata->data[idx].title.clear();
-      if (item.IsUserSet())
-        menuContext.cdata->data[idx].user = item.GetUser();
-      else
-        menuContext.cdata->data[idx].user.clear();
+    // The grid reads the entry from the core, so it only needs to be redrawn
+    if (m_currentCore->Find(uuid) != m_currentCore->GetEntryEndIter()) {
       table.RefreshRow(table.GetItemRow(uuid));
     }
     else {
@@ -652,6 +637,7 @@ void CompareDlg::OnCopyItemsToCurrentDB(wxCommandEvent& evt)
   wxCHECK_RET(ptable, wxT("Could not find ComparisonGridTable derived object in comparison grid"));
   const ComparisonGridTable& table = *ptable;
   MultiCommandsPtr pmulticmds(MultiCommands::Create(m_currentCore));
+  std::vector<pws_os::CUUID> addedUUIDs; // of the copies, as the grid has to find them in the current db
   for( size_t idx = 0; idx < menuContext->selectedRows.Count(); ++idx) {
     const int row = menuContext->selectedRows[idx];
     auto itrOther = m_otherCore->Find(table[row].uuid1);
@@ -665,11 +651,13 @@ void CompareDlg::OnCopyItemsToCurrentDB(wxCommandEvent& evt)
       newItem.CreateUUID();
       AddEntryCommand* cmd = AddEntryCommand::Create(m_currentCore, newItem, newItem.GetBaseUUID());
       pmulticmds->Add(cmd);
+      addedUUIDs.push_back(newItem.GetUUID());
     }
     else {
       const CItemData& item = itrOther->second;
       AddEntryCommand* cmd = AddEntryCommand::Create(m_currentCore, item, item.GetBaseUUID());
       pmulticmds->Add(cmd);
+      addedUUIDs.push_back(item.GetUUID());
     }
   }
   if (pmulticmds->GetSize() > 0) {
@@ -677,7 +665,7 @@ void CompareDlg::OnCopyItemsToCurrentDB(wxCommandEvent& evt)
     for( size_t idx = 0; idx < menuContext->selectedRows.Count(); ++idx) {
       const int row = static_cast<int>(menuContext->selectedRows[idx]-idx);
       st_CompareData data = table[row];
-      data.uuid0 = data.uuid1; //so far, uuid0 was nullptr since it was not found in current db
+      data.uuid0 = addedUUIDs[idx]; //so far, uuid0 was nullptr since it was not found in current db
       m_identical->data.push_back(data);
       m_identical->grid->AppendRows(1);
       menuContext->cdata->grid->DeleteRows(row);
@@ -901,6 +889,19 @@ void CompareDlg::DoSyncItemsWithCurrentDB(int menuId, ContextMenuData menuContex
   }
 }
 
+// The comparison results only hold uuids, so get group/title/user from the entry
+static void FormatCompareStats(stringT& line, const PWScore* core, const pws_os::CUUID& uuid)
+{
+  StringX group, title, user;
+  auto itr = core->Find(uuid);
+  if (itr != core->GetEntryEndIter()) {
+    group = itr->second.GetGroup();
+    title = itr->second.GetTitle();
+    user = itr->second.GetUser();
+  }
+  Format(line, IDSC_COMPARESTATS, group.c_str(), title.c_str(), user.c_str());
+}
+
 void CompareDlg::WriteReportData()
 {
   CompareData::iterator cd_iter;
@@ -923,7 +924,7 @@ void CompareDlg::WriteReportData()
     for (cd_iter = m_current->data.begin(); cd_iter != m_current->data.end(); cd_iter++) {
       const st_CompareData &st_data = *cd_iter;
 
-      Format(line, IDSC_COMPARESTATS, st_data.group.c_str(), st_data.title.c_str(), st_data.user.c_str());
+      FormatCompareStats(line, m_currentCore, st_data.uuid0);
       m_compReport.WriteLine(line);
     }
     m_compReport.WriteLine();
@@ -936,7 +937,7 @@ void CompareDlg::WriteReportData()
     for (cd_iter = m_comparison->data.begin(); cd_iter != m_comparison->data.end(); cd_iter++) {
       const st_CompareData &st_data = *cd_iter;
 
-      Format(line, IDSC_COMPARESTATS, st_data.group.c_str(), st_data.title.c_str(), st_data.user.c_str());
+      FormatCompareStats(line, m_otherCore, st_data.uuid1);
       m_compReport.WriteLine(line);
     }
     m_compReport.WriteLine();
@@ -949,7 +950,7 @@ void CompareDlg::WriteReportData()
     for (cd_iter = m_conflicts->data.begin(); cd_iter != m_conflicts->data.end(); cd_iter++) {
       const st_CompareData &st_data = *cd_iter;
 
-      Format(line, IDSC_COMPARESTATS, st_data.group.c_str(), st_data.title.c_str(), st_data.user.c_str());
+      FormatCompareStats(line, m_currentCore, st_data.uuid0);
       m_compReport.WriteLine(line);
       m_compReport.WriteLine(_("\t\thas differences in the following fields: "), false);
 
@@ -27,8 +27,14 @@
 #include "ComparisonGridTable.h"
 #include "SelectionCriteria.h"
 
+#include <algorithm>
 #include <functional>
 
+// wxGrid::AutoSizeColumn() would decrypt the column's field in every row
+// of the comparison, which can be most of a large database. The grids are
+// shown scrolled to the top, so the first rows are what the user sees.
+static const int AUTOSIZE_SAMPLE_ROWS = 300;
+
 class ComparisonGridCellAttr: public wxGridCellAttr
 {
   ComparisonGridCellAttr();
@@ -147,8 +153,33 @@ CItemData::FieldType ComparisonGridTable::ColumnToField(int col)
 void ComparisonGridTable::AutoSizeField(CItemData::FieldType ft)
 {
   int col = FieldToColumn(ft);
-  if (col > 0 && col < GetNumberCols())
-    GetView()->AutoSizeColumn(col);
+  if (col < 0 || col >= GetNumberCols())
+    return;
+
+  wxGrid* grid = GetView();
+  wxClientDC dc(grid->GetGridWindow());
+  int width = 0, height;
+  dc.SetFont(grid->GetLabelFont());
+  dc.GetTextExtent(GetColLabelValue(col), &width, &height);
+
+  dc.SetFont(grid->GetDefaultCellFont());
+  const int nRows = std::min(GetNumberRows(), AUTOSIZE_SAMPLE_ROWS);
+  for (int row = 0; row < nRows; ++row) {
+    int w;
+    dc.GetTextExtent(GetValue(row, col), &w, &height);
+    width = std::max(width, w);
+  }
+  grid->SetColSize(col, width + 2 * dc.GetCharWidth());
+}
+
+wxString ComparisonGridTable::GroupTitleUserValue(const CItemData& item, int col)
+{
+  wxString retval;
+  if (col == 0)
+    retval = towxstring(item.GetGroup());
+  else
+    retval << item.GetTitle() << wxT('[') << item.GetUser() << wxT(']');
+  return retval;
 }
 
 void ComparisonGridTable::RefreshRow(int row) const
@@ -217,23 +248,14 @@ wxString UniSafeCompareGridTable::GetValue(int row, int col)
 {
   wxString retval = wxEmptyString;
   if (size_t(row) < m_compData->size() && col < GetNumberCols()) {
-    switch(col) {
-      case 0:
-        retval = towxstring(m_compData->at(row).group);
-        break;
-      case 1:
-      {
-        retval << m_compData->at(row).title << wxT('[') <<  m_compData->at(row).user << wxT(']');
-        break;
-      }
-      default:
-      {
-        const st_CompareData& cd = m_compData->at(row);
-        ItemListConstIter itr = m_core->Find(cd.*m_uuidptr);
-        if ((itr != m_core->GetEntryEndIter()) && (itr->second.*m_colFields[col-2].available)())
-          retval = towxstring(itr->second.GetFieldValue(m_colFields[col-2].ft));
-        break;
-      }
+    const st_CompareData& cd = m_compData->at(row);
+    ItemListConstIter itr = m_core->Find(cd.*m_uuidptr);
+    if (itr != m_core->GetEntryEndIter()) {
+      const CItemData& item = itr->second;
+      if (col < 2)
+        retval = GroupTitleUserValue(item, col);
+      else if ((item.*m_colFields[col-2].available)())
+        retval = towxstring(item.GetFieldValue(m_colFields[col-2].ft));
     }
   }
 //  wxLogDebug(wxT("UniSafeCompareGridTable::GetValue returning %ls for %d, %d"), ToStr(retval), row, col);
@@ -393,24 +415,15 @@ wxString MultiSafeCompareGridTable::GetValue(int row, int col)
   row = row/2;
 
   if (size_t(row) < m_compData->size() && col < GetNumberCols()) {
-    switch(col) {
-      case 0:
-        retval = towxstring(m_compData->at(row).group);
-        break;
-      case 1:
-      {
-        retval << m_compData->at(row).title << wxT('[') <<  m_compData->at(row).user << wxT(']');
-        break;
-      }
-      default:
-      {
-        PWScore* core = GetRowCore(origRow);
-        const st_CompareData& cd = m_compData->at(row);
-        ItemListConstIter itr = core->Find(core == m_currentCore? cd.uuid0: cd.uuid1);
-        if ((itr != core->GetEntryEndIter()) && (itr->second.*m_colFields[col-2].available)())
-          retval = towxstring(itr->second.GetFieldValue(m_colFields[col-2].ft));
-        break;
-      }
+    PWScore* core = GetRowCore(origRow);
+    const st_CompareData& cd = m_compData->at(row);
+    ItemListConstIter itr = core->Find(core == m_currentCore? cd.uuid0: cd.uuid1);
+    if (itr != core->GetEntryEndIter()) {
+      const CItemData& item = itr->second;
+      if (col < 2)
+        retval = GroupTitleUserValue(item, col);
+      else if ((item.*m_colFields[col-2].available)())
+        retval = towxstring(item.GetFieldValue(m_colFields[col-2].ft));
     }
   }
 //  wxLogDebug(wxT("MultiSafeCompareGridTable::GetValue returning %ls for %d, %d"), ToStr(retval), row, col);
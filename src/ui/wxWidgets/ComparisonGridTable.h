@@ -69,6 +69,10 @@ public:
   virtual const st_CompareData& operator[](size_t index) const = 0;
 
 protected:
+  // Group (col 0) or title[user] (col 1) column text, formatted when the
+  // cell is drawn rather than kept for every row of the comparison
+  static wxString GroupTitleUserValue(const CItemData& item, int col);
+
   SelectionCriteria*      m_criteria;
   typedef bool (CItemData::*AvailableFunction)() const;
   typedef struct {
@@ -39,6 +39,11 @@ bool DndPWSafeDropTarget::OnDrop(wxCoord WXUNUSED(x), wxCoord WXUNUSED(y))
 
 wxDragResult DndPWSafeDropTarget::OnData(wxCoord x, wxCoord y, wxDragResult WXUNUSED(def))
 {
+  // Moving within the tree is done with the tree's own items, there's no
+  // need to have the source serialize them
+  if (m_tree->IsLocalDnDMove())
+    return m_tree->OnDrop(x, y, nullptr);
+
   if (!GetData())
   {
     pws_os::Trace(L"Failed to get drag and drop data");
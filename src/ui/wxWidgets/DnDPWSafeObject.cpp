@@ -54,3 +54,8 @@ DnDPWSafeObject::DnDPWSafeObject(wxMemoryBuffer *object):wxDataObjectSimple(wxDa
   else // nothing to copy
     m_object = nullptr;
 }
+
+DnDPWSafeObject::DnDPWSafeObject(const std::function<void(wxMemoryBuffer &)> &collect)
+  : wxDataObjectSimple(wxDataFormat(DnDPWSafeFormatId())), m_object(nullptr), m_collect(collect)
+{
+}
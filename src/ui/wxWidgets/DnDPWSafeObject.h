@@ -19,6 +19,7 @@
 
 ////@begin includes
 #include <string.h> // memcpy is used
+#include <functional>
 
 #include <wx/wxprec.h>
 
@@ -61,6 +62,10 @@ public:
     // reuse the serialisation methods here to copy it
   DnDPWSafeObject(wxMemoryBuffer *object = (wxMemoryBuffer *) nullptr);
 
+    // the data is only serialised by collect once a drop target asks for
+    // it, so that a drop that is handled without it doesn't pay for it
+  DnDPWSafeObject(const std::function<void(wxMemoryBuffer &)> &collect);
+
   virtual ~DnDPWSafeObject() { delete m_object; }
 
     // after a call to this function, the Object is owned by the caller and it
@@ -82,12 +87,14 @@ public:
 
   virtual size_t GetDataSize() const wxOVERRIDE
   {
+    Collect();
     if(! m_object) return 0;
     return m_object->GetDataLen();
   }
 
   virtual bool GetDataHere(void *pBuf) const wxOVERRIDE
   {
+    Collect();
     // On null nothing to be done
     if(! m_object || !m_object->GetDataLen())
       return true;
@@ -109,8 +116,17 @@ public:
   }
 
 private:
-  wxMemoryBuffer *m_object;
-  
+  void Collect() const
+  {
+    if(! m_object && m_collect) {
+      m_object = new wxMemoryBuffer;
+      m_collect(*m_object);
+      m_collect = nullptr;
+    }
+  }
+
+  mutable wxMemoryBuffer *m_object;
+  mutable std::function<void(wxMemoryBuffer &)> m_collect;
 };
 
 #endif // _PWSAFE_DNDOBJECT_H_
@@ -59,10 +59,14 @@ DnDObList::~DnDObList()
   m_uuid2atta.clear();
 }
 
-void DnDObject::DnDSerializeEntry(wxMemoryBuffer &outDDmem)
+size_t DnDObject::DnDSerializedSize() const
+{
+  return sizeof(size_t) + m_item.GetPlainTextSizeBound(m_item.IsDependent() ? GetBaseItem() : NULL);
+}
+
+void DnDObject::DnDSerializeEntry(wxMemoryBuffer &outDDmem, vector<char> &v)
 {
   // Serialize an entry
-  vector<char> v;
   const CItemData *pbci(NULL);
   if (m_item.IsDependent()) {
     pbci = GetBaseItem();
@@ -117,11 +121,20 @@ void DnDObList::DnDSerialize(wxMemoryBuffer &outDDmem)
 
   nCount = (int)GetCount();
 
+  // wxMemoryBuffer only grows by a fixed amount at a time, which makes
+  // appending many entries quadratic, so make room for all of them first
+  size_t size = outDDmem.GetDataLen() + sizeof(int) + sizeof(bool);
+  for(pos = m_objects.begin(); pos != m_objects.end(); pos++) {
+    size += (*pos)->DnDSerializedSize();
+  }
+  outDDmem.SetBufSize(size);
+
   outDDmem.AppendData((void *)&nCount, sizeof(int));
   outDDmem.AppendData((void *)&m_bDragNode, sizeof(bool));
 
+  vector<char> v; // reused, so that it's allocated only once
   for(pos = m_objects.begin(); pos != m_objects.end(); pos++) {
-    (*pos)->DnDSerializeEntry(outDDmem);
+    (*pos)->DnDSerializeEntry(outDDmem, v);
     if((*pos)->HasAttRef()) {
       InsertAttUuid((*pos)->GetUUID(CItemData::ATTREF), (*pos)->GetUUID(CItemData::UUID));
     }
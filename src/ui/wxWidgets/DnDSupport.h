@@ -44,7 +44,9 @@ public:
   DnDObject() {m_pbaseitem = NULL;};
   ~DnDObject();
 
-  void DnDSerializeEntry(wxMemoryBuffer &outDDmem);
+  // Upper bound of what DnDSerializeEntry appends
+  size_t DnDSerializedSize() const;
+  void DnDSerializeEntry(wxMemoryBuffer &outDDmem, std::vector<char> &v);
   void DnDUnSerializeEntry(wxInputStream &inStream);
   void FromItem(const CItemData &item) { m_item = item; }
   void ToItem(CItemData &item) const { item = m_item; }
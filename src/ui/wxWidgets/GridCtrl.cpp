@@ -26,6 +26,9 @@
 #include "PasswordSafeFrame.h" // for DispatchDblClickAction()
 #include "PWSafeApp.h"
 
+#include <algorithm>
+#include <vector>
+
 #ifdef __WXMSW__
 #include <wx/msw/msvcrt.h>
 #endif
@@ -199,7 +202,8 @@ void GridCtrl::UpdateGUI(UpdateGUICommand::GUI_Action ga, const pws_os::CUUID &e
       break;
     case UpdateGUICommand::GUI_ADD_ENTRY:
       ASSERT(item != nullptr);
-      AddItem(*item);
+      if (wxGetApp().GetPasswordSafeFrame()->PassesFilter(*item))
+        AddItem(*item);
       break;
     case UpdateGUICommand::GUI_DELETE_ENTRY:
       Remove(entry_uuid);
@@ -207,7 +211,9 @@ void GridCtrl::UpdateGUI(UpdateGUICommand::GUI_Action ga, const pws_os::CUUID &e
     case UpdateGUICommand::GUI_REFRESH_ENTRYFIELD:
     case UpdateGUICommand::GUI_REFRESH_ENTRYPASSWORD:
       ASSERT(item != nullptr);
-      RefreshItemField(item->GetUUID(), ft);
+      ForgetCellText(item->GetUUID());
+      if (!UpdateFilteredItem(*item))
+        RefreshItemField(item->GetUUID(), ft);
       break;
     case UpdateGUICommand::GUI_REDO_IMPORT:
     case UpdateGUICommand::GUI_UNDO_IMPORT:
@@ -216,22 +222,33 @@ void GridCtrl::UpdateGUI(UpdateGUICommand::GUI_Action ga, const pws_os::CUUID &e
       // Handled by PasswordSafeFrame
       break;
     case UpdateGUICommand::GUI_REFRESH_TREE:
-      // Not relevant for this view
+      // Only relevant for this view if an entry moved to another group
+      if (item != nullptr) {
+        ForgetCellText(item->GetUUID());
+        if (!UpdateFilteredItem(*item))
+          RefreshItemRow(item->GetUUID());
+      }
       break;
     case UpdateGUICommand::GUI_REFRESH_ENTRY:
       ASSERT(item != nullptr);
-      RefreshItem(*item);
+      ForgetCellText(item->GetUUID());
+      // The row stays where it is, just repaint it
+      if (!UpdateFilteredItem(*item))
+        RefreshItemRow(item->GetUUID());
       break;
     case UpdateGUICommand::GUI_REFRESH_GROUPS:
     case UpdateGUICommand::GUI_REFRESH_BOTHVIEWS:
       // TODO: ???
+      ClearCellText();
       break;
     case UpdateGUICommand::GUI_DB_PREFERENCES_CHANGED:
       // Handled also by PasswordSafeFrame
+      ClearCellText(); // e.g., named policies may have changed
       PreferencesChanged();
       break;
     case UpdateGUICommand::GUI_PWH_CHANGED_IN_DB:
       // TODO: ???
+      ClearCellText();
       break;
     default:
       wxFAIL_MSG(wxT("GridCtrl - Unsupported GUI action received."));
@@ -260,6 +277,7 @@ void GridCtrl::OnPasswordListModified()
 {
   m_row_map.clear();
   m_uuid_map.clear();
+  ClearCellText();
 
   ItemListConstIter iter;
   int row = 0;
@@ -332,6 +350,7 @@ void GridCtrl::UpdateItem(const CItemData &item)
 {
   uuid_array_t uuid;
   item.GetUUID(uuid);
+  ForgetCellText(CUUID(uuid));
   auto iter = m_uuid_map.find(CUUID(uuid));
   if (iter != m_uuid_map.end()) {
     int row = iter->second;
@@ -340,6 +359,24 @@ void GridCtrl::UpdateItem(const CItemData &item)
   }
 }
 
+/**
+ * If the item's passing the active filter has changed, adds or removes its
+ * row and returns true. Returns false if the row just needs repainting.
+ */
+bool GridCtrl::UpdateFilteredItem(const CItemData &item)
+{
+  const bool shown = FindItemRow(item.GetUUID()) != wxNOT_FOUND;
+  if (wxGetApp().GetPasswordSafeFrame()->PassesFilter(item)) {
+    if (shown)
+      return false;
+    AddItem(item);
+  }
+  else if (shown) {
+    Remove(item.GetUUID());
+  }
+  return true;
+}
+
 void GridCtrl::RefreshRow(int row)
 {
   wxRect rect(CellToRect( row, 0 ));
@@ -369,6 +406,8 @@ void GridCtrl::RefreshItemField(const pws_os::CUUID& uuid, CItemData::FieldType
 
 void GridCtrl::Remove(const CUUID &uuid)
 {
+  ForgetCellText(uuid);
+
   auto iter = m_uuid_map.find(uuid);
   if (iter != m_uuid_map.end()) {
     const int row = iter->second;
@@ -463,6 +502,97 @@ void GridCtrl::DeleteAllItems()
 {
   m_uuid_map.clear();
   m_row_map.clear();
+  ClearCellText();
+}
+
+const StringX &GridCtrl::GetCellText(const CItemData &item, int col)
+{
+  const CellKeyT key(item.GetUUID(), col);
+  auto iter = m_cellTextMap.find(key);
+  if (iter != m_cellTextMap.end()) {
+    m_cellText.splice(m_cellText.begin(), m_cellText, iter->second);
+    return iter->second->second;
+  }
+
+  if (m_cellText.size() >= MAX_CACHED_CELLS) {
+    m_cellTextMap.erase(m_cellText.back().first);
+    m_cellText.pop_back();
+  }
+  m_cellText.emplace_front(key, GridTable::GetCellText(item, col));
+  m_cellTextMap[key] = m_cellText.begin();
+  return m_cellText.front().second;
+}
+
+void GridCtrl::ForgetCellText(const CUUID &uuid)
+{
+  auto iter = m_cellTextMap.lower_bound(CellKeyT(uuid, 0));
+  while (iter != m_cellTextMap.end() && iter->first.first == uuid) {
+    m_cellText.erase(iter->second);
+    iter = m_cellTextMap.erase(iter);
+  }
+}
+
+void GridCtrl::ClearCellText()
+{
+  m_cellTextMap.clear();
+  m_cellText.clear();
+}
+
+/*!
+ * Sizes the visible columns to fit their label and the text of the first
+ * AUTOSIZE_SAMPLE_ROWS rows and of the rows currently on screen. Measuring
+ * every row, as wxGrid::AutoSizeColumns() does, means decrypting every
+ * entry of the database.
+ */
+void GridCtrl::AutoSizeColumnsSampled()
+{
+  const int nRows = GetNumberRows();
+
+  std::vector<int> rows;
+  for (int row = 0; row < std::min<int>(nRows, AUTOSIZE_SAMPLE_ROWS); row++)
+    rows.push_back(row);
+
+  int dummy, top, bottom;
+  CalcUnscrolledPosition(0, 0, &dummy, &top);
+  CalcUnscrolledPosition(0, GetGridWindow()->GetClientSize().GetHeight(), &dummy, &bottom);
+  const int firstVisible = std::max(YToRow(top, true), int(AUTOSIZE_SAMPLE_ROWS));
+  const int lastVisible = YToRow(bottom, true);
+  for (int row = firstVisible; row <= lastVisible && row < nRows; row++)
+    rows.push_back(row);
+
+  wxClientDC dc(GetGridWindow());
+  const int margin = 2 * dc.GetCharWidth(); // as for wxGrid's own auto-sizing, roughly
+
+  BeginBatch();
+  for (int col = 0; col < GetNumberCols(); col++) {
+    if (!IsColShown(col))
+      continue;
+
+    int width = 0, height;
+    dc.SetFont(GetLabelFont());
+    dc.GetTextExtent(GetColLabelValue(col), &width, &height);
+
+    dc.SetFont(GetDefaultCellFont());
+    for (int row : rows) {
+      int w;
+      dc.GetTextExtent(GetCellValue(row, col), &w, &height);
+      width = std::max(width, w);
+    }
+    SetColSize(col, width + margin);
+  }
+  EndBatch();
+}
+
+/*!
+ * Every cell is shown on a single line in the same font, so the row height
+ * follows from the font alone. wxGrid::AutoSizeRows() would measure (and so
+ * decrypt) every cell of every row to arrive at the same result.
+ */
+void GridCtrl::SetRowHeightFromFont()
+{
+  wxClientDC dc(GetGridWindow());
+  dc.SetFont(GetDefaultCellFont());
+  SetDefaultRowSize(dc.GetCharHeight() + ROW_MARGIN, true); // true: resize existing rows
 }
 
 /*!
@@ -29,8 +29,10 @@
 #include "os/UUID.h"
 
 #include <functional>
+#include <list>
 #include <map>
 #include <tuple>
+#include <utility>
 
 /*!
  * Forward declarations
@@ -174,6 +176,15 @@ public:
 
   void UpdateSorting();
 
+  /// Returns the text of an item's cell, from the cell cache if possible
+  const StringX &GetCellText(const CItemData &item, int col);
+
+  /// Like AutoSizeColumns(false), but only measures the first rows and the visible ones
+  void AutoSizeColumnsSampled();
+
+  /// Sets all rows to the height of a line of the default cell font
+  void SetRowHeightFromFont();
+
 ////@begin GridCtrl member variables
 ////@end GridCtrl member variables
 
@@ -191,9 +202,24 @@ public:
   std::tuple<int, int> HitTest(const wxPoint& point) const;
   bool HasGridCell(const std::tuple<int, int>& cellGridCoordinates) const;
 
+  bool UpdateFilteredItem(const CItemData &item);
+
+  void ForgetCellText(const pws_os::CUUID &uuid);
+  void ClearCellText();
+
   PWScore &m_core;
   RowUUIDMapT m_row_map;
   UUIDRowMapT m_uuid_map;
+
+  // Rendered cell text, so that repainting doesn't decrypt the same fields
+  // over and over. Most recently used first; the oldest get dropped beyond
+  // MAX_CACHED_CELLS. Being StringX, the text is wiped when dropped.
+  enum { MAX_CACHED_CELLS = 8192, AUTOSIZE_SAMPLE_ROWS = 300 };
+  enum { ROW_MARGIN = 8 }; // pixels added to the font height, as wxGrid's default row size
+  typedef std::pair<pws_os::CUUID, int> CellKeyT;
+  typedef std::list<std::pair<CellKeyT, StringX>> CellTextListT;
+  CellTextListT m_cellText;
+  std::map<CellKeyT, CellTextListT::iterator> m_cellTextMap;
 };
 
 #endif // _GRIDCTRL_H_
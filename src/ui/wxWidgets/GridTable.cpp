@@ -125,19 +125,23 @@ wxString GridTable::GetValue(int row, int col)
   if (size_t(row) < m_pwsgrid->GetNumItems() &&
       size_t(col) < NumberOf(PWSGridCellData)) {
     const CItemData *pItem = m_pwsgrid->GetItem(row);
-    if (pItem != nullptr) {
-      if (PWSGridCellData[col].ft != CItemData::POLICY) {
-        return towxstring(pItem->GetFieldValue(PWSGridCellData[col].ft));
-      } else {
-        PWPolicy pwp;
-        pItem->GetPWPolicy(pwp);
-        return towxstring(pwp.GetDisplayString());
-      }
-    }
+    if (pItem != nullptr)
+      return towxstring(m_pwsgrid->GetCellText(*pItem, col));
   }
   return wxEmptyString;
 }
 
+StringX GridTable::GetCellText(const CItemData &item, int col)
+{
+  if (size_t(col) >= NumberOf(PWSGridCellData))
+    return StringX();
+  if (PWSGridCellData[col].ft != CItemData::POLICY)
+    return item.GetFieldValue(PWSGridCellData[col].ft);
+  PWPolicy pwp;
+  item.GetPWPolicy(pwp);
+  return pwp.GetDisplayString();
+}
+
 void GridTable::SetValue(int WXUNUSED(row), int WXUNUSED(col), const wxString& WXUNUSED(value))
 {
   //I think it comes here only if the grid is editable
@@ -21,6 +21,9 @@
 #include <wx/grid.h>
 ////@end includes
 
+#include "core/ItemData.h"
+#include "core/StringX.h"
+
 /*!
  * Forward declarations
  */
@@ -74,6 +77,8 @@ public:
   virtual void Clear();
   virtual void SetView(wxGrid* grid);
 
+  // Decrypts and formats the field shown in column col
+  static StringX GetCellText(const CItemData &item, int col);
   static int GetColumnFieldType(int colID);
   static int Field2Column(int fieldType);
   static int GetNumHeaderCols();
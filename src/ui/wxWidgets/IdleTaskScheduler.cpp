@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+ * All rights reserved. Use of the code is allowed under the
+ * Artistic License 2.0 terms, as specified in the LICENSE file
+ * distributed with this code, or available from
+ * http://www.opensource.org/licenses/artistic-license-2.0.php
+ */
+
+/** \file IdleTaskScheduler.cpp
+*
+*/
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include <wx/wxprec.h>
+
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+#include <wx/stopwatch.h>
+
+#include "IdleTaskScheduler.h"
+
+#ifdef __WXMSW__
+#include <wx/msw/msvcrt.h>
+#endif
+
+// Long enough to get something done, short enough not to be noticed
+static const long STEP_BUDGET_MS = 15;
+
+IdleTaskScheduler::IdleTaskScheduler() : m_generation(0), m_paused(0)
+{
+  wxTheApp->Bind(wxEVT_IDLE, &IdleTaskScheduler::OnIdle, this);
+}
+
+IdleTaskScheduler::~IdleTaskScheduler()
+{
+  if (wxTheApp != nullptr)
+    wxTheApp->Unbind(wxEVT_IDLE, &IdleTaskScheduler::OnIdle, this);
+}
+
+void IdleTaskScheduler::Add(IdleTask *task)
+{
+  m_tasks.emplace_back(task);
+  wxWakeUpIdle();
+}
+
+void IdleTaskScheduler::CancelAll()
+{
+  m_tasks.clear();
+  m_generation++;
+}
+
+void IdleTaskScheduler::Resume()
+{
+  wxASSERT(m_paused > 0);
+  if (--m_paused == 0 && !m_tasks.empty())
+    wxWakeUpIdle();
+}
+
+void IdleTaskScheduler::OnIdle(wxIdleEvent &evt)
+{
+  evt.Skip(); // others may want idle time too
+
+  if (m_paused > 0)
+    return;
+
+  wxStopWatch sw;
+  while (!m_tasks.empty() && sw.Time() < STEP_BUDGET_MS) {
+    // A step may add tasks or cancel them all, so it's taken off the queue
+    // while it runs, and only put back if nobody cancelled in the meantime
+    std::unique_ptr<IdleTask> task(std::move(m_tasks.front()));
+    m_tasks.pop_front();
+    const unsigned generation = m_generation;
+    bool more;
+    try {
+      more = task->Step();
+    } catch (const std::exception &e) {
+      wxLogDebug(wxT("IdleTaskScheduler: task dropped: %s"), e.what());
+      more = false;
+    }
+    if (more && generation == m_generation)
+      m_tasks.push_front(std::move(task));
+  }
+
+  if (!m_tasks.empty())
+    evt.RequestMore();
+}
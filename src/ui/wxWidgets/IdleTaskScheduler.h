@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+ * All rights reserved. Use of the code is allowed under the
+ * Artistic License 2.0 terms, as specified in the LICENSE file
+ * distributed with this code, or available from
+ * http://www.opensource.org/licenses/artistic-license-2.0.php
+ */
+
+/** \file IdleTaskScheduler.h
+*
+* Runs core IdleTasks a step at a time from the application's idle events,
+* i.e., only when there are no pending user or system events, and for no
+* more than a few milliseconds per idle event. Tasks run one after the
+* other, in the order they were added.
+*
+* Unlike TimedTaskChain, which sequences a few UI actions, this is meant
+* for low-priority work on the whole database that may be dropped at any
+* point, e.g., when the database is locked or closed.
+*/
+
+#ifndef _IDLETASKSCHEDULER_H_
+#define _IDLETASKSCHEDULER_H_
+
+#include <wx/event.h>
+
+#include "core/IdleTask.h"
+
+#include <deque>
+#include <memory>
+
+class IdleTaskScheduler : public wxEvtHandler
+{
+public:
+  IdleTaskScheduler();
+  ~IdleTaskScheduler();
+
+  // Takes ownership of the task, which is deleted when done or cancelled
+  void Add(IdleTask *task);
+  // Drops all the tasks that haven't finished yet
+  void CancelAll();
+  bool HasTasks() const {return !m_tasks.empty();}
+  // No steps run between Pause and the matching Resume, e.g., while
+  // another thread reads the entries
+  void Pause() {m_paused++;}
+  void Resume();
+
+private:
+  void OnIdle(wxIdleEvent &evt);
+
+  std::deque<std::unique_ptr<IdleTask>> m_tasks;
+  unsigned m_generation; // bumped by CancelAll, so a running step can tell
+  unsigned m_paused;
+};
+
+#endif // _IDLETASKSCHEDULER_H_
@@ -488,8 +488,17 @@ void ManagePasswordPoliciesDlg::UpdateEntryList()
   m_PolicyEntries->ClearGrid();
 
   GTUSet gtuSet;
+  StringX policyName(m_PolicyNames->GetCellValue(row, 0).c_str());
 
-  if (m_core.InitialiseGTU(gtuSet, StringX(m_PolicyNames->GetCellValue(row, 0).c_str()))) {
+  // The entries still use the name the policy had when the dialog was opened
+  for (const auto& renamed : m_PolicyManager->GetRenamedPolicies()) {
+    if (renamed.second == policyName) {
+      policyName = renamed.first;
+      break;
+    }
+  }
+
+  if (m_core.InitialiseGTU(gtuSet, policyName)) {
 
     row = 0;
 
@@ -756,8 +765,22 @@ void ManagePasswordPoliciesDlg::OnOkClick( wxCommandEvent& )
     } // defChanged
 
     if (changes & Changes::NamedPolices) {
-      pmulticmds->Add(DBPolicyNamesCommand::Create(&m_core, m_PolicyManager->GetPolicies(),
+      const auto policies = m_PolicyManager->GetPolicies();
+      const auto renamed  = m_PolicyManager->GetRenamedPolicies();
+
+      pmulticmds->Add(DBPolicyNamesCommand::Create(&m_core, policies,
                                                    DBPolicyNamesCommand::NP_REPLACEALL));
+
+      // Entries follow their policy when it's renamed, and lose it when it's deleted
+      for (const auto& policy : m_core.GetPasswordPolicies()) {
+        const auto iter = renamed.find(policy.first);
+        const StringX sxNewName = (iter != renamed.end()) ? iter->second : policy.first;
+        Command *pcmd = m_core.ReassignPasswordPolicy(policy.first,
+                          (policies.find(sxNewName) != policies.end()) ? sxNewName : StringX());
+        if (pcmd != nullptr) {
+          pmulticmds->Add(pcmd);
+        }
+      }
     }
     m_core.Execute(pmulticmds);
   } // defChanged || namedChanged
@@ -166,7 +166,6 @@ void PasswordSafeFrame::DoDeleteItems(bool askConfirmation, bool isGroup)
   }
 
   if (dodelete) {
-    auto *commands = MultiCommands::Create(&m_core);
     Command *deleteCommand = nullptr;
     CItemData *item = GetSelectedEntry();
     wxTreeItemId tid;
@@ -177,36 +176,38 @@ void PasswordSafeFrame::DoDeleteItems(bool askConfirmation, bool isGroup)
       tid = m_tree->GetSelection();
       deleteCommand = Delete(tid);
     }
-    if (deleteCommand != nullptr) {
-      commands->Add(deleteCommand);
-    }
     // If the item was the only child of its parent we make the parent empty.
     // See src/ui/Windows/MainEdit::OnDelete
+    StringX sxEmptyParent;
+    bool makeParentEmpty = false;
     if (tid.IsOk()) {
       auto root = m_tree->GetRootItem();
       auto parent = m_tree->GetItemParent(tid);
       auto children = m_tree->GetChildrenCount(parent, false);
       if (parent != nullptr && root != nullptr && parent != root && children == 1) {
-        StringX sxPath = tostringx(m_tree->GetItemGroup(parent));
-        commands->Add(
-          DBEmptyGroupsCommand::Create(&m_core, sxPath, DBEmptyGroupsCommand::EG_ADD)
-        );
+        sxEmptyParent = tostringx(m_tree->GetItemGroup(parent));
+        makeParentEmpty = true;
       }
     }
-    // If MultiCommands is empty, delete
-    if (commands->GetSize() == 0) {
-      delete commands;
-    }
-    else {
-      commands->Add(
-        UpdateGUICommand::Create(
-          &m_core,
-          UpdateGUICommand::ExecuteFn::WN_EXECUTE,
-          UpdateGUICommand::GUI_Action::GUI_REFRESH_TREE
-        )
+    if (deleteCommand == nullptr && !makeParentEmpty)
+      return;
+
+    // One undo step, and one tree refresh, for the whole deletion
+    PWScore::Transaction transaction(m_core);
+    if (deleteCommand != nullptr)
+      transaction.Execute(deleteCommand);
+    if (makeParentEmpty)
+      transaction.Execute(
+        DBEmptyGroupsCommand::Create(&m_core, sxEmptyParent, DBEmptyGroupsCommand::EG_ADD)
       );
-      m_core.Execute(commands);
-    }
+    transaction.Execute(
+      UpdateGUICommand::Create(
+        &m_core,
+        UpdateGUICommand::ExecuteFn::WN_EXECUTE,
+        UpdateGUICommand::GUI_Action::GUI_REFRESH_TREE
+      )
+    );
+    transaction.Commit();
   } // dodelete
 }
 
@@ -714,12 +715,10 @@ void PasswordSafeFrame::DoCopyEmail(CItemData &item)
  */
 void PasswordSafeFrame::DoAutotype(CItemData &ci)
 {
-  std::vector<size_t> vactionverboffsets;
-  const StringX sxautotype = PWSAuxParse::GetAutoTypeString(ci, m_core,
-                                                            vactionverboffsets);
-  // even though we only need them in one of the *later* tasks, its safer to
-  // get sxautotype and vactionverboffsets set up before the reference to
-  // CItemData becomes invalid in some way
+  const PWSAuxParse::AutoType autotype(ci, m_core);
+  // even though we only need it in one of the *later* tasks, its safer to
+  // get autotype set up before the reference to CItemData becomes invalid
+  // in some way
 
   UpdateAccessTime(ci);
 
@@ -734,10 +733,10 @@ void PasswordSafeFrame::DoAutotype(CItemData &ci)
   TimedTaskChain::CreateTaskChain(
                     {{std::bind(&PasswordSafeFrame::MinimizeOrHideBeforeAutotyping, this), intervals[0]}}
                   )
-                  .then( [this, sxautotype, vactionverboffsets]() {
-                     // those lambda args should not be captured by reference
-                     // since they are on the stack
-                     DoAutotype(sxautotype, vactionverboffsets);
+                  .then( [this, autotype]() {
+                     // the lambda arg should not be captured by reference
+                     // since it is on the stack
+                     DoAutotype(autotype);
                   }, intervals[1])
                   .then( [this]() {
                      MaybeRestoreUI(false, wxEmptyString);
@@ -789,20 +788,10 @@ void PasswordSafeFrame::MaybeRestoreUI(bool autotype_err, wxString autotype_err_
     wxMessageBox(_("There was an error autotyping.  ") + autotype_err_msg, _("Autotype error"), wxOK|wxICON_ERROR, this);
 }
 
-/*
- * The entire logic is borrowed from ui/Windows/MainEdit.cpp
- */
-void PasswordSafeFrame::DoAutotype(const StringX& sx_autotype,
-          const std::vector<size_t>& vactionverboffsets)
+void PasswordSafeFrame::DoAutotype(const PWSAuxParse::AutoType& autotype)
 {
-  // All parsing of AutoType command done in one place: PWSAuxParse::GetAutoTypeString
-  // Except for anything involving time (\d, \w, \W) or use older method (\z)
-  StringX sxtmp(wxEmptyString);
-  StringX sxautotype(sx_autotype);
-  wchar_t curChar;
-
-  const int N = static_cast<int>(sxautotype.length());
-
+  // All parsing of AutoType command done in one place: PWSAuxParse::AutoType,
+  // which also sends it, with its delays and waits
   CKeySend ks;
 #ifdef __WXMAC__
   if (wxGetApp().IsActive() && !ks.SimulateApplicationSwitch()) {
@@ -817,115 +806,7 @@ void PasswordSafeFrame::DoAutotype(const StringX& sx_autotype,
   //sleep for 1 second
   pws_os::sleep_ms(1000); // Karl Student's suggestion, to ensure focus set correctly on minimize.
 
-  int gNumIts;
-  for (int n = 0; n < N; n++){
-    curChar = sxautotype[n];
-    if (curChar == L'\\') {
-      n++;
-      if (n < N)
-        curChar = sxautotype[n];
-
-      // Only need to process fields left in there by PWSAuxParse::GetAutoTypeString
-      // for later processing
-      switch (curChar) {
-        case L'd':
-        case L'w':
-        case L'W':
-        {
-           if (std::find(vactionverboffsets.begin(), vactionverboffsets.end(), static_cast<size_t>(n - 1)) ==
-               vactionverboffsets.end()) {
-             // Not in the list of found action verbs - treat as-is
-             sxtmp += L'\\';
-             sxtmp += curChar;
-             break;
-           }
-
-          /*
-           'd' means value is in milli-seconds, max value = 0.999s
-           and is the delay between sending each character
-
-           'w' means value is in milli-seconds, max value = 0.999s
-           'W' means value is in seconds, max value = 16m 39s
-           and is the wait time before sending the next character.
-           Use of this field does not change any current delay value.
-
-           User needs to understand that PasswordSafe will be unresponsive
-           for the whole of this wait period!
-          */
-
-          // Delay is going to change - send what we have with old delay
-          ks.SendString(sxtmp);
-          // start collecting new delay
-          sxtmp = wxEmptyString;
-          int newdelay = 0;
-          gNumIts = 0;
-          for (n++; n < N && (gNumIts < 3); ++gNumIts, n++) {
-            if (_istdigit(sxautotype[n])) {
-              newdelay *= 10;
-              newdelay += (sxautotype[n] - L'0');
-            } else
-              break; // for loop
-          }
-
-          n--;
-          // Either set new character delay time or wait specified time
-          if (curChar == L'd') {
-            ks.SetAndDelay(newdelay);
-          }
-          else
-            pws_os::sleep_ms(newdelay * (curChar == L'w' ? 1 : 1000));
-
-          break; // case 'd', 'w' & 'W'
-        }
-        case L'c':
-          if (std::find(vactionverboffsets.begin(), vactionverboffsets.end(), static_cast<size_t>(n - 1)) ==
-              vactionverboffsets.end()) {
-            // Not in the list of found action verbs - treat as-is
-            sxtmp += L'\\';
-            sxtmp += curChar;
-          }
-          else {
-            ks.SelectAll();
-          }
-          break;
-        case L'j':
-        case L'k':
-          if (std::find(vactionverboffsets.begin(), vactionverboffsets.end(), static_cast<size_t>(n - 1)) ==
-              vactionverboffsets.end()) {
-            // Not in the list of found action verbs - treat as-is
-            sxtmp += L'\\';
-            sxtmp += curChar;
-          }
-          else {
-            ks.EmulateMods(curChar == L'j');
-          }
-          break;
-        case L'z':
-          if (std::find(vactionverboffsets.begin(), vactionverboffsets.end(), static_cast<size_t>(n - 1)) ==
-              vactionverboffsets.end()) {
-            // Not in the list of found action verbs - treat as-is
-            sxtmp += L'\\';
-            sxtmp += curChar;
-          }
-          break;
-        case L'b':
-          if (std::find(vactionverboffsets.begin(), vactionverboffsets.end(), static_cast<size_t>(n - 1)) ==
-              vactionverboffsets.end()) {
-            // Not in the list of found action verbs - treat as-is
-            sxtmp += L'\\';
-            sxtmp += curChar;
-          } else {
-            sxtmp += L'\b';
-          }
-          break;
-        default:
-          sxtmp += curChar;
-          break;
-      }
-    } else
-      sxtmp += curChar;
-  }
-  ks.SendString(sxtmp);
+  autotype.Send(ks);
 
   pws_os::sleep_ms(1000);
 
@@ -948,10 +829,9 @@ void PasswordSafeFrame::DoBrowse(CItemData &item, bool bAutotype)
   wxString cs_command = towxstring(pci->GetURL());
 
   if (!cs_command.IsEmpty()) {
-    std::vector<size_t> vactionverboffsets;
-    StringX sxautotype = PWSAuxParse::GetAutoTypeString(*pci, m_core, vactionverboffsets);
+    const bool bHasAutotype = !PWSAuxParse::AutoType(*pci, m_core).IsEmpty();
     if (LaunchBrowser(cs_command)) {
-      if (bAutotype && !sxautotype.empty()) {
+      if (bAutotype && bHasAutotype) {
         DoAutotype(*pci);
       }
     }
@@ -26,6 +26,7 @@
 #include <wx/filename.h>
 #include <wx/tokenzr.h>
 #include <wx/utils.h> // for wxLaunchDefaultBrowser
+#include <wx/wupdlock.h>
 
 #include "core/core.h"
 #include "core/PWSdirs.h"
@@ -195,8 +196,7 @@ int PasswordSafeFrame::NewFile(StringX &fname)
          (plkUser == pws_os::getusername()) && (plkHost == pws_os::gethostname())) {
         wxMessageDialog dialog(this, _("Lock is done by yourself"), _("Remove Lock?"), wxYES_NO | wxICON_EXCLAMATION);
         if(dialog.ShowModal() == wxID_YES) {
-          HANDLE handle = 0;
-          pws_os::UnlockFile(fname.c_str(), handle);
+          m_core.UnlockFile(fname.c_str());
           if(m_core.LockFile(fname.c_str(), locker))
             fileLocked = true;
         }
@@ -435,8 +435,10 @@ int PasswordSafeFrame::Save(SaveType savetype /* = SaveType::INVALID*/)
 //    m_ctlItemTree.Invalidate();
 //  }
 
-  // Only refresh views if not existing
-  if (savetype != SaveType::NORMALEXIT)
+  // Only refresh views if not exiting, and only if a filter (e.g., for
+  // unsaved entries) may now select other entries - nothing else shown
+  // depends on whether an entry has been saved
+  if (savetype != SaveType::NORMALEXIT && m_bFilterActive)
     RefreshViews();
 
   return PWScore::SUCCESS;
@@ -531,7 +533,8 @@ int PasswordSafeFrame::SaveAs()
     m_ctlItemTree.Invalidate();
   }
 #endif
-  RefreshViews();
+  if (m_bFilterActive)
+    RefreshViews();
 
   wxGetApp().recentDatabases().AddFileToHistory(towxstring(newfile));
   CreateMenubar();
@@ -1358,7 +1361,16 @@ void PasswordSafeFrame::DoSynchronize(wxString filename)
                 wxT("Synchronize menu enabled for empty or read-only database!"));
 
   SyncWizard wiz(this, &m_core, filename);
-  if (wiz.RunWizard(wiz.GetFirstPage())) {
+  bool bSynchronized;
+  {
+    // The wizard compares the entries on a worker thread, so nothing else
+    // may read them meanwhile: neither idle tasks nor the views drawing them
+    wxWindowUpdateLocker noUpdates(this);
+    m_idleTasks.Pause();
+    bSynchronized = wiz.RunWizard(wiz.GetFirstPage());
+    m_idleTasks.Resume();
+  }
+  if (bSynchronized) {
     if (wiz.GetNumUpdated() > 0 && wiz.GetSyncCommands()) {
       m_core.Execute(wiz.GetSyncCommands());
       UpdateStatusBar();
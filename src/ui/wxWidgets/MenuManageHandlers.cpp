@@ -23,6 +23,7 @@
 #include <wx/msw/msvcrt.h>
 #endif
 
+#include <wx/choicdlg.h>
 #include <wx/filename.h>
 
 #include "core/PWSdirs.h"
@@ -30,6 +31,7 @@
 #include "os/file.h"
 #include "os/env.h"
 
+#include "BackgroundFileReader.h"
 #include "ManagePasswordPoliciesDlg.h"
 #include "OptionsPropertySheetDlg.h"
 #include "PasswordPolicyDlg.h"
@@ -237,10 +239,18 @@ void PasswordSafeFrame::DoRestoreSafe()
     // clear the application data before restoring
     ClearAppData();
 
-    if (m_core.ReadFile(tostringx(wxbf), passkey, true, MAXTEXTCHARS) == PWScore::CANT_OPEN_FILE) {
+    const int rc = BackgroundFileReader(this, m_core).Read(tostringx(wxbf), passkey, true, MAXTEXTCHARS);
+    if (rc == PWScore::CANT_OPEN_FILE) {
       wxMessageBox(wxbf << wxT("\n\n") << _("Could not open file for reading!"),
                       _("File Read Error"), wxOK | wxICON_ERROR, this);
-      return /*PWScore::CANT_OPEN_FILE*/;
+    }
+    if (rc != PWScore::SUCCESS) {
+      // Nothing was restored - don't have an empty database saved
+      m_core.SetCurFile(wxEmptyString);
+      SetTitle(wxEmptyString);
+      ResetStatusBar();
+      UpdateMenuBar();
+      return;
     }
 
     m_core.SetCurFile(wxEmptyString);    // Force a Save As...
@@ -298,6 +308,50 @@ void PasswordSafeFrame::DoGeneratePassword()
   ppdlg.Get()->ShowModal();
 }
 
+/*!
+ * wxEVT_COMMAND_MENU_SELECTED event handler for ID_ROTATEEXPIRED
+ */
+
+void PasswordSafeFrame::OnRotateExpiredPasswords(wxCommandEvent& WXUNUSED(event))
+{
+  CallAfter(&PasswordSafeFrame::DoRotateExpiredPasswords);
+}
+
+void PasswordSafeFrame::DoRotateExpiredPasswords()
+{
+  UUIDVector uuids;
+  for (const auto &ee : m_core.GetExpired(0))
+    uuids.push_back(ee.uuid);
+
+  if (uuids.empty()) {
+    wxMessageBox(_("No entries have expired passwords."), _("Change Expired Passwords"),
+                 wxOK | wxICON_INFORMATION, this);
+    return;
+  }
+
+  // First choice: each entry keeps using its own policy (or the default)
+  wxArrayString choices;
+  choices.Add(_("Each entry's own password policy"));
+  choices.Add(towxstring(PolicyManager::GetDefaultPolicyName()));
+  for (const auto &policy : PolicyManager(m_core).GetPolicies())
+    choices.Add(towxstring(policy.first));
+
+  wxString message;
+  message.Printf(_("Replace the passwords of %zu expired entries with passwords made according to:"),
+                 uuids.size());
+  wxSingleChoiceDialog dlg(this, message, _("Change Expired Passwords"), choices);
+  if (dlg.ShowModal() != wxID_OK)
+    return;
+
+  const StringX sxPolicyName = dlg.GetSelection() == 0 ? StringX() : tostringx(dlg.GetStringSelection());
+
+  size_t numRotated = 0;
+  if (m_core.RotatePasswords(uuids, sxPolicyName, numRotated) != PWScore::SUCCESS) {
+    wxMessageBox(_("Could not change the expired passwords."), _("Change Expired Passwords"),
+                 wxOK | wxICON_ERROR, this);
+  }
+}
+
 #ifndef NO_YUBI
 /*!
  * wxEVT_COMMAND_MENU_SELECTED event handler for ID_YUBIKEY_MNG
@@ -465,8 +519,7 @@ bool PasswordSafeFrame::ChangeMode(bool promptUser)
                (plkUser == pws_os::getusername()) && (plkHost == pws_os::gethostname())) {
               wxMessageDialog dialog(this, _("Lock is done by yourself"), _("Remove Lock?"), wxYES_NO | wxICON_EXCLAMATION);
               if(dialog.ShowModal() == wxID_YES) {
-                HANDLE handle = 0;
-                pws_os::UnlockFile(m_core.GetCurFile().c_str(), handle);
+                m_core.UnlockFile(m_core.GetCurFile().c_str());
                 doAgain = true;
                 continue;
               }
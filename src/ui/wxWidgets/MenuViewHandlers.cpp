@@ -33,6 +33,7 @@
 #include "PasswordSafeSearch.h"
 #include "TreeCtrl.h"
 #include "ViewReportDlg.h"
+#include "VirtualTreeCtrl.h"
 #include "core/PWSFilters.h"
 #include "SetFiltersDlg.h"
 #include "ManageFiltersDlg.h"
@@ -67,8 +68,10 @@ void PasswordSafeFrame::OnListViewClick(wxCommandEvent& WXUNUSED(evt))
 
   // Unregister the active view at core to not get notifications anymore
   m_core.UnregisterObserver(m_tree);
+  m_core.UnregisterObserver(m_vtree);
 
   ShowTree(false);
+  ShowVirtualTree(false);
   ShowGrid(true);
   SetViewType(ViewType::GRID);
 
@@ -88,8 +91,10 @@ void PasswordSafeFrame::OnTreeViewClick(wxCommandEvent& WXUNUSED(evt))
 
   // Unregister the active view at core to not get notifications anymore
   m_core.UnregisterObserver(m_grid);
+  m_core.UnregisterObserver(m_vtree);
 
   ShowGrid(false);
+  ShowVirtualTree(false);
   ShowTree(true);
   SetViewType(ViewType::TREE);
 
@@ -99,6 +104,29 @@ void PasswordSafeFrame::OnTreeViewClick(wxCommandEvent& WXUNUSED(evt))
   UpdateTreeSortMenu();
 }
 
+/*!
+ * wxEVT_COMMAND_MENU_SELECTED event handler for ID_VIRTUAL_TREE_VIEW
+ */
+
+void PasswordSafeFrame::OnVirtualTreeViewClick(wxCommandEvent& WXUNUSED(evt))
+{
+  PWSprefs::GetInstance()->SetPref(PWSprefs::LastView, _T("vtree"));
+
+  // Unregister the active view at core to not get notifications anymore
+  m_core.UnregisterObserver(m_grid);
+  m_core.UnregisterObserver(m_tree);
+
+  ShowGrid(false);
+  ShowTree(false);
+  ShowVirtualTree(true);
+  SetViewType(ViewType::VTREE);
+
+  // Register view at core as new observer for notifications
+  m_core.RegisterObserver(m_vtree);
+
+  UpdateTreeSortMenu();
+}
+
 /*!
  * wxEVT_COMMAND_MENU_SELECTED event handler for ID_SORT_TREE_BY_GROUP
  */
@@ -27,6 +27,7 @@
 #include <wx/filename.h>
 #include <wx/fontdlg.h>
 #include <wx/numformatter.h>
+#include <wx/wupdlock.h>
 
 #include "core/core.h"
 #include "core/PWScore.h"
@@ -39,6 +40,7 @@
 #include "graphics/cpane.xpm"
 
 #include "AboutDlg.h"
+#include "BackgroundFileReader.h"
 #include "Clipboard.h"
 #include "DragBarCtrl.h"
 #include "GridCtrl.h"
@@ -54,11 +56,13 @@
 #include "SafeCombinationPromptDlg.h"
 #include "SetDatabaseIdDlg.h"
 #include "StatusBar.h"
+#include "StrengthMeter.h"
 #include "SystemTray.h"
 #include "SystemTrayMenuId.h"
 #include "ToolbarButtons.h"
 #include "TreeCtrl.h"
 #include "ViewReportDlg.h"
+#include "VirtualTreeCtrl.h"
 #include "DnDFile.h"
 #include "core/Report.h"
 
@@ -196,6 +200,7 @@ BEGIN_EVENT_TABLE( PasswordSafeFrame, wxFrame )
   // Connect event handlers
   EVT_MENU( ID_LIST_VIEW,               PasswordSafeFrame::OnListViewClick               )
   EVT_MENU( ID_TREE_VIEW,               PasswordSafeFrame::OnTreeViewClick               )
+  EVT_MENU( ID_VIRTUAL_TREE_VIEW,       PasswordSafeFrame::OnVirtualTreeViewClick        )
   EVT_MENU( ID_SORT_TREE_BY_GROUP,      PasswordSafeFrame::OnSortByGroupClick            )
   EVT_MENU( ID_SORT_TREE_BY_NAME,       PasswordSafeFrame::OnSortByNameClick             )
   EVT_MENU( ID_SORT_TREE_BY_DATE,       PasswordSafeFrame::OnSortByDateClick             )
@@ -232,6 +237,7 @@ BEGIN_EVENT_TABLE( PasswordSafeFrame, wxFrame )
   // Update menu items
   EVT_UPDATE_UI( ID_LIST_VIEW,          PasswordSafeFrame::OnUpdateUI                    )
   EVT_UPDATE_UI( ID_TREE_VIEW,          PasswordSafeFrame::OnUpdateUI                    )
+  EVT_UPDATE_UI( ID_VIRTUAL_TREE_VIEW,  PasswordSafeFrame::OnUpdateUI                    )
   EVT_UPDATE_UI( ID_SORT_TREE_MENU,     PasswordSafeFrame::OnUpdateUI                    )
   EVT_UPDATE_UI( ID_SORT_TREE_BY_GROUP, PasswordSafeFrame::OnUpdateUI                    )
   EVT_UPDATE_UI( ID_SORT_TREE_BY_NAME,  PasswordSafeFrame::OnUpdateUI                    )
@@ -281,6 +287,7 @@ BEGIN_EVENT_TABLE( PasswordSafeFrame, wxFrame )
   EVT_MENU( wxID_PREFERENCES,           PasswordSafeFrame::OnPreferencesClick            )
   EVT_MENU( ID_PWDPOLSM,                PasswordSafeFrame::OnPwdPolsMClick               )
   EVT_MENU( ID_GENERATEPASSWORD,        PasswordSafeFrame::OnGeneratePassword            )
+  EVT_MENU( ID_ROTATEEXPIRED,           PasswordSafeFrame::OnRotateExpiredPasswords      )
 #ifndef NO_YUBI
   EVT_MENU( ID_YUBIKEY_MNG,             PasswordSafeFrame::OnYubikeyMngClick             )
 #endif
@@ -293,6 +300,7 @@ BEGIN_EVENT_TABLE( PasswordSafeFrame, wxFrame )
   EVT_UPDATE_UI( wxID_PREFERENCES,      PasswordSafeFrame::OnUpdateUI                    )
   EVT_UPDATE_UI( ID_PWDPOLSM,           PasswordSafeFrame::OnUpdateUI                    )
   EVT_UPDATE_UI( ID_GENERATEPASSWORD,   PasswordSafeFrame::OnUpdateUI                    )
+  EVT_UPDATE_UI( ID_ROTATEEXPIRED,      PasswordSafeFrame::OnUpdateUI                    )
   EVT_UPDATE_UI( ID_SETDATABASEID,      PasswordSafeFrame::OnUpdateUI                    )
 #ifndef NO_YUBI
   EVT_UPDATE_UI( ID_YUBIKEY_MNG,        PasswordSafeFrame::OnUpdateUI                    )
@@ -356,7 +364,8 @@ int PasswordSafeFrame::s_TotpCalculationInterval = 30; // s
 PasswordSafeFrame::PasswordSafeFrame(PWScore &core)
 : m_core(core), m_currentView(ViewType::GRID), m_search(nullptr), m_sysTray(new SystemTray(this)),
   m_bRestoredDBUnsaved(false),
-  m_RUEList(core), m_guiInfo(new GuiInfo), m_bTSUpdated(false), m_savedDBPrefs(wxEmptyString),
+  m_RUEList(core), m_weakPasswords(StrengthMeter::STRENGTH_WEAK), m_weakPasswordsAudit(0),
+    m_bWeakPasswordsAudited(false), m_guiInfo(new GuiInfo), m_bTSUpdated(false), m_savedDBPrefs(wxEmptyString),
   m_CurrentPredefinedFilter(NONE), m_bFilterActive(false), m_InitialTreeDisplayStatusAtOpen(true),
   m_LastClipboardAction(wxEmptyString), m_LastAction(CItem::FieldType::START)
 {
@@ -369,7 +378,8 @@ PasswordSafeFrame::PasswordSafeFrame(wxWindow* parent, PWScore &core,
                                      long style)
   : m_core(core), m_currentView(ViewType::GRID), m_search(nullptr), m_sysTray(new SystemTray(this)),
     m_bRestoredDBUnsaved(false),
-    m_RUEList(core), m_guiInfo(new GuiInfo), m_bTSUpdated(false), m_savedDBPrefs(wxEmptyString),
+    m_RUEList(core), m_weakPasswords(StrengthMeter::STRENGTH_WEAK), m_weakPasswordsAudit(0),
+    m_bWeakPasswordsAudited(false), m_guiInfo(new GuiInfo), m_bTSUpdated(false), m_savedDBPrefs(wxEmptyString),
     m_CurrentPredefinedFilter(NONE), m_bFilterActive(false), m_InitialTreeDisplayStatusAtOpen(true),
     m_LastClipboardAction(wxEmptyString), m_LastAction(CItem::FieldType::START)
 {
@@ -388,6 +398,9 @@ PasswordSafeFrame::PasswordSafeFrame(wxWindow* parent, PWScore &core,
   if (IsTreeView()) {
     m_core.RegisterObserver(m_tree);
   }
+  else if (IsVirtualTreeView()) {
+    m_core.RegisterObserver(m_vtree);
+  }
   else {
     m_core.RegisterObserver(m_grid);
   }
@@ -457,7 +470,13 @@ PasswordSafeFrame::~PasswordSafeFrame()
 
 void PasswordSafeFrame::Init()
 {
-  m_currentView = (PWSprefs::GetInstance()->GetPref(PWSprefs::LastView) == _T("list")) ? ViewType::GRID : ViewType::TREE;
+  const stringT lastView = PWSprefs::GetInstance()->GetPref(PWSprefs::LastView).c_str();
+  if (lastView == _T("list"))
+    m_currentView = ViewType::GRID;
+  else if (lastView == _T("vtree"))
+    m_currentView = ViewType::VTREE;
+  else
+    m_currentView = ViewType::TREE;
 
   if (PWSprefs::GetInstance()->GetPref(PWSprefs::TreeSort) == _T("date")) {
     SetTreeSortType(TreeSortType::DATE);
@@ -473,6 +492,7 @@ void PasswordSafeFrame::Init()
   m_Dragbar = nullptr;
   m_grid = nullptr;
   m_tree = nullptr;
+  m_vtree = nullptr;
   m_statusBar = nullptr;
   m_bShowEmptyGroupsInFilter = false;
   m_ApplyClearFilter = nullptr;
@@ -673,6 +693,7 @@ void PasswordSafeFrame::CreateMenubar()
   auto menuView = new wxMenu;
   menuView->Append(ID_LIST_VIEW, _("Flattened &List"), wxEmptyString, wxITEM_RADIO);
   menuView->Append(ID_TREE_VIEW, _("Nested &Tree"), wxEmptyString, wxITEM_RADIO);
+  menuView->Append(ID_VIRTUAL_TREE_VIEW, _("Nested Tree (Large &Databases)"), wxEmptyString, wxITEM_RADIO);
   menuView->AppendSeparator();
   
   auto menuSortTree = new wxMenu;
@@ -744,6 +765,7 @@ void PasswordSafeFrame::CreateMenubar()
   menuManage->Append(ID_PWDPOLSM, _("Password Policies..."), wxEmptyString, wxITEM_NORMAL);
   menuManage->AppendSeparator();
   menuManage->Append(ID_GENERATEPASSWORD, _("Generate &Password...\tCtrl+P"), _("Generate Password"), wxITEM_NORMAL);
+  menuManage->Append(ID_ROTATEEXPIRED, _("Change E&xpired Passwords..."), _("Replace all expired passwords with generated ones"), wxITEM_NORMAL);
 #ifndef NO_YUBI
   menuManage->Append(ID_YUBIKEY_MNG, _("YubiKey..."), _("Configure and backup YubiKeys"), wxITEM_NORMAL);
 #endif
@@ -776,7 +798,7 @@ void PasswordSafeFrame::CreateMenubar()
   }
 
   // Update menu selections
-  menuBar->Check((IsTreeView()) ? ID_TREE_VIEW : ID_LIST_VIEW, true);
+  menuBar->Check(IsTreeView() ? ID_TREE_VIEW : IsVirtualTreeView() ? ID_VIRTUAL_TREE_VIEW : ID_LIST_VIEW, true);
   menuBar->Check(PWSprefs::GetInstance()->GetPref(PWSprefs::UseNewToolbar) ? ID_TOOLBAR_NEW : ID_TOOLBAR_CLASSIC, true);
   menuBar->Check(ID_SHOW_EMPTY_GROUP_IN_FILTER, m_bShowEmptyGroupsInFilter);
   UpdateTreeSortMenu();
@@ -837,6 +859,11 @@ void PasswordSafeFrame::CreateControls()
 
   itemBoxSizer83->Add(m_tree, wxSizerFlags().Expand().Border(0).Proportion(1));
 
+  m_vtree = new VirtualTreeCtrl( panel, m_core, ID_VIRTUALTREECTRL, wxDefaultPosition,
+                                 wxDefaultSize, wxDV_NO_HEADER|wxDV_SINGLE );
+  wxASSERT(m_vtree);
+  itemBoxSizer83->Add(m_vtree, wxSizerFlags().Expand().Border(0).Proportion(1));
+
   itemBoxSizer83->Layout();
 
   const RecentDbList& rdb = wxGetApp().recentDatabases();
@@ -1277,13 +1304,23 @@ void PasswordSafeFrame::SetTitle(const wxString& title)
 
 int PasswordSafeFrame::Load(const StringX &passwd)
 {
-  int status = m_core.ReadCurFile(passwd);
+  // Whatever was scheduled was for the database being replaced
+  m_idleTasks.CancelAll();
+
+  int status;
+  {
+    // Events are handled while the file is read in the background, but the
+    // views mustn't draw the entries the read is replacing
+    wxWindowUpdateLocker noUpdates(this);
+    status = BackgroundFileReader(this, m_core).ReadCurFile(passwd);
+  }
   if (status == PWScore::SUCCESS) {
     wxGetApp().ConfigureIdleTimer();
     SetTitle(m_core.GetCurFile().c_str());
     m_sysTray->SetTrayStatus(SystemTray::TrayStatus::UNLOCKED);
     m_core.ResumeOnDBNotification();
     m_RUEList.SetRUEList(m_core.GetRUEList());
+    StartWeakPasswordsAudit();
   } else {
     SetTitle(wxEmptyString);
     m_sysTray->SetTrayStatus(SystemTray::TrayStatus::CLOSED);
@@ -1297,6 +1334,7 @@ bool PasswordSafeFrame::Show(bool show)
 {
   ShowGrid(show && IsGridView());
   ShowTree(show && IsTreeView());
+  ShowVirtualTree(show && IsVirtualTreeView());
   
   SetFocus();
 
@@ -1322,9 +1360,9 @@ void PasswordSafeFrame::ShowGrid(bool show)
         m_grid->AddItem(iter->second, i++);
     }
     
-    m_grid->AutoSizeRows(); // Forces row height recalculation based on font size
+    m_grid->SetRowHeightFromFont();
     if(PWSprefs::GetInstance()->GetPref(PWSprefs::AutoAdjColWidth)) {
-      m_grid->AutoSizeColumns(false);
+      m_grid->AutoSizeColumnsSampled();
       m_grid->Layout();
     }
     
@@ -1369,26 +1407,26 @@ void PasswordSafeFrame::ShowTree(bool show)
     wxFont font(towxstring(PWSprefs::GetInstance()->GetPref(PWSprefs::TreeFont)));
     if (font.IsOk())
       m_tree->SetFont(font);
+    std::vector<const CItemData *> items;
+    items.reserve(m_core.GetNumEntries());
     ItemListConstIter iter;
     for (iter = m_core.GetEntryIter();
          iter != m_core.GetEntryEndIter();
          iter++) {
       if (!m_bFilterActive ||
           m_FilterManager.PassesFiltering(iter->second, m_core))
-        m_tree->AddItem(iter->second);
+        items.push_back(&iter->second);
     }
 
+    typedef std::vector<StringX> StringVectorX;
+    StringVectorX emptyGroups;
     if(IsTreeSortGroup() && (!m_bFilterActive || m_bShowEmptyGroupsInFilter || (m_CurrentPredefinedFilter == UNSAVED))) {
       // Empty groups need to be added separately
-      typedef std::vector<StringX> StringVectorX;
-      const StringVectorX& emptyGroups = (m_bFilterActive && (m_CurrentPredefinedFilter == UNSAVED) && !m_bShowEmptyGroupsInFilter) ?  m_core.GetModifiedEmptyGroups() : m_core.GetEmptyGroups();
-      for (const auto & emptyGroup : emptyGroups)
-        m_tree->AddEmptyGroup(emptyGroup);
+      emptyGroups = (m_bFilterActive && (m_CurrentPredefinedFilter == UNSAVED) && !m_bShowEmptyGroupsInFilter) ?  m_core.GetModifiedEmptyGroups() : m_core.GetEmptyGroups();
     }
 
-    if (m_tree->HasItems()) {// avoid assertion!
-      m_tree->SortChildrenRecursively(m_tree->GetRootItem());
-    }
+    // Adds everything in sorted order, no need to sort afterwards
+    m_tree->AddItems(items, emptyGroups);
 
     if (m_InitialTreeDisplayStatusAtOpen) {
       m_InitialTreeDisplayStatusAtOpen = false;
@@ -1426,10 +1464,47 @@ void PasswordSafeFrame::ShowTree(bool show)
   GetSizer()->Layout();
 }
 
+void PasswordSafeFrame::ShowVirtualTree(bool show)
+{
+  if (show) {
+    wxFont font(towxstring(PWSprefs::GetInstance()->GetPref(PWSprefs::TreeFont)));
+    if (font.IsOk())
+      m_vtree->SetFont(font);
+    std::vector<const CItemData *> items;
+    items.reserve(m_core.GetNumEntries());
+    for (auto iter = m_core.GetEntryIter(); iter != m_core.GetEntryEndIter(); iter++) {
+      if (!m_bFilterActive ||
+          m_FilterManager.PassesFiltering(iter->second, m_core))
+        items.push_back(&iter->second);
+    }
+
+    // Same empty groups as ShowTree shows when sorting by group
+    std::vector<StringX> emptyGroups;
+    if (!m_bFilterActive || m_bShowEmptyGroupsInFilter || (m_CurrentPredefinedFilter == UNSAVED)) {
+      emptyGroups = (m_bFilterActive && (m_CurrentPredefinedFilter == UNSAVED) && !m_bShowEmptyGroupsInFilter) ?  m_core.GetModifiedEmptyGroups() : m_core.GetEmptyGroups();
+    }
+
+    // Only indexes the entries' groups - the nodes are created by the
+    // control as groups get expanded
+    m_vtree->Rebuild(items, emptyGroups);
+    m_vtree->SetFilterState(m_bFilterActive);
+  }
+  else {
+    m_vtree->Clear();
+  }
+
+  m_vtree->Show(show);
+  GetSizer()->Layout();
+}
+
 void PasswordSafeFrame::ClearAppData()
 {
+  m_idleTasks.CancelAll();
+  m_weakPasswords.Clear();
+  m_bWeakPasswordsAudited = false;
   m_grid->Clear();
   m_tree->Clear();
+  m_vtree->Clear();
   ResetFilters();
 }
 
@@ -1449,6 +1524,8 @@ CItemData *PasswordSafeFrame::GetSelectedEntry() const
   if (m_tree->IsShown()) {
     // get selected from tree
     return m_tree->GetItem(m_tree->GetSelection());
+  } else if (m_vtree->IsShown()) {
+    return m_vtree->GetSelectedItem();
   } else if (m_grid->IsShown()) {
     // get selected from grid
     return m_grid->GetItem(m_grid->GetGridCursorRow());
@@ -1516,6 +1593,15 @@ int PasswordSafeFrame::Open(const wxString &fname)
 
       // The new file is open.  Clear the lock on the old file, if any.
       m_core.SafeUnlockFile(oldfn);
+    } else if (retval == PWScore::USER_CANCEL) {
+      // Reading cleared the old database before it was cancelled, so
+      // neither file is open any more
+      ClearAppData();
+      m_core.SafeUnlockFile(stringT(fname.c_str()));
+      m_core.SafeUnlockFile(oldfn);
+      m_core.SetCurFile(L"");
+      wxMessageBox(wxString::Format(_("Opening %ls was cancelled, no database is open."), fname.wc_str()),
+                   _("Open database"), wxOK|wxICON_INFORMATION, this);
     }
     return retval;
   } else
@@ -1736,6 +1822,9 @@ void PasswordSafeFrame::SelectItem(const CUUID& uuid)
     if (IsGridView()) {
       m_grid->SelectItem(uuid);
     }
+    else if (IsVirtualTreeView()) {
+      m_vtree->SelectItem(uuid);
+    }
     else {
       m_tree->SelectItem(uuid);
     }
@@ -1887,7 +1976,10 @@ void PasswordSafeFrame::OnContextMenu(const CItemData* item)
 
       contextMenu.Append(wxID_ADD, _("Add &Entry"));
 
-      m_grid->PopupMenu(&contextMenu);
+      if (IsVirtualTreeView())
+        m_vtree->PopupMenu(&contextMenu);
+      else
+        m_grid->PopupMenu(&contextMenu);
     }
   }
   else {
@@ -2046,6 +2138,9 @@ void PasswordSafeFrame::OnContextMenu(const CItemData* item)
     if (IsTreeView()) {
       m_tree->PopupMenu(&itemEditMenu);
     }
+    else if (IsVirtualTreeView()) {
+      m_vtree->PopupMenu(&itemEditMenu);
+    }
     else {
       m_grid->PopupMenu(&itemEditMenu);
     }
@@ -2291,6 +2386,7 @@ void PasswordSafeFrame::OnUpdateUI(wxUpdateUIEvent& evt)
     case ID_CLEARCLIPBOARD:
     case ID_LIST_VIEW:
     case ID_TREE_VIEW:
+    case ID_VIRTUAL_TREE_VIEW:
     case ID_REPORTSMENU:
     case ID_BACKUP:
     case ID_RESTORE:
@@ -2469,6 +2565,11 @@ void PasswordSafeFrame::OnUpdateUI(wxUpdateUIEvent& evt)
       evt.Check(m_CurrentPredefinedFilter == UNSAVED);
       break;
 
+    case ID_ROTATEEXPIRED:
+      evt.Enable(isUnlocked && !isFileReadOnly && m_core.IsDbFileSet() &&
+                 m_core.GetExpirySize() != 0);
+      break;
+
     case ID_SHOW_ALL_EXPIRY:
       evt.Enable(isUnlocked && ((m_CurrentPredefinedFilter == EXPIRY) || ((m_CurrentPredefinedFilter == NONE) &&
        m_core.IsDbFileSet() &&
@@ -2591,6 +2692,9 @@ void PasswordSafeFrame::RebuildGUI(const int iView /*= iBothViews*/)
     ShowTree();
     m_guiInfo->Restore(this);
   }
+  else if (IsVirtualTreeView() && (iView & iTreeOnly)) {
+    ShowVirtualTree();
+  }
   else if (iView & iListOnly) {
     m_guiInfo->Save(this);
     ShowGrid();
@@ -2604,6 +2708,8 @@ void PasswordSafeFrame::RefreshViews()
 
   if (IsTreeView())
     ShowTree();
+  else if (IsVirtualTreeView())
+    ShowVirtualTree();
   else
     ShowGrid();
 
@@ -2638,7 +2744,7 @@ void PasswordSafeFrame::DatabaseModified(bool modified)
 /**
  * Implements Observer::UpdateGUI(UpdateGUICommand::GUI_Action, const pws_os::CUUID&, CItemData::FieldType)
  */
-void PasswordSafeFrame::UpdateGUI(UpdateGUICommand::GUI_Action ga, const CUUID & WXUNUSED(entry_uuid), CItemData::FieldType WXUNUSED(ft))
+void PasswordSafeFrame::UpdateGUI(UpdateGUICommand::GUI_Action ga, const CUUID &entry_uuid, CItemData::FieldType WXUNUSED(ft))
 {
   // Callback from PWScore if GUI needs updating
 
@@ -2651,6 +2757,8 @@ void PasswordSafeFrame::UpdateGUI(UpdateGUICommand::GUI_Action ga, const CUUID &
 #ifdef NOTYET
   PWSprefs *prefs = PWSprefs::GetInstance();
 #endif
+  UpdateWeakPasswords(ga, entry_uuid);
+
   switch (ga) {
     case UpdateGUICommand::GUI_ADD_ENTRY:
       // Handled by individual views.
@@ -2661,16 +2769,16 @@ void PasswordSafeFrame::UpdateGUI(UpdateGUICommand::GUI_Action ga, const CUUID &
     case UpdateGUICommand::GUI_REFRESH_ENTRYFIELD:
       // Handled by individual views.
     case UpdateGUICommand::GUI_REFRESH_ENTRYPASSWORD:
-      // Handled by individual views.
-      
-      // But on Filter active the GUI must be updated
-      if(m_bFilterActive) {
-        RebuildGUI();
-      }
+      // Handled by individual views, which also add or remove the entry
+      // if a filter is active and it now passes or fails it.
       break;
     case UpdateGUICommand::GUI_REFRESH_TREE:
-      // Caused by Database preference changed about showing username and/or
-      // passwords in the Tree View
+      // An edit that moved a single entry to another group is handled by
+      // the individual views, just like GUI_REFRESH_ENTRY.
+      if (entry_uuid != CUUID::NullUUID() && m_core.Find(entry_uuid) != m_core.GetEntryEndIter())
+        break;
+      // Otherwise caused by Database preference changed about showing
+      // username and/or passwords in the Tree View, or by group changes
       RebuildGUI(iTreeOnly);
       break;
     case UpdateGUICommand::GUI_REDO_MERGESYNC:
@@ -2680,6 +2788,7 @@ void PasswordSafeFrame::UpdateGUI(UpdateGUICommand::GUI_Action ga, const CUUID &
       // During these processes, many entries may be added/removed
       // To stop the UI going nuts, updates to the UI are suspended until
       // the action is complete - when these calls are then sent
+      StartWeakPasswordsAudit();
       RebuildGUI();
       break;
     case UpdateGUICommand::GUI_UPDATE_STATUSBAR:
@@ -2832,6 +2941,8 @@ void PasswordSafeFrame::SetFocus()
 {
   if (IsTreeView())
     m_tree->SetFocus();
+  else if (IsVirtualTreeView())
+    m_vtree->SetFocus();
   else
     m_grid->SetFocus();
 }
@@ -3052,6 +3163,8 @@ void PasswordSafeFrame::UpdateStatusBar()
     m_statusBar->SetStatusText(text, StatusBar::Field::READONLY);
 
     text.Clear(); text <<  m_core.GetNumEntries();
+    if (m_bWeakPasswordsAudited && m_weakPasswords.GetCount() != 0)
+      text << wxT(" (") << wxString::Format(_("%d weak"), static_cast<int>(m_weakPasswords.GetCount())) << wxT(")");
     m_statusBar->SetStatusText(text, StatusBar::Field::NUM_ENT);
 
     text = m_bFilterActive ? wxT("[F]") : wxT("   ");
@@ -3074,6 +3187,56 @@ void PasswordSafeFrame::UpdateStatusBar()
   }
 }
 
+void PasswordSafeFrame::StartWeakPasswordsAudit()
+{
+  // A few tens of microseconds per password, which adds up for a large
+  // database, so the audit's done from idle time, an entry at a time
+  m_weakPasswords.Clear();
+  m_bWeakPasswordsAudited = false;
+  const unsigned audit = ++m_weakPasswordsAudit;
+  m_idleTasks.Add(new EntryVisitTask(m_core,
+    [this, audit](const CItemData &item) {
+      if (audit == m_weakPasswordsAudit)
+        m_weakPasswords.Update(item);
+    },
+    EntryVisitTask::DEFAULT_ENTRIES_PER_STEP,
+    [this, audit]() {
+      if (audit == m_weakPasswordsAudit) {
+        m_bWeakPasswordsAudited = true;
+        UpdateStatusBar();
+      }
+    }));
+}
+
+// Keeps the audit's results up to date as entries change, whether the
+// audit's done or not: it visits each entry's current data, too
+void PasswordSafeFrame::UpdateWeakPasswords(UpdateGUICommand::GUI_Action ga, const CUUID &entry_uuid)
+{
+  switch (ga) {
+    case UpdateGUICommand::GUI_ADD_ENTRY:
+    case UpdateGUICommand::GUI_DELETE_ENTRY:
+    case UpdateGUICommand::GUI_REFRESH_ENTRY:
+    case UpdateGUICommand::GUI_REFRESH_ENTRYFIELD:
+    case UpdateGUICommand::GUI_REFRESH_ENTRYPASSWORD:
+    case UpdateGUICommand::GUI_REFRESH_TREE:
+      break;
+    default:
+      return;
+  }
+  if (entry_uuid == CUUID::NullUUID())
+    return;
+
+  const size_t numWeak = m_weakPasswords.GetCount();
+  auto iter = m_core.Find(entry_uuid);
+  if (ga != UpdateGUICommand::GUI_DELETE_ENTRY && iter != m_core.GetEntryEndIter())
+    m_weakPasswords.Update(iter->second);
+  else
+    m_weakPasswords.Remove(entry_uuid);
+
+  if (m_bWeakPasswordsAudited && m_weakPasswords.GetCount() != numWeak)
+    UpdateStatusBar();
+}
+
 void PasswordSafeFrame::UpdateMenuBar()
 {
   // Add code here for more complex update logic on menu items, otherwise use OnUpdateUI
@@ -3156,6 +3319,11 @@ void PasswordSafeFrame::UpdateSelChanged(const CItemData *pci)
   m_statusBar->SetStatusText(_(PWSprefs::GetDCAdescription(dca)), StatusBar::Field::DOUBLECLICK);
 }
 
+bool PasswordSafeFrame::PassesFilter(const CItemData &item)
+{
+  return !m_bFilterActive || m_FilterManager.PassesFiltering(item, m_core);
+}
+
 void PasswordSafeFrame::ChangeFontPreference(const PWSprefs::StringPrefs fontPreference)
 {
   wxFont currentFont(towxstring(PWSprefs::GetInstance()->GetPref(fontPreference)));
@@ -3166,7 +3334,8 @@ void PasswordSafeFrame::ChangeFontPreference(const PWSprefs::StringPrefs fontPre
   case (PWSprefs::StringPrefs::TreeFont):
   {
     if (!currentFont.IsOk()) {
-      currentFont = IsTreeView() ? m_tree->GetFont() : m_grid->GetDefaultCellFont();
+      currentFont = IsTreeView() ? m_tree->GetFont()
+                  : IsVirtualTreeView() ? m_vtree->GetFont() : m_grid->GetDefaultCellFont();
     }
 
     newFont = ::wxGetFontFromUser(this, currentFont, _("Select Tree/List display font"));
@@ -3176,9 +3345,13 @@ void PasswordSafeFrame::ChangeFontPreference(const PWSprefs::StringPrefs fontPre
         m_tree->SetFont(newFont);
         m_tree->Refresh(); // Updates the tree items font
       }
+      else if (IsVirtualTreeView()) {
+        m_vtree->SetFont(newFont);
+        m_vtree->Refresh();
+      }
       else {
         m_grid->SetDefaultCellFont(newFont);
-        m_grid->AutoSizeRows(); // Forces row height recalculation based on font size
+        m_grid->SetRowHeightFromFont();
         m_grid->Refresh(); // Updates the grid items font
       }
     }
@@ -27,6 +27,8 @@
 #include <wx/settings.h>
 #include <wx/modalhook.h>
 
+#include "core/PasswordStrength.h"
+#include "core/PWSAuxParse.h"
 #include "core/PWScore.h"
 #include "core/PWSFilters.h"
 #include "core/RUEList.h"
@@ -36,6 +38,7 @@
 #include "wxUtilities.h"
 #include "DnDFile.h"
 #include "DragBarCtrl.h"
+#include "IdleTaskScheduler.h"
 #include "TimedTaskChain.h"
 
 #include <tuple>
@@ -49,6 +52,7 @@
 ////@begin forward declarations
 class GridCtrl;
 class TreeCtrl;
+class VirtualTreeCtrl;
 class StatusBar;
 ////@end forward declarations
 class SystemTray;
@@ -107,6 +111,7 @@ enum {
   ID_GOTOBASEENTRY,
   ID_LIST_VIEW,
   ID_TREE_VIEW,
+  ID_VIRTUAL_TREE_VIEW,
   ID_SHOWHIDE_TOOLBAR,
   ID_SHOWHIDE_DRAGBAR,
   ID_EXPANDALL,
@@ -138,6 +143,7 @@ enum {
   ID_RESTORE,
   ID_PWDPOLSM,
   ID_GENERATEPASSWORD,
+  ID_ROTATEEXPIRED,
   ID_SETDATABASEID,
   ID_YUBIKEY_MNG,
   ID_LANGUAGEMENU,
@@ -228,7 +234,7 @@ class PasswordSafeFrame : public wxFrame, public Observer, public wxModalDialogH
     DECLARE_EVENT_TABLE()
 
 private:
-    enum class ViewType { TREE, GRID };
+    enum class ViewType { TREE, GRID, VTREE };
     enum class TreeSortType { GROUP, NAME, DATE };
 public:
   /// Constructors
@@ -335,6 +341,9 @@ public:
   /// wxEVT_COMMAND_MENU_SELECTED event handler for ID_TREE_VIEW
   void OnTreeViewClick( wxCommandEvent& event );
 
+  /// wxEVT_COMMAND_MENU_SELECTED event handler for ID_VIRTUAL_TREE_VIEW
+  void OnVirtualTreeViewClick( wxCommandEvent& event );
+
   /// wxEVT_COMMAND_MENU_SELECTED event handler for ID_SORT_TREE_BY_GROUP
   void OnSortByGroupClick( wxCommandEvent& event );
 
@@ -374,6 +383,9 @@ public:
   /// wxEVT_COMMAND_MENU_SELECTED event handler for ID_GENERATE_PASSWORD
   void OnGeneratePassword( wxCommandEvent& event );
 
+  /// wxEVT_COMMAND_MENU_SELECTED event handler for ID_ROTATEEXPIRED
+  void OnRotateExpiredPasswords( wxCommandEvent& event );
+
 #ifndef NO_YUBI
   /// wxEVT_COMMAND_MENU_SELECTED event handler for ID_YUBIKEY_MNG
   void OnYubikeyMngClick( wxCommandEvent& event );
@@ -600,6 +612,7 @@ public:
   void SetViewType(const ViewType& view) { m_currentView = view; }
   bool IsTreeView() const { return m_currentView == ViewType::TREE; }
   bool IsGridView() const { return m_currentView == ViewType::GRID; }
+  bool IsVirtualTreeView() const { return m_currentView == ViewType::VTREE; }
  
   void SetTreeSortType(const TreeSortType& view) { m_currentSort = view; }
   bool IsTreeSortGroup() const { return m_currentSort == TreeSortType::GROUP; }
@@ -612,6 +625,10 @@ public:
 
   void DispatchDblClickAction(CItemData &item); // called by grid/tree
   void UpdateSelChanged(const CItemData *pci);  // ditto
+  bool PassesFilter(const CItemData &item);      // ditto, true if no filter active
+
+  /// Low-priority work on the open database, dropped when it's locked or closed
+  IdleTaskScheduler &GetIdleTasks() { return m_idleTasks; }
 
   /// Centralized handling of right click in the grid or the tree view
   void OnContextMenu(const CItemData* item);
@@ -677,6 +694,7 @@ public:
 ////@begin PasswordSafeFrame member variables
   GridCtrl* m_grid;
   TreeCtrl* m_tree;
+  VirtualTreeCtrl* m_vtree;
   StatusBar* m_statusBar;
 ////@end PasswordSafeFrame member variables
 
@@ -700,6 +718,7 @@ private:
   int SaveImmediately();
   void ShowGrid(bool show = true);
   void ShowTree(bool show = true);
+  void ShowVirtualTree(bool show = true);
   void ClearAppData();
   bool ReloadDatabase(const StringX& password);
   bool SaveAndClearDatabaseOnLock();
@@ -760,7 +779,7 @@ private:
   void DoCopyCustomFieldValue(const StringX &fieldValue);
   void DoEdit(CItemData item);
   void DoAutotype(CItemData &item);
-  void DoAutotype(const StringX& sx_autotype, const std::vector<size_t>& vactionverboffsets);
+  void DoAutotype(const PWSAuxParse::AutoType& autotype);
   void DoBrowse(CItemData &item, bool bAutotype);
   void DoRun(CItemData &item);
   void DoEmail(CItemData &item);
@@ -786,6 +805,9 @@ private:
   /// File open, double-click, modify, r-o r/w, filter...
   void UpdateStatusBar();
   void UpdateMenuBar();
+  /// (Re)estimates the strength of all passwords from idle time
+  void StartWeakPasswordsAudit();
+  void UpdateWeakPasswords(UpdateGUICommand::GUI_Action ga, const pws_os::CUUID &entry_uuid);
   void UpdateLastClipboardAction(const CItemData::FieldType field);
 
   void ChangeFontPreference(const PWSprefs::StringPrefs fontPreference);
@@ -806,6 +828,7 @@ private:
   void DoPwdPolsMClick();
   void DoEditFilter();
   void DoGeneratePassword();
+  void DoRotateExpiredPasswords();
   void DoChangePassword();
 #ifndef NO_QR
   void DoPasswordQRCode(CItemData* item);
@@ -830,6 +853,10 @@ private:
   SystemTray* m_sysTray;
   bool m_bRestoredDBUnsaved;
   CRUEList m_RUEList;
+  IdleTaskScheduler m_idleTasks;
+  WeakPasswords m_weakPasswords;
+  unsigned m_weakPasswordsAudit; // bumped per audit, so a superseded one can tell
+  bool m_bWeakPasswordsAudited;
   GuiInfo* m_guiInfo;
   bool m_bTSUpdated;
   wxString m_savedDBPrefs;
@@ -24,7 +24,6 @@
 #endif
 
 ////@begin includes
-#include "core/PWCharPool.h"
 #include "ExternalKeyboardButton.h"
 #include "SafeCombinationCtrl.h"
 #include "SafeCombinationChangeDlg.h"
@@ -165,9 +164,7 @@ void SafeCombinationChangeDlg::CreateControls()
   m_strengthMeter = new StrengthMeter(this);
   m_newPasswdEntry->SetTextChangedHandler(
     [&](const StringX& password) {
-      m_strengthMeter->SetStrength(
-        CPasswordCharPool::CalculatePasswordStrength(password)
-      );
+      m_strengthMeter->SetPassword(password);
     }
   );
   hBoxSizer->Add(m_strengthMeter, 1, wxALIGN_LEFT|wxEXPAND, 0);
@@ -378,8 +378,7 @@ bool SafeCombinationEntryDlg::ProcessPhrase()
          (plkUser == pws_os::getusername()) && (plkHost == pws_os::gethostname())) {
         wxMessageDialog dialog(this, _("Lock is done by yourself"), _("Remove Lock?"), wxYES_NO | wxICON_EXCLAMATION);
         if(dialog.ShowModal() == wxID_YES) {
-          HANDLE handle = 0;
-          pws_os::UnlockFile(fname, handle);
+          m_core.UnlockFile(fname);
           if(m_core.LockFile(fname, locker))
             m_readOnly = false;
         }
@@ -537,8 +536,7 @@ void SafeCombinationEntryDlg::DoNewDbClick()
        (plkUser == pws_os::getusername()) && (plkHost == pws_os::gethostname())) {
       wxMessageDialog dialog(this, _("Lock is done by yourself"), _("Remove Lock?"), wxYES_NO | wxICON_EXCLAMATION);
       if(dialog.ShowModal() == wxID_YES) {
-        HANDLE handle = 0;
-        pws_os::UnlockFile(fname, handle);
+        m_core.UnlockFile(fname);
         if(m_core.LockFile(fname, locker))
           fileLocked = true;
       }
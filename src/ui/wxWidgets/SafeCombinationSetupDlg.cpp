@@ -25,7 +25,6 @@
 
 ////@begin includes
 ////@end includes
-#include "core/PWCharPool.h"
 #include "ExternalKeyboardButton.h"
 #include "SafeCombinationSetupDlg.h"
 #include "wxUtilities.h"          // for ApplyPasswordFont()
@@ -120,9 +119,7 @@ void SafeCombinationSetupDlg::CreateControls()
   m_strengthMeter = new StrengthMeter(this);
   m_PasswordEntryCtrl->SetTextChangedHandler(
     [&](const StringX& password) {
-      m_strengthMeter->SetStrength(
-        CPasswordCharPool::CalculatePasswordStrength(password)
-      );
+      m_strengthMeter->SetPassword(password);
     }
   );
   hBoxSizer->Add(m_strengthMeter, 1, wxALIGN_LEFT|wxEXPAND, 0);
@@ -342,6 +342,7 @@ void SelectAliasDlg::InitDialog()
   
   const pws_os::CUUID item_uuid = m_Item->GetUUID();
   
+  std::vector<const CItemData *> items;
   ItemListConstIter iter;
   for (iter = m_Core->GetEntryIter();
        iter != m_Core->GetEntryEndIter();
@@ -353,12 +354,9 @@ void SelectAliasDlg::InitDialog()
     }
     const pws_os::CUUID uuid = (iter->second).GetUUID();
     if (item_uuid != uuid) // Do not include own item as selectable
-      m_Tree->AddItem(iter->second);
-  }
-  
-  if (m_Tree->HasItems()) {// avoid assertion!
-    m_Tree->SortChildrenRecursively(m_Tree->GetRootItem());
+      items.push_back(&iter->second);
   }
+  m_Tree->AddItems(items);
   
   if(*m_BaseItem) {
     uuid_array_t uuid;
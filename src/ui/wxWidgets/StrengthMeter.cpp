@@ -11,6 +11,13 @@
 
 #include "StrengthMeter.h"
 
+#include "core/PasswordStrength.h"
+
+#include <cmath>
+
+// Long enough to skip the intermediate passwords while typing
+static const int DEBOUNCE_MS = 150;
+
 wxBEGIN_EVENT_TABLE(StrengthMeter, wxControl)
   EVT_PAINT(StrengthMeter::OnPaint)
   EVT_SIZE(StrengthMeter::OnSize)
@@ -26,9 +33,82 @@ StrengthMeter::StrengthMeter(wxWindow* parent, wxWindowID id,
   , m_weakLabel(_("Weak Password"))
   , m_mediumLabel(_("Medium Password"))
   , m_strongLabel(_("Strong Password"))
+  , m_requestId(0)
+  , m_debounceTimer(this)
+  , m_pendingId(0)
+  , m_hasPending(false)
+  , m_quit(false)
 {
   SetBackgroundStyle(wxBG_STYLE_PAINT);
   SetMinSize(wxSize(200, 10));
+  Bind(wxEVT_TIMER, &StrengthMeter::OnDebounceTimer, this, m_debounceTimer.GetId());
+  Bind(wxEVT_THREAD, &StrengthMeter::OnEstimated, this);
+}
+
+StrengthMeter::~StrengthMeter()
+{
+  if (m_worker.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_quit = true;
+    }
+    m_cv.notify_one();
+    m_worker.join();
+  }
+}
+
+void StrengthMeter::SetPassword(const StringX& password)
+{
+  m_requestId++;
+  m_password = password;
+  if (password.empty()) {
+    m_debounceTimer.Stop();
+    SetStrength(STRENGTH_MIN);
+  } else {
+    m_debounceTimer.StartOnce(DEBOUNCE_MS);
+  }
+}
+
+void StrengthMeter::OnDebounceTimer(wxTimerEvent& WXUNUSED(event))
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingPassword = m_password;
+    m_pendingId = m_requestId;
+    m_hasPending = true;
+  }
+  if (!m_worker.joinable())
+    m_worker = std::thread(&StrengthMeter::EstimateLoop, this);
+  m_cv.notify_one();
+}
+
+void StrengthMeter::EstimateLoop()
+{
+  PasswordStrength::Preload();
+  for (;;) {
+    StringX password;
+    long id;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this] { return m_hasPending || m_quit; });
+      if (m_quit)
+        return;
+      password.swap(m_pendingPassword);
+      id = m_pendingId;
+      m_hasPending = false;
+    }
+    auto *event = new wxThreadEvent();
+    event->SetInt(static_cast<int>(std::lround(PasswordStrength::Estimate(password))));
+    event->SetExtraLong(id);
+    wxQueueEvent(this, event); // the destructor joins us before the events go away
+  }
+}
+
+void StrengthMeter::OnEstimated(wxThreadEvent& event)
+{
+  // Ignore estimates of passwords that have been changed since
+  if (event.GetExtraLong() == m_requestId)
+    SetStrength(event.GetInt());
 }
 
 void StrengthMeter::SetStrength(int strength)
@@ -13,6 +13,13 @@
 #define STRENGTH_METER_H
 
 #include <wx/wx.h>
+#include <wx/timer.h>
+
+#include "core/StringX.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 class StrengthMeter : public wxControl {
 public:
@@ -26,9 +33,16 @@ public:
     wxWindowID id = wxID_ANY,
     const wxPoint& pos = wxDefaultPosition,
     const wxSize& size = wxDefaultSize);
+  ~StrengthMeter();
 
   // Set strength value (0-100)
   void SetStrength(int strength);
+
+  // Shows the password's strength as estimated by PasswordStrength. The
+  // estimate is made on a worker thread, once the password has stopped
+  // changing for a moment, so this can be called on every keystroke.
+  void SetPassword(const StringX& password);
+
   int GetStrength() const { return m_strength; }
 
   // Set custom colors if needed
@@ -40,6 +54,9 @@ public:
 private:
   void OnPaint(wxPaintEvent& event);
   void OnSize(wxSizeEvent& event);
+  void OnDebounceTimer(wxTimerEvent& event);
+  void OnEstimated(wxThreadEvent& event);
+  void EstimateLoop(); // worker thread
   wxColor GetColorForStrength() const;
   wxString GetLabelForStrength() const;
 
@@ -55,6 +72,19 @@ private:
   wxString m_mediumLabel;
   wxString m_strongLabel;
 
+  StringX m_password;       // latest password given to SetPassword()
+  long m_requestId;         // bumped by SetPassword(), to drop stale results
+  wxTimer m_debounceTimer;
+
+  // Shared with the worker thread
+  std::thread m_worker;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  StringX m_pendingPassword;
+  long m_pendingId;
+  bool m_hasPending;
+  bool m_quit;
+
   wxDECLARE_EVENT_TABLE();
 };
 
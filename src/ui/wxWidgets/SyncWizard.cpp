@@ -25,6 +25,7 @@
 #include <wx/valgen.h>
 #include <wx/statline.h>
 #include <wx/collpane.h>
+#include <wx/timer.h>
 
 #include "core/core.h"
 #include "core/PWScore.h"
@@ -37,7 +38,10 @@
 #include "SyncWizard.h"
 
 #include <algorithm>
+#include <atomic>
 #include <iterator>
+#include <memory>
+#include <thread>
 
 /*!
  * SyncData class declaration
@@ -190,6 +194,10 @@ public:
  * Final page of the synchronization wizard, where all the synchronization happens
  * Either shows a progressbar followed by a success/error message, or an error
  * if the sync couldn't even be started
+ *
+ * The entries are matched by PWScore::PrepareSynchronize on a worker thread,
+ * which the page polls for progress, so that the wizard stays responsive and
+ * can be cancelled. The resulting commands are executed by the caller.
  */
 class SyncStatusPage: public SyncWizardPage
 {
@@ -200,11 +208,28 @@ class SyncStatusPage: public SyncWizardPage
   void SetHeaderText(const wxString& str);
   wxString GetReadErrorMessageTemplate(int rc);
   bool DbHasNoDuplicates(PWScore* core);
-  void Synchronize(PWScore* currentCore, const PWScore* otherCore);
+  void Synchronize(PWScore* currentCore, PWScore* otherCore);
+  void StopSynchronize();
   void ReportAdvancedOptions(CReport* rpt, const wxString& operation);
   void OnSyncStartEvent(wxCommandEvent& evt);
+  void OnProgressTimer(wxTimerEvent& evt);
+  void OnSyncDone(wxThreadEvent& evt);
+  void OnWizardCancel(wxWizardEvent& evt);
+  void EnableWizardButtons(bool enable);
+
+  std::unique_ptr<PWScore> m_otherCore;
+  wxTimer m_progressTimer;
+
+  // Shared with the worker thread
+  std::thread m_worker;
+  std::atomic<bool> m_cancelled;
+  std::atomic<int> m_phase;
+  std::atomic<size_t> m_done, m_total;
+  MultiCommands* m_syncCmds;       // set by the worker, read once it has finished
+  std::vector<StringX> m_updated;  // likewise
 public:
   SyncStatusPage(wxWizard* parent, SyncData* data);
+  ~SyncStatusPage();
 
   virtual void SaveData(SyncData* WXUNUSED(data)) {}
   virtual void OnPageEnter(PageDirection dir);
@@ -559,7 +584,12 @@ void SyncOptionsSummaryPage::OnPageEnter(PageDirection direction)
 DECLARE_EVENT_TYPE(wxEVT_SYNC_START, -1)
 DEFINE_EVENT_TYPE(wxEVT_SYNC_START)
 
-SyncStatusPage::SyncStatusPage(wxWizard* parent, SyncData* data): SyncWizardPage(parent, data, _("Synchronization status"))
+SyncStatusPage::SyncStatusPage(wxWizard* parent, SyncData* data): SyncWizardPage(parent, data, _("Synchronization status")),
+                                                                  m_progressTimer(this),
+                                                                  m_cancelled(false),
+                                                                  m_phase(PWScore::SyncProgress::MATCHING),
+                                                                  m_done(0), m_total(0),
+                                                                  m_syncCmds(nullptr)
 {
   wxBoxSizer* sizer = m_pageSizer;
   wxSizerFlags flags = wxSizerFlags().Expand().Proportion(1).Border(wxLEFT|wxRIGHT, SideMargin);
@@ -583,6 +613,15 @@ SyncStatusPage::SyncStatusPage(wxWizard* parent, SyncData* data): SyncWizardPage
   sizer->Add(horizSizer, flags.Proportion(1));
 
   SetSizerAndFit(sizer);
+
+  Bind(wxEVT_TIMER, &SyncStatusPage::OnProgressTimer, this, m_progressTimer.GetId());
+  Bind(wxEVT_THREAD, &SyncStatusPage::OnSyncDone, this);
+  Bind(wxEVT_WIZARD_CANCEL, &SyncStatusPage::OnWizardCancel, this);
+}
+
+SyncStatusPage::~SyncStatusPage()
+{
+  StopSynchronize();
 }
 
 void SyncStatusPage::SetSyncSummary(const wxString& str)
@@ -635,19 +674,59 @@ void SyncStatusPage::OnSyncStartEvent(wxCommandEvent& evt)
 {
   auto *otherCore = reinterpret_cast<PWScore*>(evt.GetClientData());
   wxASSERT_MSG(otherCore, wxT("Sync Start Event did not arrive with the other PWScore"));
+  m_otherCore.reset(otherCore);
   Synchronize(m_syncData->core, otherCore);
+}
 
-  SetHeaderText(wxString::Format(_("Your database has been synchronized with \"%ls\""), otherCore->GetCurFile().c_str()));
-  SetProgressText(wxString::Format(_("%ld %ls updated"), m_syncData->numUpdated,
-                      m_syncData->numUpdated == 1? _("entry"): _("entries")));
-  SetSyncSummary(_("Synchronization completed successfully"));
+void SyncStatusPage::OnProgressTimer(wxTimerEvent& WXUNUSED(evt))
+{
+  const size_t done = m_done, total = m_total;
+  wxGauge* gauge = wxDynamicCast(FindWindow(ID_GAUGE), wxGauge);
+  if (m_phase == PWScore::SyncProgress::MATCHING) {
+    if (total <= INT_MAX) {
+      gauge->SetRange(int(total));
+      gauge->SetValue(int(done));
+    }
+    SetProgressText(wxString::Format(_("%lu of %lu entries compared"),
+                                     static_cast<unsigned long>(done), static_cast<unsigned long>(total)));
+  }
+  else {
+    gauge->SetValue(gauge->GetRange());
+    SetProgressText(wxString::Format(_("Preparing the report of %lu updated entries"),
+                                     static_cast<unsigned long>(total)));
+  }
+}
 
-  delete otherCore;
+void SyncStatusPage::EnableWizardButtons(bool enable)
+{
+  // Cancel stays enabled, to stop the synchronization
+  for (auto id : {wxID_FORWARD, wxID_BACKWARD}) {
+    wxWindow* button = GetParent()->FindWindow(id);
+    if (button)
+      button->Enable(enable);
+  }
+}
 
-  FindWindow(ID_GAUGE)->Hide();
-  FindWindow(ID_SHOW_REPORT)->Show();
+void SyncStatusPage::StopSynchronize()
+{
+  if (m_worker.joinable()) {
+    m_cancelled = true;
+    m_worker.join(); // PrepareSynchronize checks every few entries
+    m_progressTimer.Stop();
+    delete m_syncCmds;
+    m_syncCmds = nullptr;
+  }
+}
 
-  GetSizer()->Layout();
+void SyncStatusPage::OnWizardCancel(wxWizardEvent& evt)
+{
+  if (m_worker.joinable()) {
+    StopSynchronize();
+    // The report's owner outlives us here, unlike in our dtor
+    m_syncData->syncReport->EndReport();
+    m_otherCore.reset();
+  }
+  evt.Skip();
 }
 
 wxString SyncStatusPage::GetReadErrorMessageTemplate(int rc)
@@ -677,17 +756,7 @@ bool SyncStatusPage::DbHasNoDuplicates(PWScore* core)
   return true;
 }
 
-/*
-Purpose:
-Merge entries from otherCore to currentCore
-
-Algorithm:
-Foreach entry in otherCore
-  Find in m_core
-  if find a match
-    update requested fields
-*/
-void SyncStatusPage::Synchronize(PWScore* currentCore, const PWScore *otherCore)
+void SyncStatusPage::Synchronize(PWScore* currentCore, PWScore* otherCore)
 {
   CReport& rpt = *m_syncData->syncReport;
 
@@ -697,116 +766,84 @@ void SyncStatusPage::Synchronize(PWScore* currentCore, const PWScore *otherCore)
 
   ReportAdvancedOptions(&rpt, _("synchronized"));
 
-  std::vector<StringX> vs_updated;
-  int numUpdated = 0;
-
-  MultiCommands *pmulticmds = MultiCommands::Create(currentCore);
-  Command *pcmd1 = UpdateGUICommand::Create(currentCore, UpdateGUICommand::WN_UNDO,
-                                            UpdateGUICommand::GUI_UNDO_MERGESYNC);
-  pmulticmds->Add(pcmd1);
+  // Everything the worker needs, so that it doesn't touch the UI
   const SelectionCriteria& criteria = m_syncData->selCriteria;
+  const CItemData::FieldBits bsFields = criteria.GetSelectedFields();
+  const bool subgroup_bset = criteria.HasSubgroupRestriction();
   const stringT subgroup_name = tostdstring(criteria.SubgroupSearchText());
+  const int subgroup_object = criteria.SubgroupObject();
+  const int subgroup_function = criteria.SubgroupFunctionWithCase();
+
+  m_cancelled = false;
+  m_done = 0;
+  m_total = otherCore->GetNumEntries();
+  EnableWizardButtons(false);
+  m_progressTimer.Start(100);
+
+  m_worker = std::thread([this, currentCore, otherCore, bsFields, subgroup_bset, subgroup_name,
+                          subgroup_object, subgroup_function] {
+    m_syncCmds = currentCore->PrepareSynchronize(otherCore, bsFields, subgroup_bset,
+                                                 subgroup_name, subgroup_object,
+                                                 subgroup_function, m_updated, nullptr,
+                                                 [this](const PWScore::SyncProgress& progress) {
+                                                   m_phase = progress.phase;
+                                                   m_done = progress.done;
+                                                   m_total = progress.total;
+                                                   return !m_cancelled;
+                                                 });
+    wxQueueEvent(this, new wxThreadEvent()); // the destructor joins us before the events go away
+  });
+}
+
+void SyncStatusPage::OnSyncDone(wxThreadEvent& WXUNUSED(evt))
+{
+  if (!m_worker.joinable())
+    return; // stopped by a cancel
+  m_worker.join();
+  m_progressTimer.Stop();
+  EnableWizardButtons(true);
+  if (m_syncCmds == nullptr) { // cancelled
+    m_syncData->syncReport->EndReport();
+    m_otherCore.reset();
+    return;
+  }
 
-  wxGauge* gauge = wxDynamicCast(FindWindow(ID_GAUGE), wxGauge);
-  gauge->SetRange(int(otherCore->GetNumEntries()));
-
-  ItemListConstIter otherPos;
-  for (otherPos = otherCore->GetEntryIter();
-       otherPos != otherCore->GetEntryEndIter();
-       otherPos++) {
-    const CItemData &otherItem = otherCore->GetEntry(otherPos);
-    CItemData::EntryType et = otherItem.GetEntryType();
-
-    const auto currentIndex = std::distance(otherCore->GetEntryIter(), otherPos);
-    gauge->SetValue(int(currentIndex));
-
-    // Do not process Aliases and Shortcuts
-    if (et == CItemData::ET_ALIAS || et == CItemData::ET_SHORTCUT)
-      continue;
-
-    const StringX otherGroup = otherItem.GetGroup();
-    const StringX otherTitle = otherItem.GetTitle();
-    const StringX otherUser = otherItem.GetUser();
-
-    const StringX sx_updated = StringX(wxT("\xab")) +
-                           otherGroup + StringX(wxT("\xbb \xab")) +
-                           otherTitle + StringX(wxT("\xbb \xab")) +
-                           otherUser  + StringX(wxT("\xbb"));
-
-    SetProgressText((wxString() << currentIndex << wxT(": ")) + towxstring(sx_updated));
-    wxSafeYield();
-
-    if (criteria.HasSubgroupRestriction() && !otherItem.Matches(subgroup_name, criteria.SubgroupObject(), criteria.SubgroupFunctionWithCase()))
-      continue;
-
-    ItemListConstIter foundPos = currentCore->Find(otherGroup, otherTitle, otherUser);
-
-    if (foundPos != currentCore->GetEntryEndIter()) {
-      // found a match
-      CItemData curItem = currentCore->GetEntry(foundPos);
-      CItemData updItem(curItem);
-
-      uuid_array_t current_uuid, other_uuid;
-      curItem.GetUUID(current_uuid);
-      otherItem.GetUUID(other_uuid);
-      if (memcmp(static_cast<void *>(current_uuid), static_cast<void *>(other_uuid), sizeof(uuid_array_t)) != 0) {
-        pws_os::Trace(wxT("Synchronize: Mis-match UUIDs for [%ls:%ls:%ls]\n"), otherGroup.c_str(), otherTitle.c_str(), otherUser.c_str());
-      }
-
-          bool bUpdated = currentCore->SyncItem(otherItem, updItem, criteria.GetSelectedFields(), *pmulticmds, otherCore);
-#if 0 // XXX remove when done!
-      bool bUpdated(false);
-      for (size_t i = 0; i < criteria.TotalFieldsCount(); i++) {
-        auto ft = static_cast<CItemData::FieldType>(i);
-        if (criteria.IsFieldSelected(ft)) {
-          const StringX sxValue = otherItem.GetFieldValue(ft);
-          if (sxValue != updItem.GetFieldValue(ft)) {
-            bUpdated = true;
-            updItem.SetFieldValue(ft, sxValue);
-          }
-        }
-      }
-#endif
-      if (!bUpdated)
-        continue;
-
-      updItem.SetStatus(CItemData::ES_MODIFIED);
-
-      vs_updated.push_back(sx_updated);
-
-      Command *pcmd = EditEntryCommand::Create(currentCore, curItem, updItem);
-      pcmd->SetNoGUINotify();
-      pmulticmds->Add(pcmd);
-
-      numUpdated++;
-    }  // Found match via [g:t:u]
-  } // iteration over other core's entries
-
+  CReport& rpt = *m_syncData->syncReport;
+  const size_t numUpdated = m_updated.size();
   if (numUpdated > 0) {
-    std::sort(vs_updated.begin(), vs_updated.end(), MergeSyncGTUCompare);
     const wxString cs_singular_plural_type = (numUpdated == 1 ? _("entry") : _("entries"));
     const wxString cs_singular_plural_verb = (numUpdated == 1 ? _("was") : _("were"));
     const wxString resultStr = wxString::Format(_("\nThe following %ls %ls updated:"), cs_singular_plural_type,
                                                 cs_singular_plural_verb);
     rpt.WriteLine(resultStr.c_str());
-    for (size_t i = 0; i < vs_updated.size(); i++) {
-      const wxString fieldName = wxString::Format(wxT("\t%ls"), vs_updated[i].c_str());
+    for (size_t i = 0; i < m_updated.size(); i++) {
+      const wxString fieldName = wxString::Format(wxT("\t%ls"), m_updated[i].c_str());
       rpt.WriteLine(fieldName.c_str());
     }
   }
 
-  Command *pcmd2 = UpdateGUICommand::Create(currentCore, UpdateGUICommand::WN_REDO,
-                                            UpdateGUICommand::GUI_REDO_MERGESYNC);
-  pmulticmds->Add(pcmd2);
-  m_syncData->syncCmds = pmulticmds; // will execute later
+  m_syncData->syncCmds = m_syncCmds; // will execute later
+  m_syncCmds = nullptr;
 
   /* tell the user we're done & provide short merge report */
   const wxString cs_entries = (numUpdated == 1 ? _("entry") : _("entries"));
-  wxString resultStr = wxString::Format(_("\nSynchronize completed: %d %ls updated"), numUpdated, cs_entries);
+  wxString resultStr = wxString::Format(_("\nSynchronize completed: %d %ls updated"), int(numUpdated), cs_entries);
   rpt.WriteLine(resultStr.c_str());
   rpt.EndReport();
 
   m_syncData->numUpdated = numUpdated;
+
+  SetHeaderText(wxString::Format(_("Your database has been synchronized with \"%ls\""), m_otherCore->GetCurFile().c_str()));
+  SetProgressText(wxString::Format(_("%ld %ls updated"), m_syncData->numUpdated,
+                      m_syncData->numUpdated == 1? _("entry"): _("entries")));
+  SetSyncSummary(_("Synchronization completed successfully"));
+
+  m_otherCore.reset();
+
+  FindWindow(ID_GAUGE)->Hide();
+  FindWindow(ID_SHOW_REPORT)->Show();
+
+  GetSizer()->Layout();
 }
 
 void SyncStatusPage::ReportAdvancedOptions(CReport* rpt, const wxString& operation)
@@ -44,6 +44,8 @@
 #include "DnDSupport.h"
 #include "DnDDropTarget.h"
 
+#include <algorithm>
+#include <functional>
 #include <utility> // for make_pair
 #include <vector>
 
@@ -265,6 +267,8 @@ void TreeCtrl::Init()
   m_bFilterActive = false;
   m_last_dnd_item = nullptr;
   m_run_dnd = false;
+  m_dnd_cut_group_path = true;
+  m_dnd_moved = false;
 ////@end TreeCtrl member initialisation
 }
 
@@ -348,12 +352,10 @@ void TreeCtrl::UpdateGUI(UpdateGUICommand::GUI_Action ga, const pws_os::CUUID &e
   switch (ga) {
     case UpdateGUICommand::GUI_UPDATE_STATUSBAR:
       // Handled by PasswordSafeFrame
-      if(HasItems())
-        SortChildrenRecursively(GetRootItem());
       break;
     case UpdateGUICommand::GUI_ADD_ENTRY:
       ASSERT(item != nullptr);
-      if(!m_bFilterActive) {
+      if (wxGetApp().GetPasswordSafeFrame()->PassesFilter(*item)) {
         AddItem(*item);
         auto itemId = Find(*item);
         if (itemId.IsOk()) {
@@ -368,7 +370,8 @@ void TreeCtrl::UpdateGUI(UpdateGUICommand::GUI_Action ga, const pws_os::CUUID &e
     case UpdateGUICommand::GUI_REFRESH_ENTRYFIELD:
     case UpdateGUICommand::GUI_REFRESH_ENTRYPASSWORD:
       ASSERT(item != nullptr);
-      UpdateItemField(*item, ft);
+      if (!UpdateFilteredItem(*item))
+        UpdateItemField(*item, ft);
       break;
     case UpdateGUICommand::GUI_REDO_IMPORT:
     case UpdateGUICommand::GUI_UNDO_IMPORT:
@@ -377,11 +380,14 @@ void TreeCtrl::UpdateGUI(UpdateGUICommand::GUI_Action ga, const pws_os::CUUID &e
       // Handled by PasswordSafeFrame
       break;
     case UpdateGUICommand::GUI_REFRESH_TREE:
-      // Handled by PasswordSafeFrame
+      // An entry moved to another group; anything else is rebuilt by PasswordSafeFrame
+      if (item != nullptr && !UpdateFilteredItem(*item))
+        UpdateItem(*item);
       break;
     case UpdateGUICommand::GUI_REFRESH_ENTRY:
       ASSERT(item != nullptr);
-      UpdateItem(*item);
+      if (!UpdateFilteredItem(*item))
+        UpdateItem(*item);
       break;
     case UpdateGUICommand::GUI_REFRESH_GROUPS:
     case UpdateGUICommand::GUI_REFRESH_BOTHVIEWS:
@@ -622,6 +628,28 @@ wxString TreeCtrl::GetItemGroup(const wxTreeItemId& item) const
     return GetPath(item);
 }
 
+/**
+ * If the item's passing the active filter has changed, adds or removes it
+ * and returns true. Returns false if there's nothing more to it than
+ * updating the item in place.
+ */
+bool TreeCtrl::UpdateFilteredItem(const CItemData &item)
+{
+  if (!m_bFilterActive)
+    return false;
+
+  const bool shown = Find(item).IsOk();
+  if (wxGetApp().GetPasswordSafeFrame()->PassesFilter(item)) {
+    if (shown)
+      return false;
+    AddItem(item);
+  }
+  else if (shown) {
+    Remove(item.GetUUID());
+  }
+  return true;
+}
+
 void TreeCtrl::UpdateItem(const CItemData &item)
 {
   const wxTreeItemId node = Find(item);
@@ -630,7 +658,10 @@ void TreeCtrl::UpdateItem(const CItemData &item)
     const wxString newGroup = GroupNameOfItem(item).c_str();
     if (oldGroup == newGroup) {
       const wxString disp = ItemDisplayString(item);
-      SetItemText(node, disp);
+      if (GetItemText(node) != disp) {
+        SetItemText(node, disp);
+        SortChildren(GetItemParent(node)); // title may have changed
+      }
       SetItemImage(node, item);
     } else { // uh-oh - group's changed
       uuid_array_t uuid;
@@ -745,6 +776,89 @@ void TreeCtrlBase::AddItem(const CItemData &item)
   m_item_map.insert(std::make_pair(CUUID(uuid), titem));
 }
 
+namespace {
+  // Group hierarchy of the items being added by AddItems(), built before
+  // anything goes into the tree
+  struct BulkGroup {
+    std::map<StringX, BulkGroup> subgroups; // by path element
+    std::vector<std::pair<wxString, const CItemData *>> entries; // display string, item
+  };
+
+  BulkGroup &FindOrAddBulkGroup(BulkGroup &root, const StringX &group)
+  {
+    BulkGroup *g = &root;
+    StringX path = group;
+    while (!path.empty())
+      g = &g->subgroups[GetPathElem(path)];
+    return *g;
+  }
+
+  // A group's child, with the text it's sorted by
+  struct BulkChild {
+    wxString text;
+    BulkGroup *group;        // if a group
+    const CItemData *item;   // if an entry
+  };
+}
+
+void TreeCtrlBase::AddItems(const std::vector<const CItemData *> &items,
+                            const std::vector<StringX> &emptyGroups)
+{
+  AddRootItem();
+  if (GetChildrenCount(GetRootItem(), false) != 0) {
+    // Not building from scratch, so merge item by item
+    for (const auto *item : items)
+      AddItem(*item);
+    for (const auto &group : emptyGroups)
+      AddGroup(group);
+    return;
+  }
+
+  BulkGroup root;
+  for (const auto *item : items)
+    FindOrAddBulkGroup(root, GroupNameOfItem(*item)).entries.emplace_back(ItemDisplayString(*item), item);
+  for (const auto &group : emptyGroups)
+    FindOrAddBulkGroup(root, group);
+
+  const bool groupsFirst = IsGroupsFirst();
+  auto compare = [this, groupsFirst](const BulkChild &c1, const BulkChild &c2) {
+    if (groupsFirst && (c1.group != nullptr) != (c2.group != nullptr))
+      return c1.group != nullptr;
+    return CompareText(c1.text, c2.text) < 0;
+  };
+
+  // Sort each group's children once, on their cached display strings,
+  // and append them in that order
+  std::function<void(const wxTreeItemId &, BulkGroup &)> addChildren =
+    [&](const wxTreeItemId &node, BulkGroup &group) {
+      std::vector<BulkChild> children;
+      children.reserve(group.subgroups.size() + group.entries.size());
+      for (auto &subgroup : group.subgroups)
+        children.push_back({subgroup.first.c_str(), &subgroup.second, nullptr});
+      for (const auto &entry : group.entries)
+        children.push_back({entry.first, nullptr, entry.second});
+      std::stable_sort(children.begin(), children.end(), compare);
+
+      for (const auto &child : children) {
+        if (child.group != nullptr) {
+          const wxTreeItemId gnode = AppendItem(node, child.text);
+          wxTreeCtrl::SetItemImage(gnode, NODE_II);
+          addChildren(gnode, *child.group);
+          setNodeAsEmptyIfNeeded(gnode);
+        } else {
+          const wxTreeItemId titem = AppendItem(node, child.text, -1, -1,
+                                                new PWTreeItemData(*child.item));
+          SetItemImage(titem, *child.item);
+          m_item_map.insert(std::make_pair(child.item->GetUUID(), titem));
+        }
+      }
+    };
+
+  Freeze();
+  addChildren(GetRootItem(), root);
+  Thaw();
+}
+
 /**
  * Adds the root element to the tree if there is none.
  *
@@ -783,9 +897,14 @@ CItemData *TreeCtrlBase::GetItem(const wxTreeItemId &id) const
   return &itemiter->second;
 }
 
+bool TreeCtrl::IsGroupsFirst() const
+{
+  return PWSprefs::GetInstance()->GetPref(PWSprefs::ExplorerTypeTree);
+}
+
 int TreeCtrl::OnCompareItems(const wxTreeItemId& item1, const wxTreeItemId& item2)
 {
-  const bool groupsFirst = PWSprefs::GetInstance()->GetPref(PWSprefs::ExplorerTypeTree),
+  const bool groupsFirst = IsGroupsFirst(),
              item1isGroup = ItemIsGroup(item1),
              item2isGroup = ItemIsGroup(item2);
 
@@ -798,7 +917,7 @@ int TreeCtrl::OnCompareItems(const wxTreeItemId& item1, const wxTreeItemId& item
 
   const wxString text1 = GetItemText(item1);
   const wxString text2 = GetItemText(item2);
-  return text1.CmpNoCase(text2);
+  return CompareText(text1, text2);
 }
 
 void TreeCtrlBase::SortChildrenRecursively(const wxTreeItemId& item)
@@ -2102,21 +2221,26 @@ void TreeCtrl::OnDrag(wxAuiToolBarEvent& event)
   }
   
   pws_os::Trace(L"TreeCtrl::OnDrag Start");
-  wxMemoryBuffer buffer;
-  wxString fileName = L"";
-  CollectDnDData(buffer, fileName);
-  if(! buffer.GetDataLen()) {
+  if(GetRootItem() == m_last_dnd_item) {
     pws_os::Trace(L"TreeCtrl::OnDrag End without buffer content");
     event.Skip();
     return;
   }
   
-  pws_os::Trace(L"TreeCtrl::OnDrag Size %ld", static_cast<long>(buffer.GetDataLen()));
+  // With shift key pressed on drag left full group, else wise remove path to group
+  m_dnd_cut_group_path = ! ::wxGetKeyState(WXK_SHIFT);
   
-  DnDPWSafeObject dragData(&buffer);
+  // The entries are only serialized if they're dropped somewhere else than
+  // onto this tree as a move, see IsLocalDnDMove
+  wxString fileName = L"";
+  DnDPWSafeObject dragData([this, &fileName](wxMemoryBuffer &buffer) {
+    CollectDnDData(buffer, fileName);
+    pws_os::Trace(L"TreeCtrl::OnDrag Size %ld", static_cast<long>(buffer.GetDataLen()));
+  });
   
   wxDropSource source(dragData, this);
   m_run_dnd = true; // mark running drag and drop to be aware on local dropping
+  m_dnd_moved = false;
   
   switch(source.DoDragDrop(true))
   {
@@ -2138,7 +2262,7 @@ void TreeCtrl::OnDrag(wxAuiToolBarEvent& event)
 #if !defined(__WXMAC__)
       // mac OS darg and drop only allows Move, as control/command is not handled
       // Perform copy as default action for mac OS
-      if(! ::wxGetKeyState(WXK_CONTROL) && ! m_core.IsReadOnly()) {
+      if(! m_dnd_moved && ! ::wxGetKeyState(WXK_CONTROL) && ! m_core.IsReadOnly()) {
         class Command *doit;
         doit = wxGetApp().GetPasswordSafeFrame()->Delete(m_last_dnd_item);
         if (doit != nullptr)
@@ -2157,6 +2281,7 @@ void TreeCtrl::OnDrag(wxAuiToolBarEvent& event)
   }
   
   m_run_dnd = false;
+  m_dnd_moved = false;
 #else
   event.Skip();
 #endif
@@ -2169,8 +2294,7 @@ void TreeCtrl::CollectDnDData(wxMemoryBuffer &outDDmem, wxString &fileName)
   wxTreeItemId parent = GetItemParent(m_last_dnd_item);
   StringX DragPathParent = tostringx((GetRootItem() != m_last_dnd_item) ? GetItemGroup(parent) : "");
   DnDObList dnd_oblist(DragPathParent.length());
-  // With shift key pressed on drag left full group, else wise remove path to group
-  dnd_oblist.SetDragNode(::wxGetKeyState(WXK_SHIFT) ? false : true);
+  dnd_oblist.SetDragNode(m_dnd_cut_group_path);
   
   if((m_last_dnd_item == nullptr) || (GetRootItem() == m_last_dnd_item))
     return;
@@ -2806,9 +2930,19 @@ void TreeCtrl::AddDnDEntries(MultiCommands *pmCmd, DnDObList &dnd_oblist, String
   }
 }
 
+bool TreeCtrl::IsLocalDnDMove() const
+{
+#if defined(__WXMAC__)
+  // mac OS drag and drop only allows Move, which is performed as copy, see OnDrag
+  return false;
+#else
+  return m_run_dnd && ! ::wxGetKeyState(WXK_CONTROL);
+#endif
+}
+
 wxDragResult TreeCtrl::OnDrop(wxCoord x, wxCoord y, wxMemoryBuffer *inDDmem)
 {
-  if(! inDDmem) {
+  if(! inDDmem && ! IsLocalDnDMove()) {
     pws_os::Trace(L"TreeCtrl::OnDrop return 'wxDragNone' on missing memory");
     return wxDragNone;
   }
@@ -2846,7 +2980,7 @@ wxDragResult TreeCtrl::OnDrop(wxCoord x, wxCoord y, wxMemoryBuffer *inDDmem)
   
   pws_os::Trace(L"TreeCtrl::OnDrop to path '%ls'", sxDropPath.c_str());
   
-  if (ProcessDnDData(sxDropPath, inDDmem)) {
+  if (inDDmem ? ProcessDnDData(sxDropPath, inDDmem) : MoveDnDItem(sxDropPath)) {
     pws_os::Trace(L"TreeCtrl::OnDrop return '%s'", reportCopy ? "wxDragCopy" : "wxDragMove");
     result = reportCopy ? wxDragCopy : wxDragMove;
 
@@ -2860,6 +2994,118 @@ wxDragResult TreeCtrl::OnDrop(wxCoord x, wxCoord y, wxMemoryBuffer *inDDmem)
   return result;
 }
 
+/**
+ * Moves the dragged entry or group to sxDropPath by changing the group of
+ * its entries, which gives the same result as copying them there with
+ * CollectDnDData and ProcessDnDData and then deleting the originals, without
+ * serializing any of them.
+ *
+ * @return false if there's nothing to move, e.g., on dropping onto the
+ *         dragged item's own group
+ */
+bool TreeCtrl::MoveDnDItem(const StringX &sxDropPath)
+{
+  wxASSERT(m_last_dnd_item.IsOk() && (GetRootItem() != m_last_dnd_item));
+
+  const wxTreeItemId parent = GetItemParent(m_last_dnd_item);
+  const size_t parentLen = tostringx(GetItemGroup(parent)).length();
+  StringX sxDropGroup(L"");
+  if(!sxDropPath.empty()) // Add DOT at end of drop destination if not root
+    sxDropGroup = sxDropPath + GROUP_SEP;
+
+  // Where a group ends up, as in GetEntryData and AddDnDEntries
+  auto NewGroup = [&](const StringX &sxGroup) -> StringX {
+    StringX sxRelative = sxGroup;
+    if(m_dnd_cut_group_path && (parentLen > 0))
+      sxRelative = sxGroup.length() > parentLen ? sxGroup.substr(parentLen + 1) : L"";
+    return sxRelative.empty() ? sxDropPath : sxDropGroup + sxRelative;
+  };
+
+  std::vector<CItemData *> entries;
+  std::function<void(wxTreeItemId)> CollectEntries = [&](wxTreeItemId item) {
+    if(! ItemIsGroup(item)) {
+      CItemData *pci = TreeCtrl::GetItem(item);
+      wxASSERT(pci != NULL);
+      entries.push_back(pci);
+      return;
+    }
+    wxTreeItemIdValue cookie;
+    for(wxTreeItemId ti = GetFirstChild(item, cookie); ti; ti = GetNextSibling(ti))
+      CollectEntries(ti);
+  };
+  CollectEntries(m_last_dnd_item);
+
+  MultiCommands *pmcmd = MultiCommands::Create(&m_core);
+  if(!pmcmd)
+    return false;
+
+  // The entries don't notify the views one by one, which would take longer
+  // than the move itself with thousands of them; the views are rebuilt once
+  pmcmd->Add(UpdateGUICommand::Create(&m_core,
+    UpdateGUICommand::WN_UNDO, UpdateGUICommand::GUI_UNDO_MERGESYNC));
+
+  GTUSet setGTU;
+  m_core.InitialiseGTU(setGTU);
+  time_t t;
+  time(&t);
+
+  for(CItemData *pci : entries) {
+    const StringX sxOldGroup = pci->GetGroup();
+    const StringX sxGroup = NewGroup(sxOldGroup);
+    if(sxGroup == sxOldGroup)
+      continue;
+
+    StringX sxTitle = pci->GetTitle();
+    const StringX sxUser = pci->GetUser();
+    setGTU.erase(st_GroupTitleUser(sxOldGroup, sxTitle, sxUser));
+    m_core.MakeEntryUnique(setGTU, sxGroup, sxTitle, sxUser, IDSC_DRAGNUMBER);
+
+    CItemData modifiedItem(*pci);
+    modifiedItem.SetGroup(sxGroup);
+    modifiedItem.SetTitle(sxTitle);
+    modifiedItem.SetRMTime(t);
+
+    Command *pcmd = EditEntryCommand::Create(&m_core, *pci, modifiedItem);
+    pcmd->SetNoGUINotify();
+    pmcmd->Add(pcmd);
+  }
+
+  // Empty groups move along with the dragged group
+  if(ItemIsGroup(m_last_dnd_item)) {
+    const StringX sxDragPath = tostringx(GetItemGroup(m_last_dnd_item));
+    const StringX sxDragPathWithDot = sxDragPath + GROUP_SEP;
+    for(const auto & emptyGroup : m_core.GetEmptyGroups())
+    {
+      if(emptyGroup == sxDragPath || emptyGroup.find(sxDragPathWithDot) == 0) {
+        const StringX sxNew = NewGroup(emptyGroup);
+        if(sxNew != emptyGroup)
+          pmcmd->Add(DBEmptyGroupsCommand::Create(&m_core, emptyGroup, sxNew, DBEmptyGroupsCommand::EG_RENAME));
+      }
+    }
+  }
+
+  if(pmcmd->GetSize() == 1) {
+    delete pmcmd;
+    return false;
+  }
+
+  // The group the item was dragged out of stays, if empty now,
+  // and the group dropped into isn't empty anymore
+  if((GetRootItem() != parent) && (GetChildrenCount(parent, false) == 1)) {
+    pmcmd->Add(DBEmptyGroupsCommand::Create(&m_core, tostringx(GetItemGroup(parent)), DBEmptyGroupsCommand::EG_ADD));
+  }
+  if(!sxDropPath.empty() && m_core.IsEmptyGroup(sxDropPath)) {
+    pmcmd->Add(DBEmptyGroupsCommand::Create(&m_core, sxDropPath, DBEmptyGroupsCommand::EG_DELETE));
+  }
+
+  pmcmd->Add(UpdateGUICommand::Create(&m_core,
+    UpdateGUICommand::WN_EXECUTE_REDO, UpdateGUICommand::GUI_REDO_MERGESYNC));
+
+  m_core.Execute(pmcmd);
+  m_dnd_moved = true;
+  return true;
+}
+
 void TreeCtrlBase::setNodeAsNotEmpty(const wxTreeItemId item)
 {
   if(GetRootItem() != item && GetItemImage(item) == EMPTY_NODE_II)
@@ -30,6 +30,7 @@
 #include "os/UUID.h"
 
 #include <map>
+#include <vector>
 
 #include "DnDSupport.h"
 ////@end includes
@@ -117,6 +118,10 @@ public:
   
   void Clear(); // consistent name w/GridCtrl
   void AddItem(const CItemData &item);
+  // Builds the tree from scratch: each group's children are sorted once,
+  // then appended in order, instead of re-sorting the group per AddItem
+  void AddItems(const std::vector<const CItemData *> &items,
+                const std::vector<StringX> &emptyGroups = std::vector<StringX>());
   StringX GroupNameOfItem(const CItemData &item);
   
   CItemData *GetItem(const wxTreeItemId &id) const;
@@ -145,6 +150,12 @@ public:
   bool IsSortingName() const { return m_sort == TreeSortType::NAME; }
   bool IsSortingDate() const { return m_sort == TreeSortType::DATE; }
   
+protected:
+  // Order of a group's children, for both OnCompareItems and AddItems.
+  // Defaults match wxTreeCtrl's own OnCompareItems
+  virtual bool IsGroupsFirst() const { return false; }
+  virtual int CompareText(const wxString &text1, const wxString &text2) const { return text1.Cmp(text2); }
+
 private:
   bool ExistsInTree(wxTreeItemId node, const StringX &s, wxTreeItemId &si) const;
   
@@ -280,12 +291,18 @@ public:
   
   void SetDndEntry(wxTreeItemId item) { m_last_dnd_item = item; }
   bool IsReadOnly() { return m_core.IsReadOnly(); }
+  // True while an item of this tree is being dragged to be moved, which the
+  // drop target hands to OnDrop without data, see MoveDnDItem
+  bool IsLocalDnDMove() const;
   wxDragResult OnDrop(wxCoord x, wxCoord y, wxMemoryBuffer *inDDmem);
 
 private:
   void PreferencesChanged();
+  bool UpdateFilteredItem(const CItemData &item);
 
   virtual int OnCompareItems(const wxTreeItemId& item1, const wxTreeItemId& item2) override;
+  bool IsGroupsFirst() const override;
+  int CompareText(const wxString &text1, const wxString &text2) const override { return text1.CmpNoCase(text2); }
   void FinishAddingGroup(wxTreeEvent& evt, wxTreeItemId groupItem);
   void FinishRenamingGroup(wxTreeEvent& evt, wxTreeItemId groupItem, const wxString& oldPath);
   CItemData CreateNewItemAsCopy(const CItemData *dataSrc, StringX sxNewPath, bool checkName, bool newEntry = false);
@@ -309,6 +326,7 @@ private:
   void GetEntryData(DnDObList &dnd_oblist, CItemData *pci);
   bool ProcessDnDData(StringX &sxDropPath, wxMemoryBuffer *inDDmem);
   void AddDnDEntries(MultiCommands *pmCmd, DnDObList &dnd_oblist, StringX &sxDropPath);
+  bool MoveDnDItem(const StringX &sxDropPath);
 
   void EditTreeLabel(wxTreeCtrl* tree, const wxTreeItemId& id);
 
@@ -318,6 +336,8 @@ private:
   wxColour m_drag_background_colour;
   wxTreeItemId m_last_dnd_item;
   bool m_run_dnd;
+  bool m_dnd_cut_group_path; // Shift wasn't pressed on drag, see DnDObList::CutGroupPath
+  bool m_dnd_moved;          // dropped by MoveDnDItem, nothing left to delete
 
   TreeCtrlTimer m_collapse_timer;
   wxTreeItemId m_last_mice_item_in_drag_and_drop;
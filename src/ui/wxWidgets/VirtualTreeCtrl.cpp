@@ -0,0 +1,402 @@
+/*
+ * Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+ * All rights reserved. Use of the code is allowed under the
+ * Artistic License 2.0 terms, as specified in the LICENSE file
+ * distributed with this code, or available from
+ * http://www.opensource.org/licenses/artistic-license-2.0.php
+ */
+
+/** \file VirtualTreeCtrl.cpp
+*
+*/
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include <wx/wxprec.h>
+
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+#include "VirtualTreeCtrl.h"
+#include "PasswordSafeFrame.h" // for DispatchDblClickAction()
+#include "PWSafeApp.h"
+
+#include "core/PWSprefs.h"
+
+#include <algorithm>
+
+#ifdef __WXMSW__
+#include <wx/msw/msvcrt.h>
+#endif
+
+using pws_os::CUUID;
+
+namespace {
+// Same as TreeCtrl's, less the group, which is where the entry is anyway
+wxString EntryDisplayString(const CItemData &item)
+{
+  PWSprefs *prefs = PWSprefs::GetInstance();
+  wxString disp = item.GetTitle().c_str();
+
+  if (prefs->GetPref(PWSprefs::ShowUsernameInTree))
+    disp += wxT(" [") + wxString(item.GetUser().c_str()) + wxT("]");
+
+  if (prefs->GetPref(PWSprefs::ShowPasswordInTree))
+    disp += wxT(" {") + wxString(item.GetPassword().c_str()) + wxT("}");
+
+  if (item.IsProtected())
+    disp += wxUniChar(0x1f512); // padlock
+
+  if (item.HasAttRef() || item.HasAttachment())
+    disp += wxUniChar(0x1f4ce); // paperclip
+
+  return disp;
+}
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////
+// VirtualTreeModel
+
+wxString VirtualTreeModel::GetColumnType(unsigned int WXUNUSED(col)) const
+{
+  return wxT("string");
+}
+
+void VirtualTreeModel::GetValue(wxVariant &variant, const wxDataViewItem &item,
+                                unsigned int WXUNUSED(col)) const
+{
+  const GroupIndex::Node *node = ToNode(item);
+  if (node == nullptr) {
+    variant = wxString();
+  } else if (node->isGroup) {
+    variant = wxString(static_cast<const GroupIndex::Group *>(node)->name.c_str());
+  } else {
+    // Only called for the rows being drawn, so this is the only place
+    // (besides sorting) where entry fields get decrypted
+    auto iter = m_core.Find(static_cast<const GroupIndex::Entry *>(node)->uuid);
+    variant = (iter != m_core.GetEntryEndIter()) ? EntryDisplayString(iter->second) : wxString();
+  }
+}
+
+bool VirtualTreeModel::SetValue(const wxVariant &WXUNUSED(variant), const wxDataViewItem &WXUNUSED(item),
+                                unsigned int WXUNUSED(col))
+{
+  return false; // read-only
+}
+
+wxDataViewItem VirtualTreeModel::GetParent(const wxDataViewItem &item) const
+{
+  const GroupIndex::Node *node = ToNode(item);
+  if (node == nullptr || node->parent == &m_index.GetRoot())
+    return wxDataViewItem(nullptr);
+  return ToItem(node->parent);
+}
+
+bool VirtualTreeModel::IsContainer(const wxDataViewItem &item) const
+{
+  const GroupIndex::Node *node = ToNode(item);
+  return node == nullptr || node->isGroup;
+}
+
+unsigned int VirtualTreeModel::GetChildren(const wxDataViewItem &item,
+                                           wxDataViewItemArray &children) const
+{
+  const GroupIndex::Node *node = ToNode(item);
+  const GroupIndex::Group &group = (node == nullptr) ? m_index.GetRoot()
+                                   : *static_cast<const GroupIndex::Group *>(node);
+  const std::vector<const GroupIndex::Node *> &sorted = SortedChildren(group);
+  children.Alloc(sorted.size());
+  for (const GroupIndex::Node *child : sorted)
+    children.Add(ToItem(child));
+  return static_cast<unsigned int>(sorted.size());
+}
+
+// Groups first, then entries, each by name ignoring case, as the tree's
+// default sort order. An entry's title is decrypted once per sort, not once
+// per comparison.
+const std::vector<const GroupIndex::Node *> &
+VirtualTreeModel::SortedChildren(const GroupIndex::Group &group) const
+{
+  auto found = m_children.find(&group);
+  if (found != m_children.end())
+    return found->second;
+
+  std::vector<const GroupIndex::Node *> &sorted = m_children[&group];
+  sorted.reserve(group.subgroups.size() + group.entries.size());
+
+  std::vector<const GroupIndex::Group *> groups;
+  groups.reserve(group.subgroups.size());
+  for (const auto &subgroup : group.subgroups)
+    groups.push_back(subgroup.second.get());
+  std::stable_sort(groups.begin(), groups.end(),
+                   [](const GroupIndex::Group *a, const GroupIndex::Group *b) {
+                     return CompareNoCase(a->name, b->name) < 0;
+                   });
+  sorted.insert(sorted.end(), groups.begin(), groups.end());
+
+  std::vector<std::pair<StringX, const GroupIndex::Entry *>> entries;
+  entries.reserve(group.entries.size());
+  for (const auto &entry : group.entries) {
+    auto iter = m_core.Find(entry->uuid);
+    entries.emplace_back(iter != m_core.GetEntryEndIter() ? iter->second.GetTitle() : StringX(),
+                         entry.get());
+  }
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const std::pair<StringX, const GroupIndex::Entry *> &a,
+                      const std::pair<StringX, const GroupIndex::Entry *> &b) {
+                     return CompareNoCase(a.first, b.first) < 0;
+                   });
+  for (const auto &entry : entries)
+    sorted.push_back(entry.second);
+
+  return sorted;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// VirtualTreeCtrl
+
+IMPLEMENT_CLASS( VirtualTreeCtrl, wxDataViewCtrl )
+
+BEGIN_EVENT_TABLE( VirtualTreeCtrl, wxDataViewCtrl )
+  EVT_DATAVIEW_ITEM_ACTIVATED( wxID_ANY, VirtualTreeCtrl::OnItemActivated )
+  EVT_DATAVIEW_ITEM_CONTEXT_MENU( wxID_ANY, VirtualTreeCtrl::OnItemContextMenu )
+  EVT_DATAVIEW_SELECTION_CHANGED( wxID_ANY, VirtualTreeCtrl::OnSelectionChanged )
+END_EVENT_TABLE()
+
+VirtualTreeCtrl::VirtualTreeCtrl(wxWindow* parent, PWScore &core, wxWindowID id,
+                                 const wxPoint& pos, const wxSize& size, long style)
+  : wxDataViewCtrl(parent, id, pos, size, style), m_core(core),
+    m_model(new VirtualTreeModel(core, m_index))
+{
+  AssociateModel(m_model);
+  AppendTextColumn(wxEmptyString, 0);
+}
+
+VirtualTreeCtrl::~VirtualTreeCtrl()
+{
+  m_model->DecRef(); // AssociateModel() took its own reference
+}
+
+void VirtualTreeCtrl::Rebuild(const std::vector<const CItemData *> &items,
+                              const std::vector<StringX> &emptyGroups)
+{
+  // Cleared() collapses everything, so note which groups were open, as
+  // TreeCtrl does via m_guiInfo, and reopen those that still exist
+  std::vector<StringX> expanded;
+  GetExpandedGroups(m_index.GetRoot(), expanded);
+
+  // Only the groups are read here; nothing else gets decrypted until
+  // the user expands a group
+  m_index.Clear();
+  for (const CItemData *item : items)
+    m_index.Add(*item);
+  for (const auto &group : emptyGroups)
+    m_index.AddGroup(group);
+  m_model->InvalidateAll();
+  m_model->Cleared();
+
+  for (const auto &path : expanded) {
+    const GroupIndex::Group *group = m_index.FindGroup(path);
+    if (group != nullptr)
+      Expand(VirtualTreeModel::ToItem(group));
+  }
+}
+
+void VirtualTreeCtrl::GetExpandedGroups(const GroupIndex::Group &group,
+                                        std::vector<StringX> &paths) const
+{
+  // Parents go before their subgroups, so they can be expanded in order
+  for (const auto &sub : group.subgroups) {
+    if (IsExpanded(VirtualTreeModel::ToItem(sub.second.get()))) {
+      paths.push_back(sub.second->GetPath());
+      GetExpandedGroups(*sub.second, paths);
+    }
+  }
+}
+
+void VirtualTreeCtrl::Clear()
+{
+  m_index.Clear();
+  m_model->InvalidateAll();
+  m_model->Cleared();
+}
+
+void VirtualTreeCtrl::AddItem(const CItemData &item)
+{
+  // If the entry's group is new, the topmost new group is what appears
+  const GroupIndex::Group *existing = &m_index.GetRoot();
+  StringX path = item.GetGroup();
+  while (!path.empty()) {
+    auto iter = existing->subgroups.find(GroupIndex::PopPathElement(path));
+    if (iter == existing->subgroups.end())
+      break;
+    existing = iter->second.get();
+  }
+
+  const GroupIndex::Node *added = m_index.Add(item);
+  while (added->parent != existing)
+    added = added->parent;
+
+  m_model->Invalidate(existing);
+  m_model->ItemAdded(existing == &m_index.GetRoot() ? wxDataViewItem(nullptr)
+                                                    : VirtualTreeModel::ToItem(existing),
+                     VirtualTreeModel::ToItem(added));
+}
+
+void VirtualTreeCtrl::UpdateItem(const CItemData &item)
+{
+  // The title or group may have changed, either of which can move the
+  // entry, so take it out and put it back where it now belongs
+  const CUUID uuid = item.GetUUID();
+  const CItemData *selected = GetItem(GetSelection());
+  const bool wasSelected = (selected != nullptr && selected->GetUUID() == uuid);
+  // Only prune once it's back in, so that its group doesn't get
+  // removed and recreated (and collapsed) if it stays where it was
+  const GroupIndex::Group *oldGroup = RemoveEntry(uuid);
+  AddItem(item);
+  if (oldGroup != nullptr)
+    PruneGroups(oldGroup);
+  if (wasSelected)
+    SelectItem(uuid);
+}
+
+void VirtualTreeCtrl::Remove(const CUUID &uuid)
+{
+  const GroupIndex::Group *parent = RemoveEntry(uuid);
+  if (parent != nullptr)
+    PruneGroups(parent);
+}
+
+// Returns the group the entry was in, nullptr if it wasn't shown
+const GroupIndex::Group *VirtualTreeCtrl::RemoveEntry(const CUUID &uuid)
+{
+  const GroupIndex::Entry *entry = m_index.Find(uuid);
+  if (entry == nullptr)
+    return nullptr;
+
+  const GroupIndex::Group *parent = entry->parent;
+  const wxDataViewItem item = VirtualTreeModel::ToItem(entry);
+  m_index.Remove(uuid);
+  m_model->Invalidate(parent);
+  m_model->ItemDeleted(parent == &m_index.GetRoot() ? wxDataViewItem(nullptr)
+                                                    : VirtualTreeModel::ToItem(parent),
+                       item);
+  return parent;
+}
+
+// Takes out the group, and then its parents, if they've been left with
+// nothing in them, as a rebuild would. Empty groups of the database stay.
+void VirtualTreeCtrl::PruneGroups(const GroupIndex::Group *group)
+{
+  const GroupIndex::Group *root = &m_index.GetRoot();
+  while (group != root && group->entries.empty() && group->subgroups.empty() &&
+         !m_core.IsEmptyGroup(group->GetPath())) {
+    const GroupIndex::Group *parent = group->parent;
+    const wxDataViewItem item = VirtualTreeModel::ToItem(group);
+    m_model->Invalidate(group);
+    m_index.RemoveGroup(group);
+    m_model->Invalidate(parent);
+    m_model->ItemDeleted(parent == root ? wxDataViewItem(nullptr)
+                                        : VirtualTreeModel::ToItem(parent),
+                         item);
+    group = parent;
+  }
+}
+
+void VirtualTreeCtrl::UpdateGUI(UpdateGUICommand::GUI_Action ga, const CUUID &entry_uuid,
+                                CItemData::FieldType WXUNUSED(ft))
+{
+  ItemListIter iter = m_core.Find(entry_uuid);
+  const CItemData *item = (iter != m_core.GetEntryEndIter()) ? &iter->second : nullptr;
+
+  switch (ga) {
+    case UpdateGUICommand::GUI_ADD_ENTRY:
+      if (item != nullptr && wxGetApp().GetPasswordSafeFrame()->PassesFilter(*item)) {
+        AddItem(*item);
+        EnsureVisible(VirtualTreeModel::ToItem(m_index.Find(entry_uuid)));
+      }
+      break;
+    case UpdateGUICommand::GUI_DELETE_ENTRY:
+      Remove(entry_uuid);
+      break;
+    case UpdateGUICommand::GUI_REFRESH_ENTRYFIELD:
+    case UpdateGUICommand::GUI_REFRESH_ENTRYPASSWORD:
+    case UpdateGUICommand::GUI_REFRESH_ENTRY:
+    case UpdateGUICommand::GUI_REFRESH_TREE: // if an entry moved to another group
+      if (item == nullptr)
+        break;
+      if (wxGetApp().GetPasswordSafeFrame()->PassesFilter(*item))
+        UpdateItem(*item);
+      else
+        Remove(entry_uuid);
+      break;
+    default:
+      // Everything else is handled by PasswordSafeFrame, which rebuilds us
+      break;
+  }
+}
+
+void VirtualTreeCtrl::GUIRefreshEntry(const CItemData &item, bool WXUNUSED(bAllowFail))
+{
+  if (item.GetStatus() == CItemData::ES_DELETED)
+    Remove(item.GetUUID());
+  else
+    UpdateItem(item);
+}
+
+CItemData *VirtualTreeCtrl::GetItem(const wxDataViewItem &item) const
+{
+  const GroupIndex::Node *node = VirtualTreeModel::ToNode(item);
+  if (node == nullptr || node->isGroup)
+    return nullptr;
+  ItemListIter iter = m_core.Find(static_cast<const GroupIndex::Entry *>(node)->uuid);
+  return (iter != m_core.GetEntryEndIter()) ? &iter->second : nullptr;
+}
+
+CItemData *VirtualTreeCtrl::GetSelectedItem() const
+{
+  return GetItem(GetSelection());
+}
+
+bool VirtualTreeCtrl::IsGroupSelected() const
+{
+  const GroupIndex::Node *node = VirtualTreeModel::ToNode(GetSelection());
+  return node != nullptr && node->isGroup;
+}
+
+void VirtualTreeCtrl::SelectItem(const CUUID &uuid)
+{
+  const GroupIndex::Entry *entry = m_index.Find(uuid);
+  if (entry == nullptr)
+    return;
+  const wxDataViewItem item = VirtualTreeModel::ToItem(entry);
+  EnsureVisible(item); // expands the groups it's in
+  Select(item);
+}
+
+void VirtualTreeCtrl::SetFilterState(bool state)
+{
+  SetForegroundColour(state ? *wxRED : wxNullColour);
+  Refresh();
+}
+
+void VirtualTreeCtrl::OnItemActivated(wxDataViewEvent &evt)
+{
+  CItemData *item = GetItem(evt.GetItem());
+  if (item != nullptr)
+    wxGetApp().GetPasswordSafeFrame()->DispatchDblClickAction(*item);
+  else
+    evt.Skip(); // expand/collapse group
+}
+
+void VirtualTreeCtrl::OnItemContextMenu(wxDataViewEvent &evt)
+{
+  if (evt.GetItem().IsOk())
+    Select(evt.GetItem());
+  wxGetApp().GetPasswordSafeFrame()->OnContextMenu(GetItem(evt.GetItem()));
+}
+
+void VirtualTreeCtrl::OnSelectionChanged(wxDataViewEvent &evt)
+{
+  wxGetApp().GetPasswordSafeFrame()->UpdateSelChanged(GetItem(evt.GetItem()));
+}
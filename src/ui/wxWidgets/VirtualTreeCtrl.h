@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2003-2026 Rony Shapiro <ronys@pwsafe.org>.
+ * All rights reserved. Use of the code is allowed under the
+ * Artistic License 2.0 terms, as specified in the LICENSE file
+ * distributed with this code, or available from
+ * http://www.opensource.org/licenses/artistic-license-2.0.php
+ */
+
+/** \file VirtualTreeCtrl.h
+*
+* A nested view of the entries for very large databases. Unlike TreeCtrl,
+* which creates a node for every entry and group up front, this one is a
+* wxDataViewCtrl over a GroupIndex: nodes are only created when their group
+* is expanded, and entries are only decrypted for the rows that are shown.
+*/
+
+#ifndef _VIRTUALTREECTRL_H_
+#define _VIRTUALTREECTRL_H_
+
+#include <wx/dataview.h>
+
+#include "core/GroupIndex.h"
+#include "core/ItemData.h"
+#include "core/PWScore.h"
+#include "core/UIinterface.h"
+#include "os/UUID.h"
+
+#include <map>
+#include <vector>
+
+#define ID_VIRTUALTREECTRL 10062
+
+/*!
+ * VirtualTreeModel class declaration
+ *
+ * Item ids are the GroupIndex nodes themselves.
+ */
+
+class VirtualTreeModel : public wxDataViewModel
+{
+public:
+  VirtualTreeModel(PWScore &core, const GroupIndex &index) : m_core(core), m_index(index) {}
+
+  static wxDataViewItem ToItem(const GroupIndex::Node *node)
+    { return wxDataViewItem(const_cast<GroupIndex::Node *>(node)); }
+  static const GroupIndex::Node *ToNode(const wxDataViewItem &item)
+    { return static_cast<const GroupIndex::Node *>(item.GetID()); }
+
+  // Forget the sorted children of a group, e.g., after one was added or removed
+  void Invalidate(const GroupIndex::Group *group) { m_children.erase(group); }
+  void InvalidateAll() { m_children.clear(); }
+
+  unsigned int GetColumnCount() const override { return 1; }
+  wxString GetColumnType(unsigned int col) const override;
+  void GetValue(wxVariant &variant, const wxDataViewItem &item, unsigned int col) const override;
+  bool SetValue(const wxVariant &variant, const wxDataViewItem &item, unsigned int col) override;
+  wxDataViewItem GetParent(const wxDataViewItem &item) const override;
+  bool IsContainer(const wxDataViewItem &item) const override;
+  unsigned int GetChildren(const wxDataViewItem &item, wxDataViewItemArray &children) const override;
+
+private:
+  const std::vector<const GroupIndex::Node *> &SortedChildren(const GroupIndex::Group &group) const;
+
+  PWScore &m_core;
+  const GroupIndex &m_index;
+  // Children of the groups that have been expanded, groups first, in display order
+  mutable std::map<const GroupIndex::Group *, std::vector<const GroupIndex::Node *>> m_children;
+};
+
+/*!
+ * VirtualTreeCtrl class declaration
+ */
+
+class VirtualTreeCtrl : public wxDataViewCtrl, public Observer
+{
+  DECLARE_CLASS( VirtualTreeCtrl )
+  DECLARE_EVENT_TABLE()
+
+public:
+  VirtualTreeCtrl(wxWindow* parent, PWScore &core,
+                  wxWindowID id = ID_VIRTUALTREECTRL, const wxPoint& pos = wxDefaultPosition,
+                  const wxSize& size = wxDefaultSize, long style = wxDV_NO_HEADER|wxDV_SINGLE);
+  ~VirtualTreeCtrl();
+
+  /* Observer Interface Implementation */
+
+  /// Implements Observer::UpdateGUI(UpdateGUICommand::GUI_Action, const pws_os::CUUID&, CItemData::FieldType)
+  void UpdateGUI(UpdateGUICommand::GUI_Action ga, const pws_os::CUUID &entry_uuid, CItemData::FieldType ft = CItemData::START) override;
+
+  /// Implements Observer::GUIRefreshEntry(const CItemData&, bool)
+  void GUIRefreshEntry(const CItemData &item, bool bAllowFail = false) override;
+
+  void Rebuild(const std::vector<const CItemData *> &items,
+               const std::vector<StringX> &emptyGroups = {});
+  void Clear();
+
+  void AddItem(const CItemData &item);
+  void UpdateItem(const CItemData &item);
+  void Remove(const pws_os::CUUID &uuid);
+
+  CItemData *GetSelectedItem() const;
+  bool IsGroupSelected() const;
+  void SelectItem(const pws_os::CUUID &uuid);
+
+  void SetFilterState(bool state);
+
+private:
+  void OnItemActivated(wxDataViewEvent &evt);
+  void OnItemContextMenu(wxDataViewEvent &evt);
+  void OnSelectionChanged(wxDataViewEvent &evt);
+
+  CItemData *GetItem(const wxDataViewItem &item) const;
+  const GroupIndex::Group *RemoveEntry(const pws_os::CUUID &uuid);
+  void PruneGroups(const GroupIndex::Group *group);
+  // Appends the paths of the expanded groups under group
+  void GetExpandedGroups(const GroupIndex::Group &group, std::vector<StringX> &paths) const;
+
+  PWScore &m_core;
+  GroupIndex m_index;
+  VirtualTreeModel *m_model;
+};
+
+#endif // _VIRTUALTREECTRL_H_